@@ -35,8 +35,10 @@
 // Needed for checking for B-spline for faster implementation
 #include "itkAdvancedBSplineDeformableTransform.h"
 #include "itkAdvancedCombinationTransform.h"
+#include "itkStackTransform.h"
 
 #include "itkPlatformMultiThreader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -168,6 +170,9 @@ public:
   typedef typename BSplineOrder2TransformType::Pointer                             BSplineOrder2TransformPointer;
   typedef typename BSplineOrder3TransformType::Pointer                             BSplineOrder3TransformPointer;
 
+  /** Typedef for the stack transform, used by the groupwise metrics. */
+  typedef StackTransform< ScalarType, FixedImageDimension, MovingImageDimension > StackTransformType;
+
   /** Hessian type; for SelfHessian (experimental feature) */
   typedef typename DerivativeType::ValueType    HessianValueType;
   typedef vnl_sparse_matrix< HessianValueType > HessianType;
@@ -205,6 +210,18 @@ public:
   }
 
 
+  /** Typedefs for the random number generator, used by metrics that
+   * draw random numbers of their own, for example random time points.
+   */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
+
+  /** Set/Get the random number generator. By default the global instance
+   * of the MersenneTwisterRandomVariateGenerator is used.
+   */
+  itkSetObjectMacro( RandomGenerator, RandomGeneratorType );
+  itkGetModifiableObjectMacro( RandomGenerator, RandomGeneratorType );
+
   /** Inheriting classes can specify whether they use the image sampler functionality;
    * This method allows the user to inspect this setting. */
   itkGetConstMacro( UseImageSampler, bool );
@@ -341,6 +358,9 @@ protected:
    */
   mutable ImageSamplerPointer m_ImageSampler;
 
+  /** The random number generator. */
+  RandomGeneratorPointer m_RandomGenerator;
+
   /** Variables for image derivative computation. */
   bool                                   m_InterpolatorIsLinear;
   bool                                   m_InterpolatorIsBSpline;
@@ -357,6 +377,7 @@ protected:
   bool m_TransformIsAdvanced;
   typename AdvancedTransformType::Pointer m_AdvancedTransform;
   mutable bool m_TransformIsBSpline;
+  mutable typename StackTransformType::ConstPointer m_StackTransform;
 
   /** Variables for the Limiters. */
   FixedImageLimiterPointer     m_FixedImageLimiter;
@@ -532,6 +553,25 @@ protected:
     TransformJacobianType & jacobian,
     NonZeroJacobianIndicesType & nzji ) const;
 
+  /** Check if the transform is a stack transform that is not combined with
+   * an initial transform. Called by Initialize. If so, TransformPoints() and
+   * EvaluateTransformJacobians() use the batched methods of the stack transform.
+   */
+  virtual void CheckForStackTransform( void ) const;
+
+  /** Batched versions of TransformPoint() and EvaluateTransformJacobian(),
+   * used by the groupwise metrics to evaluate one spatial location at
+   * several time points in one call.
+   */
+  virtual void TransformPoints(
+    const std::vector< FixedImagePointType > & fixedImagePoints,
+    std::vector< MovingImagePointType > & mappedPoints ) const;
+
+  virtual void EvaluateTransformJacobians(
+    const std::vector< FixedImagePointType > & fixedImagePoints,
+    std::vector< TransformJacobianType > & jacobians,
+    std::vector< NonZeroJacobianIndicesType > & nzjis ) const;
+
   /** Convenience method: check if point is inside the moving mask. *****************/
   virtual bool IsInsideMovingMask( const MovingImagePointType & point ) const;
 
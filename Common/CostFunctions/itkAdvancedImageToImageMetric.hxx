@@ -51,6 +51,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   this->m_ImageSampler                = 0;
   this->m_UseImageSampler             = false;
   this->m_RequiredRatioOfValidSamples = 0.25;
+  this->m_RandomGenerator             = RandomGeneratorType::GetInstance();
 
   this->m_LinearInterpolator              = 0;
   this->m_BSplineInterpolator             = 0;
@@ -170,6 +171,9 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   /** Check if the transform is a B-spline transform. */
   this->CheckForBSplineTransform();
 
+  /** Check if the transform is a stack transform. */
+  this->CheckForStackTransform();
+
   /** Initialize some threading related parameters. */
   if( this->m_UseMultiThread )
   {
@@ -574,6 +578,36 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end CheckForBSplineTransform()
 
 
+/**
+ * ****************** CheckForStackTransform **********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::CheckForStackTransform( void ) const
+{
+  this->m_StackTransform = nullptr;
+
+  /** Check if this transform is a stack transform. */
+  const StackTransformType * testPtr_stack
+    = dynamic_cast< const StackTransformType * >( this->m_AdvancedTransform.GetPointer() );
+
+  /** Check if this transform is a combo transform with only a stack transform. */
+  const CombinationTransformType * testPtr_combo
+    = dynamic_cast< const CombinationTransformType * >( this->m_AdvancedTransform.GetPointer() );
+  if( !testPtr_stack && testPtr_combo && testPtr_combo->GetInitialTransform() == nullptr )
+  {
+    testPtr_stack = dynamic_cast< const StackTransformType * >(
+      testPtr_combo->GetCurrentTransform() );
+  }
+
+  /** Store the result. */
+  this->m_StackTransform = testPtr_stack;
+
+} // end CheckForStackTransform()
+
+
 /**
  * ******************* EvaluateMovingImageValueAndDerivative ******************
  */
@@ -792,6 +826,60 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end EvaluateTransformJacobian()
 
 
+/**
+ * *************** TransformPoints ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformPoints(
+  const std::vector< FixedImagePointType > & fixedImagePoints,
+  std::vector< MovingImagePointType > & mappedPoints ) const
+{
+  if( this->m_StackTransform.IsNotNull() )
+  {
+    this->m_StackTransform->TransformPoints( fixedImagePoints, mappedPoints );
+    return;
+  }
+
+  mappedPoints.resize( fixedImagePoints.size() );
+  for( std::size_t i = 0; i < fixedImagePoints.size(); ++i )
+  {
+    this->TransformPoint( fixedImagePoints[ i ], mappedPoints[ i ] );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * *************** EvaluateTransformJacobians ****************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::EvaluateTransformJacobians(
+  const std::vector< FixedImagePointType > & fixedImagePoints,
+  std::vector< TransformJacobianType > & jacobians,
+  std::vector< NonZeroJacobianIndicesType > & nzjis ) const
+{
+  if( this->m_StackTransform.IsNotNull() )
+  {
+    this->m_StackTransform->GetJacobians( fixedImagePoints, jacobians, nzjis );
+    return;
+  }
+
+  jacobians.resize( fixedImagePoints.size() );
+  nzjis.resize( fixedImagePoints.size() );
+  for( std::size_t i = 0; i < fixedImagePoints.size(); ++i )
+  {
+    this->EvaluateTransformJacobian( fixedImagePoints[ i ], jacobians[ i ], nzjis[ i ] );
+  }
+
+} // end EvaluateTransformJacobians()
+
+
 /**
  * ************************** IsInsideMovingMask *************************
  */
@@ -1027,6 +1115,8 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
      << this->m_ImageSampler.GetPointer() << std::endl;
   os << indent.GetNextIndent() << "UseImageSampler: "
      << this->m_UseImageSampler << std::endl;
+  os << indent.GetNextIndent() << "RandomGenerator: "
+     << this->m_RandomGenerator.GetPointer() << std::endl;
 
   /** Variables for the Limiters. */
   os << indent << "Variables related to the Limiters: " << std::endl;
@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "itkMultiInputResampleImageFilter.h"
+
+#include <itkAffineTransform.h>
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkBSplineTransform.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace
+{
+  using ImageType = itk::Image<float, 2>;
+  using TransformType = itk::Transform<double, 2, 2>;
+  using InterpolatorType = itk::InterpolateImageFunction<ImageType, double>;
+  using MultiInputResamplerType = itk::MultiInputResampleImageFilter<ImageType, ImageType, double>;
+
+  const ImageType::SizeType outputSize{ { 35, 33 } };
+  const double outputSpacing[] = { 0.9, 0.9 };
+
+  // Creates a 40x30 image with a smooth pattern, which differs per seed.
+  ImageType::Pointer CreateImage(const double seed)
+  {
+    const auto image = ImageType::New();
+    image->SetRegions(ImageType::SizeType{ { 40, 30 } });
+    image->Allocate();
+
+    for (itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      const double x = it.GetIndex()[0];
+      const double y = it.GetIndex()[1];
+      it.Set(static_cast<float>(100.0 * std::sin(0.2 * seed * x) * std::cos(0.15 * y + seed)));
+    }
+    return image;
+  }
+
+
+  // Resamples an image with an itk::ResampleImageFilter, as a reference.
+  ImageType::Pointer Resample(ImageType * image, const TransformType * transform, InterpolatorType * interpolator)
+  {
+    const auto resampler = itk::ResampleImageFilter<ImageType, ImageType, double>::New();
+    resampler->SetInput(image);
+    resampler->SetTransform(transform);
+    resampler->SetInterpolator(interpolator);
+    resampler->SetSize(outputSize);
+    resampler->SetOutputSpacing(outputSpacing);
+    resampler->SetDefaultPixelValue(-5.0f);
+    resampler->Update();
+    return resampler->GetOutput();
+  }
+
+
+  // Expects that resampling two images in a single pass gives the same result
+  // as resampling them one by one.
+  void ExpectSameResultAsResampleImageFilter(const TransformType * transform)
+  {
+    const ImageType::Pointer images[] = { CreateImage(1.0), CreateImage(2.0) };
+    const InterpolatorType::Pointer interpolators[] = {
+      itk::LinearInterpolateImageFunction<ImageType, double>::New().GetPointer(),
+      itk::BSplineInterpolateImageFunction<ImageType, double>::New().GetPointer()
+    };
+
+    const auto multiInputResampler = MultiInputResamplerType::New();
+    multiInputResampler->SetTransform(transform);
+    multiInputResampler->SetSize(outputSize);
+    multiInputResampler->SetOutputSpacing(ImageType::SpacingType(outputSpacing));
+    multiInputResampler->SetDefaultPixelValue(-5.0f);
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      multiInputResampler->SetInput(i, images[i]);
+      multiInputResampler->SetInterpolator(i, interpolators[i]);
+    }
+    multiInputResampler->Update();
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      const ImageType::Pointer expected = Resample(images[i], transform, interpolators[i]);
+      const ImageType * actual = multiInputResampler->GetOutput(i);
+      ASSERT_EQ(actual->GetLargestPossibleRegion(), expected->GetLargestPossibleRegion());
+      EXPECT_EQ(actual->GetSpacing(), expected->GetSpacing());
+
+      itk::ImageRegionConstIterator<ImageType> actualIt(actual, actual->GetLargestPossibleRegion());
+      itk::ImageRegionConstIterator<ImageType> expectedIt(expected, expected->GetLargestPossibleRegion());
+      for (; !actualIt.IsAtEnd(); ++actualIt, ++expectedIt)
+      {
+        EXPECT_NEAR(actualIt.Get(), expectedIt.Get(), 1e-3);
+      }
+    }
+  }
+
+} // namespace
+
+
+// Tests a linear transform, for which the mapped points are computed incrementally.
+GTEST_TEST(MultiInputResampleImageFilter, AffineTransform)
+{
+  const auto transform = itk::AffineTransform<double, 2>::New();
+  transform->Rotate2D(0.3);
+  transform->Translate(itk::Vector<double, 2>(3.3));
+
+  ExpectSameResultAsResampleImageFilter(transform);
+}
+
+
+// Tests a nonlinear transform, for which each point is mapped separately.
+GTEST_TEST(MultiInputResampleImageFilter, BSplineTransform)
+{
+  using BSplineTransformType = itk::BSplineTransform<double, 2, 3>;
+  const auto transform = BSplineTransformType::New();
+  BSplineTransformType::PhysicalDimensionsType physicalDimensions;
+  physicalDimensions.Fill(40.0);
+  BSplineTransformType::MeshSizeType meshSize;
+  meshSize.Fill(4);
+  transform->SetTransformDomainPhysicalDimensions(physicalDimensions);
+  transform->SetTransformDomainMeshSize(meshSize);
+
+  BSplineTransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(1.7 * i);
+  }
+  transform->SetParametersByValue(parameters);
+
+  ExpectSameResultAsResampleImageFilter(transform);
+}
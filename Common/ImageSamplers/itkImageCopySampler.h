@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __ImageCopySampler_h
+#define __ImageCopySampler_h
+
+#include "itkImageSamplerBase.h"
+
+#include <memory>
+#include <mutex>
+
+namespace itk
+{
+/** \class ImageCopySampler
+ *
+ * \brief Provides a private copy of the samples of another sampler.
+ *
+ * This sampler is used by clones of a metric that are evaluated
+ * concurrently. Updating a sampler is not thread-safe: it updates the
+ * pipeline of the fixed image, and it may select new samples. Each clone
+ * therefore gets an ImageCopySampler of the sampler of the original metric,
+ * the source sampler. Update() does not update the pipeline of this sampler.
+ * It brings the source sampler up to date instead, under a mutex that is
+ * shared by all copies of the same source, and copies its samples when
+ * they have changed since the previous update. The clones thus always use
+ * the same samples as the original metric.
+ *
+ * The original metric should not be evaluated at the same time as its
+ * clones, since it updates the source sampler without the mutex.
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TInputImage >
+class ImageCopySampler :
+  public ImageSamplerBase< TInputImage >
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef ImageCopySampler                Self;
+  typedef ImageSamplerBase< TInputImage > Superclass;
+  typedef SmartPointer< Self >            Pointer;
+  typedef SmartPointer< const Self >      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageCopySampler, ImageSamplerBase );
+
+  /** Typedefs inherited from the superclass. */
+  typedef typename Superclass::ImageSampleContainerType    ImageSampleContainerType;
+  typedef typename Superclass::ImageSampleContainerPointer ImageSampleContainerPointer;
+
+  /** The type of the mutex shared by the copies of a source sampler. */
+  typedef std::shared_ptr< std::mutex > SourceMutexPointer;
+
+  /** Set/Get the sampler whose samples are copied. */
+  itkSetObjectMacro( SourceSampler, Superclass );
+  itkGetModifiableObjectMacro( SourceSampler, Superclass );
+
+  /** Set/Get the mutex that serializes the updates of the source sampler.
+   * All copies of the same source sampler should share the same mutex.
+   */
+  virtual void SetSourceMutex( const SourceMutexPointer & mutex )
+  {
+    this->m_SourceMutex = mutex;
+  }
+
+
+  virtual const SourceMutexPointer & GetSourceMutex( void ) const
+  {
+    return this->m_SourceMutex;
+  }
+
+
+  /** Bring the source sampler up to date and copy its samples, if they
+   * changed. The pipeline of this sampler itself is not updated.
+   */
+  void Update( void ) override;
+
+  /** New samples are selected by the source sampler. */
+  bool SelectNewSamplesOnUpdate( void ) override
+  {
+    return false;
+  }
+
+
+  /** Returns whether the sampler supports SelectNewSamplesOnUpdate(). */
+  bool SelectingNewSamplesOnUpdateSupported( void ) const override
+  {
+    return false;
+  }
+
+
+protected:
+
+  /** The constructor. */
+  ImageCopySampler();
+  /** The destructor. */
+  ~ImageCopySampler() override {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Copies the samples of the source sampler. */
+  void GenerateData( void ) override;
+
+private:
+
+  /** The private constructor. */
+  ImageCopySampler( const Self & );          // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );            // purposely not implemented
+
+  typename Superclass::Pointer m_SourceSampler;
+  SourceMutexPointer           m_SourceMutex;
+  ModifiedTimeType             m_CopiedSourceUpdateTime;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageCopySampler.hxx"
+#endif
+
+#endif // end #ifndef __ImageCopySampler_h
@@ -0,0 +1,100 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __ImageCopySampler_hxx
+#define __ImageCopySampler_hxx
+
+#include "itkImageCopySampler.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage >
+ImageCopySampler< TInputImage >
+::ImageCopySampler()
+{
+  this->m_SourceMutex            = std::make_shared< std::mutex >();
+  this->m_CopiedSourceUpdateTime = 0;
+
+} // end Constructor
+
+
+/**
+ * ******************* Update *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::Update( void )
+{
+  if( this->m_SourceSampler.IsNull() )
+  {
+    itkExceptionMacro( << "No source sampler has been set!" );
+  }
+
+  std::lock_guard< std::mutex > lock( *this->m_SourceMutex );
+  this->m_SourceSampler->Update();
+  if( this->m_SourceSampler->GetOutput()->GetUpdateMTime() != this->m_CopiedSourceUpdateTime )
+  {
+    this->GenerateData();
+  }
+
+} // end Update()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::GenerateData( void )
+{
+  const ImageSampleContainerType * source = this->m_SourceSampler->GetOutput();
+  this->GetOutput()->CastToSTLContainer() = source->CastToSTLConstContainer();
+  this->GetOutput()->Modified();
+  this->m_CopiedSourceUpdateTime = source->GetUpdateMTime();
+
+} // end GenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage >
+void
+ImageCopySampler< TInputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "SourceSampler: " << this->m_SourceSampler.GetPointer() << std::endl;
+  os << indent << "CopiedSourceUpdateTime: " << this->m_CopiedSourceUpdateTime << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __ImageCopySampler_hxx
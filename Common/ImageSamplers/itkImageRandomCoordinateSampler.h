@@ -21,7 +21,6 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -88,8 +87,8 @@ public:
     InputImageType, CoordRepType, double >                    DefaultInterpolatorType;
 
   /** The random number generator used to generate random coordinates. */
-  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
-  typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
+  typedef typename Superclass::RandomGeneratorType    RandomGeneratorType;
+  typedef typename Superclass::RandomGeneratorPointer RandomGeneratorPointer;
 
   /** Set/Get the interpolator. A 3rd order B-spline interpolator is used by default. */
   itkSetObjectMacro( Interpolator, InterpolatorType );
@@ -134,7 +133,6 @@ protected:
     InputImageContinuousIndexType &       randomContIndex );
 
   InterpolatorPointer    m_Interpolator;
-  RandomGeneratorPointer m_RandomGenerator;
   InputImageSpacingType  m_SampleRegionSize;
 
   /** Generate the two corners of a sampling region, given the two corners
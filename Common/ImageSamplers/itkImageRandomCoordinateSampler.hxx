@@ -38,9 +38,6 @@ ImageRandomCoordinateSampler< TInputImage >
   bsplineInterpolator->SetSplineOrder( 3 );
   this->m_Interpolator = bsplineInterpolator;
 
-  /** Setup random generator. */
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
-
   this->m_UseRandomSampleRegion = false;
   this->m_SampleRegionSize.Fill( 1.0 );
 
@@ -360,7 +357,6 @@ ImageRandomCoordinateSampler< TInputImage >
   Superclass::PrintSelf( os, indent );
 
   os << indent << "Interpolator: " << this->m_Interpolator.GetPointer() << std::endl;
-  os << indent << "RandomGenerator: " << this->m_RandomGenerator.GetPointer() << std::endl;
 
 } // end PrintSelf()
 
@@ -91,6 +91,10 @@ protected:
     const InputImageRegionType & inputRegionForThread,
     ThreadIdType threadId ) override;
 
+  /** Translate a random position in the cropped input image region to an index. */
+  void RandomPositionToIndex( unsigned long randomPosition,
+    InputImageIndexType & positionIndex ) const;
+
 private:
 
   /** The private constructor. */
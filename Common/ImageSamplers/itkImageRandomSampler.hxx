@@ -20,8 +20,6 @@
 
 #include "itkImageRandomSampler.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
-#include "itkImageRandomConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -50,31 +48,33 @@ ImageRandomSampler< TInputImage >
   /** Reserve memory for the output. */
   sampleContainer->Reserve( this->GetNumberOfSamples() );
 
-  /** Setup a random iterator over the input image. */
-  typedef ImageRandomConstIteratorWithIndex< InputImageType > RandomIteratorType;
-  RandomIteratorType randIter( inputImage, this->GetCroppedInputImageRegion() );
-  randIter.GoToBegin();
+  /** The random positions are drawn in the same way as by the
+   * ImageRandomConstIteratorWithIndex, but from the random generator of
+   * this sampler. Start with a dummy jump, in order to generate the same
+   * sequence as the multi-threaded version.
+   */
+  const double numPixels = static_cast< double >( this->GetCroppedInputImageRegion().GetNumberOfPixels() );
+  this->m_RandomGenerator->GetVariateWithOpenRange( numPixels - 0.5 ); // dummy jump
 
   /** Setup an iterator over the output, which is of ImageSampleContainerType. */
   typename ImageSampleContainerType::Iterator iter;
   typename ImageSampleContainerType::ConstIterator end = sampleContainer->End();
 
+  InputImageIndexType index;
   if( mask.IsNull() )
   {
-    /** number of samples + 1, because of the initial ++randIter. */
-    randIter.SetNumberOfSamples( this->GetNumberOfSamples() + 1 );
-    /** Advance one, in order to generate the same sequence as when using a mask */
-    ++randIter;
     for( iter = sampleContainer->Begin(); iter != end; ++iter )
     {
-      /** Get the index, transform it to the physical coordinates and put it in the sample. */
-      InputImageIndexType index = randIter.GetIndex();
+      /** Jump to a random position. */
+      this->RandomPositionToIndex( static_cast< unsigned long >(
+        this->m_RandomGenerator->GetVariateWithOpenRange( numPixels - 0.5 ) ), index );
+
+      /** Transform the index to the physical coordinates and put it in the sample. */
       inputImage->TransformIndexToPhysicalPoint( index,
         ( *iter ).Value().m_ImageCoordinates );
+
       /** Get the value and put it in the sample. */
-      ( *iter ).Value().m_ImageValue = randIter.Get();
-      /** Jump to a random position. */
-      ++randIter;
+      ( *iter ).Value().m_ImageValue = static_cast< ImageSampleValueType >( inputImage->GetPixel( index ) );
 
     } // end for loop
   } // end if no mask
@@ -87,7 +87,8 @@ ImageRandomSampler< TInputImage >
     }
 
     /** Make sure we are not eternally trying to find samples: */
-    randIter.SetNumberOfSamples( 10 * this->GetNumberOfSamples() );
+    const unsigned long maximumNumberOfJumps = 10 * this->GetNumberOfSamples();
+    unsigned long       numberOfJumps        = 0;
 
     /** Loop over the sample container. */
     InputImagePointType inputPoint;
@@ -97,10 +98,8 @@ ImageRandomSampler< TInputImage >
       /** Loop until a valid sample is found. */
       do
       {
-        /** Jump to a random position. */
-        ++randIter;
         /** Check if we are not trying eternally to find a valid point. */
-        if( randIter.IsAtEnd() )
+        if( numberOfJumps >= maximumNumberOfJumps )
         {
           /** Squeeze the sample container to the size that is still valid. */
           typename ImageSampleContainerType::iterator stlnow = sampleContainer->begin();
@@ -110,8 +109,11 @@ ImageRandomSampler< TInputImage >
           itkExceptionMacro( << "Could not find enough image samples within "
                              << "reasonable time. Probably the mask is too small" );
         }
-        /** Get the index, and transform it to the physical coordinates. */
-        InputImageIndexType index = randIter.GetIndex();
+        /** Jump to a random position. */
+        ++numberOfJumps;
+        this->RandomPositionToIndex( static_cast< unsigned long >(
+          this->m_RandomGenerator->GetVariateWithOpenRange( numPixels - 0.5 ) ), index );
+        /** Transform the index to the physical coordinates. */
         inputImage->TransformIndexToPhysicalPoint( index, inputPoint );
         /** Check if it's inside the mask. */
         insideMask = mask->IsInsideInWorldSpace( inputPoint );
@@ -120,15 +122,15 @@ ImageRandomSampler< TInputImage >
 
       /** Put the coordinates and the value in the sample. */
       ( *iter ).Value().m_ImageCoordinates = inputPoint;
-      ( *iter ).Value().m_ImageValue       = randIter.Get();
+      ( *iter ).Value().m_ImageValue       = static_cast< ImageSampleValueType >( inputImage->GetPixel( index ) );
 
     } // end for loop
+  } // end if mask
 
-    /** Extra random sample to make sure the same sequence is generated
-     * with and without mask.
-     */
-    ++randIter;
-  }
+  /** Extra random jump to make sure the same sequence is generated
+   * with and without mask, and with and without multi-threading.
+   */
+  this->m_RandomGenerator->GetVariateWithOpenRange( numPixels - 0.5 ); // dummy jump
 
 } // end GenerateData()
 
@@ -171,24 +173,13 @@ ImageRandomSampler< TInputImage >
   typename ImageSampleContainerType::ConstIterator end = sampleContainerThisThread->End();
 
   /** Fill the local sample container. */
-  unsigned long       sampleId    = sampleStart;
-  InputImageSizeType  regionSize  = this->GetCroppedInputImageRegion().GetSize();
-  InputImageIndexType regionIndex = this->GetCroppedInputImageRegion().GetIndex();
+  unsigned long sampleId = sampleStart;
   for( iter = sampleContainerThisThread->Begin(); iter != end; ++iter, sampleId++ )
   {
     unsigned long randomPosition = static_cast< unsigned long >( this->m_RandomNumberList[ sampleId ] );
 
-    /** Translate randomPosition to an index, copied from ImageRandomConstIteratorWithIndex. */
-    unsigned long       residual;
     InputImageIndexType positionIndex;
-    for( unsigned int dim = 0; dim < InputImageDimension; dim++ )
-    {
-      const unsigned long sizeInThisDimension = regionSize[ dim ];
-      residual             = randomPosition % sizeInThisDimension;
-      positionIndex[ dim ] = residual + regionIndex[ dim ];
-      randomPosition      -= residual;
-      randomPosition      /= sizeInThisDimension;
-    }
+    this->RandomPositionToIndex( randomPosition, positionIndex );
 
     /** Transform index to the physical coordinates and put it in the sample. */
     inputImage->TransformIndexToPhysicalPoint( positionIndex,
@@ -202,6 +193,32 @@ ImageRandomSampler< TInputImage >
 } // end ThreadedGenerateData()
 
 
+/**
+ * ******************* RandomPositionToIndex *******************
+ */
+
+template< class TInputImage >
+void
+ImageRandomSampler< TInputImage >
+::RandomPositionToIndex( unsigned long randomPosition, InputImageIndexType & positionIndex ) const
+{
+  /** Translate randomPosition to an index, copied from ImageRandomConstIteratorWithIndex. */
+  const InputImageSizeType  regionSize  = this->GetCroppedInputImageRegion().GetSize();
+  const InputImageIndexType regionIndex = this->GetCroppedInputImageRegion().GetIndex();
+
+  unsigned long residual;
+  for( unsigned int dim = 0; dim < InputImageDimension; dim++ )
+  {
+    const unsigned long sizeInThisDimension = regionSize[ dim ];
+    residual             = randomPosition % sizeInThisDimension;
+    positionIndex[ dim ] = residual + regionIndex[ dim ];
+    randomPosition      -= residual;
+    randomPosition      /= sizeInThisDimension;
+  }
+
+} // end RandomPositionToIndex()
+
+
 } // end namespace itk
 
 #endif // end #ifndef __ImageRandomSampler_hxx
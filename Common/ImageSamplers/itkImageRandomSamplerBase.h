@@ -19,6 +19,7 @@
 #define __ImageRandomSamplerBase_h
 
 #include "itkImageSamplerBase.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -27,7 +28,8 @@ namespace itk
  *
  * \brief This class is a base class for any image sampler that randomly picks samples.
  *
- * It adds the Set/GetNumberOfSamples function.
+ * It adds the Set/GetNumberOfSamples function, and the random number
+ * generator that is used to pick the samples.
  *
  * \ingroup ImageSamplers
  */
@@ -68,6 +70,17 @@ public:
   itkStaticConstMacro( InputImageDimension, unsigned int,
     Superclass::InputImageDimension );
 
+  /** The random number generator used to pick the samples. */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
+
+  /** Set/Get the random number generator. By default the global instance
+   * of the MersenneTwisterRandomVariateGenerator is used. Samplers that are
+   * used in different threads at the same time should each get their own.
+   */
+  itkSetObjectMacro( RandomGenerator, RandomGeneratorType );
+  itkGetModifiableObjectMacro( RandomGenerator, RandomGeneratorType );
+
 protected:
 
   /** The constructor. */
@@ -85,6 +98,8 @@ protected:
   /** Member variable used when threading. */
   std::vector< double > m_RandomNumberList;
 
+  RandomGeneratorPointer m_RandomGenerator;
+
 private:
 
   /** The private constructor. */
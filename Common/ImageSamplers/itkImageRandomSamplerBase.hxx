@@ -20,8 +20,6 @@
 
 #include "itkImageRandomSamplerBase.h"
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
-#include "itkImageRandomConstIteratorWithIndex.h"
 
 namespace itk
 {
@@ -36,6 +34,9 @@ ImageRandomSamplerBase< TInputImage >
 {
   this->m_NumberOfSamples = 1000;
 
+  /** Setup the random generator. */
+  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
+
 } // end Constructor
 
 
@@ -48,10 +49,8 @@ void
 ImageRandomSamplerBase< TInputImage >
 ::BeforeThreadedGenerateData( void )
 {
-  /** Create a random number generator. Also used in the ImageRandomConstIteratorWithIndex. */
-  typedef typename Statistics::MersenneTwisterRandomVariateGenerator::Pointer GeneratorPointer;
-  GeneratorPointer localGenerator = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
-  // \todo: should probably be global?
+  /** Get the random number generator. */
+  RandomGeneratorType * localGenerator = this->m_RandomGenerator.GetPointer();
 
   /** Clear the random number list. */
   this->m_RandomNumberList.resize( 0 );
@@ -86,6 +85,7 @@ ImageRandomSamplerBase< TInputImage >
   Superclass::PrintSelf( os, indent );
 
   os << indent << "NumberOfSamples: " << this->m_NumberOfSamples << std::endl;
+  os << indent << "RandomGenerator: " << this->m_RandomGenerator.GetPointer() << std::endl;
 
 } // end PrintSelf()
 
@@ -21,7 +21,6 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkInterpolateImageFunction.h"
 #include "itkBSplineInterpolateImageFunction.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace itk
 {
@@ -86,8 +85,8 @@ public:
   typedef BSplineInterpolateImageFunction< InputImageType, CoordRepType, double > DefaultInterpolatorType;
 
   /** The random number generator used to generate random coordinates. */
-  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
-  typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
+  typedef typename Superclass::RandomGeneratorType    RandomGeneratorType;
+  typedef typename Superclass::RandomGeneratorPointer RandomGeneratorPointer;
 
   /** Set/Get the interpolator. A 3rd order B-spline interpolator is used by default. */
   itkSetObjectMacro( Interpolator, InterpolatorType );
@@ -128,7 +127,6 @@ protected:
     InputImageContinuousIndexType &       randomContIndex );
 
   InterpolatorPointer    m_Interpolator;
-  RandomGeneratorPointer m_RandomGenerator;
   InputImageSpacingType  m_SampleRegionSize;
 
   /** Generate the two corners of a sampling region. */
@@ -39,9 +39,6 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
   bsplineInterpolator->SetSplineOrder( 3 );
   this->m_Interpolator = bsplineInterpolator;
 
-  /** Setup the random generator. */
-  this->m_RandomGenerator = RandomGeneratorType::GetInstance();
-
   this->m_UseRandomSampleRegion = false;
   this->m_SampleRegionSize.Fill( 1.0 );
 
@@ -295,7 +292,6 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
   Superclass::PrintSelf( os, indent );
 
   os << indent << "Interpolator: " << this->m_Interpolator.GetPointer() << std::endl;
-  os << indent << "RandomGenerator: " << this->m_RandomGenerator.GetPointer() << std::endl;
 
 } // end PrintSelf
 
@@ -108,6 +108,8 @@ LineSearchOptimizer
      << this->m_InitialStepLengthEstimate << std::endl;
   os << indent << "LineSearchDirection: "
      << this->m_LineSearchDirection << std::endl;
+  os << indent << "NumberOfCostFunctionClones: "
+     << this->m_CostFunctionClones.size() << std::endl;
 
 } // end PrintSelf()
 
@@ -22,6 +22,7 @@
 #include "itkSingleValuedNonLinearOptimizer.h"
 
 #include "itkIntTypes.h" //tmp
+#include <vector>
 
 namespace itk
 {
@@ -46,10 +47,14 @@ public:
   //itkNewMacro(Self); because this is an abstract base class.
   itkTypeMacro( LineSearchOptimizer, SingleValuedNonLinearOptimizer );
 
-  typedef Superclass::MeasureType      MeasureType;
-  typedef Superclass::ParametersType   ParametersType;
-  typedef Superclass::DerivativeType   DerivativeType;
-  typedef Superclass::CostFunctionType CostFunctionType;
+  typedef Superclass::MeasureType         MeasureType;
+  typedef Superclass::ParametersType      ParametersType;
+  typedef Superclass::DerivativeType      DerivativeType;
+  typedef Superclass::CostFunctionType    CostFunctionType;
+  typedef Superclass::CostFunctionPointer CostFunctionPointer;
+
+  /** Typedef for a set of clones of the cost function. */
+  typedef std::vector< CostFunctionPointer > CostFunctionContainerType;
 
   /** Set/Get the LineSearchDirection */
   virtual void SetLineSearchDirection( const ParametersType & arg )
@@ -114,6 +119,20 @@ public:
   itkSetMacro( InitialStepLengthEstimate, double );
   itkGetConstMacro( InitialStepLengthEstimate, double );
 
+  /** Set/Get clones of the cost function, one for each work unit.
+   * Line search methods that evaluate several steps concurrently evaluate
+   * them on these clones; the main optimizer sets them after the cost
+   * function. Other line search methods ignore them.
+   */
+  virtual void SetCostFunctionClones( const CostFunctionContainerType & clones )
+  {
+    this->m_CostFunctionClones = clones;
+    this->Modified();
+  }
+
+
+  itkGetConstReferenceMacro( CostFunctionClones, CostFunctionContainerType );
+
 protected:
 
   LineSearchOptimizer();
@@ -122,6 +141,8 @@ protected:
 
   double m_CurrentStepLength;
 
+  CostFunctionContainerType m_CostFunctionClones;
+
   /** Set the current step length AND the current position, where
    * the current position is computed as:
    * m_CurrentPosition =
@@ -20,6 +20,7 @@
 #define __itkMoreThuenteLineSearchOptimizer_cxx
 
 #include "itkMoreThuenteLineSearchOptimizer.h"
+#include <algorithm>
 #include <cmath> // For abs.
 #include <limits>
 
@@ -41,9 +42,14 @@ MoreThuenteLineSearchOptimizer
   this->m_ValueTolerance            = 1e-4;
   this->m_GradientTolerance         = 0.9;
   this->m_IntervalTolerance         = std::numeric_limits< double >::epsilon();
+  this->m_NumberOfSpeculativeSteps  = 1;
   this->SetMinimumStepLength( 1e-20 );
   this->SetMaximumStepLength( 1e20 );
 
+  /** Threading related variables. */
+  this->m_Threader                   = ThreaderType::New();
+  this->m_ThreaderParameters.st_Self = this;
+
   this->InitializeLineSearch();
 
 } // end Constructor
@@ -163,8 +169,15 @@ MoreThuenteLineSearchOptimizer
     this->UpdateIntervalMinimumAndMaximum();
     this->BoundStep( this->m_step );
     this->PrepareForUnusualTermination();
-    this->SetCurrentStepLength( this->m_step );
-    this->ComputeCurrentValueAndDerivative();
+    if( this->m_NumberOfSpeculativeSteps > 1 )
+    {
+      this->ComputeSpeculativeValuesAndDerivatives();
+    }
+    else
+    {
+      this->SetCurrentStepLength( this->m_step );
+      this->ComputeCurrentValueAndDerivative();
+    }
     this->m_dg = this->DirectionalDerivative( this->m_g );
     this->TestConvergence( this->m_Stop );
     this->InvokeEvent( IterationEvent() );
@@ -315,6 +328,7 @@ MoreThuenteLineSearchOptimizer
   this->m_SufficientDecreaseConditionSatisfied = false;
   this->m_CurvatureConditionSatisfied          = false;
   this->m_CurrentStepLength                    = 0.0;
+  this->m_NumberOfEvaluatedSteps               = 0;
 
   this->m_finit                 = this->m_f;
   this->m_fx                    = this->m_finit;
@@ -418,6 +432,8 @@ void
 MoreThuenteLineSearchOptimizer
 ::ComputeCurrentValueAndDerivative( void )
 {
+  this->m_NumberOfEvaluatedSteps++;
+
   try
   {
     this->GetCostFunction()->GetValueAndDerivative(
@@ -433,6 +449,211 @@ MoreThuenteLineSearchOptimizer
 } // end ComputeCurrentValueAndDerivative()
 
 
+/**
+ * ************ ComputeSpeculativeValuesAndDerivatives ******************
+ *
+ * Evaluate the trial step and the speculative candidates concurrently,
+ * and select the step that the line search continues with.
+ */
+
+void
+MoreThuenteLineSearchOptimizer
+::ComputeSpeculativeValuesAndDerivatives( void )
+{
+  this->ComputeSpeculativeSteps();
+  const unsigned int numberOfSteps
+    = static_cast< unsigned int >( this->m_SpeculativeSteps.size() );
+
+  this->m_SpeculativeValues.assign( numberOfSteps, NumericTraits< MeasureType >::Zero );
+  this->m_SpeculativeDerivatives.resize( numberOfSteps );
+  this->m_SpeculativeFailed.assign( numberOfSteps, false );
+  this->m_SpeculativeExceptions.resize( numberOfSteps );
+
+  /** Evaluate the cost function. */
+  if( numberOfSteps == 1 || this->m_Threader->GetNumberOfWorkUnits() <= 1 )
+  {
+    this->EvaluateSpeculativeSteps( 0, numberOfSteps, this->GetCostFunction() );
+  }
+  else
+  {
+    /** Each work unit evaluates its steps on its own clone. */
+    const ThreadIdType numberOfWorkUnits = this->m_Threader->GetNumberOfWorkUnits();
+    bool               clonesAvailable   = this->m_CostFunctionClones.size() >= numberOfWorkUnits;
+    for( ThreadIdType i = 0; clonesAvailable && i < numberOfWorkUnits; ++i )
+    {
+      clonesAvailable = this->m_CostFunctionClones[ i ].IsNotNull();
+    }
+    if( !clonesAvailable )
+    {
+      itkExceptionMacro( << "ERROR: evaluating " << numberOfSteps
+                         << " speculative steps using " << numberOfWorkUnits
+                         << " work units requires a cost function clone for each work unit "
+                         << "(number of clones set: " << this->m_CostFunctionClones.size() << ")." );
+    }
+
+    this->m_Threader->SetSingleMethod( this->EvaluateSpeculativeStepsThreaderCallback,
+      &this->m_ThreaderParameters );
+    this->m_Threader->SingleMethodExecute();
+  }
+  this->m_NumberOfEvaluatedSteps += numberOfSteps;
+
+  /** An error at the trial step terminates the line search, just as
+   * in the normal mode. Errors at the other candidates are ignored.
+   */
+  if( this->m_SpeculativeFailed[ 0 ] )
+  {
+    this->m_StopCondition = MetricError;
+    this->StopOptimization();
+    throw this->m_SpeculativeExceptions[ 0 ];
+  }
+
+  /** Accept the first candidate that satisfies the Strong Wolfe Conditions.
+   * If there is none, continue with the trial step.
+   */
+  unsigned int accepted = 0;
+  for( unsigned int i = 0; i < numberOfSteps; ++i )
+  {
+    if( this->m_SpeculativeFailed[ i ] )
+    {
+      continue;
+    }
+    const double      step  = this->m_SpeculativeSteps[ i ];
+    const double      dg    = this->DirectionalDerivative( this->m_SpeculativeDerivatives[ i ] );
+    const MeasureType ftest = this->m_finit + step * this->m_dgtest;
+    if( this->m_SpeculativeValues[ i ] <= ftest
+      && std::abs( dg ) <= this->GetGradientTolerance() * ( -this->m_dginit ) )
+    {
+      accepted = i;
+      break;
+    }
+  }
+
+  this->m_step = this->m_SpeculativeSteps[ accepted ];
+  this->SetCurrentStepLength( this->m_step );
+  this->m_f = this->m_SpeculativeValues[ accepted ];
+  this->m_g = this->m_SpeculativeDerivatives[ accepted ];
+
+} // end ComputeSpeculativeValuesAndDerivatives()
+
+
+/**
+ * ******************* ComputeSpeculativeSteps **************************
+ *
+ * The first step is the trial step. The candidates alternately halve
+ * (backtracking) and double (extrapolation) the distance to the best
+ * step so far. They are kept within the interval of uncertainty and
+ * within the minimum and maximum step length.
+ */
+
+void
+MoreThuenteLineSearchOptimizer
+::ComputeSpeculativeSteps( void )
+{
+  const double stx = this->m_stepx;
+
+  this->m_SpeculativeSteps.assign( 1, this->m_step );
+
+  double backtrackingStep  = this->m_step;
+  double extrapolationStep = this->m_step;
+  for( unsigned int k = 1; k < this->m_NumberOfSpeculativeSteps; ++k )
+  {
+    double step = 0.0;
+    if( k % 2 == 1 )
+    {
+      backtrackingStep = stx + 0.5 * ( backtrackingStep - stx );
+      step             = backtrackingStep;
+    }
+    else
+    {
+      extrapolationStep = stx + 2.0 * ( extrapolationStep - stx );
+      step              = extrapolationStep;
+    }
+    step = std::max( step, this->m_stepmin );
+    step = std::min( step, this->m_stepmax );
+    this->BoundStep( step );
+
+    /** Skip candidates outside the interval and duplicates. */
+    if( ( this->m_brackt
+      && ( step <= this->m_stepmin || step >= this->m_stepmax ) )
+      || std::find( this->m_SpeculativeSteps.begin(),
+      this->m_SpeculativeSteps.end(), step ) != this->m_SpeculativeSteps.end() )
+    {
+      continue;
+    }
+    this->m_SpeculativeSteps.push_back( step );
+  }
+
+} // end ComputeSpeculativeSteps()
+
+
+/**
+ * ******************* EvaluateSpeculativeSteps *************************
+ */
+
+void
+MoreThuenteLineSearchOptimizer
+::EvaluateSpeculativeSteps( const unsigned int begin, const unsigned int end,
+  const CostFunctionType * costFunction )
+{
+  const ParametersType & initialPosition     = this->GetInitialPosition();
+  const ParametersType & lineSearchDirection = this->GetLineSearchDirection();
+  const unsigned int     numberOfParameters  = initialPosition.GetSize();
+
+  ParametersType position( numberOfParameters );
+  for( unsigned int i = begin; i < end; ++i )
+  {
+    const double step = this->m_SpeculativeSteps[ i ];
+    for( unsigned int j = 0; j < numberOfParameters; ++j )
+    {
+      position[ j ] = initialPosition[ j ] + step * lineSearchDirection[ j ];
+    }
+
+    try
+    {
+      costFunction->GetValueAndDerivative( position,
+        this->m_SpeculativeValues[ i ], this->m_SpeculativeDerivatives[ i ] );
+    }
+    catch( ExceptionObject & err )
+    {
+      this->m_SpeculativeFailed[ i ]     = true;
+      this->m_SpeculativeExceptions[ i ] = err;
+    }
+  }
+
+} // end EvaluateSpeculativeSteps()
+
+
+/**
+ * *********** EvaluateSpeculativeStepsThreaderCallback *****************
+ */
+
+ITK_THREAD_RETURN_TYPE
+MoreThuenteLineSearchOptimizer
+::EvaluateSpeculativeStepsThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID    = infoStruct->WorkUnitID;
+  ThreadIdType                 nrOfThreads = infoStruct->NumberOfWorkUnits;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Compute the steps of this thread. */
+  const unsigned int numberOfSteps
+    = static_cast< unsigned int >( temp->st_Self->m_SpeculativeSteps.size() );
+  const unsigned int chunkSize = ( numberOfSteps + nrOfThreads - 1 ) / nrOfThreads;
+  const unsigned int begin     = std::min( numberOfSteps, threadID * chunkSize );
+  const unsigned int end       = std::min( numberOfSteps, ( threadID + 1 ) * chunkSize );
+
+  /** Call the real implementation. */
+  temp->st_Self->EvaluateSpeculativeSteps( begin, end,
+    temp->st_Self->m_CostFunctionClones[ threadID ].GetPointer() );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end EvaluateSpeculativeStepsThreaderCallback()
+
+
 /**
  * ************************** TestConvergence ****************************
  *
@@ -1016,6 +1237,10 @@ MoreThuenteLineSearchOptimizer
      << this->m_GradientTolerance << std::endl;
   os << indent << "m_IntervalTolerance: "
      << this->m_IntervalTolerance << std::endl;
+  os << indent << "m_NumberOfSpeculativeSteps: "
+     << this->m_NumberOfSpeculativeSteps << std::endl;
+  os << indent << "m_NumberOfEvaluatedSteps: "
+     << this->m_NumberOfEvaluatedSteps << std::endl;
 
 } // end PrintSelf()
 
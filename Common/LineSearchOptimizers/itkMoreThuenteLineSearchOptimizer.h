@@ -20,6 +20,8 @@
 #define __itkMoreThuenteLineSearchOptimizer_h
 
 #include "itkLineSearchOptimizer.h"
+#include "itkPlatformMultiThreader.h"
+#include <vector>
 
 namespace itk
 {
@@ -64,6 +66,16 @@ namespace itk
  * when rounding errors prevent further progress. In this case stp only
  * satisfies the sufficient decrease condition.
  *
+ * Optionally, the line search can speculate on the outcome of an iteration,
+ * see SetNumberOfSpeculativeSteps(). Together with the trial step of the
+ * algorithm, a few other candidate steps are then evaluated concurrently:
+ * steps closer to the best step so far (backtracking) and steps further away
+ * from it (extrapolation), within the interval of uncertainty. The first
+ * candidate, in that order, that satisfies the Strong Wolfe Conditions is
+ * accepted. If none does, the algorithm continues with the trial step as
+ * usual, so that the result is then identical to a normal line search.
+ * Each round of concurrent evaluations counts as one iteration.
+ *
  *
  * \ingroup Numerics Optimizers
  */
@@ -80,10 +92,16 @@ public:
   itkNewMacro( Self );
   itkTypeMacro( MoreThuenteLineSearchOptimizer, LineSearchOptimizer );
 
-  typedef Superclass::MeasureType      MeasureType;
-  typedef Superclass::ParametersType   ParametersType;
-  typedef Superclass::DerivativeType   DerivativeType;
-  typedef Superclass::CostFunctionType CostFunctionType;
+  typedef Superclass::MeasureType               MeasureType;
+  typedef Superclass::ParametersType            ParametersType;
+  typedef Superclass::DerivativeType            DerivativeType;
+  typedef Superclass::CostFunctionType          CostFunctionType;
+  typedef Superclass::CostFunctionPointer       CostFunctionPointer;
+  typedef Superclass::CostFunctionContainerType CostFunctionContainerType;
+
+  /** Typedefs for multi-threading. */
+  typedef PlatformMultiThreader      ThreaderType;
+  typedef ThreaderType::WorkUnitInfo ThreadInfoType;
 
   typedef enum {
     StrongWolfeConditionsSatisfied,
@@ -166,6 +184,36 @@ public:
   itkSetClampMacro( IntervalTolerance, double, 0.0, NumericTraits< double >::max() );
   itkGetConstMacro( IntervalTolerance, double );
 
+  /** Setting: the number of step lengths that are evaluated in each
+   * iteration: the trial step and NumberOfSpeculativeSteps - 1 candidates.
+   * With more than one work unit the steps are evaluated concurrently, each
+   * work unit on its own clone of the cost function, so a clone must be
+   * supplied for each work unit by SetCostFunctionClones(). The cost function
+   * itself is never evaluated concurrently.
+   * By default set to 1, which disables the speculative mode.
+   */
+  itkSetClampMacro( NumberOfSpeculativeSteps, unsigned int,
+    1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( NumberOfSpeculativeSteps, unsigned int );
+
+  /** Set/Get the number of work units used to evaluate the speculative steps. */
+  virtual void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
+
+  virtual ThreadIdType GetNumberOfWorkUnits( void ) const
+  {
+    return this->m_Threader->GetNumberOfWorkUnits();
+  }
+
+
+  /** Progress information: the number of step lengths that have been
+   * evaluated in the current line search.
+   */
+  itkGetConstMacro( NumberOfEvaluatedSteps, unsigned long );
+
 protected:
 
   MoreThuenteLineSearchOptimizer();
@@ -204,6 +252,22 @@ protected:
   /** Ask the cost function to compute m_f and m_g at the current position. */
   virtual void ComputeCurrentValueAndDerivative( void );
 
+  /** Evaluate the trial step together with the speculative candidates,
+   * and load the first candidate that satisfies the Strong Wolfe Conditions,
+   * or else the trial step, into m_step, m_f and m_g.
+   */
+  virtual void ComputeSpeculativeValuesAndDerivatives( void );
+
+  /** Fill m_SpeculativeSteps with the trial step and the candidates. */
+  virtual void ComputeSpeculativeSteps( void );
+
+  /** Evaluate the speculative steps [begin, end) on the given cost function. */
+  void EvaluateSpeculativeSteps( const unsigned int begin, const unsigned int end,
+    const CostFunctionType * costFunction );
+
+  /** The threader callback function. */
+  static ITK_THREAD_RETURN_TYPE EvaluateSpeculativeStepsThreaderCallback( void * arg );
+
   /** Check for convergence */
   virtual void TestConvergence( bool & stop );
 
@@ -248,6 +312,25 @@ protected:
   bool m_stage1;
   bool m_SafeGuardedStepFailed;
 
+  unsigned long m_NumberOfEvaluatedSteps;
+
+  /** To give the threads access to all members. */
+  struct MultiThreaderParameterType
+  {
+    Self * st_Self;
+  };
+
+  /** Threading related variables. */
+  MultiThreaderParameterType m_ThreaderParameters;
+  ThreaderType::Pointer      m_Threader;
+
+  /** Variables of the current round of speculative evaluations. */
+  std::vector< double >          m_SpeculativeSteps;
+  std::vector< MeasureType >     m_SpeculativeValues;
+  std::vector< DerivativeType >  m_SpeculativeDerivatives;
+  std::vector< unsigned char >   m_SpeculativeFailed;
+  std::vector< ExceptionObject > m_SpeculativeExceptions;
+
 private:
 
   MoreThuenteLineSearchOptimizer( const Self & ); // purposely not implemented
@@ -257,6 +340,7 @@ private:
   double        m_ValueTolerance;
   double        m_GradientTolerance;
   double        m_IntervalTolerance;
+  unsigned int  m_NumberOfSpeculativeSteps;
 
 };
 
@@ -93,6 +93,13 @@ public:
   /** Set the parameter map. */
   void SetParameterMap( const ParameterMapType & parMap );
 
+  /** Get the parameter map. */
+  const ParameterMapType & GetParameterMap( void ) const
+  {
+    return this->m_ParameterMap;
+  }
+
+
   /** Option to print error and warning messages to a stream.
    * The default is true. If set to false no messages are printed.
    */
@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBSplineStackTransform_h
+#define __itkBSplineStackTransform_h
+
+#include "itkStackTransform.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+
+namespace itk
+{
+
+/** \class BSplineStackTransform
+ * \brief A StackTransform of B-spline sub transforms that share their grid.
+ *
+ * All sub transforms of a B-spline stack normally have an identical grid
+ * geometry; only the coefficients differ. When a spatial location is
+ * evaluated at several time points, as is done by the groupwise metrics,
+ * the B-spline weights and support indices are therefore the same for all
+ * of them. The batched TransformPoints() and GetJacobians() of this class
+ * compute the weights only once and apply them to the coefficients of each
+ * sub transform. When the points do not share their in-slice coordinates,
+ * or when the sub transforms do not share their grid, the generic
+ * implementation of the superclass is used.
+ *
+ * \ingroup Transforms
+ */
+template< class TScalarType,
+unsigned int NDimensions = 3,
+unsigned int VSplineOrder = 3 >
+class BSplineStackTransform :
+  public StackTransform< TScalarType, NDimensions, NDimensions >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef BSplineStackTransform                                 Self;
+  typedef StackTransform< TScalarType, NDimensions, NDimensions > Superclass;
+  typedef SmartPointer< Self >                                  Pointer;
+  typedef SmartPointer< const Self >                            ConstPointer;
+
+  /** New method for creating an object using a factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BSplineStackTransform, StackTransform );
+
+  /** Dimensions. */
+  itkStaticConstMacro( SpaceDimension, unsigned int, NDimensions );
+  itkStaticConstMacro( ReducedSpaceDimension, unsigned int, NDimensions - 1 );
+  itkStaticConstMacro( SplineOrder, unsigned int, VSplineOrder );
+
+  /** Typedefs from the Superclass. */
+  typedef typename Superclass::ScalarType                  ScalarType;
+  typedef typename Superclass::ParametersType              ParametersType;
+  typedef typename Superclass::NumberOfParametersType      NumberOfParametersType;
+  typedef typename Superclass::JacobianType                JacobianType;
+  typedef typename Superclass::NonZeroJacobianIndicesType  NonZeroJacobianIndicesType;
+  typedef typename Superclass::InputPointType              InputPointType;
+  typedef typename Superclass::OutputPointType             OutputPointType;
+  typedef typename Superclass::SubTransformType            SubTransformType;
+  typedef typename Superclass::SubTransformJacobianType    SubTransformJacobianType;
+  typedef typename Superclass::SubTransformInputPointType  SubTransformInputPointType;
+  typedef typename Superclass::SubTransformOutputPointType SubTransformOutputPointType;
+
+  /** The B-spline sub transform type. */
+  typedef AdvancedBSplineDeformableTransform< TScalarType,
+    itkGetStaticConstMacro( ReducedSpaceDimension ),
+    itkGetStaticConstMacro( SplineOrder ) >                 BSplineSubTransformType;
+  typedef typename BSplineSubTransformType::WeightsType             WeightsType;
+  typedef typename BSplineSubTransformType::WeightsFunctionType     WeightsFunctionType;
+  typedef typename BSplineSubTransformType::ParameterIndexArrayType ParameterIndexArrayType;
+  typedef typename BSplineSubTransformType::PixelType               PixelType;
+
+  /** Set the parameters, and check if the sub transforms share their grid. */
+  void SetParameters( const ParametersType & param ) override;
+
+  /** Overridden to invalidate the shared grid. */
+  void SetNumberOfSubTransforms( const unsigned int num ) override;
+
+  void SetSubTransform( unsigned int i, SubTransformType * transform ) override;
+
+  void SetAllSubTransforms( SubTransformType * transform ) override;
+
+  /** Batched TransformPoint(), using shared B-spline weights. */
+  void TransformPoints(
+    const std::vector< InputPointType > & ipps,
+    std::vector< OutputPointType > & opps ) const override;
+
+  /** Batched GetJacobian(), using a shared sub transform Jacobian. */
+  void GetJacobians(
+    const std::vector< InputPointType > & ipps,
+    std::vector< JacobianType > & jacs,
+    std::vector< NonZeroJacobianIndicesType > & nzjis ) const override;
+
+  /** Returns true when all sub transforms are B-splines on the same grid. */
+  itkGetConstMacro( SubTransformsShareGrid, bool );
+
+protected:
+
+  BSplineStackTransform();
+  ~BSplineStackTransform() override {}
+
+  /** Check if all sub transforms are B-spline transforms of order
+   * VSplineOrder with the same grid, and cache pointers to them.
+   */
+  virtual void UpdateSharedGrid( void );
+
+  /** Check if all points have the same in-slice coordinates. */
+  bool PointsShareInSliceCoordinates( const std::vector< InputPointType > & ipps ) const;
+
+private:
+
+  BSplineStackTransform( const Self & ); // purposely not implemented
+  void operator=( const Self & );        // purposely not implemented
+
+  bool                                          m_SubTransformsShareGrid;
+  std::vector< const BSplineSubTransformType * > m_BSplineSubTransforms;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBSplineStackTransform.hxx"
+#endif
+
+#endif
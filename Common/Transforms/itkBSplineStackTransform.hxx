@@ -0,0 +1,307 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef _itkBSplineStackTransform_hxx
+#define _itkBSplineStackTransform_hxx
+
+#include "itkBSplineStackTransform.h"
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::BSplineStackTransform() : Superclass(),
+  m_SubTransformsShareGrid( false )
+{} // end Constructor
+
+
+/**
+ * ************************ SetParameters ***********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::SetParameters( const ParametersType & param )
+{
+  this->Superclass::SetParameters( param );
+
+  /** The grids of the sub transforms may have changed since the last call. */
+  this->UpdateSharedGrid();
+
+} // end SetParameters()
+
+
+/**
+ * ************************ SetNumberOfSubTransforms ***********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::SetNumberOfSubTransforms( const unsigned int num )
+{
+  this->Superclass::SetNumberOfSubTransforms( num );
+  this->m_SubTransformsShareGrid = false;
+  this->m_BSplineSubTransforms.clear();
+
+} // end SetNumberOfSubTransforms()
+
+
+/**
+ * ************************ SetSubTransform ***********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::SetSubTransform( unsigned int i, SubTransformType * transform )
+{
+  this->Superclass::SetSubTransform( i, transform );
+  this->UpdateSharedGrid();
+
+} // end SetSubTransform()
+
+
+/**
+ * ************************ SetAllSubTransforms ***********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::SetAllSubTransforms( SubTransformType * transform )
+{
+  this->Superclass::SetAllSubTransforms( transform );
+  this->UpdateSharedGrid();
+
+} // end SetAllSubTransforms()
+
+
+/**
+ * ************************ UpdateSharedGrid ***********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::UpdateSharedGrid( void )
+{
+  this->m_SubTransformsShareGrid = false;
+  this->m_BSplineSubTransforms.clear();
+
+  const unsigned int numberOfSubTransforms = this->GetNumberOfSubTransforms();
+  if( numberOfSubTransforms == 0 )
+  {
+    return;
+  }
+
+  /** All sub transforms should be B-splines of the right order, with
+   * their coefficients set, and with the same grid as the first one.
+   */
+  std::vector< const BSplineSubTransformType * > subTransforms( numberOfSubTransforms );
+  for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+  {
+    const SubTransformType * sub = this->GetSubTransformContainer()[ t ].GetPointer();
+    subTransforms[ t ] = dynamic_cast< const BSplineSubTransformType * >( sub );
+    if( subTransforms[ t ] == nullptr || subTransforms[ t ]->GetCoefficientImages()[ 0 ].IsNull() )
+    {
+      return;
+    }
+
+    const BSplineSubTransformType * sub0 = subTransforms[ 0 ];
+    if( subTransforms[ t ]->GetGridRegion() != sub0->GetGridRegion()
+      || subTransforms[ t ]->GetGridSpacing() != sub0->GetGridSpacing()
+      || subTransforms[ t ]->GetGridOrigin() != sub0->GetGridOrigin()
+      || subTransforms[ t ]->GetGridDirection() != sub0->GetGridDirection() )
+    {
+      return;
+    }
+  }
+
+  this->m_BSplineSubTransforms   = subTransforms;
+  this->m_SubTransformsShareGrid = true;
+
+} // end UpdateSharedGrid()
+
+
+/**
+ * ******************* PointsShareInSliceCoordinates ********************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+bool
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::PointsShareInSliceCoordinates( const std::vector< InputPointType > & ipps ) const
+{
+  for( std::size_t i = 1; i < ipps.size(); ++i )
+  {
+    for( unsigned int d = 0; d < ReducedSpaceDimension; ++d )
+    {
+      if( ipps[ i ][ d ] != ipps[ 0 ][ d ] )
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+
+} // end PointsShareInSliceCoordinates()
+
+
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPoints(
+  const std::vector< InputPointType > & ipps,
+  std::vector< OutputPointType > & opps ) const
+{
+  if( ipps.empty() || !this->m_SubTransformsShareGrid
+    || !this->PointsShareInSliceCoordinates( ipps ) )
+  {
+    this->Superclass::TransformPoints( ipps, opps );
+    return;
+  }
+
+  /** Reduce dimension of the shared input point. */
+  SubTransformInputPointType ippr;
+  for( unsigned int d = 0; d < ReducedSpaceDimension; ++d )
+  {
+    ippr[ d ] = ipps[ 0 ][ d ];
+  }
+
+  /** Compute the weights and support indices once, using the first sub transform.
+   * Allocate memory on the stack.
+   */
+  const unsigned long numberOfWeights = WeightsFunctionType::NumberOfWeights;
+  typename WeightsType::ValueType weightsArray[ numberOfWeights ];
+  typename ParameterIndexArrayType::ValueType indicesArray[ numberOfWeights ];
+  WeightsType             weights( weightsArray, numberOfWeights, false );
+  ParameterIndexArrayType indices( indicesArray, numberOfWeights, false );
+
+  SubTransformOutputPointType oppr;
+  bool                        inside = true;
+  this->m_BSplineSubTransforms[ 0 ]->TransformPoint( ippr, oppr, weights, indices, inside );
+
+  /** Apply the weights to the coefficients of each sub transform. */
+  opps.resize( ipps.size() );
+  for( std::size_t i = 0; i < ipps.size(); ++i )
+  {
+    OutputPointType & opp = opps[ i ];
+    opp = ipps[ i ];
+    if( !inside )
+    {
+      /** Zero displacement outside the valid grid region. */
+      continue;
+    }
+
+    const BSplineSubTransformType * sub
+      = this->m_BSplineSubTransforms[ this->GetSubTransformIndex( ipps[ i ] ) ];
+    for( unsigned int d = 0; d < ReducedSpaceDimension; ++d )
+    {
+      const PixelType * coefficients = sub->GetCoefficientImages()[ d ]->GetBufferPointer();
+      ScalarType        displacement = NumericTraits< ScalarType >::ZeroValue();
+      for( unsigned long k = 0; k < numberOfWeights; ++k )
+      {
+        displacement += static_cast< ScalarType >( weights[ k ] * coefficients[ indices[ k ] ] );
+      }
+      opp[ d ] += displacement;
+    }
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* GetJacobians ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+BSplineStackTransform< TScalarType, NDimensions, VSplineOrder >
+::GetJacobians(
+  const std::vector< InputPointType > & ipps,
+  std::vector< JacobianType > & jacs,
+  std::vector< NonZeroJacobianIndicesType > & nzjis ) const
+{
+  if( ipps.empty() || !this->m_SubTransformsShareGrid
+    || !this->PointsShareInSliceCoordinates( ipps ) )
+  {
+    this->Superclass::GetJacobians( ipps, jacs, nzjis );
+    return;
+  }
+
+  /** Reduce dimension of the shared input point. */
+  SubTransformInputPointType ippr;
+  for( unsigned int d = 0; d < ReducedSpaceDimension; ++d )
+  {
+    ippr[ d ] = ipps[ 0 ][ d ];
+  }
+
+  /** The Jacobian of a B-spline does not depend on its coefficients,
+   * so it is the same for all sub transforms sharing the grid. Only the
+   * parameter indices are shifted to the right sub transform.
+   */
+  SubTransformJacobianType   subjac;
+  NonZeroJacobianIndicesType subnzji;
+  this->m_BSplineSubTransforms[ 0 ]->GetJacobian( ippr, subjac, subnzji );
+
+  const NumberOfParametersType numberOfSubTransformParameters
+    = this->m_BSplineSubTransforms[ 0 ]->GetNumberOfParameters();
+  const std::size_t numberOfNonZeros = subnzji.size();
+
+  jacs.resize( ipps.size() );
+  nzjis.resize( ipps.size() );
+  for( std::size_t i = 0; i < ipps.size(); ++i )
+  {
+    /** Fill output Jacobian. */
+    JacobianType & jac = jacs[ i ];
+    jac.set_size( SpaceDimension, numberOfNonZeros );
+    jac.Fill( 0.0 );
+    for( unsigned int d = 0; d < ReducedSpaceDimension; ++d )
+    {
+      for( std::size_t n = 0; n < numberOfNonZeros; ++n )
+      {
+        jac[ d ][ n ] = subjac[ d ][ n ];
+      }
+    }
+
+    /** Update non zero Jacobian indices. */
+    const NumberOfParametersType offset
+      = this->GetSubTransformIndex( ipps[ i ] ) * numberOfSubTransformParameters;
+    nzjis[ i ].resize( numberOfNonZeros );
+    for( std::size_t n = 0; n < numberOfNonZeros; ++n )
+    {
+      nzjis[ i ][ n ] = subnzji[ n ] + offset;
+    }
+  }
+
+} // end GetJacobians()
+
+
+} // end namespace itk
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "itkAdvancedTransform.h"
 #include "itkIndex.h"
+#include <vector>
 
 namespace itk
 {
@@ -143,6 +144,22 @@ public:
     JacobianType & jac,
     NonZeroJacobianIndicesType & nzji ) const override;
 
+  /** Batched versions of TransformPoint() and GetJacobian(), for a set of
+   * points that is typically spread over the stack, e.g. one spatial
+   * location evaluated at all time points, as done by the groupwise metrics.
+   * The default implementation simply loops over the points. Subclasses
+   * can exploit the geometry that is shared by the sub transforms, see
+   * BSplineStackTransform.
+   */
+  virtual void TransformPoints(
+    const std::vector< InputPointType > & ipps,
+    std::vector< OutputPointType > & opps ) const;
+
+  virtual void GetJacobians(
+    const std::vector< InputPointType > & ipps,
+    std::vector< JacobianType > & jacs,
+    std::vector< NonZeroJacobianIndicesType > & nzjis ) const;
+
   /** Set the parameters. Checks if the number of parameters
    * is correct and sets parameters of sub transforms. */
   void SetParameters( const ParametersType & param ) override;
@@ -288,6 +305,22 @@ protected:
   StackTransform();
   ~StackTransform() override {}
 
+  /** Return the index of the sub transform that handles the input point. */
+  unsigned int GetSubTransformIndex( const InputPointType & ipp ) const
+  {
+    return std::min( this->m_NumberOfSubTransforms - 1, static_cast< unsigned int >(
+      std::max( 0,
+      vnl_math::rnd( ( ipp[ ReducedInputSpaceDimension ] - this->m_StackOrigin ) / this->m_StackSpacing ) ) ) );
+  }
+
+
+  /** Read-only access to the sub transforms, for subclasses. */
+  const SubTransformContainerType & GetSubTransformContainer( void ) const
+  {
+    return this->m_SubTransformContainer;
+  }
+
+
 private:
 
   StackTransform( const Self & );  // purposely not implemented
@@ -114,10 +114,7 @@ StackTransform< TScalarType, NInputDimensions, NOutputDimensions >
 
   /** Transform point using right subtransform. */
   SubTransformOutputPointType oppr;
-  const unsigned int          subt
-    = std::min( this->m_NumberOfSubTransforms - 1, static_cast< unsigned int >(
-      std::max( 0,
-      vnl_math::rnd( ( ipp[ ReducedInputSpaceDimension ] - m_StackOrigin ) / m_StackSpacing ) ) ) );
+  const unsigned int          subt = this->GetSubTransformIndex( ipp );
   oppr = this->m_SubTransformContainer[ subt ]->TransformPoint( ippr );
 
   /** Increase dimension of input point. */
@@ -153,10 +150,7 @@ StackTransform< TScalarType, NInputDimensions, NOutputDimensions >
   }
 
   /** Get Jacobian from right subtransform. */
-  const unsigned int subt
-    = std::min( this->m_NumberOfSubTransforms - 1, static_cast< unsigned int >(
-      std::max( 0,
-      vnl_math::rnd( ( ipp[ ReducedInputSpaceDimension ] - m_StackOrigin ) / m_StackSpacing ) ) ) );
+  const unsigned int       subt = this->GetSubTransformIndex( ipp );
   SubTransformJacobianType subjac;
   this->m_SubTransformContainer[ subt ]->GetJacobian( ippr, subjac, nzji );
 
@@ -180,6 +174,48 @@ StackTransform< TScalarType, NInputDimensions, NOutputDimensions >
 } // end GetJacobian()
 
 
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+StackTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(
+  const std::vector< InputPointType > & ipps,
+  std::vector< OutputPointType > & opps ) const
+{
+  opps.resize( ipps.size() );
+  for( std::size_t i = 0; i < ipps.size(); ++i )
+  {
+    opps[ i ] = this->TransformPoint( ipps[ i ] );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* GetJacobians ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+StackTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::GetJacobians(
+  const std::vector< InputPointType > & ipps,
+  std::vector< JacobianType > & jacs,
+  std::vector< NonZeroJacobianIndicesType > & nzjis ) const
+{
+  jacs.resize( ipps.size() );
+  nzjis.resize( ipps.size() );
+  for( std::size_t i = 0; i < ipps.size(); ++i )
+  {
+    this->GetJacobian( ipps[ i ], jacs[ i ], nzjis[ i ] );
+  }
+
+} // end GetJacobians()
+
+
 /**
  * ********************* GetNumberOfNonZeroJacobianIndices ****************************
  */
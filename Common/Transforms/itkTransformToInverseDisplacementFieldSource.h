@@ -0,0 +1,220 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformToInverseDisplacementFieldSource_h
+#define __itkTransformToInverseDisplacementFieldSource_h
+
+#include "itkAdvancedTransform.h"
+#include "itkImageSource.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class TransformToInverseDisplacementFieldSource
+ * \brief Generate the displacement field of the inverse of a coordinate transform.
+ *
+ * For every voxel y of the output image, the point x is computed for which
+ * T(x) = y, and the displacement x - y is stored. The transform may be any
+ * AdvancedTransform, for example a B-spline transform or a combination of
+ * transforms, as long as it provides the spatial Jacobian.
+ *
+ * The equation T(x) = y is solved per voxel with a damped Newton method,
+ * using the spatial Jacobian of the transform:
+ * \f[ x_{k+1} = x_k - \alpha ( \partial T / \partial x )^{-1} ( T(x_k) - y ), \f]
+ * where the step size \f$ \alpha \f$ is halved until the residual decreases.
+ * When the spatial Jacobian is (nearly) singular, a fixed-point step
+ * \f$ x_{k+1} = x_k - ( T(x_k) - y ) \f$ is taken instead. The iterations
+ * are started from the solution of the previous voxel on the same scan line,
+ * which is usually very close for smooth transforms, or otherwise from the
+ * fixed-point guess \f$ x_0 = 2y - T(y) \f$.
+ *
+ * The second output contains the residual \f$ \| T(x) - y \| \f$ for every
+ * voxel, which allows to inspect where the transform is not invertible.
+ * Statistics on the residuals are available after the update.
+ *
+ * Output information (spacing, size and direction) for the output
+ * image should be set, either directly or from a reference image.
+ *
+ * This filter is implemented as a multithreaded filter. It provides a
+ * ThreadedGenerateData() method for its implementation.
+ *
+ * \ingroup GeometricTransforms
+ */
+template< class TOutputImage,
+class TTransformPrecisionType = double >
+class TransformToInverseDisplacementFieldSource :
+  public ImageSource< TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef TransformToInverseDisplacementFieldSource Self;
+  typedef ImageSource< TOutputImage >               Superclass;
+  typedef SmartPointer< Self >                      Pointer;
+  typedef SmartPointer< const Self >                ConstPointer;
+
+  typedef TOutputImage                           OutputImageType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::ConstPointer OutputImageConstPointer;
+  typedef typename OutputImageType::RegionType   OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( TransformToInverseDisplacementFieldSource, ImageSource );
+
+  /** Number of dimensions. */
+  itkStaticConstMacro( ImageDimension, unsigned int,
+    TOutputImage::ImageDimension );
+
+  /** Typedefs for transform. */
+  typedef AdvancedTransform< TTransformPrecisionType,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >     TransformType;
+  typedef typename TransformType::ConstPointer        TransformPointerType;
+  typedef typename TransformType::SpatialJacobianType SpatialJacobianType;
+  typedef typename TransformType::InputPointType      InputPointType;
+  typedef typename TransformType::OutputPointType     OutputPointType;
+
+  /** Typedefs for output image. */
+  typedef typename OutputImageType::PixelType     PixelType;
+  typedef typename PixelType::ValueType           PixelValueType;
+  typedef typename OutputImageType::RegionType    RegionType;
+  typedef typename RegionType::SizeType           SizeType;
+  typedef typename OutputImageType::IndexType     IndexType;
+  typedef typename OutputImageType::PointType     PointType;
+  typedef typename OutputImageType::SpacingType   SpacingType;
+  typedef typename OutputImageType::PointType     OriginType;
+  typedef typename OutputImageType::DirectionType DirectionType;
+
+  /** Typedefs for the residual image. */
+  typedef Image< float, itkGetStaticConstMacro( ImageDimension ) > ResidualImageType;
+  typedef typename ResidualImageType::Pointer                      ResidualImagePointer;
+
+  /** Typedefs for base image. */
+  typedef ImageBase< itkGetStaticConstMacro( ImageDimension ) > ImageBaseType;
+
+  /** Set the coordinate transformation to invert. */
+  itkSetConstObjectMacro( Transform, TransformType );
+
+  /** Get a pointer to the coordinate transform. */
+  itkGetConstObjectMacro( Transform, TransformType );
+
+  /** Set/Get the region of the output image. */
+  itkSetMacro( OutputRegion, OutputImageRegionType );
+  itkGetConstReferenceMacro( OutputRegion, OutputImageRegionType );
+
+  /** Set/Get the output image spacing. */
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+
+  /** Set/Get the output image origin. */
+  itkSetMacro( OutputOrigin, OriginType );
+  itkGetConstReferenceMacro( OutputOrigin, OriginType );
+
+  /** Set/Get the output direction cosine matrix. */
+  itkSetMacro( OutputDirection, DirectionType );
+  itkGetConstReferenceMacro( OutputDirection, DirectionType );
+
+  /** Helper method to set the output parameters based on this image */
+  void SetOutputParametersFromImage( const ImageBaseType * image );
+
+  /** Set/Get the maximum number of Newton iterations per voxel. Default: 20. */
+  itkSetMacro( MaximumNumberOfIterations, unsigned int );
+  itkGetConstMacro( MaximumNumberOfIterations, unsigned int );
+
+  /** Set/Get the tolerance on the residual || T(x) - y ||, in physical units.
+   * Default: 1e-3.
+   */
+  itkSetMacro( Tolerance, double );
+  itkGetConstMacro( Tolerance, double );
+
+  /** Get the residual image, the second output. */
+  ResidualImageType * GetResidualOutput( void );
+
+  /** Statistics on the residuals, available after the update. */
+  itkGetConstMacro( MaximumResidual, double );
+  itkGetConstMacro( MeanResidual, double );
+  itkGetConstMacro( NumberOfNonConvergedPixels, SizeValueType );
+
+  /** Create the outputs: the displacement field and the residual image. */
+  typedef ProcessObject::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer MakeOutput( DataObjectPointerArraySizeType idx ) override;
+
+  /** Set the output information of both outputs. */
+  void GenerateOutputInformation( void ) override;
+
+  /** Checking if transform is set, and initialize the statistics. */
+  void BeforeThreadedGenerateData( void ) override;
+
+  /** Combine the statistics of the threads. */
+  void AfterThreadedGenerateData( void ) override;
+
+  /** Compute the Modified Time based on changes to the components. */
+  ModifiedTimeType GetMTime( void ) const override;
+
+protected:
+
+  TransformToInverseDisplacementFieldSource();
+  ~TransformToInverseDisplacementFieldSource() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Invert the transform for all voxels in the region. */
+  void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId ) override;
+
+  /** Solve T(x) = y for x, starting from x. Returns the final residual norm. */
+  double InvertPoint( const PointType & y, InputPointType & x ) const;
+
+private:
+
+  TransformToInverseDisplacementFieldSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );                            // purposely not implemented
+
+  /** Member variables. */
+  RegionType           m_OutputRegion;         // region of the output image
+  TransformPointerType m_Transform;            // Coordinate transform to invert
+  SpacingType          m_OutputSpacing;        // output image spacing
+  OriginType           m_OutputOrigin;         // output image origin
+  DirectionType        m_OutputDirection;      // output image direction cosines
+
+  unsigned int m_MaximumNumberOfIterations;
+  double       m_Tolerance;
+
+  /** Statistics, combined from the per thread values. */
+  double        m_MaximumResidual;
+  double        m_MeanResidual;
+  SizeValueType m_NumberOfNonConvergedPixels;
+
+  std::vector< double >        m_ThreaderMaximumResidual;
+  std::vector< double >        m_ThreaderSumResidual;
+  std::vector< SizeValueType > m_ThreaderNumberOfNonConvergedPixels;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTransformToInverseDisplacementFieldSource.hxx"
+#endif
+
+#endif // end #ifndef __itkTransformToInverseDisplacementFieldSource_h
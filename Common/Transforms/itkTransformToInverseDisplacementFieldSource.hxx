@@ -0,0 +1,413 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformToInverseDisplacementFieldSource_hxx
+#define __itkTransformToInverseDisplacementFieldSource_hxx
+
+#include "itkTransformToInverseDisplacementFieldSource.h"
+
+#include "itkProgressReporter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_det.h"
+#include "vnl/vnl_inverse.h"
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::TransformToInverseDisplacementFieldSource()
+{
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_OutputOrigin.Fill( 0.0 );
+  this->m_OutputDirection.SetIdentity();
+
+  SizeType size;
+  size.Fill( 0 );
+  this->m_OutputRegion.SetSize( size );
+
+  IndexType index;
+  index.Fill( 0 );
+  this->m_OutputRegion.SetIndex( index );
+
+  this->m_MaximumNumberOfIterations  = 20;
+  this->m_Tolerance                  = 1e-3;
+  this->m_MaximumResidual            = 0.0;
+  this->m_MeanResidual               = 0.0;
+  this->m_NumberOfNonConvergedPixels = 0;
+
+  /** The second output is the residual image. */
+  this->SetNumberOfRequiredOutputs( 2 );
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+
+  // Use the classic (ITK4) threading model, to ensure ThreadedGenerateData is being called.
+  this->itk::ImageSource< TOutputImage >::DynamicMultiThreadingOff();
+
+} // end Constructor
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "OutputRegion: " << this->m_OutputRegion << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << indent << "MaximumNumberOfIterations: " << this->m_MaximumNumberOfIterations << std::endl;
+  os << indent << "Tolerance: " << this->m_Tolerance << std::endl;
+  os << indent << "MaximumResidual: " << this->m_MaximumResidual << std::endl;
+  os << indent << "MeanResidual: " << this->m_MeanResidual << std::endl;
+  os << indent << "NumberOfNonConvergedPixels: " << this->m_NumberOfNonConvergedPixels << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * ********************* MakeOutput ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+DataObject::Pointer
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::MakeOutput( DataObjectPointerArraySizeType idx )
+{
+  if( idx == 1 )
+  {
+    return ResidualImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput( idx );
+
+} // end MakeOutput()
+
+
+/**
+ * ********************* GetResidualOutput ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+typename TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >::ResidualImageType *
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GetResidualOutput( void )
+{
+  return dynamic_cast< ResidualImageType * >( this->ProcessObject::GetOutput( 1 ) );
+
+} // end GetResidualOutput()
+
+
+/**
+ * ********************* SetOutputParametersFromImage ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::SetOutputParametersFromImage( const ImageBaseType * image )
+{
+  if( !image )
+  {
+    itkExceptionMacro( << "Cannot use a null image reference" );
+  }
+
+  this->SetOutputOrigin( image->GetOrigin() );
+  this->SetOutputSpacing( image->GetSpacing() );
+  this->SetOutputDirection( image->GetDirection() );
+  this->SetOutputRegion( image->GetLargestPossibleRegion() );
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * ********************* GenerateOutputInformation ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GenerateOutputInformation( void )
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  // set the information of both outputs
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    ImageBaseType * outputPtr = dynamic_cast< ImageBaseType * >( this->ProcessObject::GetOutput( i ) );
+    if( !outputPtr )
+    {
+      continue;
+    }
+
+    outputPtr->SetLargestPossibleRegion( this->m_OutputRegion );
+    outputPtr->SetSpacing( this->m_OutputSpacing );
+    outputPtr->SetOrigin( this->m_OutputOrigin );
+    outputPtr->SetDirection( this->m_OutputDirection );
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ********************* BeforeThreadedGenerateData ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::BeforeThreadedGenerateData( void )
+{
+  if( !this->m_Transform )
+  {
+    itkExceptionMacro( << "Transform not set" );
+  }
+
+  /** Initialize the per thread statistics. */
+  const ThreadIdType numberOfThreads = this->GetNumberOfWorkUnits();
+  this->m_ThreaderMaximumResidual.assign( numberOfThreads, 0.0 );
+  this->m_ThreaderSumResidual.assign( numberOfThreads, 0.0 );
+  this->m_ThreaderNumberOfNonConvergedPixels.assign( numberOfThreads, 0 );
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ********************* ThreadedGenerateData ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  // Get the output pointers
+  OutputImagePointer   outputPtr   = this->GetOutput();
+  ResidualImagePointer residualPtr = this->GetResidualOutput();
+
+  // Create iterators that will walk the output region for this thread.
+  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIteratorType;
+  typedef ImageRegionIterator< ResidualImageType >     ResidualIteratorType;
+  OutputIteratorType   it( outputPtr, outputRegionForThread );
+  ResidualIteratorType rit( residualPtr, outputRegionForThread );
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  // The solution of the previous voxel, used as a starting point
+  IndexType                                   previousIndex;
+  typename TransformType::InputVectorType     previousDisplacement;
+  bool                                        previousValid = false;
+  PointType                                   y;
+  InputPointType                              x;
+  PixelType                                   displacement;
+
+  double &        maximumResidual = this->m_ThreaderMaximumResidual[ threadId ];
+  double &        sumResidual     = this->m_ThreaderSumResidual[ threadId ];
+  SizeValueType & nonConverged    = this->m_ThreaderNumberOfNonConvergedPixels[ threadId ];
+
+  // Walk the output region
+  for( it.GoToBegin(), rit.GoToBegin(); !it.IsAtEnd(); ++it, ++rit )
+  {
+    // Determine the coordinates of the current voxel
+    const IndexType index = it.GetIndex();
+    outputPtr->TransformIndexToPhysicalPoint( index, y );
+
+    // Check if the previous voxel is the neighbour on the same scan line
+    bool neighbour = previousValid && index[ 0 ] == previousIndex[ 0 ] + 1;
+    for( unsigned int d = 1; d < ImageDimension && neighbour; ++d )
+    {
+      neighbour = index[ d ] == previousIndex[ d ];
+    }
+
+    // Starting point: the solution of the neighbour, or the fixed-point guess 2y - T(y)
+    if( neighbour )
+    {
+      x = y + previousDisplacement;
+    }
+    else
+    {
+      x = y + ( y - this->m_Transform->TransformPoint( y ) );
+    }
+
+    // Solve T(x) = y
+    const double residual = this->InvertPoint( y, x );
+
+    // Store the displacement and the residual
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      displacement[ d ] = static_cast< PixelValueType >( x[ d ] - y[ d ] );
+    }
+    it.Set( displacement );
+    rit.Set( static_cast< float >( residual ) );
+
+    // Update the statistics
+    maximumResidual = std::max( maximumResidual, residual );
+    sumResidual    += residual;
+    const bool converged = residual <= this->m_Tolerance;
+    if( !converged )
+    {
+      ++nonConverged;
+    }
+
+    // Only use converged solutions as a starting point
+    previousIndex        = index;
+    previousDisplacement = x - y;
+    previousValid        = converged;
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ********************* InvertPoint ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+double
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::InvertPoint( const PointType & y, InputPointType & x ) const
+{
+  typedef typename TransformType::InputVectorType VectorType;
+  typedef vnl_matrix_fixed< TTransformPrecisionType, ImageDimension, ImageDimension > MatrixType;
+
+  /** The number of step halvings before switching to a fixed-point step. */
+  const unsigned int maximumNumberOfStepHalvings = 5;
+
+  VectorType residual     = this->m_Transform->TransformPoint( x ) - y;
+  double     residualNorm = residual.GetNorm();
+
+  for( unsigned int iter = 0; iter < this->m_MaximumNumberOfIterations
+    && residualNorm > this->m_Tolerance; ++iter )
+  {
+    /** Compute the Newton step J^{-1} r, or the fixed-point step r
+     * if the spatial Jacobian is (nearly) singular.
+     */
+    SpatialJacobianType sj;
+    this->m_Transform->GetSpatialJacobian( x, sj );
+    const MatrixType & jac = sj.GetVnlMatrix();
+
+    VectorType step = residual;
+    if( std::abs( vnl_det( jac ) ) > 1e-6 )
+    {
+      const MatrixType jacInverse = vnl_inverse( jac );
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        step[ i ] = 0.0;
+        for( unsigned int j = 0; j < ImageDimension; ++j )
+        {
+          step[ i ] += jacInverse( i, j ) * residual[ j ];
+        }
+      }
+    }
+
+    /** Damping: halve the step until the residual decreases. */
+    bool   improved = false;
+    double alpha    = 1.0;
+    for( unsigned int k = 0; k <= maximumNumberOfStepHalvings; ++k, alpha *= 0.5 )
+    {
+      const InputPointType xNew            = x - step * alpha;
+      const VectorType     residualNew     = this->m_Transform->TransformPoint( xNew ) - y;
+      const double         residualNormNew = residualNew.GetNorm();
+      if( residualNormNew < residualNorm )
+      {
+        x            = xNew;
+        residual     = residualNew;
+        residualNorm = residualNormNew;
+        improved     = true;
+        break;
+      }
+    }
+
+    /** Stop when no progress can be made. */
+    if( !improved )
+    {
+      break;
+    }
+  }
+
+  return residualNorm;
+
+} // end InvertPoint()
+
+
+/**
+ * ********************* AfterThreadedGenerateData ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+void
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::AfterThreadedGenerateData( void )
+{
+  this->m_MaximumResidual            = 0.0;
+  this->m_NumberOfNonConvergedPixels = 0;
+  double sumResidual = 0.0;
+  for( std::size_t i = 0; i < this->m_ThreaderSumResidual.size(); ++i )
+  {
+    this->m_MaximumResidual             = std::max( this->m_MaximumResidual, this->m_ThreaderMaximumResidual[ i ] );
+    this->m_NumberOfNonConvergedPixels += this->m_ThreaderNumberOfNonConvergedPixels[ i ];
+    sumResidual                        += this->m_ThreaderSumResidual[ i ];
+  }
+
+  const SizeValueType numberOfPixels = this->GetOutput()->GetRequestedRegion().GetNumberOfPixels();
+  this->m_MeanResidual = numberOfPixels > 0 ? sumResidual / numberOfPixels : 0.0;
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ********************* GetMTime ****************************
+ */
+
+template< class TOutputImage, class TTransformPrecisionType >
+ModifiedTimeType
+TransformToInverseDisplacementFieldSource< TOutputImage, TTransformPrecisionType >
+::GetMTime( void ) const
+{
+  ModifiedTimeType latestTime = Object::GetMTime();
+
+  if( this->m_Transform )
+  {
+    if( latestTime < this->m_Transform->GetMTime() )
+    {
+      latestTime = this->m_Transform->GetMTime();
+    }
+  }
+
+  return latestTime;
+} // end GetMTime()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTransformToInverseDisplacementFieldSource_hxx
@@ -52,7 +52,10 @@ namespace itk
  * ProcessObject::GenerateOutputInformation().
  *
  * This filter is implemented as a multithreaded filter.  It provides a
- * ThreadedGenerateData() method for its implementation.
+ * ThreadedGenerateData() method for its implementation. The output is
+ * only allocated for the requested region, so the filter supports streaming:
+ * connected to an ImageFileWriter with a number of stream divisions, the
+ * output is computed and written piece by piece, in bounded memory.
  *
  * \author Stefan Klein, Erasmus MC, The Netherlands.
  *
@@ -22,7 +22,7 @@
 
 #include "itkAdvancedIdentityTransform.h"
 #include "itkProgressReporter.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageScanlineIterator.h"
 #include "vnl/vnl_copy.h"
 
 namespace itk
@@ -243,13 +243,20 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   OutputImagePointer outputPtr = this->GetOutput();
 
   // Create an iterator that will walk the output region for this thread.
-  typedef ImageRegionIteratorWithIndex< TOutputImage > OutputIteratorType;
+  typedef ImageScanlineIterator< TOutputImage > OutputIteratorType;
   OutputIteratorType it( outputPtr, outputRegionForThread );
   it.GoToBegin();
 
   // pixel coordinates
   PointType point;
 
+  // The physical step between two neighbouring voxels on a scan line
+  typename PointType::VectorType scanlineStep;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    scanlineStep[ d ] = outputPtr->GetDirection()[ d ][ 0 ] * outputPtr->GetSpacing()[ 0 ];
+  }
+
   // Support for progress methods/callbacks
   ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
 
@@ -257,24 +264,30 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   PixelType           sjOut;
   const unsigned int  nrElements = sj.GetVnlMatrix().size();
 
-  // Walk the output region
+  // Walk the output region, scan line by scan line. Only the first voxel
+  // of a scan line is mapped from index to point, the rest by increments.
   while( !it.IsAtEnd() )
   {
-    // Determine the coordinates of the current voxel
+    // Determine the coordinates of the first voxel of the scan line
     outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
 
-    this->m_Transform->GetSpatialJacobian( point, sj );
+    while( !it.IsAtEndOfLine() )
+    {
+      this->m_Transform->GetSpatialJacobian( point, sj );
 
-    // cast spatial jacobian to output pixel type
-    vnl_copy( sj.GetVnlMatrix().begin(), sjOut.GetVnlMatrix().begin(),
-      nrElements );
+      // cast spatial jacobian to output pixel type
+      vnl_copy( sj.GetVnlMatrix().begin(), sjOut.GetVnlMatrix().begin(),
+        nrElements );
 
-    // Set it
-    it.Set( sjOut );
+      // Set it
+      it.Set( sjOut );
 
-    // Update progress and iterator
-    progress.CompletedPixel();
-    ++it;
+      // Update progress, iterator and point
+      progress.CompletedPixel();
+      ++it;
+      point += scanlineStep;
+    }
+    it.NextLine();
   }
 
 } // end NonlinearThreadedGenerateData()
@@ -333,7 +346,9 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   outputPtr->SetSpacing( m_OutputSpacing );
   outputPtr->SetOrigin( m_OutputOrigin );
   outputPtr->SetDirection( m_OutputDirection );
-  outputPtr->Allocate();
+
+  // NB: the output is allocated by the pipeline for the requested region only,
+  // which allows to stream the output in pieces, e.g. directly to disk.
 
 } // end GenerateOutputInformation()
 
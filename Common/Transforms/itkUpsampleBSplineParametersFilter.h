@@ -20,6 +20,8 @@
 
 #include "itkObject.h"
 #include "itkArray.h"
+#include "itkPlatformMultiThreader.h"
+#include <vector>
 
 namespace itk
 {
@@ -33,6 +35,19 @@ namespace itk
  * on a denser grid. Therefore, the user needs to supply the old B-spline grid
  * (region, spacing, origin, direction), and the required B-spline grid.
  *
+ * When the spacing of the required grid is an integer fraction of the
+ * current spacing in each dimension (typically a factor 2 or 1), the
+ * directions are equal, and the control points of the current grid coincide
+ * with those of the required grid (up to the shift of the B-spline basis),
+ * the exact B-spline refinement (subdivision) is used: every coarse basis
+ * function is written as a weighted sum of fine basis functions, with the
+ * weights given by the (n+1)-fold convolution of a box filter of width r,
+ * divided by r^n. This is done separably, per dimension, and multithreaded
+ * over the grid lines. Coefficients outside the current grid are treated as
+ * zero, so the refined transform equals the current transform exactly.
+ * In all other cases the general approach is used: the current B-spline is
+ * resampled on the required grid, followed by a B-spline decomposition.
+ *
  */
 
 template< class TArray, class TImage >
@@ -94,6 +109,19 @@ public:
   /** Set the B-spline order. */
   itkSetMacro( BSplineOrder, unsigned int );
 
+  /** Set/Get whether the exact B-spline refinement may be used, when the
+   * grids allow it. Default: true.
+   */
+  itkSetMacro( UseRefinement, bool );
+  itkGetConstMacro( UseRefinement, bool );
+  itkBooleanMacro( UseRefinement );
+
+  /** Set the number of threads used for the refinement. */
+  void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
   /** Compute the output parameter array. */
   virtual void UpsampleParameters( const ArrayType & param_in,
     ArrayType & param_out );
@@ -112,6 +140,41 @@ protected:
   /** Function that checks if upsampling is required. */
   virtual bool DoUpsampling( void );
 
+  /** Function that checks if the exact refinement can be used. If so, the
+   * integer spacing ratios and the offsets of the refinement in units of
+   * the required grid spacing are returned.
+   */
+  virtual bool CanUseRefinement( std::vector< unsigned int > & ratios,
+    std::vector< long > & offsets ) const;
+
+  /** Refine one coefficient image, dimension by dimension. */
+  virtual void RefineCoefficients( const ValueType * coeffs_in, ValueType * coeffs_out,
+    const std::vector< unsigned int > & ratios, const std::vector< long > & offsets );
+
+  /** Refine a part of the grid lines along one dimension. */
+  void ThreadedRefineLines( ThreadIdType threadId );
+
+  /** Typedefs for multi-threading. */
+  typedef PlatformMultiThreader      ThreaderType;
+  typedef ThreaderType::WorkUnitInfo ThreadInfoType;
+
+  /** Launch MultiThread refinement. */
+  static ITK_THREAD_RETURN_TYPE RefineLinesThreaderCallback( void * arg );
+
+  /** The settings of one refinement pass along one dimension. */
+  struct RefinementPassType
+  {
+    const ValueType *     p_Input;
+    ValueType *           p_Output;
+    std::vector< double > p_Weights;        // the refinement mask
+    unsigned int          p_Ratio;          // integer spacing ratio r
+    long                  p_Offset;         // position of the first coarse point on the fine grid
+    SizeValueType         p_InputLength;    // number of coarse points along the line
+    SizeValueType         p_OutputLength;   // number of fine points along the line
+    SizeValueType         p_Stride;         // distance between two points on a line
+    SizeValueType         p_NumberOfLines;
+  };
+
 private:
 
   UpsampleBSplineParametersFilter( const Self & ); // purposely not implemented
@@ -127,6 +190,10 @@ private:
   DirectionType m_RequiredGridDirection;
   RegionType    m_RequiredGridRegion;
   unsigned int  m_BSplineOrder;
+  bool          m_UseRefinement;
+
+  ThreaderType::Pointer m_Threader;
+  RefinementPassType    m_RefinementPass;
 
 };
 
@@ -23,6 +23,7 @@
 #include "itkBSplineResampleImageFunction.h"
 #include "itkBSplineDecompositionImageFilter.h"
 #include "itkResampleImageFilter.h"
+#include <cmath>
 
 namespace itk
 {
@@ -35,7 +36,9 @@ template< class TArray, class TImage >
 UpsampleBSplineParametersFilter< TArray, TImage >
 ::UpsampleBSplineParametersFilter()
 {
-  this->m_BSplineOrder = 3;
+  this->m_BSplineOrder  = 3;
+  this->m_UseRefinement = true;
+  this->m_Threader      = ThreaderType::New();
 
   // Initialize grid settings.
   this->m_CurrentGridOrigin.Fill( 0.0 );
@@ -64,6 +67,28 @@ UpsampleBSplineParametersFilter< TArray, TImage >
     return;
   }
 
+  /** Use the exact refinement, if possible. */
+  std::vector< unsigned int > ratios;
+  std::vector< long >         offsets;
+  if( this->m_UseRefinement && this->CanUseRefinement( ratios, offsets ) )
+  {
+    const SizeValueType currentNumberOfPixels
+      = this->m_CurrentGridRegion.GetNumberOfPixels();
+    const SizeValueType requiredNumberOfPixels
+      = this->m_RequiredGridRegion.GetNumberOfPixels();
+    parameters_out.SetSize( requiredNumberOfPixels * Dimension );
+
+    /** Each direction is refined separately. */
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      this->RefineCoefficients(
+        parameters_in.data_block() + currentNumberOfPixels * j,
+        parameters_out.data_block() + requiredNumberOfPixels * j,
+        ratios, offsets );
+    }
+    return;
+  }
+
   /** Typedefs. */
   typedef itk::ResampleImageFilter<
     ImageType, ImageType >                        UpsampleFilterType;
@@ -183,6 +208,236 @@ UpsampleBSplineParametersFilter< TArray, TImage >
 } // end DoUpsampling()
 
 
+/**
+ * ******************* CanUseRefinement *******************
+ */
+
+template< class TArray, class TImage >
+bool
+UpsampleBSplineParametersFilter< TArray, TImage >
+::CanUseRefinement( std::vector< unsigned int > & ratios,
+  std::vector< long > & offsets ) const
+{
+  /** The grids should have the same orientation. */
+  if( this->m_CurrentGridDirection != this->m_RequiredGridDirection )
+  {
+    return false;
+  }
+
+  /** The spacing ratios should be integers. */
+  ratios.resize( Dimension );
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    const double ratio = this->m_CurrentGridSpacing[ d ] / this->m_RequiredGridSpacing[ d ];
+    const double r     = std::floor( ratio + 0.5 );
+    if( r < 1.0 || std::abs( ratio - r ) > 1e-6 * r )
+    {
+      return false;
+    }
+    ratios[ d ] = static_cast< unsigned int >( r );
+  }
+
+  /** Compute the physical position of the first current control point. */
+  OriginType firstPoint = this->m_CurrentGridOrigin;
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      firstPoint[ i ] += this->m_CurrentGridDirection[ i ][ j ]
+        * this->m_CurrentGridSpacing[ j ] * this->m_CurrentGridRegion.GetIndex()[ j ];
+    }
+  }
+
+  /** Express it as a continuous index in the required grid, and subtract
+   * the shift of the refinement mask: a coarse basis function of order n
+   * centered at fine index q is the weighted sum of the fine basis functions
+   * centered at q - (n+1)(r-1)/2 + k, with k = 0, ..., (n+1)(r-1).
+   * The result should be an integer.
+   */
+  const typename DirectionType::InternalMatrixType inverseDirection
+    = this->m_RequiredGridDirection.GetInverse();
+  offsets.resize( Dimension );
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    double q = 0.0;
+    for( unsigned int i = 0; i < Dimension; ++i )
+    {
+      q += inverseDirection( d, i ) * ( firstPoint[ i ] - this->m_RequiredGridOrigin[ i ] );
+    }
+    q /= this->m_RequiredGridSpacing[ d ];
+    q -= this->m_RequiredGridRegion.GetIndex()[ d ];
+    q -= 0.5 * ( this->m_BSplineOrder + 1.0 ) * ( ratios[ d ] - 1.0 );
+
+    const double t = std::floor( q + 0.5 );
+    if( std::abs( q - t ) > 1e-4 )
+    {
+      return false;
+    }
+    offsets[ d ] = static_cast< long >( t );
+  }
+
+  return true;
+
+} // end CanUseRefinement()
+
+
+/**
+ * ******************* RefineCoefficients *******************
+ */
+
+template< class TArray, class TImage >
+void
+UpsampleBSplineParametersFilter< TArray, TImage >
+::RefineCoefficients( const ValueType * coeffs_in, ValueType * coeffs_out,
+  const std::vector< unsigned int > & ratios, const std::vector< long > & offsets )
+{
+  /** The size of the coefficient image, which changes from the current
+   * to the required size dimension by dimension.
+   */
+  std::vector< SizeValueType > size( Dimension );
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    size[ d ] = this->m_CurrentGridRegion.GetSize()[ d ];
+  }
+
+  /** Intermediate results are stored in two alternating buffers. */
+  std::vector< ValueType > buffers[ 2 ];
+  const ValueType *        input = coeffs_in;
+
+  for( unsigned int d = 0; d < Dimension; ++d )
+  {
+    RefinementPassType & pass = this->m_RefinementPass;
+    pass.p_Ratio        = ratios[ d ];
+    pass.p_Offset       = offsets[ d ];
+    pass.p_InputLength  = size[ d ];
+    pass.p_OutputLength = this->m_RequiredGridRegion.GetSize()[ d ];
+
+    /** The lines along dimension d are strided by the size of the lower dimensions. */
+    pass.p_Stride        = 1;
+    pass.p_NumberOfLines = 1;
+    for( unsigned int k = 0; k < Dimension; ++k )
+    {
+      if( k < d ) { pass.p_Stride *= size[ k ]; }
+      if( k != d ) { pass.p_NumberOfLines *= size[ k ]; }
+    }
+
+    /** The refinement mask: the (n+1)-fold convolution of a box of width r, divided by r^n. */
+    pass.p_Weights.assign( 1, 1.0 );
+    for( unsigned int n = 0; n <= this->m_BSplineOrder; ++n )
+    {
+      std::vector< double > convolved( pass.p_Weights.size() + pass.p_Ratio - 1, 0.0 );
+      for( std::size_t k = 0; k < pass.p_Weights.size(); ++k )
+      {
+        for( unsigned int l = 0; l < pass.p_Ratio; ++l )
+        {
+          convolved[ k + l ] += pass.p_Weights[ k ];
+        }
+      }
+      pass.p_Weights.swap( convolved );
+    }
+    const double normalization = std::pow( static_cast< double >( pass.p_Ratio ),
+      static_cast< double >( this->m_BSplineOrder ) );
+    for( std::size_t k = 0; k < pass.p_Weights.size(); ++k )
+    {
+      pass.p_Weights[ k ] /= normalization;
+    }
+
+    /** The last pass writes directly in the output. */
+    if( d == Dimension - 1 )
+    {
+      pass.p_Output = coeffs_out;
+    }
+    else
+    {
+      buffers[ d % 2 ].resize( pass.p_NumberOfLines * pass.p_OutputLength );
+      pass.p_Output = &( buffers[ d % 2 ][ 0 ] );
+    }
+    pass.p_Input = input;
+
+    /** Refine all lines, multi-threaded. */
+    this->m_Threader->SetSingleMethod( RefineLinesThreaderCallback, this );
+    this->m_Threader->SingleMethodExecute();
+
+    /** Prepare the next pass. */
+    size[ d ] = pass.p_OutputLength;
+    input     = pass.p_Output;
+  }
+
+} // end RefineCoefficients()
+
+
+/**
+ * ******************* RefineLinesThreaderCallback *******************
+ */
+
+template< class TArray, class TImage >
+ITK_THREAD_RETURN_TYPE
+UpsampleBSplineParametersFilter< TArray, TImage >
+::RefineLinesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->WorkUnitID;
+  Self *           filter     = static_cast< Self * >( infoStruct->UserData );
+
+  filter->ThreadedRefineLines( threadId );
+
+  return ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end RefineLinesThreaderCallback()
+
+
+/**
+ * ******************* ThreadedRefineLines *******************
+ */
+
+template< class TArray, class TImage >
+void
+UpsampleBSplineParametersFilter< TArray, TImage >
+::ThreadedRefineLines( ThreadIdType threadId )
+{
+  const RefinementPassType & pass = this->m_RefinementPass;
+
+  /** Compute the range of lines for this thread. */
+  const SizeValueType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  const SizeValueType subSize         = ( pass.p_NumberOfLines + numberOfThreads - 1 ) / numberOfThreads;
+  const SizeValueType lmin            = std::min( threadId * subSize, pass.p_NumberOfLines );
+  const SizeValueType lmax            = std::min( lmin + subSize, pass.p_NumberOfLines );
+
+  const long   numberOfWeights = static_cast< long >( pass.p_Weights.size() );
+  const long   inputLength     = static_cast< long >( pass.p_InputLength );
+  const double ratio           = static_cast< double >( pass.p_Ratio );
+
+  for( SizeValueType line = lmin; line < lmax; ++line )
+  {
+    /** The first element of this line in the input and the output. */
+    const SizeValueType inner = line % pass.p_Stride;
+    const SizeValueType outer = line / pass.p_Stride;
+    const ValueType *   in    = pass.p_Input + inner + outer * pass.p_Stride * pass.p_InputLength;
+    ValueType *         out   = pass.p_Output + inner + outer * pass.p_Stride * pass.p_OutputLength;
+
+    for( SizeValueType m = 0; m < pass.p_OutputLength; ++m )
+    {
+      /** The coarse coefficients j that contribute to fine coefficient m
+       * satisfy 0 <= m - offset - r j < numberOfWeights.
+       */
+      const long mm   = static_cast< long >( m ) - pass.p_Offset;
+      const long jmin = std::max( 0L,
+        static_cast< long >( std::ceil( ( mm - numberOfWeights + 1 ) / ratio ) ) );
+      const long jmax = std::min( inputLength - 1,
+        static_cast< long >( std::floor( mm / ratio ) ) );
+
+      double value = 0.0;
+      for( long j = jmin; j <= jmax; ++j )
+      {
+        value += pass.p_Weights[ mm - j * static_cast< long >( pass.p_Ratio ) ] * in[ j * pass.p_Stride ];
+      }
+      out[ m * pass.p_Stride ] = static_cast< ValueType >( value );
+    }
+  }
+
+} // end ThreadedRefineLines()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -205,6 +460,7 @@ UpsampleBSplineParametersFilter< TArray, TImage >
   os << indent << "RequiredGridRegion: "  << this->m_RequiredGridRegion << std::endl;
 
   os << indent << "BSplineOrder: " << this->m_BSplineOrder << std::endl;
+  os << indent << "UseRefinement: " << this->m_UseRefinement << std::endl;
 
 } // end PrintSelf()
 
@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkCachedMultiResolutionPyramidImageFilter_h
+#define __itkCachedMultiResolutionPyramidImageFilter_h
+
+#include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkImagePyramidCache.h"
+
+namespace itk
+{
+
+/** \class CachedMultiResolutionPyramidImageFilter
+ * \brief A multi-resolution pyramid whose images are shared through an
+ * ImagePyramidCache.
+ *
+ * The pyramid images are stored in the cache under CacheKey. The first
+ * filter that needs them computes them with the SourcePyramid, on the input
+ * of this filter; all other filters with the same cache and key then output
+ * the same images, without computing them again. The outputs refer to the
+ * pixel buffers in the cache, so they must not be modified.
+ *
+ * The number of levels and the schedule should be set equal to those of
+ * the source pyramid, so that users of the schedule get the same result.
+ *
+ * \sa ImagePyramidCache
+ *
+ * \ingroup PyramidImageFilter
+ */
+template<
+class TInputImage,
+class TOutputImage
+>
+class CachedMultiResolutionPyramidImageFilter :
+  public MultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef CachedMultiResolutionPyramidImageFilter                        Self;
+  typedef MultiResolutionPyramidImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                                           Pointer;
+  typedef SmartPointer< const Self >                                     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( CachedMultiResolutionPyramidImageFilter,
+    MultiResolutionPyramidImageFilter );
+
+  /** Inherit types from Superclass. */
+  typedef typename Superclass::ScheduleType           ScheduleType;
+  typedef typename Superclass::InputImageType         InputImageType;
+  typedef typename Superclass::OutputImageType        OutputImageType;
+  typedef typename Superclass::InputImagePointer      InputImagePointer;
+  typedef typename Superclass::OutputImagePointer     OutputImagePointer;
+  typedef typename Superclass::InputImageConstPointer InputImageConstPointer;
+
+  /** Typedefs for the cache. */
+  typedef ImagePyramidCache                        ImagePyramidCacheType;
+  typedef ImagePyramidCacheType::PyramidImagesType PyramidImagesType;
+
+  /** Set/Get the pyramid that computes the images, if they are not in the cache yet. */
+  itkSetObjectMacro( SourcePyramid, Superclass );
+  itkGetModifiableObjectMacro( SourcePyramid, Superclass );
+
+  /** Set/Get the cache that holds the pyramid images. */
+  itkSetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+  itkGetModifiableObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+
+  /** Set/Get the key of the pyramid images in the cache. */
+  itkSetStringMacro( CacheKey );
+  itkGetStringMacro( CacheKey );
+
+  /** Get the pyramid images from the cache, computing them if needed, and
+   * copy their information to the outputs.
+   */
+  void GenerateOutputInformation( void ) override;
+
+  /** All outputs are generated at their largest possible region. */
+  void GenerateOutputRequestedRegion( DataObject * output ) override;
+
+  /** The input is only read by the source pyramid. */
+  void GenerateInputRequestedRegion( void ) override;
+
+protected:
+
+  CachedMultiResolutionPyramidImageFilter() {}
+  ~CachedMultiResolutionPyramidImageFilter() override {}
+
+  /** Graft the pyramid images onto the outputs. */
+  void GenerateData( void ) override;
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  CachedMultiResolutionPyramidImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                          // purposely not implemented
+
+  typename Superclass::Pointer   m_SourcePyramid;
+  ImagePyramidCacheType::Pointer m_ImagePyramidCache;
+  std::string                    m_CacheKey;
+  PyramidImagesType              m_PyramidImages;
+
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkCachedMultiResolutionPyramidImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkCachedMultiResolutionPyramidImageFilter_hxx
+#define __itkCachedMultiResolutionPyramidImageFilter_hxx
+
+#include "itkCachedMultiResolutionPyramidImageFilter.h"
+
+namespace itk
+{
+
+/**
+ * GenerateOutputInformation
+ */
+template< class TInputImage, class TOutputImage >
+void
+CachedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateOutputInformation( void )
+{
+  /** Check the settings. */
+  if( this->m_SourcePyramid.IsNull() )
+  {
+    itkExceptionMacro( << "No source pyramid set." );
+  }
+  if( this->m_ImagePyramidCache.IsNull() )
+  {
+    itkExceptionMacro( << "No image pyramid cache set." );
+  }
+
+  /** Get the pyramid images. The first filter that asks for them computes
+   * them with its source pyramid, on its own input.
+   */
+  Superclass *           source = this->m_SourcePyramid;
+  const InputImageType * input  = this->GetInput();
+  this->m_PyramidImages = this->m_ImagePyramidCache->GetPyramidImages( this->m_CacheKey,
+    [ source, input ]()
+    {
+      source->SetInput( input );
+      source->UpdateLargestPossibleRegion();
+
+      PyramidImagesType images( source->GetNumberOfLevels() );
+      for( unsigned int level = 0; level < images.size(); ++level )
+      {
+        OutputImagePointer image = OutputImageType::New();
+        image->Graft( source->GetOutput( level ) );
+        images[ level ] = image;
+      }
+      return images;
+    } );
+
+  if( this->m_PyramidImages.size() != this->GetNumberOfLevels() )
+  {
+    itkExceptionMacro( << "The pyramid \"" << this->m_CacheKey << "\" in the cache has "
+                       << this->m_PyramidImages.size() << " levels, instead of "
+                       << this->GetNumberOfLevels() << "." );
+  }
+
+  /** Copy the image information of each level. */
+  for( unsigned int level = 0; level < this->GetNumberOfLevels(); ++level )
+  {
+    this->GetOutput( level )->CopyInformation( this->m_PyramidImages[ level ] );
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * GenerateOutputRequestedRegion
+ */
+template< class TInputImage, class TOutputImage >
+void
+CachedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateOutputRequestedRegion( DataObject * itkNotUsed( output ) )
+{
+  for( unsigned int level = 0; level < this->GetNumberOfLevels(); ++level )
+  {
+    this->GetOutput( level )->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateOutputRequestedRegion()
+
+
+/**
+ * GenerateInputRequestedRegion
+ */
+template< class TInputImage, class TOutputImage >
+void
+CachedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion( void )
+{
+  // call the implementation of ImageToImageFilter, instead of the
+  // superclass' implementation, which assumes shrunken outputs
+  Superclass::Superclass::GenerateInputRequestedRegion();
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * GenerateData
+ */
+template< class TInputImage, class TOutputImage >
+void
+CachedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::GenerateData( void )
+{
+  for( unsigned int level = 0; level < this->GetNumberOfLevels(); ++level )
+  {
+    this->GraftNthOutput( level, this->m_PyramidImages[ level ] );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * PrintSelf
+ */
+template< class TInputImage, class TOutputImage >
+void
+CachedMultiResolutionPyramidImageFilter< TInputImage, TOutputImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "SourcePyramid: " << this->m_SourcePyramid.GetPointer() << std::endl;
+  os << indent << "ImagePyramidCache: " << this->m_ImagePyramidCache.GetPointer() << std::endl;
+  os << indent << "CacheKey: " << this->m_CacheKey << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif
@@ -22,6 +22,11 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkImageRandomCoordinateSampler.h"
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
+#include "itkPlatformMultiThreader.h"
+
+#include "vnl/vnl_diag_matrix.h"
+#include "vnl/vnl_sparse_matrix.h"
+#include <vector>
 
 namespace itk
 {
@@ -31,6 +36,13 @@ namespace itk
  * More specifically this class computes the Jacobian terms related to the automatic
  * parameter estimation for the adaptive stochastic gradient descent optimizer.
  * Details can be found in the paper.
+ *
+ * The computation is multi-threaded. Each thread accumulates the covariance
+ * matrix of its part of the samples in a partial covariance, which stores the
+ * dominant bands only for the parameter rows that the thread actually touches.
+ * The partial covariances are then summed row by row, in parallel over the rows
+ * and in a fixed thread order, so that the result is reproducible for a given
+ * number of threads. The maximum terms are computed in parallel as well.
  */
 
 template< class TFixedImage, class TTransform >
@@ -107,11 +119,22 @@ public:
   virtual void Compute( double & TrC, double & TrCC,
     double & maxJJ, double & maxJCJ );
 
+  /** Set the number of threads, typically the number of threads of the metric. */
+  void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
+
 protected:
 
   ComputeJacobianTerms();
   ~ComputeJacobianTerms() override {}
 
+  /** Typedefs for multi-threading. */
+  typedef itk::PlatformMultiThreader ThreaderType;
+  typedef ThreaderType::WorkUnitInfo ThreadInfoType;
+
   typename FixedImageType::ConstPointer m_FixedImage;
   FixedImageRegionType       m_FixedImageRegion;
   FixedImageMaskConstPointer m_FixedImageMask;
@@ -151,6 +174,71 @@ protected:
   virtual void SampleFixedImageForJacobianTerms(
     ImageSampleContainerPointer & sampleContainer );
 
+  /** Typedefs for the covariance matrix. */
+  typedef double                                   CovarianceValueType;
+  typedef Array2D< CovarianceValueType >           CovarianceMatrixType;
+  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
+  typedef typename SparseCovarianceMatrixType::row SparseRowType;
+  typedef vnl_diag_matrix< CovarianceValueType >   DiagCovarianceMatrixType;
+
+  /** Divide [0, size) over the threads, and return the part [begin, end) of a thread. */
+  void GetRangeForThread( const SizeValueType size, const ThreadIdType threadId,
+    SizeValueType & begin, SizeValueType & end ) const;
+
+  /** Launch the threads on one of the callbacks below. */
+  void LaunchThreaderCallback( ThreaderType::ThreadFunctionType callback ) const;
+
+  /** Threader callback functions. */
+  static ITK_THREAD_RETURN_TYPE ComputeCovarianceThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE AccumulateCovarianceThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE ComputeMaximumTermsThreaderCallback( void * arg );
+
+  /** Accumulate the partial covariance of the samples of this thread (term 1). */
+  virtual void ThreadedComputeCovariance( ThreadIdType threadId );
+
+  /** Sum the partial covariances, for a range of rows. */
+  virtual void ThreadedAccumulateCovariance( ThreadIdType threadId );
+
+  /** Compute maxJJ and maxJCJ for the samples of this thread (terms 3 and 4). */
+  virtual void ThreadedComputeMaximumTerms( ThreadIdType threadId );
+
+  /** To give the threads access to all member variables and functions. */
+  struct MultiThreaderParameterType
+  {
+    Self * st_Self;
+  };
+  mutable MultiThreaderParameterType m_ThreaderParameters;
+
+  /** The partial covariance of a thread. The elements in the dominant bands
+   * are stored compactly, only for the rows that this thread touches:
+   * st_BandRowMap maps a parameter row to the row in st_BandCov, or -1.
+   */
+  struct ComputePerThreadStruct
+  {
+    SparseCovarianceMatrixType st_Cov;
+    std::vector< int >         st_BandRowMap;
+    std::vector< double >      st_BandCov;
+    double                     st_MaxJJ;
+    double                     st_MaxJCJ;
+  };
+  std::vector< ComputePerThreadStruct > m_ComputePerThreadVariables;
+
+  /** Variables shared by the threads. */
+  ThreaderType::Pointer       m_Threader;
+  ImageSampleContainerPointer m_SampleContainer;
+  SparseCovarianceMatrixType  m_Cov;
+  DiagCovarianceMatrixType    m_DiagCov;
+  std::vector< unsigned int > m_BandCovMap;
+  std::vector< unsigned int > m_BandCovMap2;
+  unsigned int                m_BandCovSize;
+
+  /** Add the covariance elements J^T J / n of one run of samples with
+   * the same nonzero Jacobian indices to the partial covariance.
+   */
+  void UpdatePartialCovariance( ComputePerThreadStruct & partial,
+    const NonZeroJacobianIndicesType & jacind,
+    const CovarianceMatrixType & jactjac, const double n ) const;
+
 private:
 
   ComputeJacobianTerms( const Self & ); // purposely not implemented
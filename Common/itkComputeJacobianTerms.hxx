@@ -44,6 +44,13 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   this->m_MaxBandCovSize               = 0;
   this->m_NumberOfBandStructureSamples = 0;
   this->m_NumberOfJacobianMeasurements = 0;
+  this->m_BandCovSize                  = 0;
+
+  /** Threading related variables. */
+  this->m_Threader = ThreaderType::New();
+
+  /** Initialize the m_ThreaderParameters. */
+  this->m_ThreaderParameters.st_Self = this;
 
 } // end Constructor
 
@@ -73,41 +80,23 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Term 4: maxJCJ, see (54)
    */
 
-  typedef double                                   CovarianceValueType;
-  typedef itk::Array2D< CovarianceValueType >      CovarianceMatrixType;
-  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
-  typedef SparseCovarianceMatrixType::row          SparseRowType;
-  typedef itk::Array< SizeValueType >              NonZeroJacobianIndicesExpandedType;
-  typedef vnl_diag_matrix< CovarianceValueType >   DiagCovarianceMatrixType;
-
   /** Initialize. */
   TrC = TrCC = maxJJ = maxJCJ = 0.0;
 
   /** Get samples. */
-  ImageSampleContainerPointer sampleContainer; // default-constructed (null)
-  SampleFixedImageForJacobianTerms( sampleContainer );
-  const SizeValueType nrofsamples = sampleContainer->Size();
-  const double        n           = static_cast< double >( nrofsamples );
+  this->m_SampleContainer = nullptr;
+  SampleFixedImageForJacobianTerms( this->m_SampleContainer );
+  const SizeValueType nrofsamples = this->m_SampleContainer->Size();
 
   /** Get the number of parameters. */
   const unsigned int P = static_cast< unsigned int >(
     this->m_Transform->GetNumberOfParameters() );
 
-  /** Get transform and set current position. */
-  typename TransformType::Pointer transform
-    = this->m_Transform;
-  const unsigned int outdim = this->m_Transform->GetOutputSpaceDimension();
-
   /** Get scales vector */
   const ScalesType & scales = this->m_Scales;
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator iter;
-  typename ImageSampleContainerType::ConstIterator begin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator end   = sampleContainer->End();
-  unsigned int samplenr = 0;
-
   /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
   NumberOfParametersType sizejacind
     = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
   JacobianType jacj( outdim, sizejacind );
@@ -115,16 +104,6 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   NonZeroJacobianIndicesType jacind( sizejacind );
   jacind[ 0 ] = 0;
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
-  NonZeroJacobianIndicesType prevjacind = jacind;
-
-  /** Initialize covariance matrix. Sparse, diagonal, and band form. */
-  SparseCovarianceMatrixType cov( P, P );
-  DiagCovarianceMatrixType   diagcov( P, 0.0 );
-  CovarianceMatrixType       bandcov;
-
-  /** For temporary storage of J'J. */
-  CovarianceMatrixType jactjac( sizejacind, sizejacind );
-  jactjac.Fill( 0.0 );
 
   typedef std::vector< unsigned int >             DifHistType;
   typedef std::pair< unsigned int, unsigned int > FreqPairType;
@@ -146,12 +125,11 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * which values of q-p occur often. This is done by making a histogram.
    * The histogram is then sorted and the most occurring bands
    * are determined. The covariance elements in these bands will not
-   * be stored in the sparse matrix structure 'cov', but in the band
-   * matrix 'bandcov', which is much faster.
-   * Only after the bandcov and cov have been filled (by looping over
-   * all Jacobian measurements in the sample container, the bandcov
-   * matrix is injected in the cov matrix, for easy further calculations,
-   * and the bandcov matrix is deleted.
+   * be stored in the sparse matrix structure of the partial covariances,
+   * but in their compact band storage, which is much faster.
+   * Only after all Jacobian measurements in the sample container have been
+   * processed, the band elements are injected in the cov matrix, for easy
+   * further calculations.
    */
   unsigned int onezero = 0;
   for( unsigned int s = 0; s < this->m_NumberOfBandStructureSamples; ++s )
@@ -163,7 +141,7 @@ ComputeJacobianTerms< TFixedImage, TTransform >
 
     /** Read fixed coordinates and get Jacobian J_j. */
     const FixedImagePointType & point
-      = sampleContainer->GetElement( samplenr ).m_ImageCoordinates;
+      = this->m_SampleContainer->GetElement( samplenr ).m_ImageCoordinates;
     this->m_Transform->GetJacobian( point, jacj, jacind );
 
     /** Skip invalid Jacobians in the beginning, if any. */
@@ -198,11 +176,12 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   /** Compute the number of bands. */
   const unsigned int bandcovsize = std::min( this->m_MaxBandCovSize,
     static_cast< unsigned int >( difHist2.size() ) );
+  this->m_BandCovSize = bandcovsize;
 
   /** Maps parameterNrDifference (q-p) to colnr in bandcov. */
-  std::vector< unsigned int > bandcovMap( P, bandcovsize );
+  this->m_BandCovMap.assign( P, bandcovsize );
   /** Maps colnr in bandcov to parameterNrDifference (q-p). */
-  std::vector< unsigned int > bandcovMap2( bandcovsize, P );
+  this->m_BandCovMap2.assign( bandcovsize, P );
 
   /** Sort the difHist2 based on the frequencies. */
   std::sort( difHist2.begin(), difHist2.end() );
@@ -212,13 +191,24 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   for( unsigned int b = 0; b < bandcovsize; ++b )
   {
     --difHist2It;
-    bandcovMap[ difHist2It->second ] = b;
-    bandcovMap2[ b ]                 = difHist2It->second;
+    this->m_BandCovMap[ difHist2It->second ] = b;
+    this->m_BandCovMap2[ b ]                 = difHist2It->second;
   }
 
-  /** Initialize band matrix. */
-  bandcov = CovarianceMatrixType( P, bandcovsize );
-  bandcov.Fill( 0.0 );
+  /** Initialize the covariance matrix and the partial covariances. */
+  const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  this->m_ComputePerThreadVariables.clear();
+  this->m_ComputePerThreadVariables.resize( numberOfThreads );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    ComputePerThreadStruct & partial = this->m_ComputePerThreadVariables[ i ];
+    partial.st_Cov    = SparseCovarianceMatrixType( P, P );
+    partial.st_BandRowMap.assign( P, -1 );
+    partial.st_MaxJJ  = 0.0;
+    partial.st_MaxJCJ = 0.0;
+  }
+  this->m_Cov     = SparseCovarianceMatrixType( P, P );
+  this->m_DiagCov = DiagCovarianceMatrixType( P, 0.0 );
 
   /**
    *    TERM 1
@@ -227,172 +217,439 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Compute C = 1/n \sum_i J_i^T J_i
    * Possibly apply scaling afterwards.
    */
+  this->LaunchThreaderCallback( Self::ComputeCovarianceThreaderCallback );
+  this->LaunchThreaderCallback( Self::AccumulateCovarianceThreaderCallback );
+
+  /** Release the memory of the partial covariances. */
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    ComputePerThreadStruct & partial = this->m_ComputePerThreadVariables[ i ];
+    partial.st_Cov = SparseCovarianceMatrixType();
+    std::vector< int >().swap( partial.st_BandRowMap );
+    std::vector< double >().swap( partial.st_BandCov );
+  }
+
+  /** Apply scales. the use of m_Scales maybe something wrong. */
+  SparseCovarianceMatrixType & cov = this->m_Cov;
+  if( this->m_UseScales )
+  {
+    for( unsigned int p = 0; p < P; ++p )
+    {
+      cov.scale_row( p, 1.0 / this->m_Scales[ p ] );
+    }
+    /**  \todo: this might be faster with get_row instead of the iterator */
+    cov.reset();
+    bool notfinished = cov.next();
+    while( notfinished )
+    {
+      const int col = cov.getcolumn();
+      cov( cov.getrow(), col ) /= scales[ col ];
+      notfinished               = cov.next();
+    }
+  }
+
+  /** Compute TrC = trace(C), and diagcov. */
+  for( unsigned int p = 0; p < P; ++p )
+  {
+    if( !cov.empty_row( p ) )
+    {
+      //avoid creation of element if the row is empty
+      CovarianceValueType & covpp = cov( p, p );
+      TrC                  += covpp;
+      this->m_DiagCov[ p ]  = covpp;
+    }
+  }
+
+  /**
+   *    TERM 2
+   *
+   * Compute TrCC = ||C||_F^2.
+   */
+  cov.reset();
+  bool notfinished2 = cov.next();
+  while( notfinished2 )
+  {
+    TrCC        += vnl_math::sqr( cov.value() );
+    notfinished2 = cov.next();
+  }
+
+  /** Symmetry: multiply by 2 and subtract sumsqr(diagcov). */
+  TrCC *= 2.0;
+  TrCC -= this->m_DiagCov.diagonal().squared_magnitude();
+
+  /**
+   *    TERM 3 and 4
+   *
+   * Compute maxJJ and maxJCJ
+   * \li maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} || J_j J_j^T ||_F ]
+   * \li maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} || J_j C J_j^T ||_F ]
+   */
+  this->LaunchThreaderCallback( Self::ComputeMaximumTermsThreaderCallback );
+
+  /** Take the maximum over the threads. */
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    maxJJ  = std::max( maxJJ, this->m_ComputePerThreadVariables[ i ].st_MaxJJ );
+    maxJCJ = std::max( maxJCJ, this->m_ComputePerThreadVariables[ i ].st_MaxJCJ );
+  }
+
+  /** Clean up. */
+  this->m_Cov     = SparseCovarianceMatrixType();
+  this->m_DiagCov = DiagCovarianceMatrixType();
+  this->m_ComputePerThreadVariables.clear();
+  this->m_SampleContainer = nullptr;
+
+} // end Compute()
+
+
+/**
+ * ************************* GetRangeForThread ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::GetRangeForThread( const SizeValueType size, const ThreadIdType threadId,
+  SizeValueType & begin, SizeValueType & end ) const
+{
+  const ThreadIdType  numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  const SizeValueType chunkSize
+    = static_cast< SizeValueType >( std::ceil( static_cast< double >( size )
+    / static_cast< double >( numberOfThreads ) ) );
+
+  begin = std::min( size, threadId * chunkSize );
+  end   = std::min( size, ( threadId + 1 ) * chunkSize );
+
+} // end GetRangeForThread()
+
+
+/**
+ * *********************** LaunchThreaderCallback ***************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::LaunchThreaderCallback( ThreaderType::ThreadFunctionType callback ) const
+{
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod( callback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderParameters ) ) );
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchThreaderCallback()
+
+
+/**
+ * ************ ComputeCovarianceThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->WorkUnitID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedComputeCovariance( threadID );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeCovarianceThreaderCallback()
+
+
+/**
+ * ************ AccumulateCovarianceThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::AccumulateCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->WorkUnitID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedAccumulateCovariance( threadID );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end AccumulateCovarianceThreaderCallback()
+
+
+/**
+ * ************ ComputeMaximumTermsThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeMaximumTermsThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID   = infoStruct->WorkUnitID;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedComputeMaximumTerms( threadID );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeMaximumTermsThreaderCallback()
+
+
+/**
+ * ************************* ThreadedComputeCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeCovariance( ThreadIdType threadId )
+{
+  /** Get the samples of this thread. */
+  const SizeValueType nrofsamples = this->m_SampleContainer->Size();
+  const double        n           = static_cast< double >( nrofsamples );
+  SizeValueType       sampleBegin = 0;
+  SizeValueType       sampleEnd   = 0;
+  this->GetRangeForThread( nrofsamples, threadId, sampleBegin, sampleEnd );
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator iter;
+  typename ImageSampleContainerType::ConstIterator begin = this->m_SampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator end   = this->m_SampleContainer->Begin();
+  begin += static_cast< int >( sampleBegin );
+  end   += static_cast< int >( sampleEnd );
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
   jacind[ 0 ] = 0;
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
+  NonZeroJacobianIndicesType prevjacind = jacind;
+
+  /** For temporary storage of J'J. */
+  CovarianceMatrixType jactjac( sizejacind, sizejacind );
+  jactjac.Fill( 0.0 );
+
+  /** Samples with the same nonzero Jacobian indices are summed in jactjac
+   * first, and only added to the partial covariance at the end of such a run.
+   */
+  ComputePerThreadStruct & partial    = this->m_ComputePerThreadVariables[ threadId ];
+  bool                     runStarted = false;
   for( iter = begin; iter != end; ++iter )
   {
-    /** Print progress 0-50%.
-     *progressObserver->UpdateAndPrintProgress( samplenr );*/
-    ++samplenr;
-
     /** Read fixed coordinates and get Jacobian J_j. */
     const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
-    this->m_Transform->GetJacobian( point, jacj, jacind  );
+    this->m_Transform->GetJacobian( point, jacj, jacind );
 
-    /** Skip invalid Jacobians in the beginning, if any. */
+    /** Skip invalid Jacobians, if any. */
     if( sizejacind > 1 )
     {
       if( jacind[ 0 ] == jacind[ 1 ] ) { continue; }
     }
 
-    if( jacind == prevjacind )
+    if( runStarted && jacind == prevjacind )
     {
       /** Update sum of J_j^T J_j. */
       vnl_fastops::inc_X_by_AtA( jactjac, jacj );
     }
     else
     {
-      /** The following should only be done after the first sample. */
-      if( iter != begin )
+      /** Update the partial covariance with the previous run. */
+      if( runStarted )
       {
-        /** Update covariance matrix. */
-        for( unsigned int pi = 0; pi < sizejacind; ++pi )
-        {
-          const unsigned int p = prevjacind[ pi ];
-          for( unsigned int qi = 0; qi < sizejacind; ++qi )
-          {
-            const unsigned int q = prevjacind[ qi ];
-            if( q >= p )
-            {
-              const double tempval = jactjac( pi, qi ) / n;
-              if( std::abs( tempval ) > 1e-14 )
-              {
-                const unsigned int bandindex = bandcovMap[ q - p ];
-                if( bandindex < bandcovsize )
-                {
-                  bandcov( p, bandindex ) += tempval;
-                }
-                else
-                {
-                  cov( p, q ) += tempval;
-                }
-              }
-            }
-          } // qi
-        }   // pi
-      }     // end if
+        this->UpdatePartialCovariance( partial, prevjacind, jactjac, n );
+      }
 
       /** Initialize jactjac by J_j^T J_j. */
       vnl_fastops::AtA( jactjac, jacj );
 
       /** Remember nonzerojacobian indices. */
       prevjacind = jacind;
-    } // end else
+      runStarted = true;
+    }
+  } // end iter loop
 
-  } // end iter loop: end computation of covariance matrix
+  /** Update the partial covariance with the last run. */
+  if( runStarted )
+  {
+    this->UpdatePartialCovariance( partial, prevjacind, jactjac, n );
+  }
+
+} // end ThreadedComputeCovariance()
+
+
+/**
+ * ************************* UpdatePartialCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::UpdatePartialCovariance( ComputePerThreadStruct & partial,
+  const NonZeroJacobianIndicesType & jacind,
+  const CovarianceMatrixType & jactjac, const double n ) const
+{
+  const unsigned int sizejacind  = jacind.size();
+  const unsigned int bandcovsize = this->m_BandCovSize;
 
-  /** Update covariance matrix once again to include last jactjac updates
-   * \todo: a bit ugly that this loop is copied from above.
-   */
   for( unsigned int pi = 0; pi < sizejacind; ++pi )
   {
-    const unsigned int p = prevjacind[ pi ];
+    const unsigned int p = jacind[ pi ];
     for( unsigned int qi = 0; qi < sizejacind; ++qi )
     {
-      const unsigned int q = prevjacind[ qi ];
+      const unsigned int q = jacind[ qi ];
       if( q >= p )
       {
         const double tempval = jactjac( pi, qi ) / n;
         if( std::abs( tempval ) > 1e-14 )
         {
-          const unsigned int bandindex = bandcovMap[ q - p ];
+          const unsigned int bandindex = this->m_BandCovMap[ q - p ];
           if( bandindex < bandcovsize )
           {
-            bandcov( p, bandindex ) += tempval;
+            /** Allocate the band row of p, when it is touched the first time. */
+            int & bandrow = partial.st_BandRowMap[ p ];
+            if( bandrow < 0 )
+            {
+              bandrow = static_cast< int >( partial.st_BandCov.size() / bandcovsize );
+              partial.st_BandCov.resize( partial.st_BandCov.size() + bandcovsize, 0.0 );
+            }
+            partial.st_BandCov[ bandrow * bandcovsize + bandindex ] += tempval;
           }
           else
           {
-            cov( p, q ) += tempval;
+            partial.st_Cov( p, q ) += tempval;
           }
         }
       }
     } // qi
   }   // pi
 
-  /** Copy the bandmatrix into the sparse matrix and empty the bandcov matrix.
-   * \todo: perhaps work further with this bandmatrix instead.
+} // end UpdatePartialCovariance()
+
+
+/**
+ * ************************* ThreadedAccumulateCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedAccumulateCovariance( ThreadIdType threadId )
+{
+  /** Get the rows of this thread. Different threads write to different rows
+   * of the covariance matrix, which is safe for the sparse matrix.
    */
-  for( unsigned int p = 0; p < P; ++p )
+  const unsigned int P = static_cast< unsigned int >( this->m_Cov.rows() );
+  SizeValueType      rowBegin = 0;
+  SizeValueType      rowEnd   = 0;
+  this->GetRangeForThread( P, threadId, rowBegin, rowEnd );
+
+  const ThreadIdType numberOfThreads = this->m_ComputePerThreadVariables.size();
+  const unsigned int bandcovsize     = this->m_BandCovSize;
+
+  for( unsigned int p = rowBegin; p < rowEnd; ++p )
   {
-    for( unsigned int b = 0; b < bandcovsize; ++b )
+    /** Sum the sparse part of the partial covariances, in thread order. */
+    for( ThreadIdType i = 0; i < numberOfThreads; ++i )
     {
-      const double tempval = bandcov( p, b );
-      if( std::abs( tempval ) > 1e-14 )
+      SparseCovarianceMatrixType & partialCov = this->m_ComputePerThreadVariables[ i ].st_Cov;
+      if( !partialCov.empty_row( p ) )
       {
-        const unsigned int q = p + bandcovMap2[ b ];
-        cov( p, q ) = tempval;
+        SparseRowType & covrowp = partialCov.get_row( p );
+        typename SparseRowType::iterator covrowpit;
+        for( covrowpit = covrowp.begin(); covrowpit != covrowp.end(); ++covrowpit )
+        {
+          this->m_Cov( p, ( *covrowpit ).first ) += ( *covrowpit ).second;
+        }
       }
     }
-  }
-  bandcov.set_size( 0, 0 );
 
-  /** Apply scales. the use of m_Scales maybe something wrong. */
-  if( this->m_UseScales )
-  {
-    for( unsigned int p = 0; p < P; ++p )
-    {
-      cov.scale_row( p, 1.0 / this->m_Scales[ p ] );
-    }
-    /**  \todo: this might be faster with get_row instead of the iterator */
-    cov.reset();
-    bool notfinished = cov.next();
-    while( notfinished )
+    /** Copy the summed bands into the sparse matrix. */
+    for( unsigned int b = 0; b < bandcovsize; ++b )
     {
-      const int col = cov.getcolumn();
-      cov( cov.getrow(), col ) /= scales[ col ];
-      notfinished               = cov.next();
+      double tempval = 0.0;
+      for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+      {
+        const ComputePerThreadStruct & partial = this->m_ComputePerThreadVariables[ i ];
+        const int                      bandrow = partial.st_BandRowMap[ p ];
+        if( bandrow >= 0 )
+        {
+          tempval += partial.st_BandCov[ bandrow * bandcovsize + b ];
+        }
+      }
+      if( std::abs( tempval ) > 1e-14 )
+      {
+        const unsigned int q = p + this->m_BandCovMap2[ b ];
+        this->m_Cov( p, q ) = tempval;
+      }
     }
-  }
+  } // end p loop
 
-  /** Compute TrC = trace(C), and diagcov. */
-  for( unsigned int p = 0; p < P; ++p )
-  {
-    if( !cov.empty_row( p ) )
-    {
-      //avoid creation of element if the row is empty
-      CovarianceValueType & covpp = cov( p, p );
-      TrC         += covpp;
-      diagcov[ p ] = covpp;
-    }
-  }
+} // end ThreadedAccumulateCovariance()
 
-  /**
-   *    TERM 2
-   *
-   * Compute TrCC = ||C||_F^2.
-   */
-  cov.reset();
-  bool notfinished2 = cov.next();
-  while( notfinished2 )
-  {
-    TrCC        += vnl_math::sqr( cov.value() );
-    notfinished2 = cov.next();
-  }
 
-  /** Symmetry: multiply by 2 and subtract sumsqr(diagcov). */
-  TrCC *= 2.0;
-  TrCC -= diagcov.diagonal().squared_magnitude();
+/**
+ * ************************* ThreadedComputeMaximumTerms ************************
+ */
 
-  /**
-   *    TERM 3 and 4
-   *
-   * Compute maxJJ and maxJCJ
-   * \li maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} || J_j J_j^T ||_F ]
-   * \li maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} || J_j C J_j^T ||_F ]
-   */
-  maxJJ  = 0.0;
-  maxJCJ = 0.0;
-  const double sqrt2 = std::sqrt( static_cast< double >( 2.0 ) );
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeMaximumTerms( ThreadIdType threadId )
+{
+  typedef itk::Array< SizeValueType > NonZeroJacobianIndicesExpandedType;
+
+  /** Get the samples of this thread. */
+  SizeValueType sampleBegin = 0;
+  SizeValueType sampleEnd   = 0;
+  this->GetRangeForThread( this->m_SampleContainer->Size(), threadId, sampleBegin, sampleEnd );
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator iter;
+  typename ImageSampleContainerType::ConstIterator begin = this->m_SampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator end   = this->m_SampleContainer->Begin();
+  begin += static_cast< int >( sampleBegin );
+  end   += static_cast< int >( sampleEnd );
+
+  /** Get the number of parameters and the scales. */
+  const unsigned int P = static_cast< unsigned int >(
+    this->m_Transform->GetNumberOfParameters() );
+  const ScalesType & scales = this->m_Scales;
+
+  /** The covariance matrix is only read below. */
+  SparseCovarianceMatrixType &     cov     = this->m_Cov;
+  const DiagCovarianceMatrixType & diagcov = this->m_DiagCov;
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
+
+  double       maxJJ  = 0.0;
+  double       maxJCJ = 0.0;
+  const double sqrt2  = std::sqrt( static_cast< double >( 2.0 ) );
 
   JacobianType                       jacjjacj( outdim, outdim );
   JacobianType                       jacjcov( outdim, sizejacind );
@@ -402,7 +659,6 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   JacobianType                       jacjcovjacj( outdim, outdim );
   NonZeroJacobianIndicesExpandedType jacindExpanded( P );
 
-  samplenr = 0;
   for( iter = begin; iter != end; ++iter )
   {
     /** Read fixed coordinates and get Jacobian. */
@@ -502,16 +758,13 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     /** Max_j [JCJ_j]. */
     maxJCJ = std::max( maxJCJ, JCJ_j );
 
-    /** Show progress 50-100%. */
-    //progressObserver->UpdateAndPrintProgress( samplenr + nrofsamples );
-    ++samplenr;
-
   } // end loop over sample container
 
-  /** Finalize progress information. */
-  //progressObserver->PrintProgress( 1.0 );
+  /** Store the maximum terms of this thread. */
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJJ  = maxJJ;
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJCJ = maxJCJ;
 
-} // end Compute()
+} // end ThreadedComputeMaximumTerms()
 
 
 /**
@@ -20,6 +20,8 @@
 
 #include "itkComputeDisplacementDistribution.h"
 
+#include <vector>
+
 
 namespace itk
 {
@@ -34,6 +36,16 @@ namespace itk
  * Fast Automatic Step Size Estimation for Gradient Descent Optimization of Image Registration
  * IEEE Transactions on Medical Imaging, vol. 35, no. 2, pp. 391 - 403, February 2016
  * http://dx.doi.org/10.1109/TMI.2015.2476354
+ *
+ * The Jacobians are measured multi-threaded. Each thread accumulates the
+ * contributions of its part of the samples only for the parameters that it
+ * touches, after which the contributions are summed per parameter, in parallel
+ * over the parameters and in a fixed thread order. The computation can also be
+ * done incrementally: InitializePreconditioner() samples the fixed image and
+ * computes the gradient, AccumulatePreconditioner() processes a part of the
+ * samples, and FinalizePreconditioner() converts the sums to the preconditioner.
+ * This way an optimizer can spread a refresh of the preconditioner over several
+ * iterations.
  */
 
 template< class TFixedImage, class TTransform >
@@ -116,6 +128,37 @@ public:
   /** Interpolate the preconditioner, for the non-visited entries. */
   virtual void PreconditionerInterpolation( ParametersType & preconditioner );
 
+  /** Start an incremental computation of the preconditioner at position mu.
+   * Samples the fixed image and, unless the Jacobi type preconditioner is
+   * computed, the exact gradient at mu.
+   */
+  virtual void InitializePreconditioner( const ParametersType & mu,
+    const bool useJacobiType );
+
+  /** Process the next numberOfSamples samples, multi-threaded. */
+  virtual void AccumulatePreconditioner( const SizeValueType numberOfSamples );
+
+  /** Convert the accumulated sums to the preconditioner, and release the
+   * memory of the incremental computation.
+   */
+  virtual void FinalizePreconditioner( double & maxJJ, ParametersType & preconditioner );
+
+  /** Get the number of samples of the incremental computation, and the
+   * number of those that still need to be processed.
+   */
+  SizeValueType GetNumberOfPreconditionerSamples( void ) const
+  {
+    return this->m_SampleContainer.IsNotNull() ? this->m_SampleContainer->Size() : 0;
+  }
+
+
+  SizeValueType GetNumberOfRemainingPreconditionerSamples( void ) const
+  {
+    return this->GetNumberOfPreconditionerSamples() - this->m_NumberOfProcessedSamples;
+  }
+
+
+
 protected:
 
   ComputePreconditionerUsingDisplacementDistribution();
@@ -139,10 +182,76 @@ protected:
   typedef typename Superclass::CoordinateRepresentationType  CoordinateRepresentationType;
   typedef typename Superclass::NumberOfParametersType        NumberOfParametersType;
 
+  /** Typedefs for multi-threading. */
+  typedef itk::PlatformMultiThreader ThreaderType;
+  typedef ThreaderType::WorkUnitInfo ThreadInfoType;
+
   double m_MaximumStepLength;
   double m_RegularizationKappa;
   double m_ConditionNumber;
 
+  /** Divide [0, size) over the threads, and return the part [begin, end) of a thread. */
+  void GetRangeForThread( const SizeValueType size, const ThreadIdType threadId,
+    SizeValueType & begin, SizeValueType & end ) const;
+
+  /** Launch the threads on one of the callbacks below. */
+  void LaunchPreconditionerThreaderCallback( ThreaderType::ThreadFunctionType callback ) const;
+
+  /** Threader callback functions. */
+  static ITK_THREAD_RETURN_TYPE AccumulatePreconditionerThreaderCallback( void * arg );
+  static ITK_THREAD_RETURN_TYPE ReducePreconditionerThreaderCallback( void * arg );
+
+  /** Accumulate the contributions of the samples of this thread. */
+  virtual void ThreadedAccumulatePreconditioner( ThreadIdType threadId );
+
+  /** Sum the contributions of all threads, for a range of parameters. */
+  virtual void ThreadedReducePreconditioner( ThreadIdType threadId );
+
+  /** To give the threads access to all member variables and functions. */
+  struct PreconditionerThreaderParameterType
+  {
+    Self * st_Self;
+  };
+  mutable PreconditionerThreaderParameterType m_PreconditionerThreaderParameters;
+
+  /** The contributions of a thread, for the parameters it touches only:
+   * st_ParameterMap maps a parameter to its three sums in st_Sums, or -1.
+   * The sums are the displacement, the squared displacement and the weight.
+   */
+  struct PreconditionerPerThreadStruct
+  {
+    std::vector< int >    st_ParameterMap;
+    std::vector< double > st_Sums;
+    double                st_MaxJJ;
+  };
+  std::vector< PreconditionerPerThreadStruct > m_PreconditionerPerThreadVariables;
+
+  /** Get the three sums of parameter p in the contributions of a thread. */
+  double * GetThreadSums( PreconditionerPerThreadStruct & partial, const unsigned int p ) const
+  {
+    int & index = partial.st_ParameterMap[ p ];
+    if( index < 0 )
+    {
+      index = static_cast< int >( partial.st_Sums.size() );
+      partial.st_Sums.resize( partial.st_Sums.size() + 3, 0.0 );
+    }
+    return &partial.st_Sums[ index ];
+  }
+
+
+  /** Variables of the incremental computation. */
+  bool                  m_UseJacobiType;
+  bool                  m_TransformIsBSpline;
+  SizeValueType         m_NumberOfProcessedSamples;
+  SizeValueType         m_AccumulateBegin;
+  SizeValueType         m_AccumulateEnd;
+  std::vector< double > m_DisplacementSum;
+  std::vector< double > m_DisplacementSquaredSum;
+  std::vector< double > m_WeightSum;
+  double                m_MaxJJ;
+  double                m_MinEigenvalue;
+  double                m_MaxEigenvalue;
+
 private:
 
   ComputePreconditionerUsingDisplacementDistribution( const Self & ); // purposely not implemented
@@ -45,6 +45,19 @@ ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
   this->m_RegularizationKappa = 0.8;
   this->m_MaximumStepLength   = 1.0;
   this->m_ConditionNumber     = 2.0;
+
+  this->m_UseJacobiType            = false;
+  this->m_TransformIsBSpline       = false;
+  this->m_NumberOfProcessedSamples = 0;
+  this->m_AccumulateBegin          = 0;
+  this->m_AccumulateEnd            = 0;
+  this->m_MaxJJ                    = 0.0;
+  this->m_MinEigenvalue            = 0.0;
+  this->m_MaxEigenvalue            = 0.0;
+
+  /** Initialize the m_PreconditionerThreaderParameters. */
+  this->m_PreconditionerThreaderParameters.st_Self = this;
+
 } // end Constructor
 
 
@@ -340,57 +353,362 @@ ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
 ::Compute( const ParametersType & mu,
   double & maxJJ, ParametersType & preconditioner )
 {
-  /** Initialize. */
-  maxJJ = 0.0;
+  /** Process all samples at once. */
+  this->InitializePreconditioner( mu, false );
+  this->AccumulatePreconditioner( this->GetNumberOfPreconditionerSamples() );
+  this->FinalizePreconditioner( maxJJ, preconditioner );
+
+#if 1
+  elxout << std::scientific;
+  elxout << "The max eigen value is: [ ";
+  elxout << this->m_MaxEigenvalue << " ";
+  elxout << "]" << std::endl;
+  elxout << "The min eigen value is: [ ";
+  elxout << this->m_MinEigenvalue << " ";
+  elxout << "]" << std::endl;
+  elxout << "The condition number before constraints is: [ ";
+  elxout << this->m_MaxEigenvalue / this->m_MinEigenvalue << " ";
+  elxout << "]" << std::endl;
+  elxout << std::fixed;
+#endif
+
+} // end Compute()
+
+
+/**
+ * ************************* ComputeJacobiTypePreconditioner ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::ComputeJacobiTypePreconditioner( const ParametersType & mu,
+  double & maxJJ, ParametersType & preconditioner )
+{
+  /** Process all samples at once. */
+  this->InitializePreconditioner( mu, true );
+  this->AccumulatePreconditioner( this->GetNumberOfPreconditionerSamples() );
+  this->FinalizePreconditioner( maxJJ, preconditioner );
 
+} // end ComputeJacobiTypePreconditioner()
+
+
+/**
+ * ************************* InitializePreconditioner ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::InitializePreconditioner( const ParametersType & mu, const bool useJacobiType )
+{
   /** Get the number of parameters. */
   const unsigned int P = static_cast< unsigned int >(
     this->m_Transform->GetNumberOfParameters() );
+  this->m_NumberOfParameters = P;
+  this->m_UseJacobiType      = useJacobiType;
 
   // Replace by a general check later.
-  bool transformIsBSpline = false;
-  if( P > 13 ) transformIsBSpline = true; // assume B-spline
+  this->m_TransformIsBSpline = P > 13; // assume B-spline
 
   /** Get the exact gradient. Uses a random coordinate sampler with
    * NumberOfSamplesForPrecondition samples, which equals P.
    */
-  DerivativeType exactgradient( P );
-  this->GetScaledDerivative( mu, exactgradient );
+  if( !useJacobiType )
+  {
+    this->m_ExactGradient = DerivativeType( P );
+    this->m_ExactGradient.Fill( 0.0 );
+    this->GetScaledDerivative( mu, this->m_ExactGradient );
+  }
 
   /** Get samples. Uses a grid sampler with m_NumberOfJacobianMeasurements samples. */
-  ImageSampleContainerPointer sampleContainer;
-  this->SampleFixedImageForJacobianTerms( sampleContainer );
-  const SizeValueType nrofsamples = sampleContainer->Size();
+  this->m_SampleContainer = nullptr;
+  this->SampleFixedImageForJacobianTerms( this->m_SampleContainer );
+  this->m_NumberOfProcessedSamples = 0;
+
+  /** Initialize the sums and the contributions of the threads. */
+  this->m_DisplacementSum.assign( P, 0.0 );
+  this->m_DisplacementSquaredSum.assign( P, 0.0 );
+  this->m_WeightSum.assign( P, 0.0 );
+  this->m_MaxJJ = 0.0;
+
+  const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  this->m_PreconditionerPerThreadVariables.clear();
+  this->m_PreconditionerPerThreadVariables.resize( numberOfThreads );
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    PreconditionerPerThreadStruct & partial = this->m_PreconditionerPerThreadVariables[ i ];
+    partial.st_ParameterMap.assign( P, -1 );
+    partial.st_MaxJJ = 0.0;
+  }
 
-  /** Get transform and set current position. */
-  typename TransformType::Pointer transform = this->m_Transform;
-  const unsigned int outdim = this->m_Transform->GetOutputSpaceDimension();
+} // end InitializePreconditioner()
 
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator iter;
-  typename ImageSampleContainerType::ConstIterator begin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator end   = sampleContainer->End();
+
+/**
+ * ************************* AccumulatePreconditioner ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::AccumulatePreconditioner( const SizeValueType numberOfSamples )
+{
+  /** Select the next samples. */
+  this->m_AccumulateBegin = this->m_NumberOfProcessedSamples;
+  this->m_AccumulateEnd   = this->m_AccumulateBegin + std::min(
+    numberOfSamples, this->GetNumberOfRemainingPreconditionerSamples() );
+  if( this->m_AccumulateEnd == this->m_AccumulateBegin )
+  {
+    return;
+  }
+
+  /** Accumulate per thread, and sum the contributions of the threads. */
+  this->LaunchPreconditionerThreaderCallback( Self::AccumulatePreconditionerThreaderCallback );
+  this->LaunchPreconditionerThreaderCallback( Self::ReducePreconditionerThreaderCallback );
+
+  const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  for( ThreadIdType i = 0; i < numberOfThreads; ++i )
+  {
+    PreconditionerPerThreadStruct & partial = this->m_PreconditionerPerThreadVariables[ i ];
+    this->m_MaxJJ = std::max( this->m_MaxJJ, partial.st_MaxJJ );
+    partial.st_Sums.clear();
+  }
+
+  this->m_NumberOfProcessedSamples = this->m_AccumulateEnd;
+
+} // end AccumulatePreconditioner()
+
+
+/**
+ * ************************* FinalizePreconditioner ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::FinalizePreconditioner( double & maxJJ, ParametersType & preconditioner )
+{
+  const unsigned int P = static_cast< unsigned int >( this->m_DisplacementSum.size() );
+  if( preconditioner.GetSize() != P )
+  {
+    preconditioner.SetSize( P );
+  }
+  maxJJ = this->m_MaxJJ;
+
+  double maxEigenvalue = -1e+9;
+  double minEigenvalue = 1e+9;
+  if( this->m_UseJacobiType )
+  {
+    for( unsigned int i = 0; i < P; ++i )
+    {
+      preconditioner[ i ] = this->m_DisplacementSum[ i ];
+      const double nonZeroBin = this->m_WeightSum[ i ] / this->m_Transform->GetOutputSpaceDimension();
+      if( nonZeroBin > 0 && preconditioner[ i ] > 1e-9 )
+      {
+        double eigenvalue = std::sqrt( preconditioner[ i ] / ( nonZeroBin ) ) + 1e-14;
+        maxEigenvalue = std::max( eigenvalue, maxEigenvalue );
+        minEigenvalue = std::min( eigenvalue, minEigenvalue );
+        preconditioner[ i ] = 1.0 / eigenvalue;
+      }
+    }
+
+    /** Condition number check. */
+    double conditionNumber = maxEigenvalue / minEigenvalue;
+    this->m_MaxEigenvalue = maxEigenvalue;
+    this->m_MinEigenvalue = minEigenvalue;
+
+    if( this->m_TransformIsBSpline && conditionNumber > this->m_ConditionNumber )
+    {
+      minEigenvalue = maxEigenvalue / this->m_ConditionNumber;
+      for( unsigned int i = 0; i < P; ++i )
+      {
+        if( preconditioner[ i ] > 1.0 / minEigenvalue )
+        {
+          preconditioner[ i ] = 1.0 / minEigenvalue;
+        }
+      }
+    }
+  }
+  else
+  {
+    /** Compute the mean local step sizes and apply the 2 sigma rule. */
+    for( unsigned int i = 0; i < P; ++i )
+    {
+      /** Mean deformation magnitude. */
+      double nonZeroBin = this->m_WeightSum[ i ];
+
+      const double meanLocalStepSize = this->m_DisplacementSum[ i ] / ( nonZeroBin + 1e-14 );
+      double sigma = this->m_DisplacementSquaredSum[ i ] / ( nonZeroBin + 1e-14 ) - meanLocalStepSize * meanLocalStepSize;
+
+      /** Due to numerical issues, in case of very small squared sums and means,
+       * the standard deviation may become negative. This happens for example in
+       * case of an affine transformation for the translational parameters.
+       */
+      if( sigma < 1e-14 ) sigma = 0;
+
+      /** Apply the 2 sigma rule. */
+      double localStep = meanLocalStepSize + 2.0 * std::sqrt( sigma ) + 1e-14;
+
+      minEigenvalue = std::min( localStep, minEigenvalue );
+      maxEigenvalue = std::max( localStep, maxEigenvalue );
+      preconditioner[ i ] = this->m_MaximumStepLength / localStep;
+
+    } // end loop over step size vector
+
+    /** Constrained the condition number into a given range, here we first try kappa = 2. */
+    double conditionNumber = maxEigenvalue / minEigenvalue;
+    this->m_MaxEigenvalue = maxEigenvalue;
+    this->m_MinEigenvalue = minEigenvalue;
+
+    if( this->m_TransformIsBSpline && conditionNumber > this->m_ConditionNumber )
+    {
+      minEigenvalue = maxEigenvalue / this->m_ConditionNumber;
+      for( unsigned int i = 0; i < P; ++i )
+      {
+        if( preconditioner[ i ] > this->m_MaximumStepLength / minEigenvalue )
+        {
+          preconditioner[ i ] = this->m_MaximumStepLength / minEigenvalue;
+        }
+      }
+    } // end condition number check.
+  }
+
+  /** Release the memory of the incremental computation. */
+  std::vector< double >().swap( this->m_DisplacementSum );
+  std::vector< double >().swap( this->m_DisplacementSquaredSum );
+  std::vector< double >().swap( this->m_WeightSum );
+  this->m_PreconditionerPerThreadVariables.clear();
+  this->m_SampleContainer          = nullptr;
+  this->m_NumberOfProcessedSamples = 0;
+
+} // end FinalizePreconditioner()
+
+
+/**
+ * ************************* GetRangeForThread ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::GetRangeForThread( const SizeValueType size, const ThreadIdType threadId,
+  SizeValueType & begin, SizeValueType & end ) const
+{
+  const ThreadIdType  numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  const SizeValueType chunkSize
+    = static_cast< SizeValueType >( std::ceil( static_cast< double >( size )
+    / static_cast< double >( numberOfThreads ) ) );
+
+  begin = std::min( size, threadId * chunkSize );
+  end   = std::min( size, ( threadId + 1 ) * chunkSize );
+
+} // end GetRangeForThread()
+
+
+/**
+ * *********************** LaunchPreconditionerThreaderCallback ***************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::LaunchPreconditionerThreaderCallback( ThreaderType::ThreadFunctionType callback ) const
+{
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod( callback,
+    const_cast< void * >( static_cast< const void * >( &this->m_PreconditionerThreaderParameters ) ) );
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchPreconditionerThreaderCallback()
+
+
+/**
+ * ************ AccumulatePreconditionerThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::AccumulatePreconditionerThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *                      infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                          threadID   = infoStruct->WorkUnitID;
+  PreconditionerThreaderParameterType * temp
+    = static_cast< PreconditionerThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedAccumulatePreconditioner( threadID );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end AccumulatePreconditionerThreaderCallback()
+
+
+/**
+ * ************ ReducePreconditionerThreaderCallback ****************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::ReducePreconditionerThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *                      infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                          threadID   = infoStruct->WorkUnitID;
+  PreconditionerThreaderParameterType * temp
+    = static_cast< PreconditionerThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  temp->st_Self->ThreadedReducePreconditioner( threadID );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ReducePreconditionerThreaderCallback()
+
+
+/**
+ * ************************* ThreadedAccumulatePreconditioner ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
+::ThreadedAccumulatePreconditioner( ThreadIdType threadId )
+{
+  PreconditionerPerThreadStruct & partial = this->m_PreconditionerPerThreadVariables[ threadId ];
+  partial.st_MaxJJ = 0.0;
+
+  /** Get the samples of this thread. */
+  SizeValueType begin = 0;
+  SizeValueType end   = 0;
+  this->GetRangeForThread( this->m_AccumulateEnd - this->m_AccumulateBegin, threadId, begin, end );
+  begin += this->m_AccumulateBegin;
+  end   += this->m_AccumulateBegin;
 
   /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int  outdim     = this->m_Transform->GetOutputSpaceDimension();
   const SizeValueType sizejacind = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
   JacobianType jacj( outdim, sizejacind );
   jacj.Fill( 0.0 );
   NonZeroJacobianIndicesType jacind( sizejacind );
 
-  /** Declare temporary variables. Not needed for all methods. check later */
+  /** Declare temporary variables. Not needed for all methods. */
   DerivativeType jacj_g( outdim );
   jacj_g.Fill( 0.0 );
-  JacobianType          jacjjacj( outdim, outdim );
-  const double          sqrt2 = std::sqrt( static_cast< double >( 2.0 ) );
-  std::vector< double > localStepSizeSquared( P, 0.0 );
-  ParametersType binCount( P );
-  binCount.Fill( 0.0 );
+  JacobianType         jacjjacj( outdim, outdim );
+  const double         sqrt2 = std::sqrt( static_cast< double >( 2.0 ) );
+  const DerivativeType & exactgradient = this->m_ExactGradient;
 
-  /** Loop over all voxels in the sample container. */
-  for( iter = begin; iter != end; ++iter )
+  /** Loop over the samples of this thread. */
+  for( SizeValueType s = begin; s < end; ++s )
   {
     /** Read fixed coordinates and get Jacobian. */
-    const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
+    const FixedImagePointType & point = this->m_SampleContainer->GetElement( s ).m_ImageCoordinates;
     this->m_Transform->GetJacobian( point, jacj, jacind );
 
     /** Compute 1st part of JJ: ||J_j||_F^2. */
@@ -401,10 +719,25 @@ ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
     JJ_j += 2.0 * sqrt2 * jacjjacj.frobenius_norm();
 
     /** Max_j [JJ_j]. */
-    maxJJ = std::max( maxJJ, JJ_j );
+    partial.st_MaxJJ = std::max( partial.st_MaxJJ, JJ_j );
+
+    /** The Jacobi type preconditioner only needs the squared Jacobian. */
+    if( this->m_UseJacobiType )
+    {
+      for( unsigned int i = 0; i < outdim; ++i )
+      {
+        for( unsigned int j = 0; j < sizejacind; ++j )
+        {
+          double * sums = this->GetThreadSums( partial, jacind[ j ] );
+          sums[ 0 ] += vnl_math::sqr( jacj( i, j ) );
+          sums[ 2 ] += 1.0;
+        }
+      }
+      continue;
+    }
 
     double displacement2_j = 0.0;
-    if( transformIsBSpline )
+    if( this->m_TransformIsBSpline )
     {
       for( unsigned int i = 0; i < outdim; ++i )
       {
@@ -433,7 +766,7 @@ ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
       }
       displacement_j = std::abs( jacj_current * exactgradient( pj ) );
 
-      if( transformIsBSpline )
+      if( this->m_TransformIsBSpline )
       {
         displacement_j = displacement_j * this->m_RegularizationKappa
           + ( 1.0 - this->m_RegularizationKappa ) * displacement2_j;
@@ -512,195 +845,55 @@ ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
         }
       } // end else for affine and rigid
 
-      /** Compute the displacement due to a change in this parameter. */
-      /** localStepSize keeps track of the mean displacement.
-        * localStepSizeSquared keeps track of the standard deviation.
-        */
-      preconditioner[ pj ] += displacement_j;
-      localStepSizeSquared[ pj ] += displacement_j * displacement_j;
-      binCount[ pj ] += 1.0;
+      /** Compute the displacement due to a change in this parameter.
+       * The sums keep track of the mean displacement and the standard deviation.
+       */
+      double * sums = this->GetThreadSums( partial, pj );
+      sums[ 0 ] += displacement_j;
+      sums[ 1 ] += displacement_j * displacement_j;
+      sums[ 2 ] += 1.0;
     }
   } // end loop over sample container
 
-
-  /** Compute the mean local step sizes and apply the 2 sigma rule. */
-  double maxEigenvalue = -1e+9;
-  double minEigenvalue = 1e+9;
-  for( unsigned int i = 0; i < P; ++i )
-  {
-    /** Mean deformation magnitude. */
-    double nonZeroBin = binCount[ i ];
-
-    const double meanLocalStepSize = preconditioner[ i ] / ( nonZeroBin + 1e-14 );
-    double sigma = localStepSizeSquared[ i ] / ( nonZeroBin + 1e-14 ) - meanLocalStepSize * meanLocalStepSize;
-
-    /** Due to numerical issues, in case of very small squared sums and means,
-     * the standard deviation may become negative. This happens for example in
-     * case of an affine transformation for the translational parameters.
-     */
-    if( sigma < 1e-14 ) sigma = 0;
-
-    /** Apply the 2 sigma rule. */
-    double localStep = meanLocalStepSize + 2.0 * std::sqrt( sigma ) + 1e-14;
-
-    minEigenvalue = std::min( localStep, minEigenvalue );
-    maxEigenvalue = std::max( localStep, maxEigenvalue );
-    preconditioner[ i ] = this->m_MaximumStepLength / localStep;
-
-  } // end loop over step size vector
-
-  /** Constrained the condition number into a given range, here we first try kappa = 2. */
-  double conditionNumber = maxEigenvalue / minEigenvalue;
-
-#if 1
-  elxout << std::scientific;
-  elxout << "The max eigen value is: [ ";
-  elxout << maxEigenvalue << " ";
-  elxout << "]" << std::endl;
-  elxout << "The min eigen value is: [ ";
-  elxout << minEigenvalue << " ";
-  elxout << "]" << std::endl;
-  elxout << "The condition number before constraints is: [ ";
-  elxout << conditionNumber << " ";
-  elxout << "]" << std::endl;
-  elxout << std::fixed;
-#endif
-
-  if( transformIsBSpline && conditionNumber > this->m_ConditionNumber )
-  {
-    minEigenvalue = maxEigenvalue / this->m_ConditionNumber;
-    for( unsigned int i = 0; i < P; ++i )
-    {
-      if( preconditioner[ i ] > this->m_MaximumStepLength / minEigenvalue )
-      {
-        preconditioner[ i ] = this->m_MaximumStepLength / minEigenvalue;
-      }
-    }
-  } // end condition number check.
-
-} // end Compute()
+} // end ThreadedAccumulatePreconditioner()
 
 
 /**
- * ************************* ComputeJacobiTypePreconditioner ************************
+ * ************************* ThreadedReducePreconditioner ************************
  */
 
 template< class TFixedImage, class TTransform >
 void
 ComputePreconditionerUsingDisplacementDistribution< TFixedImage, TTransform >
-::ComputeJacobiTypePreconditioner( const ParametersType & mu,
-  double & maxJJ, ParametersType & preconditioner )
+::ThreadedReducePreconditioner( ThreadIdType threadId )
 {
-  /** Initialize. */
-  maxJJ = 0.0;
-
-  /** Get the number of parameters. */
-  const unsigned int P = static_cast< unsigned int >(
-    this->m_Transform->GetNumberOfParameters() );
-
-  // Replace by a general check later.
-  bool transformIsBSpline = false;
-  if( P > 13 ) transformIsBSpline = true; // assume B-spline
-
-  /** Get samples. Uses a grid sampler with m_NumberOfJacobianMeasurements samples. */
-  ImageSampleContainerPointer sampleContainer;
-  this->SampleFixedImageForJacobianTerms( sampleContainer );
-  const SizeValueType nrofsamples = sampleContainer->Size();
-
-  /** Get transform and set current position. */
-  typename TransformType::Pointer transform = this->m_Transform;
-  const unsigned int outdim = this->m_Transform->GetOutputSpaceDimension();
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator iter;
-  typename ImageSampleContainerType::ConstIterator begin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator end = sampleContainer->End();
-
-  /** Variables for nonzerojacobian indices and the Jacobian. */
-  const SizeValueType sizejacind = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
-  JacobianType jacj( outdim, sizejacind );
-  jacj.Fill( 0.0 );
-  JacobianType          jacjjacj( outdim, outdim );
-  const double          sqrt2 = std::sqrt( static_cast< double >( 2.0 ) );
-  NonZeroJacobianIndicesType jacind( sizejacind );
-  ParametersType binCount( P );
-  binCount.Fill( 0.0 );
-
-  /** Loop over all voxels in the sample container. */
-  for( iter = begin; iter != end; ++iter )
-  {
-    /** Read fixed coordinates and get Jacobian. */
-    const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
-    this->m_Transform->GetJacobian( point, jacj, jacind );
-
-    /** Compute 1st part of JJ: ||J_j||_F^2. */
-    double JJ_j = vnl_math::sqr( jacj.frobenius_norm() );
-
-    /** Compute 2nd part of JJ: 2\sqrt{2} || J_j J_j^T ||_F. */
-    vnl_fastops::ABt( jacjjacj, jacj, jacj );
-    JJ_j += 2.0 * sqrt2 * jacjjacj.frobenius_norm();
-
-    /** Max_j [JJ_j]. */
-    maxJJ = std::max( maxJJ, JJ_j );
-
-    for( unsigned int i = 0; i < outdim; ++i )
-    {
-      for( unsigned int j = 0; j < sizejacind; ++j )
-      {
-        const unsigned int pj = jacind[ j ];
-        preconditioner[ pj ] += vnl_math::sqr( jacj( i, j ) );
-        binCount[ pj ] += 1;
-      }
-    }
-  }
-
-  double maxEigenvalue = -1e+9;
-  double minEigenvalue = 1e+9;
-  for( unsigned int i = 0; i < P; ++i )
-  {
-    double nonZeroBin = binCount[ i ] / outdim;
-    if( nonZeroBin > 0 && preconditioner[ i ] > 1e-9 )
-    {
-      double eigenvalue = std::sqrt( preconditioner[ i ] / ( nonZeroBin ) ) + 1e-14;
-      maxEigenvalue = std::max( eigenvalue, maxEigenvalue );
-      minEigenvalue = std::min( eigenvalue, minEigenvalue );
-      preconditioner[ i ] = 1.0 / eigenvalue;
-    }
-  }
-
-#if 0
-  elxout << std::scientific;
-  elxout << "The max eigen value is: [ ";
-  elxout << maxEigenvalue << " ";
-  elxout << "]" << std::endl;
-  elxout << "The min eigen value is: [ ";
-  elxout << minEigenvalue << " ";
-  elxout << "]" << std::endl;
-#endif
-
-  /** Condition number check. */
-  double conditionNumber = maxEigenvalue / minEigenvalue;
+  /** Get the parameters of this thread. */
+  SizeValueType begin = 0;
+  SizeValueType end   = 0;
+  this->GetRangeForThread( this->m_DisplacementSum.size(), threadId, begin, end );
 
-  if( transformIsBSpline && conditionNumber > this->m_ConditionNumber )
+  /** Sum in a fixed thread order, so that the result is reproducible.
+   * Reset the parameter maps for the next samples on the fly.
+   */
+  const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+  for( SizeValueType p = begin; p < end; ++p )
   {
-    minEigenvalue = maxEigenvalue / this->m_ConditionNumber;
-    for( unsigned int i = 0; i < P; ++i )
+    for( ThreadIdType i = 0; i < numberOfThreads; ++i )
     {
-      if( preconditioner[ i ] > 1.0 / minEigenvalue )
+      PreconditionerPerThreadStruct & partial = this->m_PreconditionerPerThreadVariables[ i ];
+      const int index = partial.st_ParameterMap[ p ];
+      if( index < 0 )
       {
-        preconditioner[ i ] = 1.0 / minEigenvalue;
+        continue;
       }
+      this->m_DisplacementSum[ p ]        += partial.st_Sums[ index ];
+      this->m_DisplacementSquaredSum[ p ] += partial.st_Sums[ index + 1 ];
+      this->m_WeightSum[ p ]              += partial.st_Sums[ index + 2 ];
+      partial.st_ParameterMap[ p ]         = -1;
     }
   }
 
-#if 0
-  elxout << std::scientific;
-  elxout << "The condition number after constraints is: [ ";
-  elxout << maxEigenvalue / minEigenvalue << " ";
-  elxout << "]" << std::endl;
-  elxout << std::fixed;
-#endif
-} // end ComputeJacobiTypePreconditioner()
+} // end ThreadedReducePreconditioner()
 
 
 /**
@@ -24,6 +24,7 @@
 #include "itkSize.h"
 #include "itkImageIORegion.h"
 #include "itkCastImageFilter.h"
+#include "itkImageAlgorithm.h"
 
 namespace itk
 {
@@ -35,6 +36,10 @@ namespace itk
  * if necessary. This is useful in some cases, to avoid the use of
  * a itk::CastImageFilter (to save memory for example).
  *
+ * The writer supports streaming (SetNumberOfStreamDivisions), if the
+ * ImageIO does: the input is then updated and written piece by piece, and
+ * only the current piece is cast, so the cast buffer is of the size of a piece.
+ *
  */
 template< class TInputImage >
 class ITKIOImageBase_HIDDEN ImageFileCastWriter : public ImageFileWriter< TInputImage >
@@ -78,41 +83,43 @@ protected:
   /** Does the real work. */
   void GenerateData( void ) override;
 
-  /** Templated function that casts the input image and returns a
+  /** Templated function that casts a region of the input image and returns
    * a pointer to the PixelBuffer. Assumes scalar singlecomponent images
-   * The buffer data is valid until this->m_Caster is destroyed or assigned
-   * a new caster. The ImageIO's PixelType is also adapted by this function */
+   * The buffer data is valid until this->m_ConvertedImage is destroyed or assigned
+   * a new image. The ImageIO's PixelType is also adapted by this function */
   template< class OutputComponentType >
   void * ConvertScalarImage( const DataObject * inputImage,
+    const InputImageRegionType & region,
     const OutputComponentType & itkNotUsed( dummy ) )
   {
     typedef Image< OutputComponentType, InputImageDimension >      DiskImageType;
     typedef typename PixelTraits< InputImagePixelType >::ValueType InputImageComponentType;
     typedef Image< InputImageComponentType, InputImageDimension >  ScalarInputImageType;
-    typedef CastImageFilter< ScalarInputImageType, DiskImageType > CasterType;
 
     /** Reconfigure the imageIO */
     //this->GetImageIO()->SetPixelTypeInfo( typeid(OutputComponentType) );
     this->GetModifiableImageIO()->SetPixelTypeInfo( static_cast< const OutputComponentType * >( 0 ) );
 
-    /** cast the input image */
-    typename CasterType::Pointer caster                    = CasterType::New();
-    this->m_Caster                                         = caster;
-    typename ScalarInputImageType::Pointer localInputImage = ScalarInputImageType::New();
-
-    localInputImage->Graft( static_cast< const ScalarInputImageType * >(inputImage) );
-
-    caster->SetInput( localInputImage );
-    caster->Update();
+    /** Cast only the region that is written, using standard c-style
+     * casts, like the itk::CastImageFilter.
+     */
+    const ScalarInputImageType * scalarInputImage
+      = static_cast< const ScalarInputImageType * >( inputImage );
+    typename DiskImageType::Pointer diskImage = DiskImageType::New();
+    diskImage->CopyInformation( scalarInputImage );
+    diskImage->SetRegions( region );
+    diskImage->Allocate();
+    ImageAlgorithm::Copy( scalarInputImage, diskImage.GetPointer(), region, region );
+    this->m_ConvertedImage = diskImage;
 
     /** return the pixel buffer of the casted image */
-    OutputComponentType * pixelBuffer     = caster->GetOutput()->GetBufferPointer();
+    OutputComponentType * pixelBuffer     = diskImage->GetBufferPointer();
     void *                convertedBuffer = static_cast< void * >( pixelBuffer );
     return convertedBuffer;
   }
 
 
-  ProcessObject::Pointer m_Caster;
+  DataObject::Pointer m_ConvertedImage;
 
 private:
 
@@ -36,7 +36,7 @@ template< class TInputImage >
 ImageFileCastWriter< TInputImage >
 ::ImageFileCastWriter()
 {
-  this->m_Caster              = 0;
+  this->m_ConvertedImage      = 0;
   this->m_OutputComponentType = this->GetDefaultOutputComponentType();
 }
 
@@ -66,7 +66,7 @@ template< class TInputImage >
 ImageFileCastWriter< TInputImage >
 ::~ImageFileCastWriter()
 {
-  this->m_Caster = 0;
+  this->m_ConvertedImage = 0;
 }
 
 
@@ -106,6 +106,12 @@ ImageFileCastWriter< TInputImage >
   /** Get the number of Components */
   unsigned int numberOfComponents = this->GetImageIO()->GetNumberOfComponents();
 
+  /** The region to write. When streaming, this is the current piece. */
+  InputImageRegionType ioRegion;
+  ImageIORegionAdaptor< InputImageDimension >::Convert(
+    this->GetImageIO()->GetIORegion(), ioRegion,
+    input->GetLargestPossibleRegion().GetIndex() );
+
   /** Extract the data as a raw buffer pointer and possibly convert.
    * Converting is only possible if the number of components equals 1 */
   if(
@@ -122,66 +128,78 @@ ImageFileCastWriter< TInputImage >
     if( this->m_OutputComponentType == "char" )
     {
       char dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy );
     }
     else if( this->m_OutputComponentType == "unsigned_char" )
     {
       unsigned char dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy );
     }
     else if( this->m_OutputComponentType == "short" )
     {
       short dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy    );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy    );
     }
     else if( this->m_OutputComponentType == "unsigned_short" )
     {
       unsigned short dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "int" )
     {
       int dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "unsigned_int" )
     {
       unsigned int dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "long" )
     {
       long dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "unsigned_long" )
     {
       unsigned long dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "float" )
     {
       float dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
     else if( this->m_OutputComponentType == "double" )
     {
       double dummy;
-      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, dummy   );
+      convertedDataBuffer = this->ConvertScalarImage( inputAsDataObject, ioRegion, dummy   );
     }
 
     /** Do the writing */
     this->GetModifiableImageIO()->Write( convertedDataBuffer );
-    /** Release the caster's memory */
-    this->m_Caster = 0;
+    /** Release the converted image's memory */
+    this->m_ConvertedImage = 0;
 
   }
-  else
+  else if( input->GetBufferedRegion() == ioRegion )
   {
     /** No casting needed or possible, just write */
     const void * dataPtr = (const void *)input->GetBufferPointer();
     this->GetModifiableImageIO()->Write( dataPtr );
   }
+  else
+  {
+    /** The input has more data than the region to write, so copy that region. */
+    InputImagePointer cacheImage = InputImageType::New();
+    cacheImage->CopyInformation( input );
+    cacheImage->SetBufferedRegion( ioRegion );
+    cacheImage->Allocate();
+    ImageAlgorithm::Copy( input, cacheImage.GetPointer(), ioRegion, ioRegion );
+
+    const void * dataPtr = (const void *)cacheImage->GetBufferPointer();
+    this->GetModifiableImageIO()->Write( dataPtr );
+  }
 
 }
 
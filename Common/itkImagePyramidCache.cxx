@@ -0,0 +1,99 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImagePyramidCache_cxx
+#define __itkImagePyramidCache_cxx
+
+#include "itkImagePyramidCache.h"
+
+namespace itk
+{
+
+/**
+ * **************** GetPyramidImages ***************
+ */
+
+ImagePyramidCache::PyramidImagesType
+ImagePyramidCache
+::GetPyramidImages( const std::string & key, const ComputeFunctionType & compute )
+{
+  /** Find or create the entry of the key. */
+  std::shared_ptr< EntryType > entry;
+  {
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    std::shared_ptr< EntryType > & found = this->m_Entries[ key ];
+    if( !found )
+    {
+      found = std::make_shared< EntryType >();
+    }
+    entry = found;
+  }
+
+  /** Compute the images, unless another thread did so already. Only the
+   * entry is locked, so that other keys can be computed at the same time.
+   */
+  std::lock_guard< std::mutex > lock( entry->m_Mutex );
+  if( entry->m_Images.empty() )
+  {
+    entry->m_Images = compute();
+  }
+
+  return entry->m_Images;
+
+} // end GetPyramidImages()
+
+
+/**
+ * **************** GetNumberOfEntries ***************
+ */
+
+std::size_t
+ImagePyramidCache
+::GetNumberOfEntries( void ) const
+{
+  std::lock_guard< std::mutex > lock( this->m_Mutex );
+
+  std::size_t numberOfEntries = 0;
+  for( EntryMapType::const_iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+  {
+    std::lock_guard< std::mutex > entryLock( it->second->m_Mutex );
+    numberOfEntries += !it->second->m_Images.empty();
+  }
+
+  return numberOfEntries;
+
+} // end GetNumberOfEntries()
+
+
+/**
+ * **************** PrintSelf ***************
+ */
+
+void
+ImagePyramidCache
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  this->Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfEntries: " << this->GetNumberOfEntries() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end __itkImagePyramidCache_cxx
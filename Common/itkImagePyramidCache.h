@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImagePyramidCache_h
+#define __itkImagePyramidCache_h
+
+#include "itkDataObject.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMacro.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ImagePyramidCache
+ *
+ * \brief A thread-safe in-memory cache for the images of a multi-resolution pyramid.
+ *
+ * When many moving images are registered to the same fixed image with the
+ * same parameter map, the fixed image pyramids of all registrations are
+ * equal. With this cache they are computed only once: the first registration
+ * that needs the images of a key computes them, while registrations that need
+ * them at the same time wait for it. All registrations then share the images,
+ * which must be treated as read-only.
+ *
+ * The key should identify everything the pyramid depends on, apart from the
+ * shared input image, for example the elastix level and the component label.
+ * The images stay in memory until the cache is destroyed.
+ *
+ * Here is an example on how to use this class:\n
+ *
+ * itk::ImagePyramidCache::PyramidImagesType images = cache->GetPyramidImages( key,
+ *   [ & ]() { ... compute and return the images ... } );
+ */
+
+class ImagePyramidCache : public Object
+{
+public:
+
+  /** Standard ITK typedefs. */
+  typedef ImagePyramidCache          Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImagePyramidCache, Object );
+
+  /** Typedefs. */
+  typedef std::vector< DataObject::Pointer >    PyramidImagesType;
+  typedef std::function< PyramidImagesType() > ComputeFunctionType;
+
+  /** Get the images of key. If they are not in the cache yet, they are
+   * computed by calling compute(), and stored. Only one thread computes
+   * the images of a key; other threads that ask for the same key wait for
+   * it. If compute() throws, nothing is stored, and the exception is passed on.
+   */
+  PyramidImagesType GetPyramidImages( const std::string & key,
+    const ComputeFunctionType & compute );
+
+  /** Get the number of keys for which images are stored. */
+  std::size_t GetNumberOfEntries( void ) const;
+
+protected:
+
+  ImagePyramidCache() {}
+  ~ImagePyramidCache() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  ImagePyramidCache( const Self & ); // purposely not implemented
+  void operator=( const Self & );    // purposely not implemented
+
+  struct EntryType
+  {
+    std::mutex        m_Mutex;
+    PyramidImagesType m_Images;
+  };
+  typedef std::map< std::string, std::shared_ptr< EntryType > > EntryMapType;
+
+  mutable std::mutex m_Mutex;
+  EntryMapType       m_Entries;
+
+};
+
+} // end namespace itk
+
+#endif // end __itkImagePyramidCache_h
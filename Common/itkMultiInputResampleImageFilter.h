@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiInputResampleImageFilter_h
+#define __itkMultiInputResampleImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkInterpolateImageFunction.h"
+#include "itkTransform.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class MultiInputResampleImageFilter
+ * \brief Resample a number of images with the same transform, in a single pass.
+ *
+ * This filter resamples all its inputs onto the same output grid, using the
+ * same coordinate transform. Input i is interpolated by interpolator i and
+ * the result is written to output i. In contrast to running an
+ * itk::ResampleImageFilter for each input, the transform is evaluated only
+ * once for each output voxel: the mapped point is computed and then all
+ * inputs are interpolated at that point. This pays off for expensive
+ * transforms, such as B-splines or combinations of transforms, when many
+ * images (e.g. channels or label images) are warped with the same transform.
+ *
+ * Note that all interpolators are connected to their input during the whole
+ * execution, so memory for e.g. B-spline coefficients is needed for all
+ * inputs at the same time.
+ *
+ * Pixels that are mapped outside an input are set to the DefaultPixelValue.
+ * The interpolated values are clamped to the range of the output pixel type,
+ * like itk::ResampleImageFilter does.
+ *
+ * \ingroup GeometricTransforms
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType = double >
+class MultiInputResampleImageFilter :
+  public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef MultiInputResampleImageFilter                   Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage > Superclass;
+  typedef SmartPointer< Self >                            Pointer;
+  typedef SmartPointer< const Self >                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MultiInputResampleImageFilter, ImageToImageFilter );
+
+  /** Number of dimensions. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs for the images. */
+  typedef TInputImage                             InputImageType;
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::Pointer       OutputImagePointer;
+  typedef typename OutputImageType::RegionType    OutputImageRegionType;
+  typedef typename OutputImageType::PixelType     OutputPixelType;
+  typedef typename OutputImageType::SizeType      SizeType;
+  typedef typename OutputImageType::IndexType     IndexType;
+  typedef typename OutputImageType::PointType     PointType;
+  typedef typename OutputImageType::SpacingType   SpacingType;
+  typedef typename OutputImageType::PointType     OriginPointType;
+  typedef typename OutputImageType::DirectionType DirectionType;
+
+  /** Typedefs for the transform and the interpolators. */
+  typedef Transform< TPrecisionType,
+    itkGetStaticConstMacro( ImageDimension ),
+    itkGetStaticConstMacro( ImageDimension ) >        TransformType;
+  typedef typename TransformType::ConstPointer        TransformPointerType;
+  typedef InterpolateImageFunction<
+    InputImageType, TPrecisionType >                  InterpolatorType;
+  typedef typename InterpolatorType::Pointer          InterpolatorPointerType;
+  typedef typename InterpolatorType::PointType        InputPointType;
+
+  /** Set/Get the coordinate transform, which maps output points to input points. */
+  itkSetConstObjectMacro( Transform, TransformType );
+  itkGetConstObjectMacro( Transform, TransformType );
+
+  /** Set/Get the interpolator of input i. */
+  virtual void SetInterpolator( const unsigned int index, InterpolatorType * interpolator );
+
+  virtual InterpolatorType * GetInterpolator( const unsigned int index ) const;
+
+  /** Set/Get the value of voxels that are mapped outside the inputs. */
+  itkSetMacro( DefaultPixelValue, OutputPixelType );
+  itkGetConstReferenceMacro( DefaultPixelValue, OutputPixelType );
+
+  /** Set/Get the output grid. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+  itkSetMacro( OutputStartIndex, IndexType );
+  itkGetConstReferenceMacro( OutputStartIndex, IndexType );
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+  itkSetMacro( OutputOrigin, OriginPointType );
+  itkGetConstReferenceMacro( OutputOrigin, OriginPointType );
+  itkSetMacro( OutputDirection, DirectionType );
+  itkGetConstReferenceMacro( OutputDirection, DirectionType );
+
+  /** The outputs get their geometry from the output grid, and
+   * there is one output for each input.
+   */
+  void GenerateOutputInformation( void ) override;
+
+  /** The inputs are needed entirely. */
+  void GenerateInputRequestedRegion( void ) override;
+
+  /** Compute the Modified Time based on changes to the components. */
+  ModifiedTimeType GetMTime( void ) const override;
+
+protected:
+
+  MultiInputResampleImageFilter();
+  ~MultiInputResampleImageFilter() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** Connect the interpolators to the inputs. */
+  void BeforeThreadedGenerateData( void ) override;
+
+  /** Disconnect the interpolators, to release e.g. B-spline coefficients. */
+  void AfterThreadedGenerateData( void ) override;
+
+  /** Resample all inputs in a region of the output grid. */
+  void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId ) override;
+
+private:
+
+  MultiInputResampleImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                // purposely not implemented
+
+  /** Member variables. */
+  TransformPointerType                   m_Transform;
+  std::vector< InterpolatorPointerType > m_Interpolators;
+  OutputPixelType                        m_DefaultPixelValue;
+  SizeType                               m_Size;
+  IndexType                              m_OutputStartIndex;
+  SpacingType                            m_OutputSpacing;
+  OriginPointType                        m_OutputOrigin;
+  DirectionType                          m_OutputDirection;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkMultiInputResampleImageFilter.hxx"
+#endif
+
+#endif // end #ifndef __itkMultiInputResampleImageFilter_h
@@ -0,0 +1,353 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMultiInputResampleImageFilter_hxx
+#define __itkMultiInputResampleImageFilter_hxx
+
+#include "itkMultiInputResampleImageFilter.h"
+
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::MultiInputResampleImageFilter()
+{
+  this->m_DefaultPixelValue = NumericTraits< OutputPixelType >::ZeroValue();
+  this->m_Size.Fill( 0 );
+  this->m_OutputStartIndex.Fill( 0 );
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_OutputOrigin.Fill( 0.0 );
+  this->m_OutputDirection.SetIdentity();
+
+  // Use the classic (ITK4) threading model, to ensure ThreadedGenerateData is being called.
+  this->DynamicMultiThreadingOff();
+
+} // end Constructor
+
+
+/**
+ * ******************* SetInterpolator *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::SetInterpolator( const unsigned int index, InterpolatorType * interpolator )
+{
+  if( index >= this->m_Interpolators.size() )
+  {
+    this->m_Interpolators.resize( index + 1 );
+  }
+  if( this->m_Interpolators[ index ] != interpolator )
+  {
+    this->m_Interpolators[ index ] = interpolator;
+    this->Modified();
+  }
+
+} // end SetInterpolator()
+
+
+/**
+ * ******************* GetInterpolator *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+typename MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >::InterpolatorType
+* MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::GetInterpolator( const unsigned int index ) const
+{
+  if( index < this->m_Interpolators.size() )
+  {
+    return this->m_Interpolators[ index ].GetPointer();
+  }
+  return nullptr;
+
+} // end GetInterpolator()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::GenerateOutputInformation( void )
+{
+  /** Make sure there is one output for each input. */
+  const unsigned int numberOfInputs = this->GetNumberOfIndexedInputs();
+  this->SetNumberOfIndexedOutputs( numberOfInputs );
+  for( unsigned int i = 0; i < numberOfInputs; ++i )
+  {
+    if( this->GetOutput( i ) == nullptr )
+    {
+      this->SetNthOutput( i, this->MakeOutput( i ) );
+    }
+  }
+
+  /** Call the superclass' implementation of this method. */
+  Superclass::GenerateOutputInformation();
+
+  /** All outputs have the geometry of the output grid. */
+  OutputImageRegionType outputLargestPossibleRegion;
+  outputLargestPossibleRegion.SetSize( this->m_Size );
+  outputLargestPossibleRegion.SetIndex( this->m_OutputStartIndex );
+
+  for( unsigned int i = 0; i < numberOfInputs; ++i )
+  {
+    OutputImageType * outputPtr = this->GetOutput( i );
+    outputPtr->SetLargestPossibleRegion( outputLargestPossibleRegion );
+    outputPtr->SetSpacing( this->m_OutputSpacing );
+    outputPtr->SetOrigin( this->m_OutputOrigin );
+    outputPtr->SetDirection( this->m_OutputDirection );
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::GenerateInputRequestedRegion( void )
+{
+  /** Call the superclass' implementation of this method. */
+  Superclass::GenerateInputRequestedRegion();
+
+  /** The mapped points can be anywhere, so request the entire inputs. */
+  for( unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); ++i )
+  {
+    InputImageType * inputPtr = const_cast< InputImageType * >( this->GetInput( i ) );
+    if( inputPtr )
+    {
+      inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::BeforeThreadedGenerateData( void )
+{
+  if( !this->m_Transform )
+  {
+    itkExceptionMacro( << "Transform not set" );
+  }
+
+  /** InterpolatorType::SetInputImage is not thread-safe, and for B-spline
+   * interpolators it computes the coefficients, so do it here, once.
+   */
+  for( unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); ++i )
+  {
+    InterpolatorType * interpolator = this->GetInterpolator( i );
+    if( interpolator == nullptr )
+    {
+      itkExceptionMacro( << "Interpolator " << i << " not set" );
+    }
+    interpolator->SetInputImage( this->GetInput( i ) );
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::AfterThreadedGenerateData( void )
+{
+  for( unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); ++i )
+  {
+    this->GetInterpolator( i )->SetInputImage( nullptr );
+  }
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageScanlineIterator< OutputImageType > OutputIteratorType;
+
+  /** All outputs have the same buffered region, so their iterators
+   * can walk the region in lockstep.
+   */
+  const unsigned int                numberOfInputs = this->GetNumberOfIndexedInputs();
+  std::vector< OutputIteratorType > outputIterators;
+  std::vector< InterpolatorType * > interpolators( numberOfInputs );
+  for( unsigned int i = 0; i < numberOfInputs; ++i )
+  {
+    outputIterators.push_back( OutputIteratorType( this->GetOutput( i ), outputRegionForThread ) );
+    interpolators[ i ] = this->GetInterpolator( i );
+  }
+
+  /** The interpolated values are clamped to the range of the output pixel type. */
+  const double minValue = static_cast< double >( NumericTraits< OutputPixelType >::NonpositiveMin() );
+  const double maxValue = static_cast< double >( NumericTraits< OutputPixelType >::max() );
+
+  /** The physical step between two neighbouring voxels on a scan line. */
+  const OutputImageType *        outputPtr = this->GetOutput( 0 );
+  typename PointType::VectorType scanlineStep;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    scanlineStep[ d ] = outputPtr->GetDirection()[ d ][ 0 ] * outputPtr->GetSpacing()[ 0 ];
+  }
+
+  /** For linear transforms, the mapped point moves with a constant step
+   * along a scan line, so the transform is only needed for the first voxel.
+   */
+  const bool isLinear = this->m_Transform->IsLinear();
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  PointType                           point;
+  InputPointType                      mappedPoint;
+  typename InputPointType::VectorType mappedScanlineStep;
+  OutputIteratorType &                it = outputIterators[ 0 ];
+  while( !it.IsAtEnd() )
+  {
+    outputPtr->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    if( isLinear )
+    {
+      mappedPoint        = this->m_Transform->TransformPoint( point );
+      mappedScanlineStep = this->m_Transform->TransformPoint( point + scanlineStep ) - mappedPoint;
+    }
+
+    while( !it.IsAtEndOfLine() )
+    {
+      /** Map the point once, and interpolate all inputs there. */
+      if( !isLinear )
+      {
+        mappedPoint = this->m_Transform->TransformPoint( point );
+      }
+
+      for( unsigned int i = 0; i < numberOfInputs; ++i )
+      {
+        if( interpolators[ i ]->IsInsideBuffer( mappedPoint ) )
+        {
+          double value = static_cast< double >( interpolators[ i ]->Evaluate( mappedPoint ) );
+          value = value < minValue ? minValue : ( value > maxValue ? maxValue : value );
+          outputIterators[ i ].Set( static_cast< OutputPixelType >( value ) );
+        }
+        else
+        {
+          outputIterators[ i ].Set( this->m_DefaultPixelValue );
+        }
+        ++outputIterators[ i ];
+      }
+
+      progress.CompletedPixel();
+      point += scanlineStep;
+      if( isLinear )
+      {
+        mappedPoint += mappedScanlineStep;
+      }
+    }
+
+    for( unsigned int i = 0; i < numberOfInputs; ++i )
+    {
+      outputIterators[ i ].NextLine();
+    }
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* GetMTime *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+ModifiedTimeType
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::GetMTime( void ) const
+{
+  ModifiedTimeType latestTime = Object::GetMTime();
+
+  if( this->m_Transform && latestTime < this->m_Transform->GetMTime() )
+  {
+    latestTime = this->m_Transform->GetMTime();
+  }
+  for( unsigned int i = 0; i < this->m_Interpolators.size(); ++i )
+  {
+    if( this->m_Interpolators[ i ] && latestTime < this->m_Interpolators[ i ]->GetMTime() )
+    {
+      latestTime = this->m_Interpolators[ i ]->GetMTime();
+    }
+  }
+
+  return latestTime;
+
+} // end GetMTime()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+MultiInputResampleImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << indent << "NumberOfInterpolators: " << this->m_Interpolators.size() << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast< typename NumericTraits< OutputPixelType >::PrintType >( this->m_DefaultPixelValue ) << std::endl;
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "OutputStartIndex: " << this->m_OutputStartIndex << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMultiInputResampleImageFilter_hxx
@@ -228,6 +228,22 @@ public:
    */
   itkGetConstReferenceMacro( LastTransformParameters, ParametersType );
 
+  /** Set/Get the level at which the optimization starts. This is used to
+   * resume an interrupted registration. The levels before the ResumeLevel
+   * are skipped: the IterationEvent is still invoked for them, so that the
+   * components can set up each level, e.g. upsample a B-spline grid, but
+   * the metric is not initialized, and the optimizer is not started.
+   * Default: 0, i.e. all levels are optimized.
+   */
+  itkSetMacro( ResumeLevel, unsigned long );
+  itkGetConstMacro( ResumeLevel, unsigned long );
+
+  /** Set/Get the transformation parameters at the end of the last skipped
+   * level, i.e. level ResumeLevel - 1. Only used if ResumeLevel > 0.
+   */
+  itkSetMacro( ResumeTransformParameters, ParametersType );
+  itkGetConstReferenceMacro( ResumeTransformParameters, ParametersType );
+
   /** Returns the transform resulting from the registration process. */
   const TransformOutputType * GetOutput( void ) const;
 
@@ -266,6 +282,13 @@ protected:
   /** Compute the size of the fixed region for each level of the pyramid. */
   virtual void PreparePyramids( void );
 
+  /** Called instead of Initialize() and the optimization, for the levels
+   * before the ResumeLevel. Sets the LastTransformParameters, the
+   * parameters of the transform, and the initial parameters of the next
+   * level, as if the current level had been optimized.
+   */
+  virtual void SkipCurrentLevel( void );
+
   /** Set the current level to be processed. */
   itkSetMacro( CurrentLevel, unsigned long );
 
@@ -301,6 +324,9 @@ private:
   unsigned long m_NumberOfLevels;
   unsigned long m_CurrentLevel;
 
+  unsigned long  m_ResumeLevel;
+  ParametersType m_ResumeTransformParameters;
+
 };
 
 } // end namespace itk
@@ -70,12 +70,14 @@ MultiResolutionImageRegistrationMethod2< TFixedImage, TMovingImage >
 
   this->m_NumberOfLevels = 1;
   this->m_CurrentLevel   = 0;
+  this->m_ResumeLevel    = 0;
 
   this->m_Stop = false;
 
   this->m_InitialTransformParameters            = ParametersType( 0 );
   this->m_InitialTransformParametersOfNextLevel = ParametersType( 0 );
   this->m_LastTransformParameters               = ParametersType( 0 );
+  this->m_ResumeTransformParameters             = ParametersType( 0 );
 
   this->m_InitialTransformParameters.Fill( 0.0f );
   this->m_InitialTransformParametersOfNextLevel.Fill( 0.0f );
@@ -318,6 +320,13 @@ MultiResolutionImageRegistrationMethod2< TFixedImage, TMovingImage >
         break;
       }
 
+      // Skip the levels that were completed before, when resuming
+      if( this->m_CurrentLevel < this->m_ResumeLevel )
+      {
+        this->SkipCurrentLevel();
+        continue;
+      }
+
       try
       {
         // initialize the interconnects between components
@@ -363,6 +372,40 @@ MultiResolutionImageRegistrationMethod2< TFixedImage, TMovingImage >
 } // end StartRegistration()
 
 
+/*
+ * Skip the current level
+ */
+template< typename TFixedImage, typename TMovingImage >
+void
+MultiResolutionImageRegistrationMethod2< TFixedImage, TMovingImage >
+::SkipCurrentLevel( void )
+{
+  // The last skipped level ends with the resume parameters. The levels
+  // before it keep the parameters that the components have set up for
+  // them, which at least have the correct size for that level.
+  ParametersType parameters = this->GetInitialTransformParametersOfNextLevel();
+  if( this->GetCurrentLevel() + 1 == this->GetResumeLevel() )
+  {
+    parameters = this->GetResumeTransformParameters();
+  }
+
+  if( parameters.Size() != this->GetModifiableTransform()->GetNumberOfParameters() )
+  {
+    itkExceptionMacro( << "Size mismatch between the parameters of skipped level "
+                       << this->GetCurrentLevel() << " and the transform" );
+  }
+
+  this->m_LastTransformParameters = parameters;
+  this->GetModifiableTransform()->SetParameters( this->m_LastTransformParameters );
+
+  if( this->GetCurrentLevel() < this->GetNumberOfLevels() - 1 )
+  {
+    this->SetInitialTransformParametersOfNextLevel( this->m_LastTransformParameters );
+  }
+
+} // end SkipCurrentLevel()
+
+
 /*
  * PrintSelf
  */
@@ -392,6 +435,7 @@ MultiResolutionImageRegistrationMethod2< TFixedImage, TMovingImage >
      << this->m_InitialTransformParametersOfNextLevel << std::endl;
   os << indent << "LastTransformParameters: "
      << this->m_LastTransformParameters << std::endl;
+  os << indent << "ResumeLevel: " << this->m_ResumeLevel << std::endl;
   os << indent << "FixedImageRegion: "
      << this->m_FixedImageRegion << std::endl;
 
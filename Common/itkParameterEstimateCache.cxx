@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParameterEstimateCache_cxx
+#define __itkParameterEstimateCache_cxx
+
+#include "itkParameterEstimateCache.h"
+#include "itk_zlib.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace itk
+{
+
+/**
+ * **************** Constructor ***************
+ */
+
+ParameterEstimateCache
+::ParameterEstimateCache()
+{
+  this->m_FileName = "";
+
+} // end Constructor()
+
+
+/**
+ * **************** ReadFile ***************
+ */
+
+std::size_t
+ParameterEstimateCache
+::ReadFile( void )
+{
+  this->m_Entries.clear();
+
+  /** A cache file that does not exist yet is simply empty. */
+  std::ifstream file( this->m_FileName.c_str() );
+  if( !file.is_open() )
+  {
+    return 0;
+  }
+
+  /** Loop over the cache file, line by line. */
+  std::string line;
+  while( itksys::SystemTools::GetLineFromStream( file, line ) )
+  {
+    std::istringstream lineStream( line );
+    std::string        key;
+    if( !( lineStream >> key ) )
+    {
+      continue;
+    }
+
+    /** Read the values; the last one is the estimation time. */
+    ValuesType values;
+    double     value = 0.0;
+    while( lineStream >> value )
+    {
+      values.push_back( value );
+    }
+    if( values.empty() || !lineStream.eof() )
+    {
+      continue; // ignore lines that cannot be parsed
+    }
+
+    EntryType entry;
+    entry.m_EstimationTime = values.back();
+    values.pop_back();
+    entry.m_Values = values;
+
+    /** Later entries replace earlier ones. */
+    this->m_Entries[ key ] = entry;
+  }
+
+  return this->m_Entries.size();
+
+} // end ReadFile()
+
+
+/**
+ * **************** GetEntry ***************
+ */
+
+bool
+ParameterEstimateCache
+::GetEntry( const std::string & key,
+  ValuesType & values, double & estimationTime ) const
+{
+  EntryMapType::const_iterator it = this->m_Entries.find( key );
+  if( it == this->m_Entries.end() )
+  {
+    return false;
+  }
+
+  values         = it->second.m_Values;
+  estimationTime = it->second.m_EstimationTime;
+  return true;
+
+} // end GetEntry()
+
+
+/**
+ * **************** AddEntry ***************
+ */
+
+void
+ParameterEstimateCache
+::AddEntry( const std::string & key,
+  const ValuesType & values, const double estimationTime )
+{
+  if( key.empty() || key.find_first_of( " \t\r\n" ) != std::string::npos )
+  {
+    itkExceptionMacro( << "ERROR: the key \"" << key
+                       << "\" is empty or contains white space." );
+  }
+
+  /** Store the entry. */
+  EntryType entry;
+  entry.m_Values         = values;
+  entry.m_EstimationTime = estimationTime;
+  this->m_Entries[ key ] = entry;
+
+  /** Compose the line, with full precision. */
+  std::ostringstream line;
+  line << std::setprecision( std::numeric_limits< double >::max_digits10 );
+  line << key;
+  for( std::size_t i = 0; i < values.size(); ++i )
+  {
+    line << " " << values[ i ];
+  }
+  line << " " << estimationTime << "\n";
+
+  /** Append it to the file in a single write, so that processes that
+   * share the cache file do not interleave their entries.
+   */
+  std::ofstream file( this->m_FileName.c_str(), std::ios::out | std::ios::app );
+  if( !file.is_open() )
+  {
+    itkExceptionMacro( << "ERROR: could not open "
+                       << this->m_FileName
+                       << " for writing." );
+  }
+  const std::string lineString = line.str();
+  file.write( lineString.c_str(), lineString.size() );
+  file.close();
+
+} // end AddEntry()
+
+
+/**
+ * **************** GetChecksum ***************
+ */
+
+std::string
+ParameterEstimateCache
+::GetChecksum( const std::string & data )
+{
+  /** Compute the crc checksum using zlib crc32 function. */
+  uLong crc = crc32( 0L, Z_NULL, 0 );
+  crc = crc32( crc, reinterpret_cast< const Bytef * >( data.c_str() ),
+    static_cast< uInt >( data.size() ) );
+
+  std::ostringstream checksum;
+  checksum << std::hex << std::setw( 8 ) << std::setfill( '0' ) << crc;
+  return checksum.str();
+
+} // end GetChecksum()
+
+
+/**
+ * **************** PrintSelf ***************
+ */
+
+void
+ParameterEstimateCache
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  this->Superclass::PrintSelf( os, indent );
+
+  os << indent << "FileName: " << this->m_FileName << std::endl;
+  os << indent << "NumberOfEntries: " << this->m_Entries.size() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end __itkParameterEstimateCache_cxx
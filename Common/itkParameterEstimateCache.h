@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParameterEstimateCache_h
+#define __itkParameterEstimateCache_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMacro.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class ParameterEstimateCache
+ *
+ * \brief A persistent cache for automatically estimated optimizer parameters.
+ *
+ * The automatic parameter estimation of the stochastic gradient descent
+ * optimizers is repeated for every resolution of every registration. When
+ * many image pairs with the same geometry are registered with the same
+ * parameter map, the estimates are typically almost the same. This class
+ * stores the estimates in a text file, so that later registrations can reuse
+ * them instead of estimating them again.
+ *
+ * Each entry is a key, a number of values, and the time that the original
+ * estimation took, so that the time saved by reusing the entry can be reported.
+ * The key should identify everything the estimates depend on, for example the
+ * checksum of the parameter map, the checksum of the image geometry, and the
+ * resolution level. GetChecksum() can be used to compute such checksums.
+ *
+ * The file contains one entry per line:\n
+ * key value_1 ... value_n estimationTime\n
+ * New entries are appended to the file, so that several processes can share
+ * a cache file. When a key occurs more than once, the last entry is used.
+ * Lines that cannot be parsed are ignored.
+ *
+ * Here is an example on how to use this class:\n
+ *
+ * itk::ParameterEstimateCache::Pointer cache = itk::ParameterEstimateCache::New();
+ * cache->SetFileName( fileName );
+ * cache->ReadFile();
+ * if( !cache->GetEntry( key, values, estimationTime ) )
+ * {
+ *   ... estimate the values ...
+ *   cache->AddEntry( key, values, estimationTime );
+ * }
+ */
+
+class ParameterEstimateCache : public Object
+{
+public:
+
+  /** Standard ITK typedefs. */
+  typedef ParameterEstimateCache     Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ParameterEstimateCache, Object );
+
+  /** Typedefs. */
+  typedef std::vector< double > ValuesType;
+
+  /** Set/Get the name of the cache file. */
+  itkSetStringMacro( FileName );
+  itkGetStringMacro( FileName );
+
+  /** Read the entries from the cache file. A file that does not exist yet
+   * is treated as an empty cache. Returns the number of entries read.
+   */
+  std::size_t ReadFile( void );
+
+  /** Look up the entry of key. Returns false if it is not in the cache. */
+  bool GetEntry( const std::string & key,
+    ValuesType & values, double & estimationTime ) const;
+
+  /** Add an entry to the cache, and append it to the cache file.
+   * An exception is thrown if the key contains white space, or if
+   * the file cannot be opened for writing.
+   */
+  void AddEntry( const std::string & key,
+    const ValuesType & values, const double estimationTime );
+
+  /** Get the number of entries in the cache. */
+  std::size_t GetNumberOfEntries( void ) const
+  {
+    return this->m_Entries.size();
+  }
+
+
+  /** Compute a checksum of a string, as a hexadecimal string. */
+  static std::string GetChecksum( const std::string & data );
+
+protected:
+
+  ParameterEstimateCache();
+  ~ParameterEstimateCache() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  ParameterEstimateCache( const Self & ); // purposely not implemented
+  void operator=( const Self & );         // purposely not implemented
+
+  struct EntryType
+  {
+    ValuesType m_Values;
+    double     m_EstimationTime;
+  };
+  typedef std::map< std::string, EntryType > EntryMapType;
+
+  std::string  m_FileName;
+  EntryMapType m_Entries;
+
+};
+
+} // end namespace itk
+
+#endif // end __itkParameterEstimateCache_h
@@ -0,0 +1,404 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParameterUpdateKernels_cxx
+#define __itkParameterUpdateKernels_cxx
+
+#include "itkParameterUpdateKernels.h"
+#include "itkPlatformMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef ELASTIX_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace itk
+{
+
+const SizeValueType ParameterUpdateKernels::MinimumNumberOfParametersPerThread;
+
+namespace
+{
+
+typedef ParameterUpdateKernels::ValueType ValueType;
+
+/**
+ * ******************* The kernels *******************
+ *
+ * Each kernel processes the parameters in the range [begin, end).
+ */
+
+struct GradientStepKernel
+{
+  ValueType *       t_NewPosition;
+  const ValueType * t_Position;
+  const ValueType * t_Gradient;
+  double            t_LearningRate;
+
+  void operator()( const SizeValueType begin, const SizeValueType end, const ThreadIdType ) const
+  {
+    ValueType *       newPosition  = this->t_NewPosition;
+    const ValueType * position     = this->t_Position;
+    const ValueType * gradient     = this->t_Gradient;
+    const double      learningRate = this->t_LearningRate;
+    for( SizeValueType j = begin; j < end; ++j )
+    {
+      newPosition[ j ] = position[ j ] - learningRate * gradient[ j ];
+    }
+  }
+};
+
+struct PreconditionedGradientStepKernel
+{
+  ValueType *       t_NewPosition;
+  const ValueType * t_Position;
+  const ValueType * t_Preconditioner;
+  const ValueType * t_Gradient;
+  ValueType *       t_SearchDirection;
+  double            t_LearningRate;
+
+  void operator()( const SizeValueType begin, const SizeValueType end, const ThreadIdType ) const
+  {
+    ValueType *       newPosition     = this->t_NewPosition;
+    const ValueType * position        = this->t_Position;
+    const ValueType * preconditioner  = this->t_Preconditioner;
+    const ValueType * gradient        = this->t_Gradient;
+    ValueType *       searchDirection = this->t_SearchDirection;
+    const double      learningRate    = this->t_LearningRate;
+    for( SizeValueType j = begin; j < end; ++j )
+    {
+      const ValueType direction = preconditioner[ j ] * gradient[ j ];
+      searchDirection[ j ] = direction;
+      newPosition[ j ]     = position[ j ] - learningRate * direction;
+    }
+  }
+};
+
+struct AdaGradStepKernel
+{
+  ValueType *       t_NewPosition;
+  const ValueType * t_Position;
+  ValueType *       t_SquaredGradientSum;
+  const ValueType * t_Gradient;
+  ValueType *       t_SearchDirection;
+  double            t_LearningRate;
+  double            t_Epsilon;
+
+  void operator()( const SizeValueType begin, const SizeValueType end, const ThreadIdType ) const
+  {
+    ValueType *       newPosition        = this->t_NewPosition;
+    const ValueType * position           = this->t_Position;
+    ValueType *       squaredGradientSum = this->t_SquaredGradientSum;
+    const ValueType * gradient           = this->t_Gradient;
+    ValueType *       searchDirection    = this->t_SearchDirection;
+    const double      learningRate       = this->t_LearningRate;
+    const double      epsilon            = this->t_Epsilon;
+    for( SizeValueType j = begin; j < end; ++j )
+    {
+      const ValueType g   = gradient[ j ];
+      const ValueType sum = squaredGradientSum[ j ] + g * g;
+      const ValueType direction = g / std::sqrt( sum + epsilon );
+      squaredGradientSum[ j ] = sum;
+      searchDirection[ j ]    = direction;
+      newPosition[ j ]        = position[ j ] - learningRate * direction;
+    }
+  }
+};
+
+struct InnerProductAndCopyKernel
+{
+  ValueType *       t_Previous;
+  const ValueType * t_Current;
+  const ValueType * t_Update;
+  double *          t_PartialInnerProducts;
+
+  void operator()( const SizeValueType begin, const SizeValueType end, const ThreadIdType threadId ) const
+  {
+    ValueType *       previous = this->t_Previous;
+    const ValueType * current  = this->t_Current;
+    const ValueType * update   = this->t_Update;
+    double            sum      = 0.0;
+    for( SizeValueType j = begin; j < end; ++j )
+    {
+      sum += previous[ j ] * current[ j ];
+      previous[ j ] = update[ j ];
+    }
+    this->t_PartialInnerProducts[ threadId ] = sum;
+  }
+};
+
+/**
+ * ******************* ComputeRange *******************
+ */
+
+inline void
+ComputeRange( const SizeValueType numberOfParameters, const ThreadIdType numberOfThreads,
+  const ThreadIdType threadId, SizeValueType & begin, SizeValueType & end )
+{
+  const SizeValueType chunk = ( numberOfParameters + numberOfThreads - 1 ) / numberOfThreads;
+  begin = std::min( numberOfParameters, threadId * chunk );
+  end   = std::min( numberOfParameters, begin + chunk );
+
+} // end ComputeRange()
+
+
+#ifndef ELASTIX_USE_OPENMP
+
+/** The struct that is passed to the threads. */
+template< class TKernel >
+struct KernelThreaderParameterType
+{
+  const TKernel * t_Kernel;
+  SizeValueType   t_NumberOfParameters;
+};
+
+/**
+ * ******************* KernelThreaderCallback *******************
+ */
+
+template< class TKernel >
+ITK_THREAD_RETURN_TYPE
+KernelThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  PlatformMultiThreader::WorkUnitInfo * infoStruct
+    = static_cast< PlatformMultiThreader::WorkUnitInfo * >( arg );
+  const ThreadIdType threadId        = infoStruct->WorkUnitID;
+  const ThreadIdType numberOfThreads = infoStruct->NumberOfWorkUnits;
+  const KernelThreaderParameterType< TKernel > * temp
+    = static_cast< const KernelThreaderParameterType< TKernel > * >( infoStruct->UserData );
+
+  /** Process the range of this thread. */
+  SizeValueType begin, end;
+  ComputeRange( temp->t_NumberOfParameters, numberOfThreads, threadId, begin, end );
+  ( *temp->t_Kernel )( begin, end, threadId );
+
+  return ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end KernelThreaderCallback()
+
+#endif
+
+/**
+ * ******************* RunKernel *******************
+ *
+ * Runs the kernel on numberOfThreads threads, as computed by
+ * GetNumberOfThreadsToUse(). The thread ids passed to the kernel
+ * are smaller than numberOfThreads.
+ */
+
+template< class TKernel >
+void
+RunKernel( const TKernel & kernel, const SizeValueType numberOfParameters,
+  const ThreadIdType numberOfThreads )
+{
+  if( numberOfThreads <= 1 )
+  {
+    kernel( 0, numberOfParameters, 0 );
+    return;
+  }
+
+#ifdef ELASTIX_USE_OPENMP
+  const int nthreads = static_cast< int >( numberOfThreads );
+  #pragma omp parallel for num_threads( nthreads ) schedule( static, 1 )
+  for( int i = 0; i < nthreads; ++i )
+  {
+    SizeValueType begin, end;
+    ComputeRange( numberOfParameters, numberOfThreads, i, begin, end );
+    kernel( begin, end, i );
+  }
+#else
+  KernelThreaderParameterType< TKernel > temp;
+  temp.t_Kernel             = &kernel;
+  temp.t_NumberOfParameters = numberOfParameters;
+
+  /** The threader may use fewer work units than requested, but never more. */
+  PlatformMultiThreader::Pointer threader = PlatformMultiThreader::New();
+  threader->SetNumberOfWorkUnits( numberOfThreads );
+  threader->SetSingleMethod( KernelThreaderCallback< TKernel >, &temp );
+  threader->SingleMethodExecute();
+#endif
+
+} // end RunKernel()
+
+
+} // end namespace anonymous
+
+
+/**
+ * ******************* GetNumberOfThreadsToUse *******************
+ */
+
+ThreadIdType
+ParameterUpdateKernels
+::GetNumberOfThreadsToUse( const SizeValueType numberOfParameters,
+  const ThreadIdType numberOfThreads )
+{
+  const SizeValueType requested = numberOfThreads > 0 ? numberOfThreads
+    : MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  const SizeValueType maximum = std::max< SizeValueType >( 1,
+    numberOfParameters / MinimumNumberOfParametersPerThread );
+
+  return static_cast< ThreadIdType >( std::min( requested, maximum ) );
+
+} // end GetNumberOfThreadsToUse()
+
+
+/**
+ * ******************* GradientStep *******************
+ */
+
+void
+ParameterUpdateKernels
+::GradientStep(
+  ArrayType & newPosition,
+  const ArrayType & position,
+  const ArrayType & gradient,
+  const double learningRate,
+  const ThreadIdType numberOfThreads )
+{
+  GradientStepKernel kernel;
+  kernel.t_NewPosition  = newPosition.data_block();
+  kernel.t_Position     = position.data_block();
+  kernel.t_Gradient     = gradient.data_block();
+  kernel.t_LearningRate = learningRate;
+
+  const SizeValueType n = position.GetSize();
+  RunKernel( kernel, n, Self::GetNumberOfThreadsToUse( n, numberOfThreads ) );
+
+} // end GradientStep()
+
+
+/**
+ * ******************* PreconditionedGradientStep *******************
+ */
+
+void
+ParameterUpdateKernels
+::PreconditionedGradientStep(
+  ArrayType & newPosition,
+  const ArrayType & position,
+  const ArrayType & preconditioner,
+  const ArrayType & gradient,
+  ArrayType & searchDirection,
+  const double learningRate,
+  const ThreadIdType numberOfThreads )
+{
+  PreconditionedGradientStepKernel kernel;
+  kernel.t_NewPosition     = newPosition.data_block();
+  kernel.t_Position        = position.data_block();
+  kernel.t_Preconditioner  = preconditioner.data_block();
+  kernel.t_Gradient        = gradient.data_block();
+  kernel.t_SearchDirection = searchDirection.data_block();
+  kernel.t_LearningRate    = learningRate;
+
+  const SizeValueType n = position.GetSize();
+  RunKernel( kernel, n, Self::GetNumberOfThreadsToUse( n, numberOfThreads ) );
+
+} // end PreconditionedGradientStep()
+
+
+/**
+ * ******************* AdaGradStep *******************
+ */
+
+void
+ParameterUpdateKernels
+::AdaGradStep(
+  ArrayType & newPosition,
+  const ArrayType & position,
+  ArrayType & squaredGradientSum,
+  const ArrayType & gradient,
+  ArrayType & searchDirection,
+  const double learningRate,
+  const double epsilon,
+  const ThreadIdType numberOfThreads )
+{
+  AdaGradStepKernel kernel;
+  kernel.t_NewPosition        = newPosition.data_block();
+  kernel.t_Position           = position.data_block();
+  kernel.t_SquaredGradientSum = squaredGradientSum.data_block();
+  kernel.t_Gradient           = gradient.data_block();
+  kernel.t_SearchDirection    = searchDirection.data_block();
+  kernel.t_LearningRate       = learningRate;
+  kernel.t_Epsilon            = epsilon;
+
+  const SizeValueType n = position.GetSize();
+  RunKernel( kernel, n, Self::GetNumberOfThreadsToUse( n, numberOfThreads ) );
+
+} // end AdaGradStep()
+
+
+/**
+ * ******************* InnerProductAndCopy *******************
+ */
+
+double
+ParameterUpdateKernels
+::InnerProductAndCopy(
+  ArrayType & previous,
+  const ArrayType & current,
+  const ArrayType & update,
+  const ThreadIdType numberOfThreads )
+{
+  const SizeValueType n       = current.GetSize();
+  const ThreadIdType  threads = Self::GetNumberOfThreadsToUse( n, numberOfThreads );
+
+  /** Threads that are not used leave their partial inner product zero. */
+  std::vector< double > partialInnerProducts( threads, 0.0 );
+
+  InnerProductAndCopyKernel kernel;
+  kernel.t_Previous             = previous.data_block();
+  kernel.t_Current              = current.data_block();
+  kernel.t_Update               = update.data_block();
+  kernel.t_PartialInnerProducts = &partialInnerProducts[ 0 ];
+
+  RunKernel( kernel, n, threads );
+
+  /** Sum in a fixed order, for reproducibility. */
+  double innerProduct = 0.0;
+  for( ThreadIdType i = 0; i < threads; ++i )
+  {
+    innerProduct += partialInnerProducts[ i ];
+  }
+  return innerProduct;
+
+} // end InnerProductAndCopy()
+
+
+/**
+ * ******************* InnerProductAndCopy *******************
+ */
+
+double
+ParameterUpdateKernels
+::InnerProductAndCopy(
+  ArrayType & previous,
+  const ArrayType & current,
+  const ThreadIdType numberOfThreads )
+{
+  return Self::InnerProductAndCopy( previous, current, current, numberOfThreads );
+
+} // end InnerProductAndCopy()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkParameterUpdateKernels_cxx
@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkParameterUpdateKernels_h
+#define __itkParameterUpdateKernels_h
+
+#include "itkArray.h"
+#include "itkIntTypes.h"
+
+namespace itk
+{
+
+/** \class ParameterUpdateKernels
+ * \brief Fused, multi-threaded kernels for the parameter updates of the
+ * gradient based optimizers.
+ *
+ * The gradient based optimizers advance the parameters as
+ * \f$ \mu_{k+1} = \mu_k - a_k d_k \f$, where the search direction \f$ d_k \f$
+ * is the gradient, possibly multiplied by a diagonal preconditioner. These
+ * kernels compute the search direction, the preconditioner update and the
+ * new position in a single pass over the parameters, using loops without
+ * dependencies between the iterations, which the compiler can vectorize.
+ *
+ * The adaptive step size mechanism needs the inner product of the current
+ * gradient with the one of the previous iteration, after which the current
+ * gradient is stored for the next iteration. InnerProductAndCopy() does both
+ * in a single pass as well.
+ *
+ * The output arrays may alias the input arrays, so that the position can be
+ * updated in place. All arrays are assumed to have the same size.
+ *
+ * The work is divided over at most \c numberOfThreads threads, using OpenMP
+ * when elastix is built with it, and the ITK PlatformMultiThreader otherwise.
+ * Each thread processes at least MinimumNumberOfParametersPerThread
+ * parameters, since for smaller problems the threading overhead exceeds the
+ * gain. Most registrations therefore simply run the vectorized single-threaded
+ * loop, while large B-spline grids are updated in parallel. Passing zero
+ * threads selects the global default number of threads of ITK. The partial
+ * inner products are summed in a fixed order, so that the result does not
+ * depend on the scheduling of the threads.
+ *
+ * \ingroup Optimizers
+ */
+
+class ParameterUpdateKernels
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef ParameterUpdateKernels Self;
+
+  /** Typedefs. */
+  typedef double           ValueType;
+  typedef Array< double >  ArrayType;
+
+  /** The minimum number of parameters per thread. */
+  static const SizeValueType MinimumNumberOfParametersPerThread = 16384;
+
+  /** Gradient descent step: newPosition = position - learningRate * gradient. */
+  static void GradientStep(
+    ArrayType & newPosition,
+    const ArrayType & position,
+    const ArrayType & gradient,
+    const double learningRate,
+    const ThreadIdType numberOfThreads = 0 );
+
+  /** Preconditioned gradient descent step:
+   * searchDirection = preconditioner .* gradient, and
+   * newPosition = position - learningRate * searchDirection.
+   */
+  static void PreconditionedGradientStep(
+    ArrayType & newPosition,
+    const ArrayType & position,
+    const ArrayType & preconditioner,
+    const ArrayType & gradient,
+    ArrayType & searchDirection,
+    const double learningRate,
+    const ThreadIdType numberOfThreads = 0 );
+
+  /** AdaGrad step: squaredGradientSum += gradient .* gradient,
+   * searchDirection = gradient ./ sqrt( squaredGradientSum + epsilon ), and
+   * newPosition = position - learningRate * searchDirection.
+   */
+  static void AdaGradStep(
+    ArrayType & newPosition,
+    const ArrayType & position,
+    ArrayType & squaredGradientSum,
+    const ArrayType & gradient,
+    ArrayType & searchDirection,
+    const double learningRate,
+    const double epsilon,
+    const ThreadIdType numberOfThreads = 0 );
+
+  /** Returns the inner product < previous, current >, and then stores
+   * update in previous, for use in the next iteration.
+   */
+  static double InnerProductAndCopy(
+    ArrayType & previous,
+    const ArrayType & current,
+    const ArrayType & update,
+    const ThreadIdType numberOfThreads = 0 );
+
+  /** Returns the inner product < previous, current >, and then stores
+   * current in previous, for use in the next iteration.
+   */
+  static double InnerProductAndCopy(
+    ArrayType & previous,
+    const ArrayType & current,
+    const ThreadIdType numberOfThreads = 0 );
+
+  /** The number of threads that is actually used for a given problem size. */
+  static ThreadIdType GetNumberOfThreadsToUse(
+    const SizeValueType numberOfParameters,
+    const ThreadIdType numberOfThreads );
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkParameterUpdateKernels_h
@@ -48,6 +48,7 @@ ScaledSingleValuedNonLinearOptimizer
    * as squared scales (following the ITK convention)!
    */
   this->m_ScaledCostFunction->SetSquaredScales( this->GetScales() );
+  this->UpdateScaledCostFunctionClones();
   this->Modified();
 
 } // end InitializeScales()
@@ -61,12 +62,56 @@ void
 ScaledSingleValuedNonLinearOptimizer
 ::SetCostFunction( CostFunctionType * costFunction )
 {
+  if( this->m_ScaledCostFunction->GetUnscaledCostFunction() != costFunction )
+  {
+    this->m_ScaledCostFunctionClones.clear();
+  }
   this->m_ScaledCostFunction->SetUnscaledCostFunction( costFunction );
   this->Superclass::SetCostFunction( costFunction );
 
 } // end SetCostFunction()
 
 
+/**
+ * ****************** SetCostFunctionClones ******************************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::SetCostFunctionClones( const CostFunctionContainerType & clones )
+{
+  this->m_ScaledCostFunctionClones.clear();
+  for( std::size_t i = 0; i < clones.size(); ++i )
+  {
+    ScaledCostFunctionPointer scaledClone = ScaledCostFunctionType::New();
+    scaledClone->SetUnscaledCostFunction( clones[ i ] );
+    this->m_ScaledCostFunctionClones.push_back( scaledClone );
+  }
+  this->UpdateScaledCostFunctionClones();
+  this->Modified();
+
+} // end SetCostFunctionClones()
+
+
+/**
+ * ************* UpdateScaledCostFunctionClones ********************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::UpdateScaledCostFunctionClones( void )
+{
+  for( std::size_t i = 0; i < this->m_ScaledCostFunctionClones.size(); ++i )
+  {
+    ScaledCostFunctionType * scaledClone = this->m_ScaledCostFunctionClones[ i ];
+    scaledClone->SetSquaredScales( this->m_ScaledCostFunction->GetSquaredScales() );
+    scaledClone->SetUseScales( this->m_ScaledCostFunction->GetUseScales() );
+    scaledClone->SetNegateCostFunction( this->m_ScaledCostFunction->GetNegateCostFunction() );
+  }
+
+} // end UpdateScaledCostFunctionClones()
+
+
 /**
  * ********************* SetUseScales ******************************
  */
@@ -76,6 +121,7 @@ ScaledSingleValuedNonLinearOptimizer
 ::SetUseScales( bool arg )
 {
   this->m_ScaledCostFunction->SetUseScales( arg );
+  this->UpdateScaledCostFunctionClones();
   this->Modified();
 
 } // end SetUseScales()
@@ -226,6 +272,7 @@ ScaledSingleValuedNonLinearOptimizer
   {
     this->m_Maximize = _arg;
     this->m_ScaledCostFunction->SetNegateCostFunction( _arg );
+    this->UpdateScaledCostFunctionClones();
     this->Modified();
   }
 }  // end SetMaximize()
@@ -248,6 +295,8 @@ ScaledSingleValuedNonLinearOptimizer
      << this->m_UnscaledCurrentPosition << std::endl;
   os << indent << "ScaledCostFunction: "
      << this->m_ScaledCostFunction.GetPointer() << std::endl;
+  os << indent << "ScaledCostFunctionClones: "
+     << this->m_ScaledCostFunctionClones.size() << std::endl;
   os << indent << "Maximize: "
      << ( this->m_Maximize ? "true" : "false" ) << std::endl;
 
@@ -21,6 +21,8 @@
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itkScaledSingleValuedCostFunction.h"
 
+#include <vector>
+
 namespace itk
 {
 /** \class ScaledSingleValuedNonLinearOptimizer
@@ -87,6 +89,9 @@ public:
   typedef ScaledSingleValuedCostFunction  ScaledCostFunctionType;
   typedef ScaledCostFunctionType::Pointer ScaledCostFunctionPointer;
 
+  typedef std::vector< CostFunctionType::Pointer >  CostFunctionContainerType;
+  typedef std::vector< ScaledCostFunctionPointer >  ScaledCostFunctionContainerType;
+
   /** Configure the scaled cost function. This function
    * sets the current scales in the ScaledCostFunction.
    * NB: it assumes that the scales entered by the user
@@ -96,9 +101,23 @@ public:
    */
   virtual void InitializeScales( void );
 
-  /** Setting: SetCostFunction. */
+  /** Setting: SetCostFunction. Clones of another cost function are discarded. */
   void SetCostFunction( CostFunctionType * costFunction ) override;
 
+  /** Set copies of the cost function that may be evaluated concurrently,
+   * for optimizers that evaluate several positions at the same time. Each
+   * clone is wrapped in its own scaled cost function, with the same scales
+   * and settings as the ScaledCostFunction.
+   */
+  virtual void SetCostFunctionClones( const CostFunctionContainerType & clones );
+
+  /** Get the scaled wrappers of the cost function clones. */
+  const ScaledCostFunctionContainerType & GetScaledCostFunctionClones( void ) const
+  {
+    return this->m_ScaledCostFunctionClones;
+  }
+
+
   /** Setting: Turn on/off the use of scales. Set this flag to false when no
    * scaling is desired.
    */
@@ -137,8 +156,9 @@ protected:
   void PrintSelf( std::ostream & os, Indent indent ) const override;
 
   /** Member variables. */
-  ParametersType            m_ScaledCurrentPosition;
-  ScaledCostFunctionPointer m_ScaledCostFunction;
+  ParametersType                  m_ScaledCurrentPosition;
+  ScaledCostFunctionPointer       m_ScaledCostFunction;
+  ScaledCostFunctionContainerType m_ScaledCostFunctionClones;
 
   /** Set m_ScaledCurrentPosition. */
   virtual void SetScaledCurrentPosition( const ParametersType & parameters );
@@ -183,6 +203,11 @@ private:
   /** The private copy constructor. */
   void operator=( const Self & );                         // purposely not implemented
 
+  /** Copy the scales and settings of the ScaledCostFunction to the
+   * scaled cost function clones.
+   */
+  void UpdateScaledCostFunctionClones( void );
+
   /** Variable to store the CurrentPosition, when the function
    * GetCurrentPosition is called. This method needs a member variable,
    * because the GetCurrentPosition return something by reference.
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkStochasticConvergenceMonitor_cxx
+#define __itkStochasticConvergenceMonitor_cxx
+
+#include "itkStochasticConvergenceMonitor.h"
+
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * **************** Constructor ***************
+ */
+
+StochasticConvergenceMonitor
+::StochasticConvergenceMonitor()
+{
+  this->m_WindowSize        = 0;
+  this->m_RelativeTolerance = 1e-3;
+  this->m_ConfidenceFactor  = 2.0;
+
+  this->Initialize();
+
+} // end Constructor()
+
+
+/**
+ * **************** Initialize ***************
+ */
+
+void
+StochasticConvergenceMonitor
+::Initialize( void )
+{
+  this->m_Values.assign( this->m_WindowSize, 0.0 );
+  this->m_NumberOfValues                = 0;
+  this->m_Converged                     = false;
+  this->m_RelativeDecrease              = 0.0;
+  this->m_RelativeDecreaseStandardError = 0.0;
+
+} // end Initialize()
+
+
+/**
+ * **************** AddValue ***************
+ */
+
+bool
+StochasticConvergenceMonitor
+::AddValue( const double value )
+{
+  /** A fit needs at least three points. */
+  const unsigned int windowSize = this->m_WindowSize;
+  if( windowSize < 3 || this->m_Converged )
+  {
+    return this->m_Converged;
+  }
+
+  /** The window size may have changed since Initialize() was called. */
+  if( this->m_Values.size() != windowSize )
+  {
+    this->Initialize();
+  }
+
+  /** Store the value; wait until the window is full. */
+  this->m_Values[ this->m_NumberOfValues % windowSize ] = value;
+  ++this->m_NumberOfValues;
+  if( this->m_NumberOfValues < windowSize )
+  {
+    return false;
+  }
+
+  /** Fit y = a + b x through the window, with x = 0 for the oldest value.
+   * The x values are equidistant, so Sxx has a closed form.
+   */
+  const unsigned long oldest = this->m_NumberOfValues % windowSize;
+  const double        n      = static_cast< double >( windowSize );
+  const double        xMean  = 0.5 * ( n - 1.0 );
+  const double        Sxx    = n * ( n * n - 1.0 ) / 12.0;
+  double              yMean  = 0.0;
+  for( unsigned int i = 0; i < windowSize; ++i )
+  {
+    yMean += this->m_Values[ i ];
+  }
+  yMean /= n;
+
+  double Sxy = 0.0;
+  for( unsigned int i = 0; i < windowSize; ++i )
+  {
+    const double x = static_cast< double >( i ) - xMean;
+    Sxy += x * ( this->m_Values[ ( oldest + i ) % windowSize ] - yMean );
+  }
+  const double slope = Sxy / Sxx;
+
+  /** Estimate the standard error of the slope from the residuals. */
+  double SSE = 0.0;
+  for( unsigned int i = 0; i < windowSize; ++i )
+  {
+    const double x        = static_cast< double >( i ) - xMean;
+    const double residual = this->m_Values[ ( oldest + i ) % windowSize ] - yMean - slope * x;
+    SSE += residual * residual;
+  }
+  const double slopeStandardError = std::sqrt( SSE / ( n - 2.0 ) / Sxx );
+
+  /** Express the decrease over the window relative to the mean value. When the
+   * mean value is zero, convergence requires that there is no significant decrease.
+   */
+  const double scale = std::abs( yMean ) > 0.0 ? 1.0 / std::abs( yMean ) : 1.0;
+  this->m_RelativeDecrease              = -slope * n * scale;
+  this->m_RelativeDecreaseStandardError = slopeStandardError * n * scale;
+
+  const double tolerance = std::abs( yMean ) > 0.0 ? this->m_RelativeTolerance : 0.0;
+  this->m_Converged = this->m_RelativeDecrease
+    - this->m_ConfidenceFactor * this->m_RelativeDecreaseStandardError <= tolerance;
+
+  return this->m_Converged;
+
+} // end AddValue()
+
+
+/**
+ * **************** PrintSelf ***************
+ */
+
+void
+StochasticConvergenceMonitor
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  this->Superclass::PrintSelf( os, indent );
+
+  os << indent << "WindowSize: " << this->m_WindowSize << std::endl;
+  os << indent << "RelativeTolerance: " << this->m_RelativeTolerance << std::endl;
+  os << indent << "ConfidenceFactor: " << this->m_ConfidenceFactor << std::endl;
+  os << indent << "Converged: " << this->m_Converged << std::endl;
+  os << indent << "RelativeDecrease: " << this->m_RelativeDecrease << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end __itkStochasticConvergenceMonitor_cxx
@@ -0,0 +1,140 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkStochasticConvergenceMonitor_h
+#define __itkStochasticConvergenceMonitor_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMacro.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class StochasticConvergenceMonitor
+ *
+ * \brief Detects when a stochastic optimization stops making progress.
+ *
+ * The stochastic gradient descent optimizers compute the metric value and its
+ * derivative on a new random set of samples in each iteration, so that the
+ * usual stopping criteria, based on the gradient magnitude or on the change of
+ * the metric value between two iterations, are unreliable. This class instead
+ * fits a straight line through the metric values of the last WindowSize
+ * iterations, and declares convergence when the decrease of the metric value
+ * over the window is not significantly larger than RelativeTolerance times the
+ * mean metric value in the window. The decrease is considered significant when
+ * it exceeds the tolerance by more than ConfidenceFactor times its standard
+ * error, which is estimated from the residuals of the fit.
+ *
+ * Here is an example on how to use this class:\n
+ *
+ * itk::StochasticConvergenceMonitor::Pointer monitor = itk::StochasticConvergenceMonitor::New();
+ * monitor->SetWindowSize( 100 );
+ * monitor->Initialize();
+ * for( each iteration )
+ * {
+ *   ... compute value ...
+ *   if( monitor->AddValue( value ) ) break;
+ * }
+ *
+ * A WindowSize of zero, the default, disables the monitor.
+ */
+
+class StochasticConvergenceMonitor : public Object
+{
+public:
+
+  /** Standard ITK typedefs. */
+  typedef StochasticConvergenceMonitor Self;
+  typedef Object                       Superclass;
+  typedef SmartPointer< Self >         Pointer;
+  typedef SmartPointer< const Self >   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( StochasticConvergenceMonitor, Object );
+
+  /** Set/Get the number of iterations over which the progress is measured.
+   * Zero disables the monitor. Default: 0.
+   */
+  itkSetMacro( WindowSize, unsigned int );
+  itkGetConstMacro( WindowSize, unsigned int );
+
+  /** Set/Get the relative decrease of the metric value over the window
+   * below which the optimization is considered converged. Default: 1e-3.
+   */
+  itkSetMacro( RelativeTolerance, double );
+  itkGetConstMacro( RelativeTolerance, double );
+
+  /** Set/Get the number of standard errors by which the decrease should exceed
+   * the tolerance to be significant. Larger values stop earlier. Default: 2.0.
+   */
+  itkSetMacro( ConfidenceFactor, double );
+  itkGetConstMacro( ConfidenceFactor, double );
+
+  /** Forget all values; call this at the start of each optimization. */
+  void Initialize( void );
+
+  /** Add the metric value of the next iteration. Returns true when the
+   * optimization has converged, and keeps doing so after that.
+   */
+  bool AddValue( const double value );
+
+  /** Get whether convergence has been detected. */
+  itkGetConstMacro( Converged, bool );
+
+  /** Get the relative decrease of the metric value over the last window,
+   * as estimated by the last fit.
+   */
+  itkGetConstMacro( RelativeDecrease, double );
+
+  /** Get the standard error of the relative decrease of the last fit. */
+  itkGetConstMacro( RelativeDecreaseStandardError, double );
+
+protected:
+
+  StochasticConvergenceMonitor();
+  ~StochasticConvergenceMonitor() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+private:
+
+  StochasticConvergenceMonitor( const Self & ); // purposely not implemented
+  void operator=( const Self & );               // purposely not implemented
+
+  unsigned int m_WindowSize;
+  double       m_RelativeTolerance;
+  double       m_ConfidenceFactor;
+
+  /** The values of the last WindowSize iterations, as a circular buffer. */
+  std::vector< double > m_Values;
+  unsigned long         m_NumberOfValues;
+
+  bool   m_Converged;
+  double m_RelativeDecrease;
+  double m_RelativeDecreaseStandardError;
+
+};
+
+} // end namespace itk
+
+#endif // end __itkStochasticConvergenceMonitor_h
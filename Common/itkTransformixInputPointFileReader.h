@@ -40,6 +40,12 @@ namespace itk
  *
  * The second word in the text file represents the number of points that
  * should be read.
+ *
+ * Files with the extension ".bin" are binary point files. They contain no
+ * header, only the world coordinates of the points, as consecutive doubles
+ * (x0 y0 [z0] x1 y1 [z1] ...) in the byte order of the machine. The number
+ * of points follows from the file size. Reading binary files avoids parsing
+ * text, which takes most of the time for very large point sets.
  **/
 
 template< class TOutputMesh >
@@ -82,6 +88,9 @@ public:
    */
   itkGetConstMacro( NumberOfPoints, unsigned long );
 
+  /** Get whether the file is a binary point file, see the class description. */
+  itkGetConstMacro( FileIsBinary, bool );
+
   /** Prepare the allocation of the output mesh during the first back
    * propagation of the pipeline. Updates the PointsAreIndices and NumberOfPoints.
    */
@@ -97,6 +106,7 @@ protected:
 
   unsigned long m_NumberOfPoints;
   bool          m_PointsAreIndices;
+  bool          m_FileIsBinary;
 
   std::ifstream m_Reader;
 
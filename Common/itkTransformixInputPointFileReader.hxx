@@ -21,6 +21,13 @@
 
 #include "itkTransformixInputPointFileReader.h"
 
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
 namespace itk
 {
 
@@ -34,6 +41,7 @@ TransformixInputPointFileReader< TOutputMesh >
 {
   this->m_NumberOfPoints   = 0;
   this->m_PointsAreIndices = false;
+  this->m_FileIsBinary     = false;
 } // end constructor
 
 
@@ -69,6 +77,34 @@ TransformixInputPointFileReader< TOutputMesh >
   {
     this->m_Reader.close();
   }
+
+  /** A binary point file has no header; the number of points follows from the file size. */
+  const std::string extension = itksys::SystemTools::GetFilenameLastExtension( this->m_FileName );
+  this->m_FileIsBinary = ( extension == ".bin" || extension == ".BIN" );
+  if( this->m_FileIsBinary )
+  {
+    this->m_Reader.open( this->m_FileName.c_str(), std::ios::in | std::ios::binary );
+    this->m_Reader.seekg( 0, std::ios::end );
+    const std::streamoff fileSize = this->m_Reader.tellg();
+    this->m_Reader.seekg( 0, std::ios::beg );
+
+    const std::streamoff pointSize = OutputMeshType::PointDimension * sizeof( double );
+    if( fileSize < 0 || fileSize % pointSize != 0 )
+    {
+      std::ostringstream msg;
+      msg << "The size of the binary point file is not a multiple of "
+          << pointSize << " bytes (" << OutputMeshType::PointDimension << " doubles). "
+          << std::endl << "Filename: " << this->m_FileName
+          << std::endl;
+      MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+      throw e;
+    }
+
+    this->m_PointsAreIndices = false;
+    this->m_NumberOfPoints   = static_cast< unsigned long >( fileSize / pointSize );
+    return;
+  }
+
   this->m_Reader.open( this->m_FileName.c_str() );
 
   /** Read the first entry */
@@ -116,21 +152,71 @@ TransformixInputPointFileReader< TOutputMesh >
 
   OutputMeshPointer      output = this->GetOutput();
   PointsContainerPointer points = PointsContainerType::New();
+  if( this->m_NumberOfPoints > 0 )
+  {
+    points->Reserve( this->m_NumberOfPoints );
+  }
 
-  /** Read the file */
-  if( this->m_Reader.is_open() )
+  if( !this->m_Reader.is_open() )
+  {
+    std::ostringstream msg;
+    msg << "The file has unexpectedly been closed. "
+        << std::endl << "Filename: " << this->m_FileName
+        << std::endl;
+    MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+    throw e;
+  }
+
+  if( this->m_FileIsBinary )
   {
-    for( unsigned int i = 0; i < this->m_NumberOfPoints; ++i )
+    /** Read the binary file in blocks, to limit the size of the buffer. */
+    const unsigned long   pointsPerBlock = 65536;
+    std::vector< double > buffer( pointsPerBlock * dimension );
+    for( unsigned long i = 0; i < this->m_NumberOfPoints; i += pointsPerBlock )
     {
-      // read point from textfile
-      PointType point;
-      for( unsigned int j = 0; j < dimension; j++ )
+      const unsigned long numberOfPointsInBlock
+        = std::min( pointsPerBlock, this->m_NumberOfPoints - i );
+      this->m_Reader.read( reinterpret_cast< char * >( &buffer[ 0 ] ),
+        numberOfPointsInBlock * dimension * sizeof( double ) );
+      if( !this->m_Reader )
+      {
+        std::ostringstream msg;
+        msg << "Error while reading the binary point file. "
+            << std::endl << "Filename: " << this->m_FileName
+            << std::endl;
+        MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+        throw e;
+      }
+
+      for( unsigned long k = 0; k < numberOfPointsInBlock; ++k )
       {
-        if( !this->m_Reader.eof() )
+        PointType & point = points->ElementAt( i + k );
+        for( unsigned int j = 0; j < dimension; j++ )
         {
-          this->m_Reader >> point[ j ];
+          point[ j ] = static_cast< typename PointType::ValueType >( buffer[ k * dimension + j ] );
         }
-        else
+      }
+    }
+  }
+  else
+  {
+    /** Read the rest of the text file at once and parse it with strtod,
+     * which is much faster than reading value by value with operator>>.
+     */
+    std::ostringstream contents;
+    contents << this->m_Reader.rdbuf();
+    const std::string text     = contents.str();
+    const char *      position = text.c_str();
+    char *            end      = nullptr;
+
+    for( unsigned long i = 0; i < this->m_NumberOfPoints; ++i )
+    {
+      // read point from textfile
+      PointType & point = points->ElementAt( i );
+      for( unsigned int j = 0; j < dimension; j++ )
+      {
+        const double value = std::strtod( position, &end );
+        if( end == position )
         {
           std::ostringstream msg;
           msg << "The file is not large enough. "
@@ -138,22 +224,12 @@ TransformixInputPointFileReader< TOutputMesh >
               << std::endl;
           MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
           throw e;
-          return;
         }
+        point[ j ] = static_cast< typename PointType::ValueType >( value );
+        position   = end;
       }
-      points->push_back( point );
     }
   }
-  else
-  {
-    std::ostringstream msg;
-    msg << "The file has unexpectedly been closed. "
-        << std::endl << "Filename: " << this->m_FileName
-        << std::endl;
-    MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
-    throw e;
-    return;
-  }
 
   /** set in output */
   output->Initialize();
@@ -0,0 +1,253 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __xoutasync_cxx
+#define __xoutasync_cxx
+
+#include "xoutasync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace xoutlibrary
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+asyncstreambuf::asyncstreambuf( std::ostream & target, std::size_t capacity ) :
+  m_Target( target ),
+  m_TargetStartPosition( target.tellp() ),
+  m_PutCount( 0 ),
+  m_TakeCount( 0 ),
+  m_Stop( false )
+{
+  std::size_t size = 1;
+  while( size < capacity )
+  {
+    size <<= 1;
+  }
+  this->m_RingBuffer.resize( size );
+  this->m_Mask = size - 1;
+  this->m_PutLock.clear();
+
+  /** No put area is used: all characters go through xsputn and overflow. */
+  this->setp( nullptr, nullptr );
+
+  this->m_Thread = std::thread( &asyncstreambuf::WriteToTarget, this );
+
+} // end Constructor
+
+
+/**
+ * ********************* Destructor *****************************
+ */
+
+asyncstreambuf::~asyncstreambuf()
+{
+  {
+    std::lock_guard< std::mutex > lock( this->m_StopMutex );
+    this->m_Stop = true;
+  }
+  this->m_StopCondition.notify_one();
+  this->m_Thread.join();
+
+} // end Destructor
+
+
+/**
+ * ********************* xsputn *********************************
+ */
+
+std::streamsize
+asyncstreambuf::xsputn( const char_type * s, std::streamsize n )
+{
+  if( n > 0 )
+  {
+    this->Put( s, static_cast< std::size_t >( n ) );
+  }
+  return n;
+
+} // end xsputn()
+
+
+/**
+ * ********************* overflow *******************************
+ */
+
+asyncstreambuf::int_type
+asyncstreambuf::overflow( int_type c )
+{
+  if( traits_type::eq_int_type( c, traits_type::eof() ) )
+  {
+    return traits_type::not_eof( c );
+  }
+
+  const char_type ch = traits_type::to_char_type( c );
+  this->Put( &ch, 1 );
+  return c;
+
+} // end overflow()
+
+
+/**
+ * ********************* seekoff ********************************
+ */
+
+asyncstreambuf::pos_type
+asyncstreambuf::seekoff( off_type off, std::ios_base::seekdir way,
+  std::ios_base::openmode which )
+{
+  if( off != 0 || way != std::ios_base::cur || which != std::ios_base::out
+    || this->m_TargetStartPosition == pos_type( off_type( -1 ) ) )
+  {
+    return pos_type( off_type( -1 ) );
+  }
+
+  /** The position that the target will have once everything is written. */
+  return this->m_TargetStartPosition
+    + static_cast< off_type >( this->m_PutCount.load( std::memory_order_acquire ) );
+
+} // end seekoff()
+
+
+/**
+ * ********************* Put ************************************
+ */
+
+void
+asyncstreambuf::Put( const char * s, std::size_t n )
+{
+  while( this->m_PutLock.test_and_set( std::memory_order_acquire ) )
+  {
+    std::this_thread::yield();
+  }
+
+  const std::size_t capacity = this->m_RingBuffer.size();
+  std::size_t       putCount = this->m_PutCount.load( std::memory_order_relaxed );
+  while( n > 0 )
+  {
+    /** Wait for room in the ring buffer, if it is full. */
+    const std::size_t available
+      = capacity - ( putCount - this->m_TakeCount.load( std::memory_order_acquire ) );
+    if( available == 0 )
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    /** Copy as much as fits, up to the end of the ring buffer. */
+    const std::size_t position = putCount & this->m_Mask;
+    const std::size_t count    = std::min( n, std::min( available, capacity - position ) );
+    std::memcpy( &this->m_RingBuffer[ position ], s, count );
+    putCount += count;
+    this->m_PutCount.store( putCount, std::memory_order_release );
+
+    s += count;
+    n -= count;
+  }
+
+  this->m_PutLock.clear( std::memory_order_release );
+
+} // end Put()
+
+
+/**
+ * ********************* WriteToTarget **************************
+ *
+ * Takes the characters from the ring buffer and writes them to the
+ * target. The target is flushed each time the ring buffer becomes empty.
+ * An idle thread sleeps increasingly longer, up to 20 ms, so that it
+ * hardly costs any CPU time, while the output is still written promptly.
+ */
+
+void
+asyncstreambuf::WriteToTarget( void )
+{
+  const std::size_t capacity     = this->m_RingBuffer.size();
+  const auto        maxSleepTime = std::chrono::microseconds( 20000 );
+  auto              sleepTime    = std::chrono::microseconds( 100 );
+  bool              flushed      = true;
+
+  for( ;; )
+  {
+    /** Read the stop flag before the put count, so that all characters
+     * that were put before stopping are written.
+     */
+    const bool        stop      = this->m_Stop.load( std::memory_order_acquire );
+    const std::size_t putCount  = this->m_PutCount.load( std::memory_order_acquire );
+    const std::size_t takeCount = this->m_TakeCount.load( std::memory_order_relaxed );
+
+    if( putCount != takeCount )
+    {
+      const std::size_t position = takeCount & this->m_Mask;
+      const std::size_t count    = std::min( putCount - takeCount, capacity - position );
+      this->m_Target.write( &this->m_RingBuffer[ position ], static_cast< std::streamsize >( count ) );
+      this->m_TakeCount.store( takeCount + count, std::memory_order_release );
+      flushed   = false;
+      sleepTime = std::chrono::microseconds( 100 );
+      continue;
+    }
+
+    if( !flushed )
+    {
+      this->m_Target.flush();
+      flushed = true;
+    }
+    if( stop )
+    {
+      return;
+    }
+
+    std::unique_lock< std::mutex > lock( this->m_StopMutex );
+    this->m_StopCondition.wait_for( lock, sleepTime, [ this ] { return this->m_Stop.load(); } );
+    sleepTime = std::min( 2 * sleepTime, maxSleepTime );
+  }
+
+} // end WriteToTarget()
+
+
+/**
+ * ********************* asyncostream ***************************
+ */
+
+asyncostream::asyncostream( std::ostream & target ) :
+  std::ostream( nullptr ),
+  m_StreamBuffer( target )
+{
+  this->rdbuf( &this->m_StreamBuffer );
+
+} // end Constructor
+
+
+/**
+ * ********************* ~asyncostream **************************
+ */
+
+asyncostream::~asyncostream()
+{
+  /** The stream buffer writes the remaining output when it is destructed. */
+  this->rdbuf( nullptr );
+
+} // end Destructor
+
+
+} // end namespace xoutlibrary
+
+#endif // end #ifndef __xoutasync_cxx
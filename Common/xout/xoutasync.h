@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __xoutasync_h
+#define __xoutasync_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <ios>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace xoutlibrary
+{
+
+/**
+ * \class asyncstreambuf
+ * \brief A stream buffer that writes to another stream in a background thread.
+ *
+ * The characters that are written to this stream buffer are copied into a
+ * ring buffer. A background thread takes them from the ring buffer and
+ * writes them to the target stream, which it flushes whenever the ring
+ * buffer has become empty. Writing and flushing (e.g. by std::endl) thus
+ * only cost a copy in the writing thread; the formatting and the I/O of the
+ * target stream are done by the background thread. The characters reach the
+ * target unchanged and in order.
+ *
+ * The ring buffer is lock-free between the writing threads and the
+ * background thread. Writing threads are serialized by a spin lock, which
+ * is only contended when several threads log at the same time. When the ring
+ * buffer is full, the writing thread waits until there is room again, so
+ * no output is lost.
+ *
+ * The destructor waits until all characters are written to the target and
+ * flushes it. The target must therefore outlive this object, and must not
+ * be used directly while this object exists.
+ *
+ * \ingroup xout
+ */
+
+class asyncstreambuf : public std::streambuf
+{
+public:
+
+  /** Constructor. The capacity of the ring buffer is rounded up to a power of two. */
+  explicit asyncstreambuf( std::ostream & target, std::size_t capacity = 1 << 20 );
+
+  /** Destructor. Writes the remaining characters and stops the background thread. */
+  ~asyncstreambuf() override;
+
+protected:
+
+  /** Copy characters into the ring buffer. */
+  std::streamsize xsputn( const char_type * s, std::streamsize n ) override;
+
+  int_type overflow( int_type c ) override;
+
+  /** Flushing is done by the background thread, so there is nothing to do here. */
+  int sync() override { return 0; }
+
+  /** Only supports querying the current position, i.e. tellp(). Returns -1
+   * if the target does not support that either, e.g. a console.
+   */
+  pos_type seekoff( off_type off, std::ios_base::seekdir way,
+    std::ios_base::openmode which = std::ios_base::out ) override;
+
+private:
+
+  asyncstreambuf( const asyncstreambuf & );    // purposely not implemented
+  void operator=( const asyncstreambuf & );    // purposely not implemented
+
+  /** Copy n characters into the ring buffer. */
+  void Put( const char * s, std::size_t n );
+
+  /** The loop of the background thread. */
+  void WriteToTarget( void );
+
+  std::ostream &      m_Target;
+  pos_type            m_TargetStartPosition;
+  std::vector< char > m_RingBuffer;
+  std::size_t         m_Mask;
+
+  /** The total number of characters that have been put into, and taken
+   * from the ring buffer. Their difference is the number of characters
+   * that still have to be written to the target.
+   */
+  std::atomic< std::size_t > m_PutCount;
+  std::atomic< std::size_t > m_TakeCount;
+
+  /** Serializes the writing threads. */
+  std::atomic_flag m_PutLock;
+
+  /** Used to stop the background thread. The condition variable only wakes
+   * up a background thread that is idle; the writing threads do not use it.
+   */
+  std::atomic< bool >     m_Stop;
+  std::mutex              m_StopMutex;
+  std::condition_variable m_StopCondition;
+
+  std::thread m_Thread;
+
+};
+
+/**
+ * \class asyncostream
+ * \brief An output stream that writes to another stream in a background thread.
+ *
+ * An std::ostream with an asyncstreambuf, which can be passed as output to
+ * the xout objects instead of the target stream itself. See asyncstreambuf.
+ *
+ * \ingroup xout
+ */
+
+class asyncostream : public std::ostream
+{
+public:
+
+  explicit asyncostream( std::ostream & target );
+
+  ~asyncostream() override;
+
+private:
+
+  asyncostream( const asyncostream & );   // purposely not implemented
+  void operator=( const asyncostream & ); // purposely not implemented
+
+  asyncstreambuf m_StreamBuffer;
+
+};
+
+} // end namespace xoutlibrary
+
+#endif // end #ifndef __xoutasync_h
@@ -23,10 +23,15 @@
 namespace xoutlibrary
 {
 static xoutbase_type * local_xout = 0;
+static thread_local xoutbase_type * thread_xout = 0;
 
 xoutbase_type &
 get_xout( void )
 {
+  if( thread_xout != 0 )
+  {
+    return *thread_xout;
+  }
   return *local_xout;
 }
 
@@ -37,8 +42,23 @@ set_xout( xoutbase_type * arg )
   local_xout = arg;
 }
 
+
+void
+set_thread_xout( xoutbase_type * arg )
+{
+  thread_xout = arg;
+}
+
+
+xoutbase_type *
+get_thread_xout( void )
+{
+  return thread_xout;
+}
+
+
 bool xout_valid() {
-  return local_xout != 0;
+  return thread_xout != 0 || local_xout != 0;
 }
 
 
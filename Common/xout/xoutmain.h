@@ -23,6 +23,7 @@
 #include "xoutsimple.h"
 #include "xoutrow.h"
 #include "xoutcell.h"
+#include "xoutasync.h"
 
 /** Define a namespace alias. */
 namespace xl = xoutlibrary;
@@ -41,6 +42,15 @@ xoutbase_type & get_xout( void );
 
 void set_xout( xoutbase_type * arg );
 
+/** An xout that is only used by the calling thread, instead of the one
+ * that is set by set_xout(). This allows several registrations to run
+ * concurrently in one process, each logging to its own destinations.
+ * Pass 0 to use the global xout again.
+ */
+void set_thread_xout( xoutbase_type * arg );
+
+xoutbase_type * get_thread_xout( void );
+
 bool xout_valid();
 
 } // end namespace xoutlibrary
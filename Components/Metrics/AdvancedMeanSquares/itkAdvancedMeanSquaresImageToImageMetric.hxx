@@ -885,7 +885,7 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 
   /** Initialize some variables. */
   this->m_NumberOfPixelsCounted = 0;
-  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  RandomGeneratorType::Pointer randomGenerator = this->m_RandomGenerator;
   randomGenerator->Initialize();
 
   /** Array that stores dM(x)/dmu, and the sparse jacobian+indices. */
@@ -107,7 +107,7 @@ PCAMetric< TFixedImage, TMovingImage >
   numbers.clear();
 
   /** Initialize random number generator. */
-  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+  Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator = this->m_RandomGenerator;
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -763,6 +763,10 @@ PCAMetric< TFixedImage, TMovingImage >
   std::vector< FixedImagePointType > SamplesOK;
   MatrixType                         datablock( nrOfSamplesPerThreads, this->m_G );
 
+  /** Variables to store the points of one sample position over time. */
+  std::vector< FixedImagePointType >  fixedPoints( this->m_G );
+  std::vector< MovingImagePointType > mappedPoints;
+
   unsigned int pixelIndex = 0;
   for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
   {
@@ -773,28 +777,28 @@ PCAMetric< TFixedImage, TMovingImage >
     FixedImageContinuousIndexType voxelCoord;
     this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
 
+    /** Set fixed point's last dimension to all t, transform them back to
+     * world coordinates, and transform them in one call.
+     */
+    for( unsigned int d = 0; d < this->m_G; ++d )
+    {
+      voxelCoord[ this->m_LastDimIndex ] = d;
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoints[ d ] );
+    }
+    fixedPoint = fixedPoints[ this->m_G - 1 ];
+    this->TransformPoints( fixedPoints, mappedPoints );
+
     unsigned int numSamplesOk = 0;
 
     /** Loop over t */
     for( unsigned int d = 0; d < this->m_G; ++d )
     {
       /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
+      RealType                     movingImageValue;
+      const MovingImagePointType & mappedPoint = mappedPoints[ d ];
 
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ this->m_LastDimIndex ] = d;
-
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
       /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
+      bool sampleOk = this->IsInsideMovingMask( mappedPoint );
 
       if( sampleOk )
 
@@ -988,12 +992,15 @@ PCAMetric< TFixedImage, TMovingImage >
 
   /** Initialize some variables. */
   RealType                  movingImageValue;
-  MovingImagePointType      mappedPoint;
   MovingImageDerivativeType movingImageDerivative;
 
-  TransformJacobianType      jacobian;
-  DerivativeType             imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-  NonZeroJacobianIndicesType nzjis( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+  DerivativeType imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+
+  /** Variables to store the points and Jacobians of one sample position over time. */
+  std::vector< FixedImagePointType >        fixedPoints( this->m_G );
+  std::vector< MovingImagePointType >       mappedPoints;
+  std::vector< TransformJacobianType >      jacobians;
+  std::vector< NonZeroJacobianIndicesType > nzjiss;
 
   unsigned int dummyindex = 0;
   /** Second loop over fixed image samples. */
@@ -1008,24 +1015,28 @@ PCAMetric< TFixedImage, TMovingImage >
     FixedImageContinuousIndexType voxelCoord;
     this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
 
+    /** Set fixed point's last dimension to all t, transform them back to
+     * world coordinates, and transform them and get the TransformJacobians
+     * dT/dmu in one call.
+     */
     for( unsigned int d = 0; d < this->m_G; ++d )
     {
-      /** Set fixed point's last dimension to lastDimPosition. */
       voxelCoord[ this->m_LastDimIndex ] = d;
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoints[ d ] );
+    }
+    this->TransformPoints( fixedPoints, mappedPoints );
+    this->EvaluateTransformJacobians( fixedPoints, jacobians, nzjiss );
 
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-      this->TransformPoint( fixedPoint, mappedPoint );
+    for( unsigned int d = 0; d < this->m_G; ++d )
+    {
+      const NonZeroJacobianIndicesType & nzjis = nzjiss[ d ];
 
       this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, &movingImageDerivative );
-
-      /** Get the TransformJacobian dT/dmu */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzjis );
+        mappedPoints[ d ], movingImageValue, &movingImageDerivative );
 
       /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
       this->EvaluateTransformJacobianInnerProduct(
-        jacobian, movingImageDerivative, imageJacobian );
+        jacobians[ d ], movingImageDerivative, imageJacobian );
 
       /** build metric derivative components */
       for( unsigned int p = 0; p < nzjis.size(); ++p )
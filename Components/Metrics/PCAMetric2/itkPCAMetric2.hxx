@@ -93,7 +93,7 @@ PCAMetric2< TFixedImage, TMovingImage >
 
   /** Initialize random number generator. */
   Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator
-    = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+    = this->m_RandomGenerator;
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -138,7 +138,7 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
   /** Initialize random number generator. */
   Statistics::MersenneTwisterRandomVariateGenerator::Pointer randomGenerator
-    = Statistics::MersenneTwisterRandomVariateGenerator::GetInstance();
+    = this->m_RandomGenerator;
 
   /** Sample additional at fixed timepoint. */
   for( unsigned int i = 0; i < m_NumAdditionalSamplesFixed; ++i )
@@ -247,6 +247,10 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     }
   }
 
+  /** Variables to store the points of one sample position over time. */
+  std::vector< FixedImagePointType >  fixedPoints;
+  std::vector< MovingImagePointType > mappedPoints;
+
   /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
   for( fiter = fbegin; fiter != fend; ++fiter )
   {
@@ -263,31 +267,32 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     FixedImageContinuousIndexType voxelCoord;
     this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
 
-    /** Loop over the slowest varying dimension. */
-    float              sumValues               = 0.0;
-    float              sumValuesSquared        = 0.0;
-    unsigned int       numSamplesOk            = 0;
+    /** Set fixed point's last dimension to all lastDimPositions and
+     * transform them back to world coordinates.
+     */
     const unsigned int realNumLastDimPositions = lastDimPositions.size();
+    fixedPoints.resize( realNumLastDimPositions );
     for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
     {
-      /** Initialize some variables. */
-      RealType             movingImageValue;
-      MovingImagePointType mappedPoint;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
       voxelCoord[ lastDim ] = lastDimPositions[ d ];
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoints[ d ] );
+    }
 
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
+    /** Transform the points of all time points in one call. */
+    this->TransformPoints( fixedPoints, mappedPoints );
 
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    /** Loop over the slowest varying dimension. */
+    float        sumValues        = 0.0;
+    float        sumValuesSquared = 0.0;
+    unsigned int numSamplesOk     = 0;
+    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+    {
+      /** Initialize some variables. */
+      RealType                     movingImageValue;
+      const MovingImagePointType & mappedPoint = mappedPoints[ d ];
 
       /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
+      bool sampleOk = this->IsInsideMovingMask( mappedPoint );
 
       /** Compute the moving image value and check if the point is
        * inside the moving image buffer.
@@ -416,8 +421,7 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   }
 
   /** Create variables to store intermediate results in. */
-  TransformJacobianType jacobian;
-  DerivativeType        imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+  DerivativeType imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
 
   /** Get real last dim samples. */
   const unsigned int realNumLastDimPositions
@@ -432,6 +436,15 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
   std::vector< RealType >       MT( realNumLastDimPositions );
   std::vector< DerivativeType > dMTdmu( realNumLastDimPositions );
 
+  /** Variables to store the points and Jacobians of one sample position over time. */
+  std::vector< FixedImagePointType >        fixedPoints( realNumLastDimPositions );
+  std::vector< MovingImagePointType >       mappedPoints;
+  std::vector< MovingImageDerivativeType >  movingImageDerivatives( realNumLastDimPositions );
+  std::vector< FixedImagePointType >        validFixedPoints;
+  std::vector< unsigned int >               validPositions;
+  std::vector< TransformJacobianType >      jacobians;
+  std::vector< NonZeroJacobianIndicesType > validNzjis;
+
   /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
   for( fiter = fbegin; fiter != fend; ++fiter )
   {
@@ -456,33 +469,33 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     float        sumValuesSquared = 0.0;
     unsigned int numSamplesOk     = 0;
 
-    /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
+    /** Set fixed point's last dimension to all lastDimPositions, transform
+     * them back to world coordinates, and transform them in one call.
+     */
     for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
     {
-      /** Initialize some variables. */
-      RealType                  movingImageValue;
-      MovingImagePointType      mappedPoint;
-      MovingImageDerivativeType movingImageDerivative;
-
-      /** Set fixed point's last dimension to lastDimPosition. */
       voxelCoord[ lastDim ] = lastDimPositions[ d ];
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoints[ d ] );
+    }
+    this->TransformPoints( fixedPoints, mappedPoints );
+
+    /** First loop over t: compute M(T(x,t)) and dM/dx, and store. */
+    validFixedPoints.clear();
+    validPositions.clear();
+    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+    {
+      /** Initialize some variables. */
+      RealType movingImageValue;
 
       /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
+      bool sampleOk = this->IsInsideMovingMask( mappedPoints[ d ] );
 
       /** Compute the moving image value and check if the point is
       * inside the moving image buffer. */
       if( sampleOk )
       {
         sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, &movingImageDerivative );
+          mappedPoints[ d ], movingImageValue, &movingImageDerivatives[ d ] );
       }
 
       if( sampleOk )
@@ -492,16 +505,10 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
         sumValues        += movingImageValue;
         sumValuesSquared += movingImageValue * movingImageValue;
 
-        /** Get the TransformJacobian dT/dmu. */
-        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzjis[ d ] );
-
-        /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
-        this->EvaluateTransformJacobianInnerProduct(
-          jacobian, movingImageDerivative, imageJacobian );
-
         /** Store values. */
-        MT[ d ]     = movingImageValue;
-        dMTdmu[ d ] = imageJacobian;
+        MT[ d ] = movingImageValue;
+        validFixedPoints.push_back( fixedPoints[ d ] );
+        validPositions.push_back( d );
       }
       else
       {
@@ -511,6 +518,19 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
       } // end if sampleOk
     }
 
+    /** Get the TransformJacobians dT/dmu of all valid time points in one call. */
+    this->EvaluateTransformJacobians( validFixedPoints, jacobians, validNzjis );
+
+    /** Compute the innerproducts (dM/dx)^T (dT/dmu), dM(T(x,t))/dmu, and store. */
+    for( unsigned int i = 0; i < validPositions.size(); ++i )
+    {
+      const unsigned int d = validPositions[ i ];
+      this->EvaluateTransformJacobianInnerProduct(
+        jacobians[ i ], movingImageDerivatives[ d ], imageJacobian );
+      dMTdmu[ d ] = imageJacobian;
+      nzjis[ d ].swap( validNzjis[ i ] );
+    }
+
     if( numSamplesOk > 0 )
     {
       this->m_NumberOfPixelsCounted++;
@@ -76,6 +76,7 @@ namespace elastix
  *    Default/recommended value: 500. When you are in a hurry, you may go down to 250 for example.
  *    When you have plenty of time, and want to be absolutely sure of the best results, a setting
  *    of 2000 is reasonable. In general, 500 gives satisfactory results.
+ * \parameter ConvergenceWindowSize, ConvergenceRelativeTolerance, ConvergenceConfidenceFactor: see OptimizerBase.
  * \parameter MaximumNumberOfSamplingAttempts: The maximum number of sampling attempts. Sometimes
  *   not enough corresponding samples can be drawn, upon which an exception is thrown. With this
  *   parameter it is possible to try to draw another set of samples. \n
@@ -244,6 +245,10 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Get/Set the maximum number of iterations of the current resolution. */
+  elxMaximumNumberOfIterationsPublicMacro( NumberOfIterations );
+
+
   /** Check if any scales are set, and set the UseScales flag on or off;
    * after that call the superclass' implementation.
    */
@@ -434,6 +439,9 @@ private:
   bool m_UseNoiseCompensation;
   bool m_OriginalButSigmoidToDefault;
 
+  /** The number of threads of the parameter update, as set by -threads. */
+  itk::ThreadIdType m_NumberOfUpdateThreads;
+
 };
 
 } // end namespace elastix
@@ -29,6 +29,7 @@
 #include <utility>
 #include "itkAdvancedImageToImageMetric.h"
 #include "itkTimeProbe.h"
+#include "itkParameterUpdateKernels.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -69,6 +70,7 @@ AdaGrad< TElastix >
   this->m_AdvancedTransform = 0;
 
   this->m_UseNoiseCompensation = true;
+  this->m_NumberOfUpdateThreads = 0;
 
 } // Constructor
 
@@ -82,6 +84,9 @@ void
 AdaGrad< TElastix >
 ::BeforeRegistration( void )
 {
+  /** Use the random generator of this registration for the perturbations. */
+  this->m_RandomGenerator = this->GetElastix()->GetRandomGenerator();
+
   /** Add the target cell "stepsize" to xout["iteration"]. */
   xout[ "iteration" ].AddTargetCell( "2:Metric" );
   xout[ "iteration" ].AddTargetCell( "3a:Time" );
@@ -123,6 +128,17 @@ AdaGrad< TElastix >
     "MaximumNumberOfIterations", this->GetComponentLabel(), level, 0 );
   this->SetNumberOfIterations( maximumNumberOfIterations );
 
+  /** Set the number of threads of the parameter update, 0 meaning the default. */
+  this->m_NumberOfUpdateThreads = 0;
+  std::string tmp = this->m_Configuration->GetCommandLineArgument( "-threads" );
+  if( tmp != "" )
+  {
+    this->m_NumberOfUpdateThreads = atoi( tmp.c_str() );
+  }
+
+  /** Set the parameters of the convergence monitor. */
+  this->ReadConvergenceMonitorParameters( this->GetModifiableConvergenceMonitor() );
+
   /** Set the gain parameter A. */
   double A = 20.0;
   this->GetConfiguration()->ReadParameter( A,
@@ -350,7 +366,8 @@ AdaGrad< TElastix >
    * typedef enum {
    *   MaximumNumberOfIterations,
    *   MetricError,
-   *   MinimumStepSize } StopConditionType;
+   *   MinimumStepSize,
+   *   StochasticConvergence } StopConditionType;
    */
   std::string stopcondition;
 
@@ -368,6 +385,10 @@ AdaGrad< TElastix >
       stopcondition = "The minimum step length has been reached";
       break;
 
+    case StochasticConvergence:
+      stopcondition = this->GetConvergenceMonitorStopCondition( this->GetConvergenceMonitor() );
+      break;
+
     default:
       stopcondition = "Unknown";
       break;
@@ -448,9 +469,6 @@ void
 AdaGrad< TElastix >
 ::AdvanceOneStep( void )
 {
-  /** Get space dimension. */
-  const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Compute and set the learning rate. */
   double lamda = this->GetParam_a() / (1.0 + this->Superclass1::GetCurrentTime() / this->GetParam_A());
   this->SetLearningRate( lamda );
@@ -463,16 +481,14 @@ AdaGrad< TElastix >
   /** Get a reference to the current position. */
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
-  /** Update the new position. */
+  /** Update the sum of squared gradients, the search direction
+   * and the new position, in a single pass.
+   */
   const double eta = 1e-14;
   const double lamda2 = lamda * this->m_NoiseFactor;
-//  const double lamda2 = 0.01;
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    this->m_PreconditionVector[ j ] += this->m_Gradient[ j ] * this->m_Gradient[ j ];
-    searchDirection[ j ] = this->m_Gradient[ j ] / ( std::sqrt( this->m_PreconditionVector[ j ] + eta ) );
-    newPosition[ j ] = currentPosition[ j ] - lamda2 * searchDirection[ j ];
-  }
+  itk::ParameterUpdateKernels::AdaGradStep( newPosition, currentPosition,
+    this->m_PreconditionVector, this->m_Gradient, searchDirection, lamda2, eta,
+    this->m_NumberOfUpdateThreads );
 
   this->Superclass1::UpdateCurrentTime();
   this->InvokeEvent( itk::IterationEvent() );
@@ -596,6 +612,7 @@ AdaGrad< TElastix >
       this->GetElastix()->GetElxMetricBase( m )->GetAdvancedMetricImageSampler();
     //preconditionSamplers[ m ] = ImageRandomCoordinateSamplerType::New();
     preconditionSamplers[ m ] = ImageRandomSamplerType::New();
+    preconditionSamplers[ m ]->SetRandomGenerator( this->m_RandomGenerator );
     preconditionSamplers[ m ]->SetInput( sampler->GetInput() );
     preconditionSamplers[ m ]->SetInputImageRegion( sampler->GetInputImageRegion() );
     preconditionSamplers[ m ]->SetMask( sampler->GetMask() );
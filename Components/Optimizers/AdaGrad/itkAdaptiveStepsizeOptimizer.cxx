@@ -21,6 +21,7 @@
 #include "itkAdaptiveStepsizeOptimizer.h"
 
 #include "vnl/vnl_math.h"
+#include "itkParameterUpdateKernels.h"
 #include "itkSigmoidImageFilter.h"
 
 namespace itk
@@ -66,15 +67,17 @@ AdaptiveStepsizeOptimizer
         * std::log( -this->GetSigmoidMax() / this->GetSigmoidMin() );
       sigmoid.SetBeta( beta );
 
-      /** Formula (2) in Cruz */
-      const double inprod = inner_product(
-        this->m_PreviousSearchDirection, this->GetGradient() );
+      /** Formula (2) in Cruz, and save for the next iteration. */
+      const double inprod = ParameterUpdateKernels::InnerProductAndCopy(
+        this->m_PreviousSearchDirection, this->GetGradient(), this->GetSearchDirection() );
       this->m_CurrentTime += sigmoid( -inprod );
       this->m_CurrentTime  = std::max( 0.0, this->m_CurrentTime );
     }
-
-    /** Save for next iteration */
-    this->m_PreviousSearchDirection = this->GetSearchDirection();
+    else
+    {
+      /** Save for next iteration */
+      this->m_PreviousSearchDirection = this->GetSearchDirection();
+    }
   }
   /** Decaying or constant step size. */
   else if ( this->m_StepSizeStrategy == "Decaying")
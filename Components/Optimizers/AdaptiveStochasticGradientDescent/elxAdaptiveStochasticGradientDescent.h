@@ -23,6 +23,7 @@
 
 #include "itkComputeJacobianTerms.h"            // For  ASGD step size
 #include "itkComputeDisplacementDistribution.h" // For FASGD step size
+#include "itkParameterEstimateCache.h"
 #include "elxProgressCommand.h"
 #include "itkAdvancedTransform.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
@@ -73,6 +74,7 @@ namespace elastix
  *    Default/recommended value: 500. When you are in a hurry, you may go down to 250 for example.
  *    When you have plenty of time, and want to be absolutely sure of the best results, a setting
  *    of 2000 is reasonable. In general, 500 gives satisfactory results.
+ * \parameter ConvergenceWindowSize, ConvergenceRelativeTolerance, ConvergenceConfidenceFactor: see OptimizerBase.
  * \parameter MaximumNumberOfSamplingAttempts: The maximum number of sampling attempts. Sometimes
  *   not enough corresponding samples can be drawn, upon which an exception is thrown. With this
  *   parameter it is possible to try to draw another set of samples. \n
@@ -182,6 +184,16 @@ namespace elastix
  *   The parameter can be specified for each resolution, or for all resolutions at once.\n
  *   example: <tt>(NoiseCompensation "true")</tt>\n
  *   Default/recommended: true.
+ * \parameter AutomaticParameterEstimationCacheFileName: A file in which the automatically
+ *   estimated parameters are stored, and from which they are reused by later registrations,
+ *   instead of estimating them again. An entry is only reused when the parameter map, the
+ *   geometry of the fixed and moving image, the number of transform parameters and the
+ *   resolution are the same, so this is meant for registering many similar image pairs
+ *   with the same parameter map. Note that the image contents are not compared.
+ *   The file may be shared by several elastix processes.\n
+ *   example: <tt>(AutomaticParameterEstimationCacheFileName "/data/cache/asgd.txt")</tt>\n
+ *   Default: "", which means that no cache is used.
+ *   The parameter has only influence when AutomaticParameterEstimation is used.
  *
  * \todo: this class contains a lot of functional code, which actually does not belong here.
  *
@@ -247,6 +259,10 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Get/Set the maximum number of iterations of the current resolution. */
+  elxMaximumNumberOfIterationsPublicMacro( NumberOfIterations );
+
+
   /** Check if any scales are set, and set the UseScales flag on or off;
    * after that call the superclass' implementation.
    */
@@ -321,6 +337,8 @@ protected:
   typedef typename ImageSampleContainerType::Pointer ImageSampleContainerPointer;
 
   /** Other protected typedefs */
+  typedef itk::ParameterEstimateCache                            ParameterEstimateCacheType;
+  typedef ParameterEstimateCacheType::Pointer                    ParameterEstimateCachePointer;
   typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
   typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
   typedef ProgressCommand                                        ProgressCommandType;
@@ -370,6 +388,11 @@ protected:
    */
   virtual void AutomaticParameterEstimation( void );
 
+  /** Compute the key of the current resolution in the parameter estimate cache,
+   * from the parameter map, the image geometry and the resolution level.
+   */
+  virtual std::string GetParameterEstimateCacheKey( void ) const;
+
   /** Original estimation method to get the reasonable values for the parameters
    * SP_a, SP_alpha (=1), SigmoidMin, SigmoidMax (=1), and
    * SigmoidScale.
@@ -425,6 +448,10 @@ private:
   bool m_UseNoiseCompensation;
   bool m_OriginalButSigmoidToDefault;
 
+  /** The cache of automatically estimated parameters, and the time saved by it. */
+  ParameterEstimateCachePointer m_ParameterEstimateCache;
+  double                        m_ParameterEstimateCacheTimeSaved;
+
 };
 
 } // end namespace elastix
@@ -60,6 +60,9 @@ AdaptiveStochasticGradientDescent< TElastix >
   this->m_UseNoiseCompensation        = true;
   this->m_OriginalButSigmoidToDefault = false;
 
+  this->m_ParameterEstimateCache          = nullptr;
+  this->m_ParameterEstimateCacheTimeSaved = 0.0;
+
 } // Constructor
 
 
@@ -72,6 +75,9 @@ void
 AdaptiveStochasticGradientDescent< TElastix >
 ::BeforeRegistration( void )
 {
+  /** Use the random generator of this registration for the perturbations. */
+  this->m_RandomGenerator = this->GetElastix()->GetRandomGenerator();
+
   /** Add the target cell "stepsize" to xout["iteration"]. */
   xout[ "iteration" ].AddTargetCell( "2:Metric" );
   xout[ "iteration" ].AddTargetCell( "3a:Time" );
@@ -86,6 +92,22 @@ AdaptiveStochasticGradientDescent< TElastix >
 
   this->m_SettingsVector.clear();
 
+  /** Read the cache of automatically estimated parameters, if desired. */
+  std::string cacheFileName = "";
+  this->GetConfiguration()->ReadParameter( cacheFileName,
+    "AutomaticParameterEstimationCacheFileName", this->GetComponentLabel(), 0, 0, false );
+  this->m_ParameterEstimateCache          = nullptr;
+  this->m_ParameterEstimateCacheTimeSaved = 0.0;
+  if( !cacheFileName.empty() )
+  {
+    this->m_ParameterEstimateCache = ParameterEstimateCacheType::New();
+    this->m_ParameterEstimateCache->SetFileName( cacheFileName );
+    const std::size_t numberOfEntries = this->m_ParameterEstimateCache->ReadFile();
+    elxout << "Read " << numberOfEntries
+           << " cached automatic parameter estimates from "
+           << cacheFileName << std::endl;
+  }
+
 } // end BeforeRegistration()
 
 
@@ -111,6 +133,9 @@ AdaptiveStochasticGradientDescent< TElastix >
     "MaximumNumberOfIterations", this->GetComponentLabel(), level, 0 );
   this->SetNumberOfIterations( maximumNumberOfIterations );
 
+  /** Set the parameters of the convergence monitor. */
+  this->ReadConvergenceMonitorParameters( this->GetModifiableConvergenceMonitor() );
+
   /** Set the gain parameter A. */
   double A = 20.0;
   this->GetConfiguration()->ReadParameter( A,
@@ -324,7 +349,8 @@ AdaptiveStochasticGradientDescent< TElastix >
    * typedef enum {
    *   MaximumNumberOfIterations,
    *   MetricError,
-   *   MinimumStepSize } StopConditionType;
+   *   MinimumStepSize,
+   *   StochasticConvergence } StopConditionType;
    */
   std::string stopcondition;
 
@@ -342,6 +368,10 @@ AdaptiveStochasticGradientDescent< TElastix >
       stopcondition = "The minimum step length has been reached";
       break;
 
+    case StochasticConvergence:
+      stopcondition = this->GetConvergenceMonitorStopCondition( this->GetConvergenceMonitor() );
+      break;
+
     default:
       stopcondition = "Unknown";
       break;
@@ -392,6 +422,14 @@ AdaptiveStochasticGradientDescent< TElastix >
     << " for all resolutions:" << std::endl;
   this->PrintSettingsVector( this->m_SettingsVector );
 
+  /** Report the time saved by the parameter estimate cache. */
+  if( this->m_ParameterEstimateCache.IsNotNull() )
+  {
+    elxout << "Reusing cached automatic parameter estimates saved approximately "
+           << this->ConvertSecondsToDHMS( this->m_ParameterEstimateCacheTimeSaved, 2 )
+           << std::endl;
+  }
+
 } // end AfterRegistration()
 
 
@@ -494,6 +532,35 @@ void
 AdaptiveStochasticGradientDescent< TElastix >
 ::AutomaticParameterEstimation( void )
 {
+  /** Reuse the estimates of an earlier registration of similar images, if available.
+   * The values are a, A, alpha, fmax, fmin, omega and the maximum step length.
+   * A and the maximum step length are user input, which are checked for safety.
+   */
+  std::string                          cacheKey = "";
+  ParameterEstimateCacheType::ValuesType cachedValues;
+  if( this->m_ParameterEstimateCache.IsNotNull() )
+  {
+    cacheKey = this->GetParameterEstimateCacheKey();
+    double estimationTime = 0.0;
+    if( this->m_ParameterEstimateCache->GetEntry( cacheKey, cachedValues, estimationTime )
+      && cachedValues.size() == 7
+      && cachedValues[ 1 ] == this->GetParam_A()
+      && cachedValues[ 6 ] == this->GetMaximumStepLength() )
+    {
+      this->SetParam_a( cachedValues[ 0 ] );
+      this->SetParam_alpha( cachedValues[ 2 ] );
+      this->SetSigmoidMax( cachedValues[ 3 ] );
+      this->SetSigmoidMin( cachedValues[ 4 ] );
+      this->SetSigmoidScale( cachedValues[ 5 ] );
+
+      this->m_ParameterEstimateCacheTimeSaved += estimationTime;
+      elxout << "Reusing the cached automatic parameter estimates for "
+             << this->elxGetClassName() << ", which saves approximately "
+             << this->ConvertSecondsToDHMS( estimationTime, 2 ) << std::endl;
+      return;
+    }
+  }
+
   /** Total time. */
   itk::TimeProbe timer1;
   timer1.Start();
@@ -530,9 +597,76 @@ AdaptiveStochasticGradientDescent< TElastix >
   elxout << "Automatic parameter estimation took "
          << this->ConvertSecondsToDHMS( timer1.GetMean(), 2 ) << std::endl;
 
+  /** Store the estimates in the cache. */
+  if( this->m_ParameterEstimateCache.IsNotNull() )
+  {
+    cachedValues.resize( 7 );
+    cachedValues[ 0 ] = this->GetParam_a();
+    cachedValues[ 1 ] = this->GetParam_A();
+    cachedValues[ 2 ] = this->GetParam_alpha();
+    cachedValues[ 3 ] = this->GetSigmoidMax();
+    cachedValues[ 4 ] = this->GetSigmoidMin();
+    cachedValues[ 5 ] = this->GetSigmoidScale();
+    cachedValues[ 6 ] = this->GetMaximumStepLength();
+    this->m_ParameterEstimateCache->AddEntry( cacheKey, cachedValues, timer1.GetMean() );
+  }
+
 } // end AutomaticParameterEstimation()
 
 
+/**
+ * ******************* GetParameterEstimateCacheKey **********************
+ */
+
+template< class TElastix >
+std::string
+AdaptiveStochasticGradientDescent< TElastix >
+::GetParameterEstimateCacheKey( void ) const
+{
+  /** The parameter map, which is sorted by parameter name. */
+  typedef typename ConfigurationType::ParameterFileParserType::ParameterMapType ParameterMapType;
+  const ParameterMapType & parameterMap = this->GetConfiguration()->GetParameterMap();
+  std::ostringstream       parameterMapString;
+  typename ParameterMapType::const_iterator it;
+  for( it = parameterMap.begin(); it != parameterMap.end(); ++it )
+  {
+    parameterMapString << it->first;
+    for( unsigned int i = 0; i < it->second.size(); ++i )
+    {
+      parameterMapString << " " << it->second[ i ];
+    }
+    parameterMapString << "\n";
+  }
+  parameterMapString << "ElastixLevel " << this->GetConfiguration()->GetElastixLevel() << "\n";
+
+  /** The geometry of the fixed and moving image, and the number of parameters. */
+  const FixedImageType *  fixedImage  = this->GetElastix()->GetFixedImage();
+  const MovingImageType * movingImage = this->GetElastix()->GetMovingImage();
+  std::ostringstream      geometryString;
+  geometryString << std::setprecision( 17 );
+  geometryString << fixedImage->GetLargestPossibleRegion().GetSize()
+                 << fixedImage->GetSpacing()
+                 << fixedImage->GetOrigin()
+                 << fixedImage->GetDirection();
+  geometryString << movingImage->GetLargestPossibleRegion().GetSize()
+                 << movingImage->GetSpacing()
+                 << movingImage->GetOrigin()
+                 << movingImage->GetDirection();
+  geometryString << "FixedMask " << ( this->GetElastix()->GetFixedMask() != nullptr ) << "\n";
+  geometryString << "NumberOfParameters " << this->GetInitialPosition().GetSize() << "\n";
+
+  /** Compose the key. */
+  const unsigned int level = static_cast< unsigned int >(
+    this->m_Registration->GetAsITKBaseType()->GetCurrentLevel() );
+  std::ostringstream key;
+  key << "ParameterMap:" << ParameterEstimateCacheType::GetChecksum( parameterMapString.str() )
+      << ",Geometry:" << ParameterEstimateCacheType::GetChecksum( geometryString.str() )
+      << ",Resolution:" << level;
+  return key.str();
+
+} // end GetParameterEstimateCacheKey()
+
+
 /**
  * ******************* AutomaticParameterEstimationOriginal **********************
  */
@@ -579,6 +713,7 @@ AdaptiveStochasticGradientDescent< TElastix >
     this->m_NumberOfBandStructureSamples );
   computeJacobianTerms->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeJacobianTerms->SetNumberOfWorkUnits( testPtr->GetNumberOfWorkUnits() );
 
   /** Check if use scales. */
   bool useScales = this->GetUseScales();
@@ -19,6 +19,7 @@
 #include "itkAdaptiveStochasticGradientDescentOptimizer.h"
 
 #include "vnl/vnl_math.h"
+#include "itkParameterUpdateKernels.h"
 #include "itkSigmoidImageFilter.h"
 
 namespace itk
@@ -64,15 +65,17 @@ AdaptiveStochasticGradientDescentOptimizer
         * std::log( -this->GetSigmoidMax() / this->GetSigmoidMin() );
       sigmoid.SetBeta( beta );
 
-      /** Formula (2) in Cruz */
-      const double inprod = inner_product(
+      /** Formula (2) in Cruz, and save for the next iteration. */
+      const double inprod = ParameterUpdateKernels::InnerProductAndCopy(
         this->m_PreviousGradient, this->GetGradient() );
       this->m_CurrentTime += sigmoid( -inprod );
       this->m_CurrentTime  = std::max( 0.0, this->m_CurrentTime );
     }
-
-    /** Save for next iteration */
-    this->m_PreviousGradient = this->GetGradient();
+    else
+    {
+      /** Save for next iteration */
+      this->m_PreviousGradient = this->GetGradient();
+    }
   }
   else
   {
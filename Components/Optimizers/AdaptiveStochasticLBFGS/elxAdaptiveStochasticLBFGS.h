@@ -403,19 +403,6 @@ private:
   AdaptiveStochasticLBFGS( const Self& );  // purposely not implemented
   void operator=( const Self& );           // purposely not implemented
 
-  // multi-threaded AdvanceOneStep:
-  struct MultiThreaderParameterType
-  {
-    ParametersType *  t_NewPosition;
-    Self *            t_Optimizer;
-  };
-
-  /** The callback function. */
-  static itk::ITK_THREAD_RETURN_TYPE AdvanceOneStepThreaderCallback( void * arg );
-
-  /** The threaded implementation of AdvanceOneStep(). */
-  inline void ThreadedAdvanceOneStep( ThreadIdType threadId, ParametersType & newPosition );
-
   bool    m_AutomaticParameterEstimation;
   bool    m_AutomaticLBFGSStepsizeEstimation;
   double  m_MaximumStepLength;
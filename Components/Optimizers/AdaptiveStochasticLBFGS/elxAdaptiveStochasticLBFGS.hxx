@@ -31,6 +31,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkParameterUpdateKernels.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -99,6 +100,9 @@ void
 AdaptiveStochasticLBFGS<TElastix>
 ::BeforeRegistration( void )
 {
+  /** Use the random generator of this registration for the perturbations. */
+  this->m_RandomGenerator = this->GetElastix()->GetRandomGenerator();
+
   /** Add the target cell "stepsize" to xout["iteration"]. */
   xout["iteration"].AddTargetCell("2:Metric");
   xout["iteration"].AddTargetCell("3a:Time");
@@ -592,22 +596,15 @@ AdaptiveStochasticLBFGS<TElastix>
 {
   itkDebugMacro( "AdvanceOneStep" );
 
-  /** Get space dimension. */
-  const unsigned int spaceDimension
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Get a reference to the previously allocated newPosition. */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
   /** Get a reference to the current position. */
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
-  /** Update the new position. */
-  const double learningRate = this->GetLearningRate();
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] - learningRate * this->m_Gradient[ j ];
-  }
+  /** Update the new position, multi-threaded for large numbers of parameters. */
+  itk::ParameterUpdateKernels::GradientStep( newPosition, currentPosition,
+    this->m_Gradient, this->GetLearningRate(), this->m_Threader->GetNumberOfWorkUnits() );
 
   this->InvokeEvent( itk::IterationEvent() );
 
@@ -992,6 +989,7 @@ AdaptiveStochasticLBFGS<TElastix>
     this->m_NumberOfBandStructureSamples );
   computeJacobianTerms->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeJacobianTerms->SetNumberOfWorkUnits( testPtr->GetNumberOfWorkUnits() );
 
   /** Check if use scales. */
   bool useScales = this->GetUseScales();
@@ -21,6 +21,7 @@
 #include "itkAdaptiveStochasticLBFGSOptimizer.h"
 
 #include "vnl/vnl_math.h"
+#include "itkParameterUpdateKernels.h"
 #include "itkSigmoidImageFilter.h"
 
 namespace itk
@@ -67,14 +68,17 @@ AdaptiveStochasticLBFGSOptimizer
   {
     if( this->GetCurrentIteration() > 0 )
     {
-      /** Formula (2) in Cruz: <g_k, g_{k-1}>. */
-      const double inprod = inner_product( this->m_PreviousGradient, this->GetGradient() );
+      /** Formula (2) in Cruz: <g_k, g_{k-1}>, and save for the next iteration. */
+      const double inprod = ParameterUpdateKernels::InnerProductAndCopy(
+        this->m_PreviousGradient, this->GetGradient() );
       this->m_CurrentTime += sigmoid( -inprod );
       this->m_CurrentTime = std::max( 0.0, this->m_CurrentTime );
     }
-
-    /** Save for next iteration */
-    this->m_PreviousGradient = this->GetGradient();
+    else
+    {
+      /** Save for next iteration */
+      this->m_PreviousGradient = this->GetGradient();
+    }
   }
   else if( this->m_UseAdaptiveStepSizes && this->m_UseSearchDirForAdaptiveStepSize )
   {
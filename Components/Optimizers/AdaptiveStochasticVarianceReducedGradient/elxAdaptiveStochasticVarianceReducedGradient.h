@@ -73,6 +73,7 @@ namespace elastix
   *    Default/recommended value: 500. When you are in a hurry, you may go down to 250 for example.
   *    When you have plenty of time, and want to be absolutely sure of the best results, a setting
   *    of 2000 is reasonable. In general, 500 gives satisfactory results.
+  * \parameter ConvergenceWindowSize, ConvergenceRelativeTolerance, ConvergenceConfidenceFactor: see OptimizerBase.
   * \parameter MaximumNumberOfSamplingAttempts: The maximum number of sampling attempts. Sometimes
   *   not enough corresponding samples can be drawn, upon which an exception is thrown. With this
   *   parameter it is possible to try to draw another set of samples. \n
@@ -182,6 +183,21 @@ namespace elastix
   *   The parameter can be specified for each resolution, or for all resolutions at once.\n
   *   example: <tt>(NoiseCompensation "true")</tt>\n
   *   Default/recommended: true.
+  * \parameter NumberOfSnapshotBatches: The gradient snapshot at the start of each outer
+  *   iteration, over NumberOfSpatialSamples random samples, is computed as the weighted mean
+  *   of the gradients over this number of batches of new random samples. Each batch is
+  *   evaluated by the metric with all threads, and only the samples of one batch are in
+  *   memory at a time. For metrics that are not a mean over the samples, such as normalized
+  *   correlation and mutual information, the result approximates the gradient over all samples.
+  *   The parameter can be specified for each resolution, or for all resolutions at once.\n
+  *   example: <tt>(NumberOfSnapshotBatches 10)</tt>\n
+  *   Default value: 1.
+  * \parameter SnapshotInterval: The number of outer iterations that the gradient snapshot and
+  *   its position are reused, before a new snapshot is computed. The variance reduced gradient
+  *   stays unbiased, but its variance grows when the position moves away from the snapshot.
+  *   The parameter can be specified for each resolution, or for all resolutions at once.\n
+  *   example: <tt>(SnapshotInterval 2)</tt>\n
+  *   Default value: 1, i.e. a new snapshot every outer iteration.
   *
   * \todo: this class contains a lot of functional code, which actually does not belong here.
   *
@@ -421,6 +437,19 @@ protected:
   virtual void GetScaledDerivativeWithExceptionHandling(
     const ParametersType & parameters, DerivativeType & derivative );
 
+  /** Compute the gradient snapshot at position over NumberOfSpatialSamples
+   * random samples, in NumberOfSnapshotBatches batches.
+   */
+  virtual void ComputeSnapshotGradient(
+    const ParametersType & position, DerivativeType & snapshotGradient );
+
+  /** Add weight times the gradient at position over numberOfSamples new
+   * random samples to the snapshot gradient. Used by ComputeSnapshotGradient.
+   */
+  virtual void AddSnapshotGradientBatch( const ParametersType & position,
+    const SizeValueType numberOfSamples, const double weight,
+    DerivativeType & snapshotGradient );
+
   /** Helper function that adds a random perturbation delta to the input
    * parameters, with delta ~ sigma * N(0,I). Used by SampleGradients.
    */
@@ -436,19 +465,6 @@ private:
   AdaptiveStochasticVarianceReducedGradient( const Self& );  // purposely not implemented
   void operator=( const Self& );                     // purposely not implemented
 
-  // multi-threaded AdvanceOneStep:
-  struct MultiThreaderParameterType
-  {
-    ParametersType *  t_NewPosition;
-    Self *            t_Optimizer;
-  };
-
-  /** The callback function. */
-  static itk::ITK_THREAD_RETURN_TYPE AdvanceOneStepThreaderCallback( void * arg );
-
-  /** The threaded implementation of AdvanceOneStep(). */
-  inline void ThreadedAdvanceOneStep( ThreadIdType threadId, ParametersType & newPosition );
-
   bool    m_AutomaticParameterEstimation;
   double  m_MaximumStepLength;
 
@@ -466,6 +482,10 @@ private:
   SizeValueType m_NumberOfInnerLoopSamples;
   SizeValueType m_NumberOfSpatialSamples;
 
+  /** Private variables for the gradient snapshot. */
+  SizeValueType m_NumberOfSnapshotBatches;
+  SizeValueType m_SnapshotInterval;
+
   /** The flag of using noise compensation. */
   bool m_UseNoiseCompensation;
   bool m_OriginalButSigmoidToDefault;
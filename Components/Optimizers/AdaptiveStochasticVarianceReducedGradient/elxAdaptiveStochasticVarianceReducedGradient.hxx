@@ -31,6 +31,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
+#include "itkParameterUpdateKernels.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -68,6 +69,8 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   this->m_NumberOfSamplesForExactGradient = 100000;
   this->m_NumberOfSpatialSamples = 5000;
   this->m_NumberOfInnerLoopSamples = 10;
+  this->m_NumberOfSnapshotBatches = 1;
+  this->m_SnapshotInterval = 1;
   this->m_SigmoidScaleFactor = 0.1;
   this->m_NoiseFactor =0.8;
 
@@ -93,6 +96,9 @@ void
 AdaptiveStochasticVarianceReducedGradient<TElastix>
 ::BeforeRegistration( void )
 {
+  /** Use the random generator of this registration for the perturbations. */
+  this->m_RandomGenerator = this->GetElastix()->GetRandomGenerator();
+
   /** Add the target cell "stepsize" to xout["iteration"]. */
   xout["iteration"].AddTargetCell("2:Metric");
   xout["iteration"].AddTargetCell("3a:Time");
@@ -138,6 +144,9 @@ void AdaptiveStochasticVarianceReducedGradient<TElastix>
   this->m_OutsideIterations = maximumNumberOfIterations;
   this->SetNumberOfIterations( this->m_OutsideIterations );
 
+  /** Set the parameters of the convergence monitor. */
+  this->ReadConvergenceMonitorParameters( this->GetModifiableConvergenceMonitor() );
+
   /** Set the numberOfInnerLoopSamples. */
   SizeValueType numberOfInnerLoopSamples = 10;
   this->GetConfiguration()->ReadParameter( numberOfInnerLoopSamples,
@@ -150,6 +159,19 @@ void AdaptiveStochasticVarianceReducedGradient<TElastix>
     "NumberOfSpatialSamples", this->GetComponentLabel(), level, 0 );
   this->m_NumberOfSpatialSamples = numberOfSpatialSamples;
 
+  /** Set the number of batches and the reuse of the gradient snapshot. */
+  this->m_NumberOfSnapshotBatches = 1;
+  this->GetConfiguration()->ReadParameter( this->m_NumberOfSnapshotBatches,
+    "NumberOfSnapshotBatches", this->GetComponentLabel(), level, 0 );
+  this->m_NumberOfSnapshotBatches = std::max(
+    static_cast< SizeValueType >( 1 ), this->m_NumberOfSnapshotBatches );
+
+  this->m_SnapshotInterval = 1;
+  this->GetConfiguration()->ReadParameter( this->m_SnapshotInterval,
+    "SnapshotInterval", this->GetComponentLabel(), level, 0 );
+  this->m_SnapshotInterval = std::max(
+    static_cast< SizeValueType >( 1 ), this->m_SnapshotInterval );
+
   /** Set the gain parameter A. */
   double A = 20.0;
   this->GetConfiguration()->ReadParameter( A,
@@ -352,7 +374,8 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
    * typedef enum {
    *   MaximumNumberOfIterations,
    *   MetricError,
-   *   MinimumStepSize } StopConditionType;
+   *   MinimumStepSize,
+   *   StochasticConvergence } StopConditionType;
    */
   std::string stopcondition;
 
@@ -366,6 +389,10 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
     stopcondition = "The minimum step length has been reached";
     break;
 
+  case StochasticConvergence :
+    stopcondition = this->GetConvergenceMonitorStopCondition( this->GetConvergenceMonitor() );
+    break;
+
   default:
     stopcondition = "Unknown";
     break;
@@ -449,6 +476,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   itkDebugMacro("StartOptimization");
 
   this->m_CurrentIteration   = 0;
+  this->m_ConvergenceMonitor->Initialize();
 
     /** Get the number of parameters; checks also if a cost function has been set at all.
   * if not: an exception is thrown */
@@ -475,22 +503,15 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
 {
   itkDebugMacro( "AdvancedOneStep" );
 
-  /** Get space dimension. */
-  const unsigned int spaceDimension
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Get a reference to the previously allocated newPosition. */
-  ParametersType &newPosition = this->m_ScaledCurrentPosition;
+  ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
   /** Get a reference to the current position. */
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
-  /** Update the new position. */
-  const double learningRate = this->GetLearningRate();
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[j] = currentPosition[j] - learningRate * this->m_Gradient[j];
-  }
+  /** Update the new position, multi-threaded for large numbers of parameters. */
+  itk::ParameterUpdateKernels::GradientStep( newPosition, currentPosition,
+    this->m_Gradient, this->GetLearningRate(), this->m_Threader->GetNumberOfWorkUnits() );
 
   this->InvokeEvent( itk::IterationEvent() );
 }
@@ -530,9 +551,6 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   itk::TimeProbesCollectorBase timeCollector;
 
   timeCollector.Start( "init" );
-   /** Set the NumberOfSpatialSamples. */
-  SizeValueType numberOfSpatialSamples = this->m_NumberOfSpatialSamples;
-
   SizeValueType spaceDimension
     = this->GetScaledCostFunction()->GetNumberOfParameters();
 
@@ -543,10 +561,13 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
 
   const unsigned int M = this->GetElastix()->GetNumberOfMetrics();
 
-  std::vector< ImageRandomSamplerBasePointer >  samplerVec( M );
-  std::vector< ImageRandomSamplerPointer >      randomSamplerVec( M );
+  std::vector< ImageSamplerBasePointer >        samplerVec( M );
   std::vector< ImageRandomSamplerPointer >      subRandomSamplerVec( M );
-  std::vector< ImageRadomSampleContainerPointer > randomSampleContainer( M );
+
+  /** The position of the gradient snapshot, and the number of outer iterations it was used. */
+  ParametersType previousPosition;
+  SizeValueType  snapshotAge = this->m_SnapshotInterval;
+
   /** set the number of samples. */
 //  unsigned int innerNumberOfSpatialSamples = 10;
   //unsigned int innerLoopIterations = 50;
@@ -554,7 +575,6 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
   /** Print the elapsed time. */
   timeCollector.Stop( "init" );
 
-  SizeValueType nrofsamplesCheck;
   while( !this->m_Stop )
   {
       /** The following code relies on the fact that all
@@ -569,37 +589,17 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
       this->m_AutomaticParameterEstimationDone = true;
     }//endif
 
-    for( unsigned int m = 0; m < M; ++m )
+    /** Compute the gradient snapshot at the current position, unless the
+     * previous snapshot is reused.
+     */
+    timeCollector.Start( "g1" );
+    if( snapshotAge >= this->m_SnapshotInterval )
     {
-     ImageSamplerBasePointer sampler =
-       this->GetElastix()->GetElxMetricBase(m)->GetAdvancedMetricImageSampler();
-     samplerVec[ m ] =
-       dynamic_cast< ImageRandomSamplerBaseType * >( sampler.GetPointer() );
-
-      randomSamplerVec[ m ] = ImageRandomSamplerType::New();
-      randomSamplerVec[ m ]->SetInput( samplerVec[ m ]->GetInput() );
-      randomSamplerVec[ m ]->SetInputImageRegion( samplerVec[ m ]->
-        GetInputImageRegion() );
-      randomSamplerVec[ m ]->SetMask( samplerVec[m]->GetMask() );
-      randomSamplerVec[ m ] ->SetNumberOfSamples( numberOfSpatialSamples );
-      randomSamplerVec[ m ] ->Update();
-      this->GetElastix()->GetElxMetricBase( m )
-        ->SetAdvancedMetricImageSampler( randomSamplerVec[ m ]);
-      randomSampleContainer[ m ] = randomSamplerVec[ m ] -> GetOutput();
-      nrofsamplesCheck = randomSampleContainer[ m ] ->Size();
+      previousPosition = this->GetScaledCurrentPosition();
+      this->ComputeSnapshotGradient( previousPosition, this->m_MeanGradient );
+      snapshotAge = 0;
     }
-
-    //this->SelectNewSamples();
-    timeCollector.Start( "copy" );
-    ParametersType previousPosition = this->GetScaledCurrentPosition();
-    timeCollector.Stop( "copy" );
-
-    timeCollector.Start( "g1" );
-    this->GetRegistration()->GetAsITKBaseType()->GetModifiableMetric()->SetNumberOfWorkUnits(
-      this->GetRegistration()->GetAsITKBaseType()->GetMetric()->GetThreader()->GetGlobalDefaultNumberOfThreads()
-      );
-    this->GetScaledDerivativeWithExceptionHandling( previousPosition, this->m_MeanGradient );
-    //this->GetScaledValueAndDerivative( this->GetScaledCurrentPosition() ,this->m_Value, this->m_PreviousGradient );
+    ++snapshotAge;
     timeCollector.Stop( "g1" );
 
     /** StopOptimization may have been called. */
@@ -613,12 +613,18 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
     //
     for( unsigned int m = 0; m < M; ++m )
     {
-      ImageSamplerBasePointer sampler =
-        this->GetElastix()->GetElxMetricBase(m)->GetAdvancedMetricImageSampler();
+      /** Any sampler will do: only its input, region and mask are used. */
       samplerVec[ m ] =
-        dynamic_cast< ImageRandomSamplerBaseType * >( sampler.GetPointer() );
+        this->GetElastix()->GetElxMetricBase(m)->GetAdvancedMetricImageSampler();
+      if( samplerVec[ m ].IsNull() )
+      {
+        itkExceptionMacro( << "ERROR: " << this->GetElastix()->GetElxMetricBase( m )->GetComponentLabel()
+                           << " does not use an image sampler, which is required by "
+                           << "the AdaptiveStochasticVarianceReducedGradient optimizer." );
+      }
 
       subRandomSamplerVec[ m ] = ImageRandomSamplerType::New();
+      subRandomSamplerVec[ m ]->SetRandomGenerator( this->m_RandomGenerator );
 //       subRandomSamplerVec[ m ]->SetInput( randomSamplerVec[ m ] ->GetInput());
 //       subRandomSamplerVec[ m ]->SetInputImageRegion( randomSamplerVec[ m ]->
 //         GetInputImageRegion() );
@@ -690,6 +696,9 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
 
       this->Superclass1::UpdateCurrentTime();
 
+      /** Feed the convergence monitor; it is checked after the outer iteration. */
+      this->m_ConvergenceMonitor->AddValue( this->m_Value );
+
       this->m_CurrentInnerIteration++;
       /** Preserve the previous position. */
     }//end inner forloop
@@ -713,6 +722,14 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
       this->StopOptimization();
       break;
     }
+
+    /** Stop when the metric value stopped decreasing. */
+    if( this->m_ConvergenceMonitor->GetConverged() )
+    {
+      this->m_StopCondition = StochasticConvergence;
+      this->StopOptimization();
+      break;
+    }
   }//end while
 
   timeCollector.Report( std::cout );
@@ -850,6 +867,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
     this->m_NumberOfBandStructureSamples );
   computeJacobianTerms->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeJacobianTerms->SetNumberOfWorkUnits( testPtr->GetNumberOfWorkUnits() );
 
   /** Check if use scales. */
   bool useScales = this->GetUseScales();
@@ -1405,6 +1423,88 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>
 } // end GetScaledDerivativeWithExceptionHandling()
 
 
+/**
+ * *************** ComputeSnapshotGradient ***************
+ */
+
+template <class TElastix>
+void
+AdaptiveStochasticVarianceReducedGradient<TElastix>
+::ComputeSnapshotGradient(
+  const ParametersType & position, DerivativeType & snapshotGradient )
+{
+  const SizeValueType numberOfSamples = this->m_NumberOfSpatialSamples;
+  const SizeValueType numberOfBatches = std::max( static_cast< SizeValueType >( 1 ),
+    std::min( this->m_NumberOfSnapshotBatches, numberOfSamples ) );
+
+  snapshotGradient = DerivativeType( position.GetSize() );
+  snapshotGradient.Fill( 0.0 );
+
+  /** Divide the samples equally over the batches. The gradient of each batch
+   * is weighted with its share of the samples.
+   */
+  for( SizeValueType b = 0; b < numberOfBatches; ++b )
+  {
+    const SizeValueType batchSize = numberOfSamples / numberOfBatches
+      + ( b < numberOfSamples % numberOfBatches ? 1 : 0 );
+    this->AddSnapshotGradientBatch( position, batchSize,
+      static_cast< double >( batchSize ) / static_cast< double >( numberOfSamples ),
+      snapshotGradient );
+  }
+
+} // end ComputeSnapshotGradient()
+
+
+/**
+ * *************** AddSnapshotGradientBatch ***************
+ */
+
+template <class TElastix>
+void
+AdaptiveStochasticVarianceReducedGradient<TElastix>
+::AddSnapshotGradientBatch( const ParametersType & position,
+  const SizeValueType numberOfSamples, const double weight,
+  DerivativeType & snapshotGradient )
+{
+  /** Replace the samplers by random samplers with new samples. */
+  const unsigned int M = this->GetElastix()->GetNumberOfMetrics();
+  std::vector< ImageSamplerBasePointer > originalSamplerVec( M );
+  for( unsigned int m = 0; m < M; ++m )
+  {
+    originalSamplerVec[ m ]
+      = this->GetElastix()->GetElxMetricBase( m )->GetAdvancedMetricImageSampler();
+
+    ImageRandomSamplerPointer batchSampler = ImageRandomSamplerType::New();
+    batchSampler->SetRandomGenerator( this->m_RandomGenerator );
+    batchSampler->SetInput( originalSamplerVec[ m ]->GetInput() );
+    batchSampler->SetInputImageRegion( originalSamplerVec[ m ]->GetInputImageRegion() );
+    batchSampler->SetMask( originalSamplerVec[ m ]->GetMask() );
+    batchSampler->SetNumberOfSamples( numberOfSamples );
+    batchSampler->Update();
+    this->GetElastix()->GetElxMetricBase( m )->SetAdvancedMetricImageSampler( batchSampler );
+  }
+
+  /** The snapshot uses many samples, so use all threads of the metric. */
+  this->GetRegistration()->GetAsITKBaseType()->GetModifiableMetric()->SetNumberOfWorkUnits(
+    this->GetRegistration()->GetAsITKBaseType()->GetMetric()->GetThreader()->GetGlobalDefaultNumberOfThreads()
+    );
+  DerivativeType batchGradient( position.GetSize() );
+  this->GetScaledDerivativeWithExceptionHandling( position, batchGradient );
+
+  /** Set the samplers back to the original. */
+  for( unsigned int m = 0; m < M; ++m )
+  {
+    this->GetElastix()->GetElxMetricBase( m )->SetAdvancedMetricImageSampler( originalSamplerVec[ m ] );
+  }
+
+  for( unsigned int j = 0; j < snapshotGradient.GetSize(); ++j )
+  {
+    snapshotGradient[ j ] += weight * batchGradient[ j ];
+  }
+
+} // end AddSnapshotGradientBatch()
+
+
 /**
  * *************** AddRandomPerturbation ***************
  */
@@ -21,6 +21,7 @@
 #include "itkAdaptiveStochasticVarianceReducedGradientOptimizer.h"
 
 #include "vnl/vnl_math.h"
+#include "itkParameterUpdateKernels.h"
 #include "itkSigmoidImageFilter.h"
 
 namespace itk
@@ -67,15 +68,17 @@ void AdaptiveStochasticVarianceReducedGradientOptimizer
         std::log( -this->GetSigmoidMax() / this->GetSigmoidMin() );
       sigmoid.SetBeta( beta );
 
-      ///** Formula (2) in Cruz */
-      const double inprod = inner_product(
+      /** Formula (2) in Cruz, and save for the next iteration. */
+      const double inprod = ParameterUpdateKernels::InnerProductAndCopy(
         this->m_PreviousGradient, this->GetGradient() );
       this->m_CurrentTime += sigmoid( -inprod );
       this->m_CurrentTime = std::max( 0.0, this->m_CurrentTime );
     }
-    /** Save for next iteration */
-     //this->m_PrePreviousGradient = this->m_PreviousGradient;
-    this->m_PreviousGradient = this->GetGradient();
+    else
+    {
+      /** Save for next iteration */
+      this->m_PreviousGradient = this->GetGradient();
+    }
   }
   else
   {
@@ -20,6 +20,7 @@
 
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
 #include "itkPlatformMultiThreader.h"
+#include "itkStochasticConvergenceMonitor.h"
 
 namespace itk
 {
@@ -83,9 +84,13 @@ public:
     MinimumStepSize,
     InvalidDiagonalMatrix,
     GradientMagnitudeTolerance,
-    LineSearchError
+    LineSearchError,
+    StochasticConvergence
   } StopConditionType;
 
+  /** Typedef for the convergence monitor. */
+  typedef StochasticConvergenceMonitor ConvergenceMonitorType;
+
   /** Advance one step following the gradient direction. */
   virtual void AdvanceOneStep( void );
 
@@ -157,10 +162,17 @@ public:
     this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
   }
   //itkGetConstReferenceMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set whether AdvanceOneStep() may be multi-threaded. This is only
+   * done for large numbers of parameters, see ParameterUpdateKernels.
+   * Default: true.
+   */
   itkSetMacro( UseMultiThread, bool );
 
-  itkSetMacro( UseOpenMP, bool );
-  itkSetMacro( UseEigen, bool );
+  /** Get the convergence monitor, to configure it. It is fed with the metric
+   * value of every iteration, see StochasticConvergenceMonitor.
+   */
+  itkGetModifiableObjectMacro( ConvergenceMonitor, ConvergenceMonitorType );
 
 protected:
   StochasticVarianceReducedGradientDescentOptimizer();
@@ -184,6 +196,7 @@ protected:
   //DerivativeType                m_PrePreviousGradient;
   ParametersType                m_PreviousPosition;
   ThreaderType::Pointer         m_Threader;
+  ConvergenceMonitorType::Pointer m_ConvergenceMonitor;
 
   bool                          m_Stop;
   unsigned long                 m_NumberOfIterations;
@@ -196,22 +209,8 @@ private:
   StochasticVarianceReducedGradientDescentOptimizer( const Self& ); // purposely not implemented
   void operator=( const Self& ); // purposely not implemented
 
-  // multi-threaded AdvanceOneStep:
+  /** Use multi-threading in AdvanceOneStep(). */
   bool m_UseMultiThread;
-  struct MultiThreaderParameterType
-  {
-    ParametersType *  t_NewPosition;
-    Self *            t_Optimizer;
-  };
-
-  bool m_UseOpenMP;
-  bool m_UseEigen;
-
-  /** The callback function. */
-  static ITK_THREAD_RETURN_TYPE AdvanceOneStepThreaderCallback( void * arg );
-
-  /** The threaded implementation of AdvanceOneStep(). */
-  inline void ThreadedAdvanceOneStep( ThreadIdType threadId, ParametersType & newPosition );
 
 };
 
@@ -107,6 +107,14 @@ namespace elastix
  *    reported back in the elastix.log file. This parameter can be specified for each resolution. \n
  *    example: <tt>(UpdateBDPeriod 0 0 50)</tt> \n
  *    Default: 0 (so, automatically determined).
+ * \parameter UseMultiThreadingForOptimizer: evaluate the offspring of a generation
+ *    concurrently, each thread on its own copy of the metric. The number of threads is
+ *    given by the -threads command line argument, and is divided over the copies. Only
+ *    supported for a single metric with a combination of a matrix-offset, translation or
+ *    B-spline transform; otherwise a warning is printed and the offspring are evaluated
+ *    one at a time. The results do not depend on this setting.\n
+ *    example: <tt>(UseMultiThreadingForOptimizer "true")</tt> \n
+ *    Default: "false". This parameter can be specified for each resolution. \n
  *
  * \ingroup Optimizers
  */
@@ -157,6 +165,7 @@ public:
   typedef typename Superclass2::ITKBaseType          ITKBaseType;
 
   /** Check if any scales are set, and set the UseScales flag on or off;
+   * create the metric copies for multi-threading;
    * after that call the superclass' implementation */
   void StartOptimization( void ) override;
 
@@ -49,6 +49,18 @@ CMAEvolutionStrategy< TElastix >::StartOptimization( void )
     }
   }
 
+  /** Evaluate the offspring concurrently on copies of the metric, if possible. */
+  if( this->GetUseMultiThread() )
+  {
+    typename Superclass2::CostFunctionContainerType clones;
+    if( !this->CreateCostFunctionClones( this->GetCostFunction(),
+      this->GetNumberOfWorkUnits(), clones ) )
+    {
+      this->SetUseMultiThread( false );
+    }
+    this->SetCostFunctionClones( clones );
+  }
+
   /** Call the superclass */
   this->Superclass1::StartOptimization();
 
@@ -102,6 +114,9 @@ CMAEvolutionStrategy< TElastix >::BeforeRegistration( void )
   xout[ "iteration" ][ "5b:MaximumD" ] << std::showpoint << std::fixed;
   xout[ "iteration" ][ "5c:MinimumD" ] << std::showpoint << std::fixed;
 
+  /** Sample the offspring with the random generator of this registration. */
+  this->SetRandomGenerator( this->GetElastix()->GetRandomGenerator() );
+
 } // end BeforeRegistration
 
 
@@ -208,6 +223,21 @@ CMAEvolutionStrategy< TElastix >
     "MinimumDeviation", this->GetComponentLabel(), level, 0 );
   this->SetMinimumDeviation( minimumDeviation );
 
+  /** Set UseMultiThread */
+  bool useMultiThreading = false;
+  this->m_Configuration->ReadParameter( useMultiThreading,
+    "UseMultiThreadingForOptimizer", this->GetComponentLabel(), level, 0 );
+  this->SetUseMultiThread( useMultiThreading );
+  if( useMultiThreading )
+  {
+    std::string tmp = this->m_Configuration->GetCommandLineArgument( "-threads" );
+    if( tmp != "" )
+    {
+      const unsigned int nrOfThreads = atoi( tmp.c_str() );
+      this->SetNumberOfWorkUnits( nrOfThreads );
+    }
+  }
+
 } // end BeforeEachResolution
 
 
@@ -22,6 +22,7 @@
 #include "itkCMAEvolutionStrategyOptimizer.h"
 #include "itkSymmetricEigenAnalysis.h"
 #include "vnl/vnl_math.h"
+#include "vnl/vnl_fastops.h"
 #include <algorithm>
 #include <cmath>
 #include "itkCommand.h"
@@ -76,6 +77,11 @@ CMAEvolutionStrategyOptimizer::CMAEvolutionStrategyOptimizer()
   this->m_PositionToleranceMin       = 1e-12;
   this->m_PositionToleranceMax       = 1e8;
   this->m_ValueTolerance             = 1e-12;
+  this->m_UseMultiThread             = false;
+
+  /** Threading related variables. */
+  this->m_Threader = ThreaderType::New();
+  this->m_ThreaderParameters.st_Self = this;
 
 } // end constructor
 
@@ -125,6 +131,7 @@ CMAEvolutionStrategyOptimizer::PrintSelf( std::ostream & os, Indent indent ) con
   os << indent << "m_PositionToleranceMin: " << this->m_PositionToleranceMin << std::endl;
   os << indent << "m_PositionToleranceMax: " << this->m_PositionToleranceMax << std::endl;
   os << indent << "m_ValueTolerance: " << this->m_ValueTolerance << std::endl;
+  os << indent << "m_UseMultiThread: " << this->m_UseMultiThread << std::endl;
 
   os << indent << "m_RecombinationWeights: " << this->m_RecombinationWeights << std::endl;
   os << indent << "m_C: " << this->m_C << std::endl;
@@ -501,76 +508,194 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 {
   itkDebugMacro( "GenerateOffspring" );
 
-  /** Get the number of parameters from the cost function */
-  const unsigned int numberOfParameters
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Some casts/aliases: */
-  const unsigned int N      = numberOfParameters;
   const unsigned int lambda = this->m_PopulationSize;
 
   /** Clear the old values */
   this->m_CostFunctionValues.clear();
 
-  /** Fill the m_NormalizedSearchDirs and SearchDirs */
-  unsigned int lam       = 0;
-  unsigned int nrOfFails = 0;
-  while( lam < lambda )
+  /** Precompute B * D, so that each search direction costs a single
+   * matrix-vector product */
+  if( this->GetUseCovarianceMatrixAdaptation() )
   {
-    /** draw from distribution N(0,I) */
-    for( unsigned int par = 0; par < N; ++par )
+    this->m_BD = this->m_B;
+    for( unsigned int par = 0; par < this->m_BD.cols(); ++par )
     {
-      this->m_NormalizedSearchDirs[ lam ][ par ]
-        = this->m_RandomGenerator->GetNormalVariate();
+      this->m_BD.scale_column( par, this->m_D[ par ] );
     }
-    /** Make like it was drawn from N(0,C) */
-    if( this->GetUseCovarianceMatrixAdaptation() )
-    {
-      this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
-    }
-    else
-    {
-      this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
-    }
-    /** Make like it was drawn from N( 0, sigma^2 C ) */
-    this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+  }
 
-    /** Compute the cost function */
-    MeasureType costFunctionValue = 0.0;
-    /** x_lam = m + d_lam */
-    ParametersType x_lam = this->GetScaledCurrentPosition();
-    x_lam += this->m_SearchDirs[ lam ];
-    try
-    {
-      costFunctionValue = this->GetScaledValue( x_lam );
-    }
-    catch( ExceptionObject & err )
+  /** Draw the complete population before evaluating it, so that the random
+   * numbers do not depend on the order of the cost function evaluations */
+  for( unsigned int lam = 0; lam < lambda; ++lam )
+  {
+    this->DrawSearchDir( lam );
+  }
+
+  /** Evaluate the population, possibly concurrently */
+  this->EvaluateOffspring();
+
+  /** Try other parameter vectors for the offspring for which the cost function
+   * evaluation failed, in a fixed order. Give up after 11 retries. */
+  for( unsigned int lam = 0; lam < lambda; ++lam )
+  {
+    unsigned int nrOfFails = 0;
+    while( !this->m_OffspringEvaluated[ lam ] )
     {
       ++nrOfFails;
-      /** try another parameter vector if we haven't tried that for 10 times already */
-      if( nrOfFails <= 10 )
+      this->DrawSearchDir( lam );
+
+      /** x_lam = m + d_lam */
+      ParametersType x_lam = this->GetScaledCurrentPosition();
+      x_lam += this->m_SearchDirs[ lam ];
+      try
       {
-        continue;
+        this->m_OffspringValues[ lam ]    = this->GetScaledValue( x_lam );
+        this->m_OffspringEvaluated[ lam ] = true;
       }
-      else
+      catch( ExceptionObject & err )
       {
-        this->m_StopCondition = MetricError;
-        this->StopOptimization();
-        throw err;
+        if( nrOfFails > 10 )
+        {
+          this->m_StopCondition = MetricError;
+          this->StopOptimization();
+          throw err;
+        }
       }
     }
+
     /** Successfull cost function evaluation */
     this->m_CostFunctionValues.push_back(
-      MeasureIndexPairType( costFunctionValue, lam ) );
+      MeasureIndexPairType( this->m_OffspringValues[ lam ], lam ) );
+  }
+
+} // end GenerateOffspring
 
-    /** Reset the number of failed cost function evaluations */
-    nrOfFails = 0;
 
-    /** next offspring member */
-    ++lam;
+/**
+ * ****************** DrawSearchDir *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::DrawSearchDir( const unsigned int lam )
+{
+  /** Get the number of parameters from the cost function */
+  const unsigned int N = this->GetScaledCostFunction()->GetNumberOfParameters();
+
+  /** draw from distribution N(0,I) */
+  for( unsigned int par = 0; par < N; ++par )
+  {
+    this->m_NormalizedSearchDirs[ lam ][ par ]
+      = this->m_RandomGenerator->GetNormalVariate();
+  }
+  /** Make like it was drawn from N(0,C) */
+  if( this->GetUseCovarianceMatrixAdaptation() )
+  {
+    this->m_SearchDirs[ lam ] = this->m_BD * this->m_NormalizedSearchDirs[ lam ];
   }
+  else
+  {
+    this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
+  }
+  /** Make like it was drawn from N( 0, sigma^2 C ) */
+  this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
 
-} // end GenerateOffspring
+} // end DrawSearchDir
+
+
+/**
+ * ****************** EvaluateOffspring *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::EvaluateOffspring( void )
+{
+  itkDebugMacro( "EvaluateOffspring" );
+
+  const unsigned int lambda = this->m_PopulationSize;
+  this->m_OffspringValues.assign( lambda, NumericTraits< MeasureType >::Zero );
+  this->m_OffspringEvaluated.assign( lambda, false );
+
+  if( !this->m_UseMultiThread || this->m_Threader->GetNumberOfWorkUnits() == 1 )
+  {
+    this->EvaluateOffspring( 0, lambda, this->m_ScaledCostFunction );
+    return;
+  }
+
+  /** Each thread evaluates its part of the offspring on its own clone. */
+  const ThreadIdType numberOfWorkUnits = this->m_Threader->GetNumberOfWorkUnits();
+  if( this->GetScaledCostFunctionClones().size() < numberOfWorkUnits )
+  {
+    itkExceptionMacro( << "UseMultiThread is set, but only "
+                       << this->GetScaledCostFunctionClones().size()
+                       << " cost function clones are set for "
+                       << numberOfWorkUnits << " threads. "
+                       << "Use SetCostFunctionClones() to set one clone per thread." );
+  }
+
+  /** Setup threader and launch. */
+  this->m_Threader->SetSingleMethod( this->EvaluateOffspringThreaderCallback,
+    &this->m_ThreaderParameters );
+  this->m_Threader->SingleMethodExecute();
+
+} // end EvaluateOffspring
+
+
+/**
+ * ****************** EvaluateOffspring *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::EvaluateOffspring(
+  const unsigned int begin, const unsigned int end,
+  const ScaledCostFunctionType * costFunction )
+{
+  for( unsigned int lam = begin; lam < end; ++lam )
+  {
+    /** x_lam = m + d_lam */
+    ParametersType x_lam = this->GetScaledCurrentPosition();
+    x_lam += this->m_SearchDirs[ lam ];
+    try
+    {
+      this->m_OffspringValues[ lam ]    = costFunction->GetValue( x_lam );
+      this->m_OffspringEvaluated[ lam ] = true;
+    }
+    catch( ExceptionObject & )
+    {
+      /** Retried in GenerateOffspring() */
+    }
+  }
+
+} // end EvaluateOffspring
+
+
+/**
+ * ************ EvaluateOffspringThreaderCallback ****************************
+ */
+
+ITK_THREAD_RETURN_TYPE
+CMAEvolutionStrategyOptimizer::EvaluateOffspringThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID    = infoStruct->WorkUnitID;
+  ThreadIdType                 nrOfThreads = infoStruct->NumberOfWorkUnits;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Compute the part of the population of this thread. */
+  const unsigned int lambda    = temp->st_Self->m_PopulationSize;
+  const unsigned int chunkSize = ( lambda + nrOfThreads - 1 ) / nrOfThreads;
+  const unsigned int begin     = std::min( lambda, threadID * chunkSize );
+  const unsigned int end       = std::min( lambda, ( threadID + 1 ) * chunkSize );
+
+  /** Call the real implementation, on the cost function clone of this thread. */
+  temp->st_Self->EvaluateOffspring( begin, end,
+    temp->st_Self->GetScaledCostFunctionClones()[ threadID ] );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end EvaluateOffspringThreaderCallback()
 
 
 /**
@@ -760,36 +885,20 @@ CMAEvolutionStrategyOptimizer::UpdateC( void )
   }
   this->m_C *= oldCfactor;
 
-  /** Do rank-one update */
-  const double rankonefactor = c_cov / mu_cov;
-  for( unsigned int i = 0; i < N; ++i )
-  {
-    const double evolutionPath_i = this->m_EvolutionPath[ i ];
-    for( unsigned int j = 0; j < N; ++j )
-    {
-      const double update = rankonefactor * evolutionPath_i * this->m_EvolutionPath[ j ];
-      this->m_C[ i ][ j ] += update;
-    }
-  }
-
-  /** Do rank-mu update */
-  const double rankmufactor = c_cov * ( 1.0 - 1.0 / mu_cov );
+  /** Do the rank-one and the rank-mu update at once, as C += Y^T Y.
+   * The first row of Y is the scaled evolution path, for the rank-one update,
+   * and the other rows are the scaled search directions of the parents. */
+  const double         rankonefactor = c_cov / mu_cov;
+  const double         rankmufactor  = c_cov * ( 1.0 - 1.0 / mu_cov );
+  vnl_matrix< double > Y( mu + 1, N );
+  Y.set_row( 0, std::sqrt( rankonefactor ) * this->m_EvolutionPath );
   for( unsigned int m = 0; m < mu; ++m )
   {
-    const unsigned int lam               = this->m_CostFunctionValues[ m ].second;
-    const double       sqrtweight        = std::sqrt( this->m_RecombinationWeights[ m ] );
-    ParametersType     weightedSearchDir = this->m_SearchDirs[ lam ];
-    weightedSearchDir *= ( sqrtweight / sigma );
-    for( unsigned int i = 0; i < N; ++i )
-    {
-      const double weightedSearchDir_i = weightedSearchDir[ i ];
-      for( unsigned int j = 0; j < N; ++j )
-      {
-        const double update = rankmufactor * weightedSearchDir_i * weightedSearchDir[ j ];
-        this->m_C[ i ][ j ] += update;
-      }
-    }
-  } // end for m
+    const unsigned int lam    = this->m_CostFunctionValues[ m ].second;
+    const double       factor = std::sqrt( rankmufactor * this->m_RecombinationWeights[ m ] ) / sigma;
+    Y.set_row( m + 1, factor * this->m_SearchDirs[ lam ] );
+  }
+  vnl_fastops::inc_X_by_AtA( this->m_C, Y );
 
 } // end UpdateC
 
@@ -27,6 +27,7 @@
 #include "itkArray.h"
 #include "itkArray2D.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkPlatformMultiThreader.h"
 #include "vnl/vnl_diag_matrix.h"
 
 namespace itk
@@ -219,6 +220,36 @@ public:
   itkSetMacro( ValueTolerance, double );
   itkGetConstMacro( ValueTolerance, double );
 
+  /** Setting: evaluate the offspring of a generation concurrently, each thread
+   * evaluating a fixed part of the population on its own copy of the cost
+   * function, see SetCostFunctionClones(). The cost function itself is never
+   * called concurrently. EvaluateOffspring() throws an exception when less
+   * clones than threads are set. The offspring are always drawn in the
+   * same order, so the result does not depend on the number of threads.
+   * Default: false */
+  itkSetMacro( UseMultiThread, bool );
+  itkGetConstMacro( UseMultiThread, bool );
+
+  /** Set the number of threads used to evaluate the offspring concurrently. */
+  virtual void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
+
+  virtual ThreadIdType GetNumberOfWorkUnits( void ) const
+  {
+    return this->m_Threader->GetNumberOfWorkUnits();
+  }
+
+
+  /** Set/Get the random number generator used to generate the offspring.
+   * By default the global instance of the MersenneTwisterRandomVariateGenerator
+   * is used. */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  itkSetObjectMacro( RandomGenerator, RandomGeneratorType );
+  itkGetModifiableObjectMacro( RandomGenerator, RandomGeneratorType );
+
 protected:
 
   typedef Array< double >               RecombinationWeightsType;
@@ -231,7 +262,9 @@ protected:
     std::pair< MeasureType, unsigned int >  MeasureIndexPairType;
   typedef std::vector< MeasureIndexPairType > MeasureContainerType;
 
-  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  /** Typedefs for multi-threading. */
+  typedef itk::PlatformMultiThreader ThreaderType;
+  typedef ThreaderType::WorkUnitInfo ThreadInfoType;
 
   /** The random number generator used to generate the offspring. */
   RandomGeneratorType::Pointer m_RandomGenerator;
@@ -293,6 +326,11 @@ protected:
   ParameterContainerType m_NormalizedSearchDirs;
   /** cost function values for each \f$x_i = m + d_i\f$ */
   MeasureContainerType m_CostFunctionValues;
+  /** The cost function values of the offspring, in the order of m_SearchDirs,
+   * and whether their evaluation succeeded. The flags are not stored in a
+   * std::vector< bool >, since the threads write them concurrently. */
+  std::vector< MeasureType >   m_OffspringValues;
+  std::vector< unsigned char > m_OffspringEvaluated;
   /** \f$m(g+1) - m(g)\f$ */
   ParametersType m_CurrentScaledStep;
   /** \f$1/\sigma * D^{-1} * B' * m_CurrentScaledStep, needed for p_{\sigma}\f$ */
@@ -311,6 +349,16 @@ protected:
   CovarianceMatrixType m_B;
   /** D: sqrt(eigen values) */
   EigenValueMatrixType m_D;
+  /** B * D, used to generate the search directions */
+  CovarianceMatrixType m_BD;
+
+  /** To give the threads access to all member variables and functions. */
+  struct MultiThreaderParameterType
+  {
+    Self * st_Self;
+  };
+  MultiThreaderParameterType m_ThreaderParameters;
+  ThreaderType::Pointer      m_Threader;
 
   /** Constructor */
   CMAEvolutionStrategyOptimizer();
@@ -358,6 +406,20 @@ protected:
    * and m_CostFunctionValues */
   virtual void GenerateOffspring( void );
 
+  /** Draw m_NormalizedSearchDirs[ lam ], and compute m_SearchDirs[ lam ] */
+  virtual void DrawSearchDir( const unsigned int lam );
+
+  /** Evaluate the cost function for all offspring, concurrently if desired,
+   * and fill m_OffspringValues and m_OffspringEvaluated */
+  virtual void EvaluateOffspring( void );
+
+  /** Evaluate the (scaled) costFunction for the offspring [begin, end) */
+  virtual void EvaluateOffspring( const unsigned int begin, const unsigned int end,
+    const ScaledCostFunctionType * costFunction );
+
+  /** Threader callback, which evaluates a part of the offspring */
+  static ITK_THREAD_RETURN_TYPE EvaluateOffspringThreaderCallback( void * arg );
+
   /** Sort the m_CostFunctionValues vector and update m_MeasureHistory */
   virtual void SortCostFunctionValues( void );
 
@@ -422,6 +484,7 @@ private:
   double        m_PositionToleranceMax;
   double        m_PositionToleranceMin;
   double        m_ValueTolerance;
+  bool          m_UseMultiThread;
 
 };
 
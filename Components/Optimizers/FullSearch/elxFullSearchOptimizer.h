@@ -48,6 +48,25 @@ namespace elastix
  *   This varies the second transform parameter in the range [-4.0 3.0] with steps of 1.0
  *   and the third parameter in the range [-1.0 1.0] with steps of 0.5. The names are used
  *   as column headers in the screen output.
+ * \parameter FullSearchCoarseGridFactor: Enables a coarse-to-fine search when larger than 1.
+ *   First only every FullSearchCoarseGridFactor-th point in each search space dimension
+ *   is evaluated. Then the best points of this coarse lattice are refined, by evaluating
+ *   all points within FullSearchCoarseGridFactor - 1 steps of them. Points that are not
+ *   evaluated are NaN in the optimization surface image. Can be specified for each resolution.\n
+ *   example: <tt>(FullSearchCoarseGridFactor 4 2)</tt> \n
+ *   Default value: 1, which searches the full range.
+ * \parameter FullSearchNumberOfRefinementCandidates: The number of best points of the coarse
+ *   lattice that are refined. Can be specified for each resolution.\n
+ *   example: <tt>(FullSearchNumberOfRefinementCandidates 5)</tt> \n
+ *   Default value: 1.
+ * \parameter UseMultiThreadingForOptimizer: Evaluate the points of the search space
+ *   concurrently, each thread on its own copy of the metric. The number of threads is given
+ *   by the -threads command line argument, and is divided over the copies. Only supported for
+ *   a single metric with a combination of a matrix-offset, translation or B-spline transform;
+ *   otherwise a warning is printed and the points are evaluated one at a time. The results do
+ *   not depend on this setting. Can be specified for each resolution.\n
+ *   example: <tt>(UseMultiThreadingForOptimizer "true")</tt> \n
+ *   Default value: "false".
  *
  * \ingroup Optimizers
  * \sa FullSearchOptimizer
@@ -116,6 +135,9 @@ public:
   /** Methods that have to be present everywhere.*/
   void BeforeRegistration( void ) override;
 
+  /** Create the metric copies for multi-threading and call the superclass' implementation. */
+  void StartOptimization( void ) override;
+
   void BeforeEachResolution( void ) override;
 
   void AfterEachResolution( void ) override;
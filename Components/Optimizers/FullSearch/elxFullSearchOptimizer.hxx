@@ -19,6 +19,7 @@
 #define __elxFullSearchOptimizer_hxx
 
 #include "elxFullSearchOptimizer.h"
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -163,6 +164,32 @@ FullSearch< TElastix >
     }
   } // end while
 
+  /** Read the settings of the coarse-to-fine search. */
+  unsigned int coarseGridFactor = 1;
+  this->GetConfiguration()->ReadParameter( coarseGridFactor,
+    "FullSearchCoarseGridFactor", this->GetComponentLabel(), level, 0 );
+  this->SetCoarseGridFactor( std::max( coarseGridFactor, 1u ) );
+
+  unsigned int numberOfRefinementCandidates = 1;
+  this->GetConfiguration()->ReadParameter( numberOfRefinementCandidates,
+    "FullSearchNumberOfRefinementCandidates", this->GetComponentLabel(), level, 0 );
+  this->SetNumberOfRefinementCandidates( numberOfRefinementCandidates );
+
+  /** Read whether the points are evaluated concurrently. */
+  bool useMultiThreading = false;
+  this->GetConfiguration()->ReadParameter( useMultiThreading,
+    "UseMultiThreadingForOptimizer", this->GetComponentLabel(), level, 0 );
+  this->SetUseMultiThread( useMultiThreading );
+  if( useMultiThreading )
+  {
+    std::string tmp = this->m_Configuration->GetCommandLineArgument( "-threads" );
+    if( tmp != "" )
+    {
+      const unsigned int nrOfThreads = atoi( tmp.c_str() );
+      this->SetNumberOfWorkUnits( nrOfThreads );
+    }
+  }
+
   if( realGood )
   {
     /** The number of dimensions. */
@@ -180,6 +207,13 @@ FullSearch< TElastix >
     this->m_OptimizationSurface->Allocate();
     /** \todo try/catch block around Allocate? */
 
+    /** A coarse-to-fine search does not visit all points; mark the others. */
+    if( this->GetCoarseGridFactor() > 1 )
+    {
+      this->m_OptimizationSurface->FillBuffer(
+        itk::NumericTraits< float >::quiet_NaN() );
+    }
+
     /** Set the name of this image on disk. */
     std::string resultImageFormat = "mhd";
     this->m_Configuration->ReadParameter(
@@ -193,10 +227,21 @@ FullSearch< TElastix >
       << "." << resultImageFormat;
     this->m_OptimizationSurface->SetOutputFileName( makeString.str().c_str() );
 
-    elxout
-      << "Total number of iterations needed in this resolution: "
-      << this->GetNumberOfIterations()
-      << "." << std::endl;
+    if( this->GetCoarseGridFactor() > 1 )
+    {
+      elxout
+        << "Coarse-to-fine search in this resolution, with a coarse grid factor of "
+        << this->GetCoarseGridFactor()
+        << " and " << this->GetNumberOfRefinementCandidates()
+        << " refinement candidate(s)." << std::endl;
+    }
+    else
+    {
+      elxout
+        << "Total number of iterations needed in this resolution: "
+        << this->GetNumberOfIterations()
+        << "." << std::endl;
+    }
 
   }
   else
@@ -208,6 +253,33 @@ FullSearch< TElastix >
 } // end BeforeEachResolution()
 
 
+/**
+ * ***************** StartOptimization ***********************
+ */
+
+template< class TElastix >
+void
+FullSearch< TElastix >
+::StartOptimization( void )
+{
+  /** Evaluate the points concurrently on copies of the metric, if possible. */
+  if( this->GetUseMultiThread() )
+  {
+    typename Superclass2::CostFunctionContainerType clones;
+    if( !this->CreateCostFunctionClones( this->GetCostFunction(),
+      this->GetNumberOfWorkUnits(), clones ) )
+    {
+      this->SetUseMultiThread( false );
+    }
+    this->SetCostFunctionClones( clones );
+  }
+
+  /** Call the superclass' implementation. */
+  this->Superclass1::StartOptimization();
+
+} // end StartOptimization()
+
+
 /**
  * ***************** AfterEachIteration *************************
  */
@@ -258,6 +330,10 @@ FullSearch< TElastix >
       stopcondition = "Error in metric";
       break;
 
+    case CoarseToFineRangeSearched:
+      stopcondition = "The coarse lattice and the neighbourhoods of the best candidates have been searched";
+      break;
+
     default:
       stopcondition = "Unknown";
       break;
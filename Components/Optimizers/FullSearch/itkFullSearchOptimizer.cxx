@@ -25,6 +25,9 @@
 #include "itkMacro.h"
 #include "itkNumericTraits.h"
 
+#include <algorithm>
+#include <set>
+
 namespace itk
 {
 
@@ -45,6 +48,13 @@ FullSearchOptimizer
   m_NumberOfSearchSpaceDimensions = 0;
   m_SearchSpace                   = 0;
   m_LastSearchSpaceChanges        = 0;
+  m_CoarseGridFactor              = 1;
+  m_NumberOfRefinementCandidates  = 1;
+  m_UseMultiThread                = false;
+
+  /** Threading related variables. */
+  m_Threader                   = ThreaderType::New();
+  m_ThreaderParameters.st_Self = this;
 
 }   //end constructor
 
@@ -98,14 +108,222 @@ FullSearchOptimizer
   m_Stop = false;
 
   InvokeEvent( StartEvent() );
-  while( !m_Stop )
+
+  if( m_CoarseGridFactor > 1 )
   {
+    this->RunCoarseToFineSearch();
+  }
+  else
+  {
+    this->RunFullSearch();
+  }
 
-    try
+}   //end function ResumeOptimization
+
+
+/**
+ * ************************ RunFullSearch ************************
+ */
+void
+FullSearchOptimizer
+::RunFullSearch( void )
+{
+  const unsigned long numberOfIterations = this->GetNumberOfIterations();
+  const unsigned int  batchSize          = this->GetBatchSize();
+
+  /** Visit all points, starting at the current iteration. The linear index
+   * of a point equals the iteration number of the full search.
+   */
+  LinearIndexContainerType batch;
+  while( !m_Stop && m_CurrentIteration < numberOfIterations )
+  {
+    batch.clear();
+    for( unsigned long i = m_CurrentIteration;
+      i < numberOfIterations && batch.size() < batchSize; ++i )
     {
-      m_Value = m_CostFunction->GetValue( this->GetCurrentPosition() );
+      batch.push_back( i );
     }
-    catch( ExceptionObject & err )
+    this->EvaluateBatch( batch, 0 );
+  }
+
+  if( !m_Stop )
+  {
+    m_StopCondition = FullRangeSearched;
+    StopOptimization();
+  }
+
+} // end RunFullSearch
+
+
+/**
+ * ******************** RunCoarseToFineSearch ********************
+ */
+void
+FullSearchOptimizer
+::RunCoarseToFineSearch( void )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+  const IndexValueType        factor               = static_cast< IndexValueType >( m_CoarseGridFactor );
+
+  /** Setup the coarse lattice: every factor-th index and the last index. */
+  std::vector< std::vector< IndexValueType > > indicesPerDimension( searchSpaceDimension );
+  for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+  {
+    const IndexValueType size = static_cast< IndexValueType >( searchSpaceSize[ ssdim ] );
+    for( IndexValueType i = 0; i < size; i += factor )
+    {
+      indicesPerDimension[ ssdim ].push_back( i );
+    }
+    if( indicesPerDimension[ ssdim ].back() != size - 1 )
+    {
+      indicesPerDimension[ ssdim ].push_back( size - 1 );
+    }
+  }
+  LinearIndexContainerType coarseLattice;
+  this->AppendLattice( indicesPerDimension, coarseLattice );
+
+  /** Evaluate the coarse lattice. */
+  m_CurrentIteration = 0;
+  MeasureIndexPairContainerType evaluatedPoints;
+  this->EvaluatePoints( coarseLattice, &evaluatedPoints );
+  if( m_Stop )
+  {
+    return;
+  }
+
+  /** Select the best candidates. Ties are resolved by the linear index,
+   * so that the selection is deterministic.
+   */
+  if( m_Maximize )
+  {
+    for( unsigned int i = 0; i < evaluatedPoints.size(); ++i )
+    {
+      evaluatedPoints[ i ].first = -evaluatedPoints[ i ].first;
+    }
+  }
+  const std::size_t numberOfCandidates = std::min(
+    static_cast< std::size_t >( m_NumberOfRefinementCandidates ), evaluatedPoints.size() );
+  std::partial_sort( evaluatedPoints.begin(),
+    evaluatedPoints.begin() + numberOfCandidates, evaluatedPoints.end() );
+
+  /** Collect the points around the candidates that were not evaluated yet. */
+  std::set< unsigned long > visited( coarseLattice.begin(), coarseLattice.end() );
+  LinearIndexContainerType  refinement;
+  for( std::size_t c = 0; c < numberOfCandidates; ++c )
+  {
+    const SearchSpaceIndexType candidate = this->LinearIndexToIndex( evaluatedPoints[ c ].second );
+    for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+    {
+      const IndexValueType size  = static_cast< IndexValueType >( searchSpaceSize[ ssdim ] );
+      const IndexValueType first = std::max( candidate[ ssdim ] - factor + 1, IndexValueType( 0 ) );
+      const IndexValueType last  = std::min( candidate[ ssdim ] + factor - 1, size - 1 );
+      indicesPerDimension[ ssdim ].clear();
+      for( IndexValueType i = first; i <= last; ++i )
+      {
+        indicesPerDimension[ ssdim ].push_back( i );
+      }
+    }
+
+    LinearIndexContainerType neighbourhood;
+    this->AppendLattice( indicesPerDimension, neighbourhood );
+    for( std::size_t i = 0; i < neighbourhood.size(); ++i )
+    {
+      if( visited.insert( neighbourhood[ i ] ).second )
+      {
+        refinement.push_back( neighbourhood[ i ] );
+      }
+    }
+  }
+
+  /** Evaluate the refinement points. */
+  this->EvaluatePoints( refinement, 0 );
+
+  if( !m_Stop )
+  {
+    m_StopCondition = CoarseToFineRangeSearched;
+    StopOptimization();
+  }
+
+} // end RunCoarseToFineSearch
+
+
+/**
+ * ************************ EvaluatePoints ***********************
+ */
+void
+FullSearchOptimizer
+::EvaluatePoints( const LinearIndexContainerType & linearIndices,
+  MeasureIndexPairContainerType * evaluatedPoints )
+{
+  const std::size_t numberOfPoints = linearIndices.size();
+  const std::size_t batchSize      = this->GetBatchSize();
+
+  LinearIndexContainerType batch;
+  for( std::size_t begin = 0; begin < numberOfPoints && !m_Stop; begin += batchSize )
+  {
+    const std::size_t end = std::min( numberOfPoints, begin + batchSize );
+    batch.assign( linearIndices.begin() + begin, linearIndices.begin() + end );
+    this->EvaluateBatch( batch, evaluatedPoints );
+  }
+
+} // end EvaluatePoints
+
+
+/**
+ * ************************ EvaluateBatch ************************
+ */
+void
+FullSearchOptimizer
+::EvaluateBatch( const LinearIndexContainerType & linearIndices,
+  MeasureIndexPairContainerType * evaluatedPoints )
+{
+  const unsigned int numberOfPoints = static_cast< unsigned int >( linearIndices.size() );
+
+  /** Compute the positions. */
+  m_BatchPositions.resize( numberOfPoints );
+  for( unsigned int i = 0; i < numberOfPoints; ++i )
+  {
+    m_BatchPositions[ i ] = this->IndexToPosition( this->LinearIndexToIndex( linearIndices[ i ] ) );
+  }
+  m_BatchValues.assign( numberOfPoints, NumericTraits< MeasureType >::Zero );
+  m_BatchFailed.assign( numberOfPoints, false );
+  m_BatchExceptions.resize( numberOfPoints );
+
+  /** Evaluate the cost function. */
+  if( numberOfPoints == 1 || this->GetBatchSize() == 1 )
+  {
+    this->EvaluateBatchRange( 0, numberOfPoints, m_CostFunction );
+  }
+  else
+  {
+    /** Each work unit evaluates its points on its own clone. */
+    const ThreadIdType numberOfWorkUnits = m_Threader->GetNumberOfWorkUnits();
+    bool               enoughClones      = m_CostFunctionClones.size() >= numberOfWorkUnits;
+    for( ThreadIdType i = 0; enoughClones && i < numberOfWorkUnits; ++i )
+    {
+      enoughClones = m_CostFunctionClones[ i ].IsNotNull();
+    }
+    if( !enoughClones )
+    {
+      itkExceptionMacro( << "UseMultiThread is set, but no cost function clone is set "
+                         << "for each of the " << numberOfWorkUnits << " work units. "
+                         << "Use SetCostFunctionClones() to set one clone per work unit." );
+    }
+
+    m_Threader->SetSingleMethod( this->EvaluateBatchThreaderCallback,
+      &m_ThreaderParameters );
+    m_Threader->SingleMethodExecute();
+  }
+
+  /** Process the points in order. */
+  for( unsigned int i = 0; i < numberOfPoints; ++i )
+  {
+    m_CurrentIndexInSearchSpace = this->LinearIndexToIndex( linearIndices[ i ] );
+    m_CurrentPointInSearchSpace = this->IndexToPoint( m_CurrentIndexInSearchSpace );
+    this->SetCurrentPosition( m_BatchPositions[ i ] );
+
+    if( m_BatchFailed[ i ] )
     {
       // An exception has occurred.
       // Terminate immediately.
@@ -113,12 +331,13 @@ FullSearchOptimizer
       StopOptimization();
 
       // Pass exception to caller
-      throw err;
+      throw m_BatchExceptions[ i ];
     }
+    m_Value = m_BatchValues[ i ];
 
-    if( m_Stop )
+    if( evaluatedPoints )
     {
-      break;
+      evaluatedPoints->push_back( MeasureIndexPairType( m_Value, linearIndices[ i ] ) );
     }
 
     /** Check if the value is a minimum or maximum */
@@ -134,19 +353,177 @@ FullSearchOptimizer
     /** Prepare for next step */
     m_CurrentIteration++;
 
-    if( m_CurrentIteration >= this->GetNumberOfIterations() )
+    if( m_Stop )
     {
-      m_StopCondition = FullRangeSearched;
-      StopOptimization();
       break;
     }
+  }
 
-    /** Set the next position in search space. */
-    this->UpdateCurrentPosition();
+} // end EvaluateBatch
 
-  } // end while
 
-}   //end function ResumeOptimization
+/**
+ * ********************* EvaluateBatchRange **********************
+ */
+void
+FullSearchOptimizer
+::EvaluateBatchRange( const unsigned int begin, const unsigned int end,
+  const CostFunctionType * costFunction )
+{
+  for( unsigned int i = begin; i < end; ++i )
+  {
+    try
+    {
+      m_BatchValues[ i ] = costFunction->GetValue( m_BatchPositions[ i ] );
+    }
+    catch( ExceptionObject & err )
+    {
+      m_BatchFailed[ i ]     = true;
+      m_BatchExceptions[ i ] = err;
+    }
+  }
+
+} // end EvaluateBatchRange
+
+
+/**
+ * **************** EvaluateBatchThreaderCallback ****************
+ */
+ITK_THREAD_RETURN_TYPE
+FullSearchOptimizer
+::EvaluateBatchThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType                 threadID    = infoStruct->WorkUnitID;
+  ThreadIdType                 nrOfThreads = infoStruct->NumberOfWorkUnits;
+  MultiThreaderParameterType * temp
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Compute the part of the batch of this thread. */
+  const unsigned int numberOfPoints
+    = static_cast< unsigned int >( temp->st_Self->m_BatchPositions.size() );
+  const unsigned int chunkSize = ( numberOfPoints + nrOfThreads - 1 ) / nrOfThreads;
+  const unsigned int begin     = std::min( numberOfPoints, threadID * chunkSize );
+  const unsigned int end       = std::min( numberOfPoints, ( threadID + 1 ) * chunkSize );
+
+  /** Call the real implementation, on the cost function clone of this thread. */
+  temp->st_Self->EvaluateBatchRange( begin, end,
+    temp->st_Self->m_CostFunctionClones[ threadID ] );
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end EvaluateBatchThreaderCallback
+
+
+/**
+ * ************************ GetBatchSize *************************
+ */
+unsigned int
+FullSearchOptimizer
+::GetBatchSize( void ) const
+{
+  /** Without multi-threading the points are evaluated one by one, so that
+   * no evaluations are wasted when an observer stops the optimization.
+   */
+  const unsigned int numberOfWorkUnits = m_Threader->GetNumberOfWorkUnits();
+  if( !m_UseMultiThread || numberOfWorkUnits <= 1 )
+  {
+    return 1;
+  }
+
+  /** A few points per work unit, to balance the load. */
+  return 4 * numberOfWorkUnits;
+
+} // end GetBatchSize
+
+
+/**
+ * ************************ LinearIndexToIndex *******************
+ */
+FullSearchOptimizer::SearchSpaceIndexType
+FullSearchOptimizer
+::LinearIndexToIndex( unsigned long linearIndex )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+
+  /** The first dimension varies fastest, see UpdateCurrentPosition. */
+  SearchSpaceIndexType index( searchSpaceDimension );
+  for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+  {
+    index[ ssdim ] = static_cast< IndexValueType >( linearIndex % searchSpaceSize[ ssdim ] );
+    linearIndex   /= searchSpaceSize[ ssdim ];
+  }
+
+  return index;
+
+} // end LinearIndexToIndex
+
+
+/**
+ * ************************ IndexToLinearIndex *******************
+ */
+unsigned long
+FullSearchOptimizer
+::IndexToLinearIndex( const SearchSpaceIndexType & index )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+
+  unsigned long linearIndex = 0;
+  for( unsigned int ssdim = searchSpaceDimension; ssdim > 0; ssdim-- )
+  {
+    linearIndex = linearIndex * searchSpaceSize[ ssdim - 1 ]
+      + static_cast< unsigned long >( index[ ssdim - 1 ] );
+  }
+
+  return linearIndex;
+
+} // end IndexToLinearIndex
+
+
+/**
+ * ************************ AppendLattice ************************
+ */
+void
+FullSearchOptimizer
+::AppendLattice(
+  const std::vector< std::vector< IndexValueType > > & indicesPerDimension,
+  LinearIndexContainerType & linearIndices )
+{
+  const unsigned int searchSpaceDimension = static_cast< unsigned int >( indicesPerDimension.size() );
+  if( searchSpaceDimension == 0 )
+  {
+    return;
+  }
+
+  /** Loop over all combinations; the first dimension varies fastest. */
+  std::vector< std::size_t > counter( searchSpaceDimension, 0 );
+  SearchSpaceIndexType       index( searchSpaceDimension );
+  bool                       done = false;
+  while( !done )
+  {
+    for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+    {
+      index[ ssdim ] = indicesPerDimension[ ssdim ][ counter[ ssdim ] ];
+    }
+    linearIndices.push_back( this->IndexToLinearIndex( index ) );
+
+    /** Increase the counter. */
+    done = true;
+    for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+    {
+      if( ++counter[ ssdim ] < indicesPerDimension[ ssdim ].size() )
+      {
+        done = false;
+        break;
+      }
+      counter[ ssdim ] = 0;
+    }
+  }
+
+} // end AppendLattice
 
 
 /**
@@ -24,6 +24,9 @@
 #include "itkImage.h"
 #include "itkArray.h"
 #include "itkFixedArray.h"
+#include "itkPlatformMultiThreader.h"
+#include <utility>
+#include <vector>
 
 namespace itk
 {
@@ -35,6 +38,19 @@ namespace itk
  * Optimizer that scans a subspace of the parameter space
  * and searches for the best parameters.
  *
+ * By default all points of the search space are visited. Alternatively, a
+ * coarse-to-fine search can be done, by setting the CoarseGridFactor to a
+ * value larger than 1. Then only every CoarseGridFactor-th point (and the
+ * last point) in each search space dimension is evaluated first. After that,
+ * the NumberOfRefinementCandidates best points of this coarse lattice are
+ * refined, by evaluating all points of the search space that lie within
+ * CoarseGridFactor - 1 steps of them.
+ *
+ * The points can be evaluated concurrently, see SetUseMultiThread().
+ * The results do not depend on the number of threads: the points are
+ * always processed, and the IterationEvents are always invoked, in the
+ * same order.
+ *
  * \todo This optimizer has similar functionality as the recently added
  * itkExhaustiveOptimizer. See if we can replace it by that optimizer,
  * or inherit from it.
@@ -62,7 +78,8 @@ public:
   /** Codes of stopping conditions */
   typedef enum {
     FullRangeSearched,
-    MetricError
+    MetricError,
+    CoarseToFineRangeSearched
   } StopConditionType;
 
   /* Typedefs inherited from superclass */
@@ -89,6 +106,11 @@ public:
   /** The size of each dimension to be searched ((max-min)/step)) */
   typedef Array< SizeValueType > SearchSpaceSizeType;
 
+  /** Typedefs for multi-threading. */
+  typedef PlatformMultiThreader              ThreaderType;
+  typedef ThreaderType::WorkUnitInfo         ThreadInfoType;
+  typedef std::vector< CostFunctionPointer > CostFunctionContainerType;
+
   /** NB: The methods SetScales has no influence! */
 
   /** Methods to configure the cost function. */
@@ -125,7 +147,9 @@ public:
    */
   void StartOptimization( void ) override;
 
-  /** Resume previously stopped optimization with current parameters
+  /** Resume previously stopped optimization with current parameters.
+   * A full search continues at the current iteration; a coarse-to-fine
+   * search is started again.
    * \sa StopOptimization.
    */
   virtual void ResumeOptimization( void );
@@ -171,6 +195,51 @@ public:
   /** Convert an index to a point */
   virtual SearchSpacePointType IndexToPoint( const SearchSpaceIndexType & index );
 
+  /** Set/Get the step between the points of the coarse lattice, in number of
+   * search space steps. A value of 1 (the default) searches the full range.
+   */
+  itkSetMacro( CoarseGridFactor, unsigned int );
+  itkGetConstMacro( CoarseGridFactor, unsigned int );
+
+  /** Set/Get the number of best points of the coarse lattice that are refined.
+   * Only used when the CoarseGridFactor is larger than 1. Default: 1.
+   */
+  itkSetMacro( NumberOfRefinementCandidates, unsigned int );
+  itkGetConstMacro( NumberOfRefinementCandidates, unsigned int );
+
+  /** Set/Get whether the points of the search space are evaluated concurrently.
+   * Each work unit then evaluates its points on its own clone of the cost
+   * function, see SetCostFunctionClones(); the cost function itself is never
+   * called concurrently. An exception is thrown when less clones than work
+   * units are set. Default: false.
+   */
+  itkSetMacro( UseMultiThread, bool );
+  itkGetConstMacro( UseMultiThread, bool );
+  itkBooleanMacro( UseMultiThread );
+
+  /** Set the number of work units used to evaluate the points. */
+  virtual void SetNumberOfWorkUnits( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
+  }
+
+
+  virtual ThreadIdType GetNumberOfWorkUnits( void ) const
+  {
+    return this->m_Threader->GetNumberOfWorkUnits();
+  }
+
+
+  /** Set clones of the cost function, one for each work unit. Work unit i
+   * uses clone i. Only used when UseMultiThread is set.
+   */
+  virtual void SetCostFunctionClones( const CostFunctionContainerType & clones )
+  {
+    this->m_CostFunctionClones = clones;
+    this->Modified();
+  }
+
+
   /** Get the current iteration number. */
   itkGetConstMacro( CurrentIteration, unsigned long );
 
@@ -215,12 +284,76 @@ protected:
   unsigned long m_LastSearchSpaceChanges;
   virtual void ProcessSearchSpaceChanges( void );
 
+  /** Typedef for the evaluated points: the value and the linear index. */
+  typedef std::pair< MeasureType, unsigned long > MeasureIndexPairType;
+  typedef std::vector< MeasureIndexPairType >     MeasureIndexPairContainerType;
+  typedef std::vector< unsigned long >            LinearIndexContainerType;
+
+  /** Convert between an index in search space and its linear index, which
+   * is the iteration number at which a full search visits the point.
+   */
+  SearchSpaceIndexType LinearIndexToIndex( unsigned long linearIndex );
+
+  unsigned long IndexToLinearIndex( const SearchSpaceIndexType & index );
+
+  /** Append the linear indices of all combinations of the given indices
+   * per search space dimension, in full search order.
+   */
+  void AppendLattice( const std::vector< std::vector< IndexValueType > > & indicesPerDimension,
+    LinearIndexContainerType & linearIndices );
+
+  /** Evaluate a list of points in batches, see EvaluateBatch(). */
+  void EvaluatePoints( const LinearIndexContainerType & linearIndices,
+    MeasureIndexPairContainerType * evaluatedPoints );
+
+  /** Evaluate a batch of points, possibly concurrently, and then process
+   * them in order: update the best value and invoke an IterationEvent for
+   * each point. If evaluatedPoints is not null, the values are appended to it.
+   */
+  void EvaluateBatch( const LinearIndexContainerType & linearIndices,
+    MeasureIndexPairContainerType * evaluatedPoints );
+
+  /** Evaluate the points [begin, end) of the current batch on costFunction. */
+  void EvaluateBatchRange( const unsigned int begin, const unsigned int end,
+    const CostFunctionType * costFunction );
+
+  /** The threader callback function. */
+  static ITK_THREAD_RETURN_TYPE EvaluateBatchThreaderCallback( void * arg );
+
+  /** The number of points evaluated at once. */
+  unsigned int GetBatchSize( void ) const;
+
+  /** Run the full search, and the coarse-to-fine search, respectively. */
+  void RunFullSearch( void );
+
+  void RunCoarseToFineSearch( void );
+
+  /** To give the threads access to all members. */
+  struct MultiThreaderParameterType
+  {
+    Self * st_Self;
+  };
+
+  /** Threading related variables. */
+  MultiThreaderParameterType m_ThreaderParameters;
+  ThreaderType::Pointer      m_Threader;
+  CostFunctionContainerType  m_CostFunctionClones;
+
+  /** Variables of the current batch. */
+  std::vector< ParametersType >  m_BatchPositions;
+  std::vector< MeasureType >     m_BatchValues;
+  std::vector< unsigned char >   m_BatchFailed;
+  std::vector< ExceptionObject > m_BatchExceptions;
+
 private:
 
   FullSearchOptimizer( const Self & ); // purposely not implemented
   void operator=( const Self & );      // purposely not implemented
 
   unsigned long m_CurrentIteration;
+  unsigned int  m_CoarseGridFactor;
+  unsigned int  m_NumberOfRefinementCandidates;
+  bool          m_UseMultiThread;
 
 };
 
@@ -21,6 +21,7 @@
 #include "itkAdaptiveStochasticPreconditionedGradientDescentOptimizer.h"
 
 #include "vnl/vnl_math.h"
+#include "itkParameterUpdateKernels.h"
 
 namespace itk
 {
@@ -63,15 +64,17 @@ AdaptiveStochasticPreconditionedGradientDescentOptimizer
         std::log( - this->GetSigmoidMax() / this->GetSigmoidMin() );
       sigmoid.SetBeta( beta );
 
-      /** Formula (2) in Cruz */
-      const double inprod = inner_product(
-        this->m_PreviousSearchDirection, this->GetGradient() );
+      /** Formula (2) in Cruz, and save for the next iteration. */
+      const double inprod = ParameterUpdateKernels::InnerProductAndCopy(
+        this->m_PreviousSearchDirection, this->GetGradient(), this->GetSearchDirection() );
       this->m_CurrentTime += sigmoid(-inprod);
       this->m_CurrentTime = vnl_math_max( 0.0, this->m_CurrentTime );
     }
-
-    /** Save for next iteration */
-    this->m_PreviousSearchDirection = this->GetSearchDirection();
+    else
+    {
+      /** Save for next iteration */
+      this->m_PreviousSearchDirection = this->GetSearchDirection();
+    }
   }
   else
   {
@@ -64,6 +64,7 @@ namespace elastix
  *    Default/recommended value: 500. When you are in a hurry, you may go down to 250 for example.
  *    When you have plenty of time, and want to be absolutely sure of the best results, a setting
  *    of 2000 is reasonable. In general, 500 gives satisfactory results.
+ * \parameter ConvergenceWindowSize, ConvergenceRelativeTolerance, ConvergenceConfidenceFactor: see OptimizerBase.
  * \parameter MaximumNumberOfSamplingAttempts: The maximum number of sampling attempts. Sometimes
  *   not enough corresponding samples can be drawn, upon which an exception is thrown. With this
  *   parameter it is possible to try to draw another set of samples. \n
@@ -167,6 +168,15 @@ namespace elastix
  * \parameter RegularizationKappa: Selects for the preconditioner regularization.
  *   The parameter can be specified for each resolution, or for all resolutions at once.\n
  *   example: <tt>(RegularizationKappa 0.9)</tt>\n
+ * \parameter PreconditionerRefreshInterval: When larger than 0, the preconditioner is
+ *   re-estimated during the resolution, at the position of the optimizer. Instead of
+ *   interrupting the optimization, the Jacobian measurements are spread over this number
+ *   of iterations, after which the new preconditioner replaces the old one. The step size
+ *   and the noise compensation factor are not re-estimated.
+ *   The parameter can be specified for each resolution, or for all resolutions at once.\n
+ *   example: <tt>(PreconditionerRefreshInterval 100)</tt>\n
+ *   Default value: 0, which means that the preconditioner is only estimated at the start
+ *   of each resolution. The parameter has only influence when AutomaticParameterEstimation is used.
  *
  * \todo: this class contains a lot of functional code, which actually does not belong here.
  *
@@ -232,6 +242,10 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Get/Set the maximum number of iterations of the current resolution. */
+  elxMaximumNumberOfIterationsPublicMacro( NumberOfIterations );
+
+
   /** Check if any scales are set, and set the UseScales flag on or off;
    * after that call the superclass' implementation.
    */
@@ -377,6 +391,16 @@ protected :
    */
   virtual void AutomaticPreconditionerEstimation( void );
 
+  /** Replace the samplers of the metrics by random samplers with
+   * NumberOfSamplesForPrecondition samples, or restore the original samplers.
+   */
+  virtual void SetPreconditionSamplers( const bool install );
+
+  /** Process the next part of the Jacobian measurements of a refresh of the
+   * preconditioner, and replace the preconditioner when the refresh is complete.
+   */
+  virtual void RefreshPreconditioner( void );
+
   /** Measure some derivatives, exact and approximated. Returns
    * the squared magnitude of the gradient and approximation error.
    * Needed for the automatic parameter estimation.
@@ -419,8 +443,18 @@ private:
 
   /** The flag of using noise compensation. */
   bool m_UseNoiseCompensation;
+
+  /** Private variables for the preconditioner refresh. */
+  PreconditionerEstimationPointer        m_PreconditionerEstimator;
+  std::vector< ImageSamplerBasePointer > m_OriginalSamplers;
+  SizeValueType                          m_PreconditionerRefreshInterval;
+  SizeValueType                          m_PreconditionerRefreshBatchSize;
+  bool                                   m_UseJacobiTypePreconditioner;
   bool m_OriginalButSigmoidToDefault;
 
+  /** The number of threads of the parameter update, as set by -threads. */
+  itk::ThreadIdType m_NumberOfUpdateThreads;
+
 };
 
 } // end namespace elastix
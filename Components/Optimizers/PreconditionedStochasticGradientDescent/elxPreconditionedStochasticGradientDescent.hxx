@@ -29,6 +29,7 @@
 #include <utility>
 #include "itkAdvancedImageToImageMetric.h"
 #include "itkTimeProbe.h"
+#include "itkParameterUpdateKernels.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -69,6 +70,11 @@ PreconditionedStochasticGradientDescent< TElastix >
   this->m_AdvancedTransform = 0;
 
   this->m_UseNoiseCompensation = true;
+  this->m_NumberOfUpdateThreads = 0;
+
+  this->m_PreconditionerRefreshInterval  = 0;
+  this->m_PreconditionerRefreshBatchSize = 0;
+  this->m_UseJacobiTypePreconditioner    = false;
 
 } // Constructor
 
@@ -82,6 +88,9 @@ void
 PreconditionedStochasticGradientDescent< TElastix >
 ::BeforeRegistration( void )
 {
+  /** Use the random generator of this registration for the perturbations. */
+  this->m_RandomGenerator = this->GetElastix()->GetRandomGenerator();
+
   /** Add the target cell "stepsize" to xout["iteration"]. */
   xout[ "iteration" ].AddTargetCell( "2:Metric" );
   xout[ "iteration" ].AddTargetCell( "3a:Time" );
@@ -123,6 +132,17 @@ PreconditionedStochasticGradientDescent< TElastix >
     "MaximumNumberOfIterations", this->GetComponentLabel(), level, 0 );
   this->SetNumberOfIterations( maximumNumberOfIterations );
 
+  /** Set the number of threads of the parameter update, 0 meaning the default. */
+  this->m_NumberOfUpdateThreads = 0;
+  std::string tmp = this->m_Configuration->GetCommandLineArgument( "-threads" );
+  if( tmp != "" )
+  {
+    this->m_NumberOfUpdateThreads = atoi( tmp.c_str() );
+  }
+
+  /** Set the parameters of the convergence monitor. */
+  this->ReadConvergenceMonitorParameters( this->GetModifiableConvergenceMonitor() );
+
   /** Set the gain parameter A. */
   double A = 20.0;
   this->GetConfiguration()->ReadParameter( A,
@@ -163,6 +183,9 @@ PreconditionedStochasticGradientDescent< TElastix >
   this->GetConfiguration()->ReadParameter( this->m_AutomaticParameterEstimation,
     "AutomaticParameterEstimation", this->GetComponentLabel(), level, 0 );
 
+  this->m_PreconditionerEstimator       = nullptr;
+  this->m_PreconditionerRefreshInterval = 0;
+
   std::string stepSizeStrategy = "Adaptive";
   this->GetConfiguration()->ReadParameter(stepSizeStrategy,
     "StepSizeStrategy", this->GetComponentLabel(), 0, 0 );
@@ -264,6 +287,10 @@ PreconditionedStochasticGradientDescent< TElastix >
     this->GetConfiguration()->ReadParameter( this->m_ConditionNumber,
       "ConditionNumber", this->GetComponentLabel(), level, 0 );
 
+    /** Set the number of iterations over which a refresh of the preconditioner is spread. */
+    this->GetConfiguration()->ReadParameter( this->m_PreconditionerRefreshInterval,
+      "PreconditionerRefreshInterval", this->GetComponentLabel(), level, 0 );
+
   } // end if automatic parameter estimation
   else
   {
@@ -328,6 +355,13 @@ PreconditionedStochasticGradientDescent< TElastix >
     xl::xout[ "iteration" ][ "4b:||SearchDirection||" ] << this->GetSearchDirection().magnitude();
   }
 
+  /** Refresh the preconditioner, a part of it every iteration. */
+  if( this->m_PreconditionerRefreshInterval > 0
+    && this->m_PreconditionerEstimator.IsNotNull() )
+  {
+    this->RefreshPreconditioner();
+  }
+
   /** Select new spatial samples for the computation of the metric. */
   if( this->GetNewSamplesEveryIteration() )
   {
@@ -354,7 +388,8 @@ PreconditionedStochasticGradientDescent< TElastix >
    * typedef enum {
    *   MaximumNumberOfIterations,
    *   MetricError,
-   *   MinimumStepSize } StopConditionType;
+   *   MinimumStepSize,
+   *   StochasticConvergence } StopConditionType;
    */
   std::string stopcondition;
 
@@ -372,6 +407,10 @@ PreconditionedStochasticGradientDescent< TElastix >
       stopcondition = "The minimum step length has been reached";
       break;
 
+    case StochasticConvergence:
+      stopcondition = this->GetConvergenceMonitorStopCondition( this->GetConvergenceMonitor() );
+      break;
+
     default:
       stopcondition = "Unknown";
       break;
@@ -452,9 +491,6 @@ void
 PreconditionedStochasticGradientDescent< TElastix >
 ::AdvanceOneStep( void )
 {
-  /** Get space dimension. */
-  const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Compute and set the learning rate. */
   const double lamda = this->GetParam_a() / ( 1.0 + this->Superclass1::GetCurrentTime() / this->GetParam_A() );
   this->SetLearningRate( lamda );
@@ -467,13 +503,11 @@ PreconditionedStochasticGradientDescent< TElastix >
   /** Get a reference to the current position. */
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
-  /** Update the new position. */
+  /** Update the search direction and the new position, in a single pass. */
   const double lamda2 = lamda * this->m_NoiseFactor;
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    searchDirection[ j ] = this->m_PreconditionVector[ j ] * this->m_Gradient[ j ];
-    newPosition[ j ] = currentPosition[ j ] - lamda2 * searchDirection[ j ];
-  }
+  itk::ParameterUpdateKernels::PreconditionedGradientStep( newPosition, currentPosition,
+    this->m_PreconditionVector, this->m_Gradient, searchDirection, lamda2,
+    this->m_NumberOfUpdateThreads );
 
   this->Superclass1::UpdateCurrentTime();
   this->InvokeEvent( itk::IterationEvent() );
@@ -577,36 +611,14 @@ PreconditionedStochasticGradientDescent< TElastix >
                        << "the metric to be of type AdvancedImageToImageMetric!" );
   }
 
-  /** Getting pointers to the samplers. */
-  const unsigned int M = this->GetElastix()->GetNumberOfMetrics();
-  std::vector< ImageSamplerBasePointer >  originalSampler( M );
-  for( unsigned int m = 0; m < M; ++m )
-  {
-    ImageSamplerBasePointer sampler =
-      this->GetElastix()->GetElxMetricBase(m)->GetAdvancedMetricImageSampler();
-    originalSampler[ m ] = dynamic_cast< ImageSamplerBaseType * >( sampler.GetPointer() );
-  }
-
-  /** Create a random sampler with more samples that can be used for the pre-conditioner computation. */
-  //std::vector< ImageRandomCoordinateSamplerPointer > preconditionSamplers( M, 0 ); // very slow, leave this for reminder. YQ
-  std::vector< ImageRandomSamplerPointer > preconditionSamplers( M );
-  for( unsigned int m = 0; m < M; ++m )
-  {
-    ImageSamplerBasePointer sampler =
-      this->GetElastix()->GetElxMetricBase( m )->GetAdvancedMetricImageSampler();
-    //preconditionSamplers[ m ] = ImageRandomCoordinateSamplerType::New();
-    preconditionSamplers[ m ] = ImageRandomSamplerType::New();
-    preconditionSamplers[ m ]->SetInput( sampler->GetInput() );
-    preconditionSamplers[ m ]->SetInputImageRegion( sampler->GetInputImageRegion() );
-    preconditionSamplers[ m ]->SetMask( sampler->GetMask() );
-    preconditionSamplers[ m ]->SetNumberOfSamples( this->m_NumberOfSamplesForPrecondition );
-    preconditionSamplers[ m ]->Update();
-    this->GetElastix()->GetElxMetricBase( m )
-      ->SetAdvancedMetricImageSampler( preconditionSamplers[ m ] );
-  }
+  /** Use random samplers with more samples for the pre-conditioner computation. */
+  this->SetPreconditionSamplers( true );
 
-  /** Construct preconditionerEstimator to initialize the preconditioner estimation. */
-  PreconditionerEstimationPointer preconditionerEstimator = PreconditionerEstimationType::New();
+  /** Construct preconditionerEstimator to initialize the preconditioner estimation.
+   * It is kept for refreshing the preconditioner during the resolution.
+   */
+  this->m_PreconditionerEstimator = PreconditionerEstimationType::New();
+  PreconditionerEstimationType * preconditionerEstimator = this->m_PreconditionerEstimator;
   preconditionerEstimator->SetFixedImage( testPtr->GetFixedImage() );
   preconditionerEstimator->SetFixedImageRegion( testPtr->GetFixedImageRegion() );
   preconditionerEstimator->SetFixedImageMask( testPtr->GetFixedImageMask() );
@@ -619,6 +631,7 @@ PreconditionedStochasticGradientDescent< TElastix >
   preconditionerEstimator->SetMaximumStepLength( this->m_MaximumStepLength );
   preconditionerEstimator->SetConditionNumber( this->m_ConditionNumber );
   preconditionerEstimator->SetUseScales( false ); // Make sure scales are not used
+  preconditionerEstimator->SetNumberOfWorkUnits( testPtr->GetNumberOfWorkUnits() );
 
   /** Construct the preconditioner and initialize. */
   this->m_PreconditionVector = ParametersType( P );
@@ -632,6 +645,7 @@ PreconditionedStochasticGradientDescent< TElastix >
   bool useJacobiType = false;
   this->GetConfiguration()->ReadParameter( useJacobiType,
     "JacobiTypePreconditioner", this->GetComponentLabel(), level, 0 );
+  this->m_UseJacobiTypePreconditioner = useJacobiType;
 
   if( useJacobiType )
   {
@@ -658,10 +672,7 @@ PreconditionedStochasticGradientDescent< TElastix >
 #endif
 
   /** Set the sampler back to the original. */
-  for( unsigned int m = 0; m < M; ++m )
-  {
-    this->GetElastix()->GetElxMetricBase( m )->SetAdvancedMetricImageSampler( originalSampler[ m ] );
-  }
+  this->SetPreconditionSamplers( false );
 
   /** This part is for PSGD-Jacobian type preconditioner, automatic etimation of the step size. */
   double      jacg = 0.0;
@@ -747,6 +758,100 @@ PreconditionedStochasticGradientDescent< TElastix >
 } // end AutomaticPreconditionerEstimation()
 
 
+/**
+ * ******************* SetPreconditionSamplers **********************
+ */
+
+template< class TElastix >
+void
+PreconditionedStochasticGradientDescent< TElastix >
+::SetPreconditionSamplers( const bool install )
+{
+  const unsigned int M = this->GetElastix()->GetNumberOfMetrics();
+
+  /** Set the samplers back to the original. */
+  if( !install )
+  {
+    for( unsigned int m = 0; m < this->m_OriginalSamplers.size(); ++m )
+    {
+      this->GetElastix()->GetElxMetricBase( m )
+        ->SetAdvancedMetricImageSampler( this->m_OriginalSamplers[ m ] );
+    }
+    this->m_OriginalSamplers.clear();
+    return;
+  }
+
+  /** Getting pointers to the samplers. */
+  this->m_OriginalSamplers.resize( M );
+  for( unsigned int m = 0; m < M; ++m )
+  {
+    ImageSamplerBasePointer sampler =
+      this->GetElastix()->GetElxMetricBase(m)->GetAdvancedMetricImageSampler();
+    this->m_OriginalSamplers[ m ] = dynamic_cast< ImageSamplerBaseType * >( sampler.GetPointer() );
+  }
+
+  /** Create a random sampler with more samples that can be used for the pre-conditioner computation. */
+  //std::vector< ImageRandomCoordinateSamplerPointer > preconditionSamplers( M, 0 ); // very slow, leave this for reminder. YQ
+  std::vector< ImageRandomSamplerPointer > preconditionSamplers( M );
+  for( unsigned int m = 0; m < M; ++m )
+  {
+    ImageSamplerBasePointer sampler =
+      this->GetElastix()->GetElxMetricBase( m )->GetAdvancedMetricImageSampler();
+    //preconditionSamplers[ m ] = ImageRandomCoordinateSamplerType::New();
+    preconditionSamplers[ m ] = ImageRandomSamplerType::New();
+    preconditionSamplers[ m ]->SetRandomGenerator( this->m_RandomGenerator );
+    preconditionSamplers[ m ]->SetInput( sampler->GetInput() );
+    preconditionSamplers[ m ]->SetInputImageRegion( sampler->GetInputImageRegion() );
+    preconditionSamplers[ m ]->SetMask( sampler->GetMask() );
+    preconditionSamplers[ m ]->SetNumberOfSamples( this->m_NumberOfSamplesForPrecondition );
+    preconditionSamplers[ m ]->Update();
+    this->GetElastix()->GetElxMetricBase( m )
+      ->SetAdvancedMetricImageSampler( preconditionSamplers[ m ] );
+  }
+
+} // end SetPreconditionSamplers()
+
+
+/**
+ * ******************* RefreshPreconditioner **********************
+ */
+
+template< class TElastix >
+void
+PreconditionedStochasticGradientDescent< TElastix >
+::RefreshPreconditioner( void )
+{
+  PreconditionerEstimationType * estimator = this->m_PreconditionerEstimator;
+
+  /** Start a new refresh at the current position. The gradient is computed
+   * now; the Jacobian measurements are spread over the next iterations.
+   */
+  if( estimator->GetNumberOfRemainingPreconditionerSamples() == 0 )
+  {
+    this->SetPreconditionSamplers( true );
+    estimator->InitializePreconditioner( this->GetScaledCurrentPosition(),
+      this->m_UseJacobiTypePreconditioner );
+    this->SetPreconditionSamplers( false );
+
+    this->m_PreconditionerRefreshBatchSize = static_cast< SizeValueType >( std::ceil(
+      static_cast< double >( estimator->GetNumberOfPreconditionerSamples() )
+      / static_cast< double >( this->m_PreconditionerRefreshInterval ) ) );
+    return;
+  }
+
+  /** Process the next part of the Jacobian measurements. */
+  estimator->AccumulatePreconditioner( this->m_PreconditionerRefreshBatchSize );
+
+  /** Replace the preconditioner when the refresh is complete. */
+  if( estimator->GetNumberOfRemainingPreconditionerSamples() == 0 )
+  {
+    double maxJJ = 0.0;
+    estimator->FinalizePreconditioner( maxJJ, this->m_PreconditionVector );
+  }
+
+} // end RefreshPreconditioner()
+
+
 /**
  * ******************** SampleGradients **********************
  */
@@ -80,6 +80,15 @@ namespace elastix
  *    In general it is wise to do so.\n
  *    example: <tt>(StopIfWolfeNotSatisfied "true" "false")</tt> \n
  *    Default value: "true".\n
+ * \parameter NumberOfSpeculativeLineSearchSteps: The number of step lengths that the
+ *    itk::MoreThuenteLineSearchOptimizer evaluates in each line search iteration: the
+ *    trial step and NumberOfSpeculativeLineSearchSteps - 1 candidates. When larger than 1,
+ *    the steps are evaluated concurrently, each thread on its own copy of the metric; the
+ *    number of threads is given by the -threads command line argument. Only supported for
+ *    a single metric with a combination of a matrix-offset, translation or B-spline
+ *    transform; otherwise a warning is printed and the steps are evaluated one at a time.\n
+ *    example: <tt>(NumberOfSpeculativeLineSearchSteps 4 4 2)</tt> \n
+ *    Default value: 1, which disables the speculative steps.\n
  *
  * \ingroup Optimizers
  */
@@ -136,6 +145,7 @@ public:
   typedef typename EventPassThroughType::Pointer EventPassThroughPointer;
 
   /** Check if any scales are set, and set the UseScales flag on or off;
+   * create the metric copies for the speculative line search steps;
    * after that call the superclass' implementation */
   void StartOptimization( void ) override;
 
@@ -151,6 +161,10 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Get/Set the maximum number of iterations of the current resolution. */
+  elxMaximumNumberOfIterationsPublicMacro( MaximumNumberOfIterations );
+
+
   itkGetConstMacro( StartLineSearch, bool );
 
 protected:
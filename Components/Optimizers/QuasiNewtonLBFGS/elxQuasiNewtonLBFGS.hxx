@@ -103,6 +103,23 @@ QuasiNewtonLBFGS< TElastix >::StartOptimization( void )
     }
   }
 
+  /** Evaluate the speculative line search steps concurrently on copies
+   * of the metric, if possible.
+   */
+  typename Superclass2::CostFunctionContainerType clones;
+  if( this->m_LineOptimizer->GetNumberOfSpeculativeSteps() > 1
+    && this->m_LineOptimizer->GetNumberOfWorkUnits() > 1 )
+  {
+    if( !this->CreateCostFunctionClones( this->GetCostFunction(),
+      this->m_LineOptimizer->GetNumberOfWorkUnits(), clones ) )
+    {
+      /** Fall back to the plain, non-speculative line search. */
+      this->m_LineOptimizer->SetNumberOfSpeculativeSteps( 1 );
+      this->m_LineOptimizer->SetNumberOfWorkUnits( 1 );
+    }
+  }
+  this->SetCostFunctionClones( clones );
+
   this->Superclass1::StartOptimization();
 
 }   //end StartOptimization
@@ -260,6 +277,21 @@ QuasiNewtonLBFGS< TElastix >
     "LineSearchGradientTolerance", this->GetComponentLabel(), level, 0 );
   this->m_LineOptimizer->SetGradientTolerance( lineSearchGradientTolerance );
 
+  /** Set the NumberOfSpeculativeLineSearchSteps */
+  unsigned int numberOfSpeculativeSteps = 1;
+  this->m_Configuration->ReadParameter( numberOfSpeculativeSteps,
+    "NumberOfSpeculativeLineSearchSteps", this->GetComponentLabel(), level, 0 );
+  this->m_LineOptimizer->SetNumberOfSpeculativeSteps( numberOfSpeculativeSteps );
+  if( numberOfSpeculativeSteps > 1 )
+  {
+    std::string tmp = this->m_Configuration->GetCommandLineArgument( "-threads" );
+    if( tmp != "" )
+    {
+      const unsigned int nrOfThreads = atoi( tmp.c_str() );
+      this->m_LineOptimizer->SetNumberOfWorkUnits( nrOfThreads );
+    }
+  }
+
   /** Set the GradientMagnitudeTolerance */
   double gradientMagnitudeTolerance = 0.000001;
   this->m_Configuration->ReadParameter( gradientMagnitudeTolerance,
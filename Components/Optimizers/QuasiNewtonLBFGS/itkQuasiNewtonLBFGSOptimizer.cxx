@@ -361,6 +361,16 @@ QuasiNewtonLBFGSOptimizer::LineSearch(
   }
 
   LSO->SetCostFunction( this->m_ScaledCostFunction );
+
+  /** Pass the scaled clones, for line searches that evaluate steps concurrently. */
+  const ScaledCostFunctionContainerType &            scaledClones = this->GetScaledCostFunctionClones();
+  LineSearchOptimizerType::CostFunctionContainerType clones( scaledClones.size() );
+  for( unsigned int i = 0; i < scaledClones.size(); ++i )
+  {
+    clones[ i ] = scaledClones[ i ].GetPointer();
+  }
+  LSO->SetCostFunctionClones( clones );
+
   LSO->SetLineSearchDirection( searchDir );
   LSO->SetInitialPosition( x );
   LSO->SetInitialValue( f );
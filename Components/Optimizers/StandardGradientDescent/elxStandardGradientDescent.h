@@ -121,6 +121,10 @@ public:
 
   void AfterRegistration( void ) override;
 
+  /** Get/Set the maximum number of iterations of the current resolution. */
+  elxMaximumNumberOfIterationsPublicMacro( NumberOfIterations );
+
+
   /** Check if any scales are set, and set the UseScales flag on or off;
   * after that call the superclass' implementation */
   void StartOptimization( void ) override;
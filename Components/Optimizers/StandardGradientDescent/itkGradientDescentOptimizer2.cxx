@@ -21,10 +21,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkMacro.h"
-
-#ifdef ELASTIX_USE_OPENMP
-#include <omp.h>
-#endif
+#include "itkParameterUpdateKernels.h"
 
 
 namespace itk
@@ -45,6 +42,7 @@ GradientDescentOptimizer2
   this->m_CurrentIteration   = 0;
   this->m_Value              = 0.0;
   this->m_StopCondition      = MaximumNumberOfIterations;
+  this->m_ConvergenceMonitor = ConvergenceMonitorType::New();
 
   this->m_UseOpenMP      = false;
 #ifdef ELASTIX_USE_OPENMP
@@ -85,6 +83,7 @@ GradientDescentOptimizer2
 ::StartOptimization( void )
 {
   this->m_CurrentIteration = 0;
+  this->m_ConvergenceMonitor->Initialize();
 
   /** Get the number of parameters; checks also if a cost function has been set at all.
    * if not: an exception is thrown */
@@ -153,6 +152,14 @@ GradientDescentOptimizer2
       break;
     }
 
+    /** Stop when the metric value stopped decreasing. */
+    if( this->m_ConvergenceMonitor->AddValue( this->m_Value ) )
+    {
+      this->m_StopCondition = StochasticConvergence;
+      this->StopOptimization();
+      break;
+    }
+
   } // end while
 
 } // end ResumeOptimization()
@@ -201,36 +208,17 @@ GradientDescentOptimizer2
 {
   itkDebugMacro( "AdvanceOneStep" );
 
-  /** Get space dimension. */
-  const unsigned int spaceDimension = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Get a reference to the previously allocated newPosition. */
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
-  /** Advance one step. */
-#if 1 // force single-threaded since it is fastest most of the times
-//#ifndef ELASTIX_USE_OPENMP // If no OpenMP detected then use single-threaded code
   /** Get a reference to the current position. */
   const ParametersType & currentPosition = this->GetScaledCurrentPosition();
 
-  /** Update the new position. */
-  for( unsigned int j = 0; j < spaceDimension; ++j )
-  {
-    newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * this->m_Gradient[ j ];
-  }
-#else // Otherwise use OpenMP
-  /** Get a reference to the current position. */
-  const ParametersType & currentPosition = this->GetScaledCurrentPosition();
-
-  /** Update the new position. */
-  const int nthreads = static_cast< int >( this->m_Threader->GetNumberOfWorkUnits() );
-  omp_set_num_threads( nthreads );
-  #pragma omp parallel for
-  for( int j = 0; j < static_cast< int >( spaceDimension ); j++ )
-  {
-    newPosition[ j ] = currentPosition[ j ] - this->m_LearningRate * this->m_Gradient[ j ];
-  }
-#endif
+  /** Advance one step: mu_{k+1} = mu_k - a_k * gradient_k.
+   * Multi-threaded only for large numbers of parameters.
+   */
+  ParameterUpdateKernels::GradientStep( newPosition, currentPosition,
+    this->m_Gradient, this->m_LearningRate, this->m_UseOpenMP ? 0 : 1 );
 
   this->InvokeEvent( IterationEvent() );
 
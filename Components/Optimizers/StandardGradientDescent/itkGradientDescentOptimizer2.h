@@ -19,6 +19,7 @@
 #define __itkGradientDescentOptimizer2_h
 
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
+#include "itkStochasticConvergenceMonitor.h"
 
 
 namespace itk
@@ -37,8 +38,9 @@ namespace itk
  * \f]
  *
  * The learning rate is a fixed scalar defined via SetLearningRate().
- * The optimizer steps through a user defined number of iterations;
- * no convergence checking is done.
+ * The optimizer steps through a user defined number of iterations,
+ * unless the ConvergenceMonitor detects that the metric value stopped
+ * decreasing; by default it is disabled.
  *
  * Additionally, user can scale each component of the \f$\partial f / \partial p\f$
  * but setting a scaling vector using method SetScale().
@@ -83,9 +85,13 @@ public:
   typedef enum {
     MaximumNumberOfIterations,
     MetricError,
-    MinimumStepSize
+    MinimumStepSize,
+    StochasticConvergence
   } StopConditionType;
 
+  /** Typedef for the convergence monitor. */
+  typedef StochasticConvergenceMonitor ConvergenceMonitorType;
+
   /** Advance one step following the gradient direction. */
   virtual void AdvanceOneStep( void );
 
@@ -130,9 +136,17 @@ public:
   /** Get current search direction */
   itkGetConstReferenceMacro( SearchDirection, DerivativeType );
 
-  /** Set use OpenMP or not. */
+  /** Set whether the parameter update may be multi-threaded. This is only
+   * done for large numbers of parameters, see ParameterUpdateKernels.
+   * Default: true when elastix is built with OpenMP.
+   */
   itkSetMacro( UseOpenMP, bool );
 
+  /** Get the convergence monitor, to configure it. It is fed with the metric
+   * value of every iteration, see StochasticConvergenceMonitor.
+   */
+  itkGetModifiableObjectMacro( ConvergenceMonitor, ConvergenceMonitorType );
+
 protected:
 
   GradientDescentOptimizer2();
@@ -150,6 +164,8 @@ protected:
   unsigned long m_NumberOfIterations;
   unsigned long m_CurrentIteration;
 
+  ConvergenceMonitorType::Pointer m_ConvergenceMonitor;
+
 private:
 
   GradientDescentOptimizer2( const Self & ); // purposely not implemented
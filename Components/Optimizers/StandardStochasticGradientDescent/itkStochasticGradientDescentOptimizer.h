@@ -158,10 +158,12 @@ public:
     this->m_Threader->SetNumberOfWorkUnits( numberOfThreads );
   }
   //itkGetConstReferenceMacro( NumberOfThreads, ThreadIdType );
-  itkSetMacro( UseMultiThread, bool );
 
-  itkSetMacro( UseOpenMP, bool );
-  itkSetMacro( UseEigen, bool );
+  /** Set whether AdvanceOneStep() may be multi-threaded. This is only
+   * done for large numbers of parameters, see ParameterUpdateKernels.
+   * Default: true.
+   */
+  itkSetMacro( UseMultiThread, bool );
 
 protected:
   StochasticGradientDescentOptimizer();
@@ -197,22 +199,8 @@ private:
   StochasticGradientDescentOptimizer( const Self& ); //purposely not implemented
   void operator=( const Self& ); //purposely not implemented
 
-  // multi-threaded AdvanceOneStep:
+  /** Use multi-threading in AdvanceOneStep(). */
   bool m_UseMultiThread;
-  struct MultiThreaderParameterType
-  {
-    ParametersType *  t_NewPosition;
-    Self *            t_Optimizer;
-  };
-
-  bool m_UseOpenMP;
-  bool m_UseEigen;
-
-  /** The callback function. */
-  static ITK_THREAD_RETURN_TYPE AdvanceOneStepThreaderCallback( void * arg );
-
-  /** The threaded implementation of AdvanceOneStep(). */
-  inline void ThreadedAdvanceOneStep( ThreadIdType threadId, ParametersType & newPosition );
 
 };
 
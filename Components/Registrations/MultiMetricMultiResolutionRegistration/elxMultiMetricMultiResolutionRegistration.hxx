@@ -298,7 +298,7 @@ MultiMetricMultiResolutionRegistration< TElastix >
   for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfFixedImagePyramids(); ++i )
   {
     this->SetFixedImagePyramid( this->GetElastix()->
-      GetElxFixedImagePyramidBase( i )->GetAsITKBaseType(), i );
+      GetElxFixedImagePyramidBase( i )->GetRegistrationPyramid(), i );
   }
 
   for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfMovingImagePyramids(); ++i )
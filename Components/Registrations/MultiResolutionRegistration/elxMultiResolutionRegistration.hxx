@@ -117,7 +117,7 @@ MultiResolutionRegistration< TElastix >
   this->SetMovingImage( this->GetElastix()->GetMovingImage() );
 
   this->SetFixedImagePyramid( this->GetElastix()->
-    GetElxFixedImagePyramidBase()->GetAsITKBaseType() );
+    GetElxFixedImagePyramidBase()->GetRegistrationPyramid() );
 
   this->SetMovingImagePyramid( this->GetElastix()->
     GetElxMovingImagePyramidBase()->GetAsITKBaseType() );
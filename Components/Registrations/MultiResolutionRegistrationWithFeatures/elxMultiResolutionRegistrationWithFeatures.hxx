@@ -111,7 +111,7 @@ MultiResolutionRegistrationWithFeatures< TElastix >
   for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfFixedImagePyramids(); ++i )
   {
     this->SetFixedImagePyramid( this->GetElastix()->
-      GetElxFixedImagePyramidBase( i )->GetAsITKBaseType(), i );
+      GetElxFixedImagePyramidBase( i )->GetRegistrationPyramid(), i );
   }
 
   /** Set the moving image pyramids. */
@@ -500,6 +500,13 @@ MultiInputMultiResolutionImageRegistrationMethodBase< TFixedImage, TMovingImage
       break;
     }
 
+    // Skip the levels that were completed before, when resuming
+    if( currentLevel < this->GetResumeLevel() )
+    {
+      this->SkipCurrentLevel();
+      continue;
+    }
+
     try
     {
       // initialize the interconnects between components
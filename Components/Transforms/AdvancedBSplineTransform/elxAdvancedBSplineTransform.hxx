@@ -456,6 +456,9 @@ AdvancedBSplineTransform< TElastix >
   this->m_GridUpsampler->SetRequiredGridRegion( requiredGridRegion );
   this->m_GridUpsampler->SetRequiredGridDirection( requiredGridDirection );
 
+  /** The exact refinement does not wrap around the cyclic dimension. */
+  this->m_GridUpsampler->SetUseRefinement( !this->m_Cyclic );
+
   /** Compute the upsampled B-spline parameters. */
   ParametersType upsampledParameters;
   this->m_GridUpsampler->UpsampleParameters( latestParameters, upsampledParameters );
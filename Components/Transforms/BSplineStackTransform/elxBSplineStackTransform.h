@@ -24,6 +24,7 @@
 #include "itkAdvancedCombinationTransform.h"
 #include "itkAdvancedBSplineDeformableTransform.h"
 #include "itkStackTransform.h"
+#include "itkBSplineStackTransform.h"
 
 /** Include grid schedule computer and upsample filter. */
 #include "itkGridScheduleComputer.h"
@@ -165,6 +166,22 @@ public:
     itkGetStaticConstMacro( SpaceDimension ) >            BSplineStackTransformType;
   typedef typename BSplineStackTransformType::Pointer BSplineStackTransformPointer;
 
+  /** Typedefs for the stack transforms with a B-spline sub transform of
+   * a specific order, which evaluate all sub transforms on a shared grid.
+   */
+  typedef itk::BSplineStackTransform<
+    typename elx::TransformBase< TElastix >::CoordRepType,
+    itkGetStaticConstMacro( SpaceDimension ),
+    1 >                                                   BSplineStackTransformLinearType;
+  typedef itk::BSplineStackTransform<
+    typename elx::TransformBase< TElastix >::CoordRepType,
+    itkGetStaticConstMacro( SpaceDimension ),
+    2 >                                                   BSplineStackTransformQuadraticType;
+  typedef itk::BSplineStackTransform<
+    typename elx::TransformBase< TElastix >::CoordRepType,
+    itkGetStaticConstMacro( SpaceDimension ),
+    3 >                                                   BSplineStackTransformCubicType;
+
   /** Typedef for supported BSplineTransform types. */
   typedef itk::AdvancedBSplineDeformableTransform<
     typename elx::TransformBase< TElastix >::CoordRepType,
@@ -50,14 +50,17 @@ BSplineStackTransform< TElastix >
   if( this->m_SplineOrder == 1 )
   {
     this->m_BSplineDummySubTransform = BSplineTransformLinearType::New();
+    this->m_BSplineStackTransform    = BSplineStackTransformLinearType::New();
   }
   else if( this->m_SplineOrder == 2 )
   {
     this->m_BSplineDummySubTransform = BSplineTransformQuadraticType::New();
+    this->m_BSplineStackTransform    = BSplineStackTransformQuadraticType::New();
   }
   else if( this->m_SplineOrder == 3 )
   {
     this->m_BSplineDummySubTransform = BSplineTransformCubicType::New();
+    this->m_BSplineStackTransform    = BSplineStackTransformCubicType::New();
   }
   else
   {
@@ -70,9 +73,6 @@ BSplineStackTransform< TElastix >
    * for image dimension 2.
    */
 
-  /** Create stack transform. */
-  this->m_BSplineStackTransform = BSplineStackTransformType::New();
-
   /** Set stack transform as current transform. */
   this->SetCurrentTransform( this->m_BSplineStackTransform );
 
@@ -25,6 +25,7 @@
 #include "itkThinPlateSplineKernelTransform2.h"
 #include "itkThinPlateR2LogRSplineKernelTransform2.h"
 #include "itkVolumeSplineKernelTransform2.h"
+#include "itkWendlandSplineKernelTransform2.h"
 
 namespace elastix
 {
@@ -53,8 +54,12 @@ namespace elastix
  *    <tt>(%Transform "SplineKernelTransform")</tt>
  * \parameter SplineKernelType: Select the deformation model, which must
  * be one of { ThinPlateSpline, ThinPlateR2LogRSpline, VolumeSpline,
- * ElasticBodySpline, ElasticBodyReciprocalSpline). In 2D this option is
- * ignored and a ThinPlateSpline will always be used. \n
+ * ElasticBodySpline, ElasticBodyReciprocalSpline, WendlandSpline). In 2D
+ * this option is ignored and a ThinPlateSpline will always be used, unless
+ * the WendlandSpline is selected. The WendlandSpline has a compactly
+ * supported kernel and uses a sparse (cached Cholesky or iterative)
+ * solver, which makes it suitable for large sets of landmarks (tens of
+ * thousands). \n
  *   example: <tt>(SplineKernelType "ElasticBodySpline")</tt>\n
  * Default: ThinPlateSpline. You cannot specify this parameter for each
  * resolution differently.
@@ -70,6 +75,18 @@ namespace elastix
  * Default: 0.3. You cannot specify this parameter for each resolution differently.\n
  * Valid values are withing -1.0 and 0.5. 0.5 means incompressible.
  * Negative values are a bit odd, but possible. See Wikipedia on PoissonRatio.
+ * \parameter SplineSupportRadius: Set the support radius (in mm) of the
+ * WendlandSpline kernel. For other SplineKernelTypes this parameter is
+ * ignored. A value of 0 means that the radius is estimated from the
+ * landmark density.\n
+ *   example: <tt>(SplineSupportRadius 20.0 )</tt>\n
+ * Default: 0.0. You cannot specify this parameter for each resolution differently.
+ * \parameter SplineSolverTolerance: Set the relative residual tolerance of
+ * the conjugate gradient solver of the WendlandSpline, which is used when
+ * the kernel matrix is too large to be factorized. For other
+ * SplineKernelTypes this parameter is ignored.\n
+ *   example: <tt>(SplineSolverTolerance 1e-6 )</tt>\n
+ * Default: 1e-8. You cannot specify this parameter for each resolution differently.
  *
  * \commandlinearg -fp: a file specifying a set of points that will serve
  * as fixed image landmarks.\n
@@ -91,8 +108,9 @@ namespace elastix
  *    <tt>(%Transform "SplineKernelTransform")</tt>
  * \transformparameter SplineKernelType: Select the deformation model,
  * which must be one of { ThinPlateSpline, ThinPlateR2LogRSpline, VolumeSpline,
- * ElasticBodySpline, ElasticBodyReciprocalSpline). In 2D this option is
- * ignored and a ThinPlateSpline will always be used. \n
+ * ElasticBodySpline, ElasticBodyReciprocalSpline, WendlandSpline). In 2D this
+ * option is ignored and a ThinPlateSpline will always be used, unless the
+ * WendlandSpline is selected. \n
  *   example: <tt>(SplineKernelType "ElasticBodySpline")</tt>\n   *
  * \transformparameter SplineRelaxationFactor: make the spline interpolating
  * or approximating. A value of 0.0 gives an interpolating transform.
@@ -104,6 +122,13 @@ namespace elastix
  *   example: <tt>(SplinePoissonRatio 0.3 )</tt>\n
  * Valid values are withing -1.0 and 0.5. 0.5 means incompressible.
  * Negative values are a bit odd, but possible. See Wikipedia on PoissonRatio.
+ * \transformparameter SplineSupportRadius: The support radius of the
+ * WendlandSpline kernel, as used during the registration (also when it was
+ * estimated). For other SplineKernelTypes this parameter is ignored.\n
+ *   example: <tt>(SplineSupportRadius 20.0 )</tt>\n
+ * \transformparameter SplineSolverTolerance: The relative residual tolerance
+ * of the conjugate gradient solver of the WendlandSpline.\n
+ *   example: <tt>(SplineSolverTolerance 1e-8 )</tt>\n
  * \transformparameter FixedImageLandmarks: The landmark positions in the
  * fixed image, in world coordinates. Positions written as x1 y1 [z1] x2 y2 [z2] etc.\n
  *   example: <tt>(FixedImageLandmarks 10.0 11.0 12.0 4.0 4.0 4.0 6.0 6.0 6.0 )</tt>
@@ -219,12 +244,19 @@ protected:
     CoordRepType, itkGetStaticConstMacro( SpaceDimension ) >   EBKernelTransformType;
   typedef itk::ElasticBodyReciprocalSplineKernelTransform2<
     CoordRepType, itkGetStaticConstMacro( SpaceDimension ) >   EBRKernelTransformType;
+  typedef itk::WendlandSplineKernelTransform2<
+    CoordRepType, itkGetStaticConstMacro( SpaceDimension ) >   WKernelTransformType;
 
   /** Create an instance of a kernel transform. Returns false if the
    * kernelType is unknown.
    */
   virtual bool SetKernelType( const std::string & kernelType );
 
+  /** Read the WendlandSpline specific parameters from the configuration
+   * and set them in the kernel transform, if that is a WendlandSpline.
+   */
+  virtual void ReadWendlandSplineParameters( void );
+
   /** Read source landmarks from fp file
    * \li Try reading -fp file
    */
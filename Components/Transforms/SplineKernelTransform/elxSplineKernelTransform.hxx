@@ -22,6 +22,7 @@
 #include "itkTransformixInputPointFileReader.h"
 #include "vnl/vnl_math.h"
 #include "itkTimeProbe.h"
+#include <iomanip>
 
 namespace elastix
 {
@@ -53,7 +54,12 @@ SplineKernelTransform< TElastix >
    * appropriate for 2D and the normal for 3D
    * \todo: understand why
    */
-  if( SpaceDimension == 2 )
+  if( kernelType == "WendlandSpline" )
+  {
+    /** The compactly supported kernel is valid for both 2D and 3D. */
+    this->m_KernelTransform = WKernelTransformType::New();
+  }
+  else if( SpaceDimension == 2 )
   {
     /** only one variant for 2D possible: */
     this->m_KernelTransform = TPRKernelTransformType::New();
@@ -201,6 +207,9 @@ SplineKernelTransform< TElastix >
     matrixInversionMethod, "TPSMatrixInversionMethod", 0, true );
   this->m_KernelTransform->SetMatrixInversionMethod( matrixInversionMethod );
 
+  /** Set the support radius and solver tolerance of the WendlandSpline. */
+  this->ReadWendlandSplineParameters();
+
   /** Load fixed image (source) landmark positions. */
   this->DetermineSourceLandmarks();
 
@@ -222,6 +231,37 @@ SplineKernelTransform< TElastix >
 } // end BeforeRegistration()
 
 
+/**
+ * ******************* ReadWendlandSplineParameters ***********************
+ */
+
+template< class TElastix >
+void
+SplineKernelTransform< TElastix >
+::ReadWendlandSplineParameters( void )
+{
+  WKernelTransformType * wendlandTransform
+    = dynamic_cast< WKernelTransformType * >( this->m_KernelTransform.GetPointer() );
+  if( wendlandTransform == 0 )
+  {
+    return;
+  }
+
+  /** The support radius; 0 means estimated from the landmark density. */
+  double supportRadius = 0.0;
+  this->GetConfiguration()->ReadParameter(
+    supportRadius, "SplineSupportRadius", this->GetComponentLabel(), 0, -1 );
+  wendlandTransform->SetSupportRadius( supportRadius );
+
+  /** The relative residual tolerance of the conjugate gradient solver. */
+  double solverTolerance = 1e-8;
+  this->GetConfiguration()->ReadParameter(
+    solverTolerance, "SplineSolverTolerance", this->GetComponentLabel(), 0, -1 );
+  wendlandTransform->SetSolverTolerance( solverTolerance );
+
+} // end ReadWendlandSplineParameters()
+
+
 /**
  * ************************* DetermineSourceLandmarks *********************
  */
@@ -432,6 +472,9 @@ SplineKernelTransform< TElastix >
     poissonRatio, "SplinePoissonRatio", this->GetComponentLabel(), 0, -1 );
   this->m_KernelTransform->SetPoissonRatio( poissonRatio );
 
+  /** Set the support radius and solver tolerance of the WendlandSpline. */
+  this->ReadWendlandSplineParameters();
+
   /** Read number of parameters. */
   unsigned int numberOfParameters = 0;
   this->GetConfiguration()->ReadParameter(
@@ -493,6 +536,20 @@ SplineKernelTransform< TElastix >
   xl::xout[ "transpar" ] << "(SplineRelaxationFactor "
                          << this->m_KernelTransform->GetStiffness() << ")" << std::endl;
 
+  /** Write the WendlandSpline specific parameters. */
+  const WKernelTransformType * wendlandTransform
+    = dynamic_cast< const WKernelTransformType * >( this->m_KernelTransform.GetPointer() );
+  if( wendlandTransform != 0 )
+  {
+    /** The used radius, so that transformix does not estimate it again. */
+    xl::xout[ "transpar" ] << std::setprecision( 10 );
+    xl::xout[ "transpar" ] << "(SplineSupportRadius "
+                           << wendlandTransform->GetUsedSupportRadius() << ")" << std::endl;
+    xl::xout[ "transpar" ] << std::setprecision( this->m_Elastix->GetDefaultOutputPrecision() );
+    xl::xout[ "transpar" ] << "(SplineSolverTolerance "
+                           << wendlandTransform->GetSolverTolerance() << ")" << std::endl;
+  }
+
   /** Write the fixed image landmarks. */
   const ParametersType & fixedParams = this->m_KernelTransform->GetFixedParameters();
   xl::xout[ "transpar" ] << "(FixedImageLandmarks ";
@@ -184,10 +184,12 @@ public:
   itkGetModifiableObjectMacro( Displacements, VectorSetType );
 
   /** Compute W matrix. */
-  void ComputeWMatrix( void );
+  virtual void ComputeWMatrix( void );
 
-  /** Compute L matrix inverse. */
-  void ComputeLInverse( void );
+  /** Compute L matrix inverse. Subclasses that do not use the dense
+   * L matrix, may override this method to set up their own solver.
+   */
+  virtual void ComputeLInverse( void );
 
   /** Compute the position of point in the new space */
   OutputPointType TransformPoint( const InputPointType & thisPoint ) const override;
@@ -0,0 +1,298 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkWendlandSplineKernelTransform2_h
+#define __itkWendlandSplineKernelTransform2_h
+
+#include "itkKernelTransform2.h"
+#include <vector>
+
+namespace itk
+{
+
+/** \class WendlandSplineKernelTransform2
+ * \brief A kernel transform with a compactly supported kernel, for large
+ * landmark sets.
+ *
+ * The dense kernel transforms (thin plate spline etc.) require the
+ * inversion of a dense \f$ d(n+d+1) \f$ square matrix, and visit all
+ * \f$ n \f$ landmarks for every transformed point. This is not feasible
+ * for more than a few thousand landmarks. This class instead uses the
+ * Wendland \f$ \psi_{3,1} \f$ kernel:
+ * \f[ G(x) = (1 - r/a)_+^4 ( 4 r/a + 1 ) I, \quad r = \|x\|, \f]
+ * which is zero beyond the support radius \f$ a \f$ and positive definite
+ * for dimensions up to three. The transform is computed in two steps:
+ * first the affine part is fitted to the landmark displacements in the
+ * least squares sense, after which the residual displacements are
+ * interpolated by solving the sparse, symmetric positive definite kernel
+ * system.
+ *
+ * When the landmarks are set, the kernel matrix is reordered by the
+ * reverse Cuthill-McKee algorithm, and its Cholesky factor is computed in
+ * envelope (skyline) storage. The factor is cached, so that every solve,
+ * both for the kernel weights and for each call of GetJacobian(), costs one
+ * forward and one backward substitution over the envelope, instead of a
+ * complete iterative solve. When the envelope has more elements than
+ * MaximumNumberOfFactorElements, which happens for very large landmark sets,
+ * in particular in 3D, the factorization is skipped and the kernel system is
+ * solved by a Jacobi preconditioned conjugate gradient method. The accuracy
+ * of that solution is controlled by the SolverTolerance, which bounds the
+ * relative residual of the kernel system. Note that GetJacobian() is then
+ * much more expensive, as it requires a complete solve for every point.
+ *
+ * Landmarks are stored in a regular bucket grid with a cell size equal to
+ * the support radius, so that both the assembly of the kernel matrix and
+ * the evaluation of a point only visit the landmarks in the neighbouring
+ * cells.
+ *
+ * \ingroup Transforms
+ */
+
+template< class TScalarType,         // Data type for scalars (float or double)
+unsigned int NDimensions = 3 >
+// Number of dimensions
+class WendlandSplineKernelTransform2 :
+  public KernelTransform2< TScalarType, NDimensions >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef WendlandSplineKernelTransform2               Self;
+  typedef KernelTransform2< TScalarType, NDimensions > Superclass;
+  typedef SmartPointer< Self >                         Pointer;
+  typedef SmartPointer< const Self >                   ConstPointer;
+
+  /** New macro for creation of through a Smart Pointer */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( WendlandSplineKernelTransform2, KernelTransform2 );
+
+  /** Scalar type. */
+  typedef typename Superclass::ScalarType ScalarType;
+
+  /** Parameters type. */
+  typedef typename Superclass::ParametersType ParametersType;
+
+  /** Jacobian Type */
+  typedef typename Superclass::JacobianType JacobianType;
+
+  /** Dimension of the domain space. */
+  itkStaticConstMacro( SpaceDimension, unsigned int, Superclass::SpaceDimension );
+
+  /** These (rather redundant) typedefs are needed because on SGI, typedefs
+   * are not inherited.
+   */
+  typedef typename Superclass::InputPointType             InputPointType;
+  typedef typename Superclass::OutputPointType            OutputPointType;
+  typedef typename Superclass::InputVectorType            InputVectorType;
+  typedef typename Superclass::OutputVectorType           OutputVectorType;
+  typedef typename Superclass::InputCovariantVectorType   InputCovariantVectorType;
+  typedef typename Superclass::OutputCovariantVectorType  OutputCovariantVectorType;
+  typedef typename Superclass::PointsIterator             PointsIterator;
+  typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
+  /** Set/Get the support radius of the kernel. A value of zero (the default)
+   * means that the radius is estimated from the landmark density, such that
+   * on average about 30 landmarks fall within the support of each kernel.
+   */
+  virtual void SetSupportRadius( const TScalarType radius )
+  {
+    if( radius != this->m_SupportRadius )
+    {
+      this->m_SupportRadius                = radius > 0 ? radius : 0.0;
+      this->m_LMatrixComputed              = false;
+      this->m_LInverseComputed             = false;
+      this->m_LMatrixDecompositionComputed = false;
+      this->m_WMatrixComputed              = false;
+      this->Modified();
+    }
+  }
+
+
+  itkGetConstMacro( SupportRadius, TScalarType );
+
+  /** The support radius that is actually used, after automatic estimation. */
+  itkGetConstMacro( UsedSupportRadius, TScalarType );
+
+  /** Set/Get the relative residual tolerance of the conjugate gradient solver. */
+  itkSetMacro( SolverTolerance, double );
+  itkGetConstMacro( SolverTolerance, double );
+
+  /** Set/Get the maximum number of conjugate gradient iterations. */
+  itkSetMacro( MaximumNumberOfSolverIterations, unsigned long );
+  itkGetConstMacro( MaximumNumberOfSolverIterations, unsigned long );
+
+  /** Set/Get the maximum number of elements of the envelope of the Cholesky
+   * factor of the kernel matrix. Larger kernel systems are solved iteratively.
+   */
+  virtual void SetMaximumNumberOfFactorElements( const unsigned long number )
+  {
+    if( number != this->m_MaximumNumberOfFactorElements )
+    {
+      this->m_MaximumNumberOfFactorElements = number;
+      this->m_LMatrixComputed               = false;
+      this->m_LInverseComputed              = false;
+      this->m_LMatrixDecompositionComputed  = false;
+      this->m_WMatrixComputed               = false;
+      this->Modified();
+    }
+  }
+
+
+  itkGetConstMacro( MaximumNumberOfFactorElements, unsigned long );
+
+  /** Get whether the Cholesky factor of the kernel matrix is used. */
+  virtual bool GetKernelFactorizationComputed( void ) const
+  {
+    return this->m_KernelFactorizationComputed;
+  }
+
+
+  /** Get the number of non-zero elements of the sparse kernel matrix. */
+  virtual unsigned long GetNumberOfNonZeroKernelElements( void ) const
+  {
+    return static_cast< unsigned long >( this->m_KernelValues.size() );
+  }
+
+
+  /** Setup the bucket grid, the sparse kernel matrix and the affine
+   * least squares projection. Replaces the dense L matrix inversion.
+   */
+  void ComputeLInverse( void ) override;
+
+  /** Compute the affine part and the kernel weights from the landmark
+   * displacements, using the sparse conjugate gradient solver.
+   */
+  void ComputeWMatrix( void ) override;
+
+  /** Compute the Jacobian of the transformation. Each call requires one
+   * solve of the kernel system, with the cached Cholesky factor if present.
+   */
+  void GetJacobian(
+    const InputPointType &,
+    JacobianType &,
+    NonZeroJacobianIndicesType & ) const override;
+
+protected:
+
+  WendlandSplineKernelTransform2();
+  ~WendlandSplineKernelTransform2() override {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const override;
+
+  /** These (rather redundant) typedefs are needed because on SGI, typedefs
+   * are not inherited.
+   */
+  typedef typename Superclass::GMatrixType GMatrixType;
+
+  /** Compute G(x)
+   * For the Wendland spline, this is:
+   * \f$ G(x) = (1 - r/a)_+^4 (4 r/a + 1) I \f$
+   * where
+   * r(x) = Euclidean norm = sqrt[x1^2 + x2^2 + x3^2]
+   * a = the support radius
+   * I = identity matrix.
+   */
+  void ComputeG( const InputVectorType & x, GMatrixType & GMatrix ) const override;
+
+  /** Compute the contribution of the landmarks weighted by the kernel function
+   * to the global deformation of the space. Only the landmarks in the
+   * neighbouring bucket grid cells are visited.
+   */
+  void ComputeDeformationContribution(
+    const InputPointType & inputPoint, OutputPointType & result ) const override;
+
+  /** Evaluate the kernel for a squared distance. */
+  TScalarType EvaluateKernel( const TScalarType squaredDistance ) const;
+
+  /** Collect the indices and kernel values of the landmarks within the
+   * support radius of the point.
+   */
+  void GetLandmarksInSupport( const InputPointType & point,
+    std::vector< unsigned long > & indices,
+    std::vector< TScalarType > & values ) const;
+
+  /** Solve (K + stiffness * I) x = b, with the cached Cholesky factor if
+   * present, and otherwise by Jacobi preconditioned conjugate gradients.
+   * Returns the number of conjugate gradient iterations used.
+   */
+  unsigned long SolveKernelSystem( const std::vector< TScalarType > & b,
+    std::vector< TScalarType > & x ) const;
+
+  /** Reorder the kernel matrix and compute its Cholesky factor in envelope
+   * storage, if the envelope is not too large.
+   */
+  void ComputeKernelFactorization( void );
+
+private:
+
+  WendlandSplineKernelTransform2( const Self & ); // purposely not implemented
+  void operator=( const Self & );                 // purposely not implemented
+
+  typedef std::vector< unsigned long > IndexListType;
+  typedef std::vector< TScalarType >   ValueListType;
+
+  TScalarType   m_SupportRadius;
+  TScalarType   m_UsedSupportRadius;
+  double        m_SolverTolerance;
+  unsigned long m_MaximumNumberOfSolverIterations;
+  unsigned long m_MaximumNumberOfFactorElements;
+
+  /** Local copy of the source landmarks, for fast access. */
+  ValueListType m_LandmarkCoordinates;
+
+  /** The bucket grid, in compressed row format:
+   * the landmarks in cell c are m_CellLandmarks[ m_CellStart[ c ] .. m_CellStart[ c + 1 ] ).
+   */
+  FixedArray< TScalarType, NDimensions > m_GridOrigin;
+  FixedArray< long, NDimensions >        m_GridSize;
+  TScalarType                            m_CellSize;
+  IndexListType                          m_CellStart;
+  IndexListType                          m_CellLandmarks;
+
+  /** The sparse kernel matrix K + stiffness * I, in compressed row format. */
+  IndexListType m_KernelRowStart;
+  IndexListType m_KernelColumns;
+  ValueListType m_KernelValues;
+  ValueListType m_KernelDiagonal;
+
+  /** The Cholesky factor L of the reordered kernel matrix, in envelope
+   * storage: row i holds L( i, j ) for j = m_FactorFirstColumn[ i ] .. i,
+   * starting at m_FactorValues[ m_FactorRowStart[ i ] ]. Row i of the
+   * reordered matrix is row m_FactorPermutation[ i ] of the kernel matrix.
+   */
+  bool          m_KernelFactorizationComputed;
+  IndexListType m_FactorPermutation;
+  IndexListType m_FactorFirstColumn;
+  IndexListType m_FactorRowStart;
+  ValueListType m_FactorValues;
+
+  /** The affine least squares projection H = (P^T P)^{-1} P^T,
+   * with P the n x (d+1) matrix with rows [p_i^T 1].
+   */
+  vnl_matrix< TScalarType > m_AffineProjection;
+
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkWendlandSplineKernelTransform2.hxx"
+#endif
+
+#endif // __itkWendlandSplineKernelTransform2_h
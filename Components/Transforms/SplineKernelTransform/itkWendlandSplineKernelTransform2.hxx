@@ -0,0 +1,853 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef _itkWendlandSplineKernelTransform2_hxx
+#define _itkWendlandSplineKernelTransform2_hxx
+
+#include "itkWendlandSplineKernelTransform2.h"
+#include "vnl/algo/vnl_svd.h"
+#include "vnl/vnl_math.h"
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::WendlandSplineKernelTransform2()
+{
+  this->m_SupportRadius                   = 0.0;
+  this->m_UsedSupportRadius               = 1.0;
+  this->m_CellSize                        = 1.0;
+  this->m_SolverTolerance                 = 1e-8;
+  this->m_MaximumNumberOfSolverIterations = 1000;
+  this->m_MaximumNumberOfFactorElements   = 20000000;
+  this->m_KernelFactorizationComputed     = false;
+
+  this->m_GridOrigin.Fill( 0.0 );
+  this->m_GridSize.Fill( 0 );
+
+  /** The G matrix is diagonal, but the Jacobian is not computed
+   * from the inverse L matrix, so the fast route of the superclass
+   * does not apply.
+   */
+  this->m_FastComputationPossible = false;
+
+} // end Constructor
+
+
+/**
+ * ******************* EvaluateKernel *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+TScalarType
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::EvaluateKernel( const TScalarType squaredDistance ) const
+{
+  const TScalarType r = std::sqrt( squaredDistance ) / this->m_UsedSupportRadius;
+  if( r >= 1.0 )
+  {
+    return NumericTraits< TScalarType >::ZeroValue();
+  }
+
+  const TScalarType t  = 1.0 - r;
+  const TScalarType t2 = t * t;
+  return t2 * t2 * ( 4.0 * r + 1.0 );
+
+} // end EvaluateKernel()
+
+
+/**
+ * ******************* ComputeG *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::ComputeG( const InputVectorType & x, GMatrixType & GMatrix ) const
+{
+  const TScalarType g = this->EvaluateKernel( x.GetSquaredNorm() );
+  GMatrix.fill( NumericTraits< TScalarType >::ZeroValue() );
+  GMatrix.fill_diagonal( g );
+
+} // end ComputeG()
+
+
+/**
+ * ******************* GetLandmarksInSupport *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::GetLandmarksInSupport( const InputPointType & point,
+  std::vector< unsigned long > & indices,
+  std::vector< TScalarType > & values ) const
+{
+  indices.clear();
+  values.clear();
+  if( this->m_CellLandmarks.empty() )
+  {
+    return;
+  }
+
+  /** Determine the range of neighbouring cells. Since the cell size is
+   * not smaller than the support radius, only the direct neighbours of
+   * the cell containing the point have to be visited.
+   */
+  long lower[ NDimensions ];
+  long upper[ NDimensions ];
+  for( unsigned int d = 0; d < NDimensions; ++d )
+  {
+    const double c = std::floor( ( point[ d ] - this->m_GridOrigin[ d ] ) / this->m_CellSize );
+    if( c < -1.0 || c > static_cast< double >( this->m_GridSize[ d ] ) )
+    {
+      return;
+    }
+    lower[ d ] = std::max( static_cast< long >( c ) - 1, 0L );
+    upper[ d ] = std::min( static_cast< long >( c ) + 1, this->m_GridSize[ d ] - 1 );
+  }
+
+  const TScalarType squaredRadius = this->m_UsedSupportRadius * this->m_UsedSupportRadius;
+
+  long cell[ NDimensions ];
+  std::copy( lower, lower + NDimensions, cell );
+  while( true )
+  {
+    /** Linear index of the current cell. */
+    unsigned long linearIndex = 0;
+    for( int d = NDimensions - 1; d >= 0; --d )
+    {
+      linearIndex = linearIndex * this->m_GridSize[ d ] + cell[ d ];
+    }
+
+    /** Visit the landmarks in this cell. */
+    const unsigned long first = this->m_CellStart[ linearIndex ];
+    const unsigned long last  = this->m_CellStart[ linearIndex + 1 ];
+    for( unsigned long k = first; k < last; ++k )
+    {
+      const unsigned long lnd = this->m_CellLandmarks[ k ];
+      const TScalarType * p   = &this->m_LandmarkCoordinates[ lnd * NDimensions ];
+      TScalarType         squaredDistance = 0.0;
+      for( unsigned int d = 0; d < NDimensions; ++d )
+      {
+        const TScalarType diff = point[ d ] - p[ d ];
+        squaredDistance += diff * diff;
+      }
+      if( squaredDistance < squaredRadius )
+      {
+        indices.push_back( lnd );
+        values.push_back( this->EvaluateKernel( squaredDistance ) );
+      }
+    }
+
+    /** Go to the next cell. */
+    unsigned int d = 0;
+    for( ; d < NDimensions; ++d )
+    {
+      if( cell[ d ] < upper[ d ] )
+      {
+        ++cell[ d ];
+        break;
+      }
+      cell[ d ] = lower[ d ];
+    }
+    if( d == NDimensions )
+    {
+      break;
+    }
+  }
+
+} // end GetLandmarksInSupport()
+
+
+/**
+ * ******************* ComputeLInverse *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::ComputeLInverse( void )
+{
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+
+  this->m_LandmarkCoordinates.assign( numberOfLandmarks * NDimensions, 0.0 );
+  this->m_CellStart.clear();
+  this->m_CellLandmarks.clear();
+  this->m_KernelRowStart.assign( 1, 0 );
+  this->m_KernelColumns.clear();
+  this->m_KernelValues.clear();
+  this->m_KernelDiagonal.clear();
+  this->m_AffineProjection.set_size( NDimensions + 1, numberOfLandmarks );
+  this->m_KernelFactorizationComputed = false;
+
+  if( numberOfLandmarks == 0 )
+  {
+    this->m_LMatrixComputed  = true;
+    this->m_LInverseComputed = true;
+    return;
+  }
+
+  /** Copy the landmarks and compute their bounding box. */
+  FixedArray< TScalarType, NDimensions > minimum;
+  FixedArray< TScalarType, NDimensions > maximum;
+  minimum.Fill( NumericTraits< TScalarType >::max() );
+  maximum.Fill( NumericTraits< TScalarType >::NonpositiveMin() );
+  PointsIterator sp = this->m_SourceLandmarks->GetPoints()->Begin();
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    for( unsigned int d = 0; d < NDimensions; ++d )
+    {
+      const TScalarType c = sp->Value()[ d ];
+      this->m_LandmarkCoordinates[ lnd * NDimensions + d ] = c;
+      minimum[ d ] = std::min( minimum[ d ], c );
+      maximum[ d ] = std::max( maximum[ d ], c );
+    }
+    ++sp;
+  }
+
+  /** Determine the support radius. If not specified, choose it such that
+   * on average 30 landmarks are within the support of each kernel.
+   */
+  TScalarType maximumExtent = 0.0;
+  for( unsigned int d = 0; d < NDimensions; ++d )
+  {
+    maximumExtent = std::max( maximumExtent, maximum[ d ] - minimum[ d ] );
+  }
+  if( this->m_SupportRadius > 0.0 )
+  {
+    this->m_UsedSupportRadius = this->m_SupportRadius;
+  }
+  else if( maximumExtent > 0.0 )
+  {
+    double volume = 1.0;
+    for( unsigned int d = 0; d < NDimensions; ++d )
+    {
+      volume *= std::max( static_cast< double >( maximum[ d ] - minimum[ d ] ),
+        maximumExtent / static_cast< double >( numberOfLandmarks ) );
+    }
+    const double unitBallVolume = std::pow( vnl_math::pi, 0.5 * NDimensions )
+      / std::tgamma( 0.5 * NDimensions + 1.0 );
+    this->m_UsedSupportRadius = std::pow(
+      30.0 * volume / ( numberOfLandmarks * unitBallVolume ), 1.0 / NDimensions );
+  }
+  else
+  {
+    this->m_UsedSupportRadius = 1.0;
+  }
+
+  /** Setup the bucket grid. The cell size is at least the support radius;
+   * it is enlarged when the grid would contain far more cells than landmarks.
+   */
+  this->m_CellSize = this->m_UsedSupportRadius;
+  const double maximumNumberOfCells = 8.0 * numberOfLandmarks + 1024.0;
+  while( true )
+  {
+    double numberOfCells = 1.0;
+    for( unsigned int d = 0; d < NDimensions; ++d )
+    {
+      numberOfCells *= std::floor( ( maximum[ d ] - minimum[ d ] ) / this->m_CellSize ) + 1.0;
+    }
+    if( numberOfCells <= maximumNumberOfCells )
+    {
+      break;
+    }
+    this->m_CellSize *= 2.0;
+  }
+
+  unsigned long numberOfCells = 1;
+  for( unsigned int d = 0; d < NDimensions; ++d )
+  {
+    this->m_GridOrigin[ d ] = minimum[ d ];
+    this->m_GridSize[ d ]   = static_cast< long >(
+      std::floor( ( maximum[ d ] - minimum[ d ] ) / this->m_CellSize ) ) + 1;
+    numberOfCells *= this->m_GridSize[ d ];
+  }
+
+  /** Sort the landmarks into the cells, in compressed row format. */
+  std::vector< unsigned long > landmarkCell( numberOfLandmarks );
+  this->m_CellStart.assign( numberOfCells + 1, 0 );
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    unsigned long linearIndex = 0;
+    for( int d = NDimensions - 1; d >= 0; --d )
+    {
+      long c = static_cast< long >( std::floor(
+        ( this->m_LandmarkCoordinates[ lnd * NDimensions + d ] - this->m_GridOrigin[ d ] )
+        / this->m_CellSize ) );
+      c           = std::min( std::max( c, 0L ), this->m_GridSize[ d ] - 1 );
+      linearIndex = linearIndex * this->m_GridSize[ d ] + c;
+    }
+    landmarkCell[ lnd ] = linearIndex;
+    ++this->m_CellStart[ linearIndex + 1 ];
+  }
+  for( unsigned long c = 0; c < numberOfCells; ++c )
+  {
+    this->m_CellStart[ c + 1 ] += this->m_CellStart[ c ];
+  }
+  this->m_CellLandmarks.resize( numberOfLandmarks );
+  std::vector< unsigned long > fill( this->m_CellStart.begin(), this->m_CellStart.end() - 1 );
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    this->m_CellLandmarks[ fill[ landmarkCell[ lnd ] ]++ ] = lnd;
+  }
+
+  /** Assemble the sparse kernel matrix K + stiffness * I. */
+  this->m_KernelRowStart.resize( numberOfLandmarks + 1 );
+  this->m_KernelDiagonal.resize( numberOfLandmarks );
+  std::vector< unsigned long > indices;
+  std::vector< TScalarType >   values;
+  InputPointType               point;
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    for( unsigned int d = 0; d < NDimensions; ++d )
+    {
+      point[ d ] = this->m_LandmarkCoordinates[ lnd * NDimensions + d ];
+    }
+    this->GetLandmarksInSupport( point, indices, values );
+
+    for( std::size_t k = 0; k < indices.size(); ++k )
+    {
+      if( indices[ k ] == lnd )
+      {
+        values[ k ] += this->m_Stiffness;
+        this->m_KernelDiagonal[ lnd ] = values[ k ];
+      }
+    }
+    this->m_KernelColumns.insert( this->m_KernelColumns.end(), indices.begin(), indices.end() );
+    this->m_KernelValues.insert( this->m_KernelValues.end(), values.begin(), values.end() );
+    this->m_KernelRowStart[ lnd + 1 ] = this->m_KernelColumns.size();
+  }
+
+  /** Factorize the kernel matrix, for fast solves in ComputeWMatrix and GetJacobian. */
+  this->ComputeKernelFactorization();
+
+  /** Compute the affine least squares projection H = (P^T P)^{-1} P^T.
+   * The pseudo-inverse is used, to support degenerate (e.g. coplanar)
+   * landmark configurations.
+   */
+  vnl_matrix< TScalarType > PtP( NDimensions + 1, NDimensions + 1, 0.0 );
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    const TScalarType * p = &this->m_LandmarkCoordinates[ lnd * NDimensions ];
+    for( unsigned int i = 0; i <= NDimensions; ++i )
+    {
+      const TScalarType pi = i < NDimensions ? p[ i ] : 1.0;
+      for( unsigned int j = 0; j <= NDimensions; ++j )
+      {
+        const TScalarType pj = j < NDimensions ? p[ j ] : 1.0;
+        PtP( i, j ) += pi * pj;
+      }
+    }
+  }
+  const vnl_matrix< TScalarType > PtPInverse = vnl_svd< TScalarType >( PtP, 1e-10 ).pinverse();
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    const TScalarType * p = &this->m_LandmarkCoordinates[ lnd * NDimensions ];
+    for( unsigned int i = 0; i <= NDimensions; ++i )
+    {
+      TScalarType h = PtPInverse( i, NDimensions );
+      for( unsigned int j = 0; j < NDimensions; ++j )
+      {
+        h += PtPInverse( i, j ) * p[ j ];
+      }
+      this->m_AffineProjection( i, lnd ) = h;
+    }
+  }
+
+  this->m_LMatrixComputed              = true;
+  this->m_LInverseComputed             = true;
+  this->m_LMatrixDecompositionComputed = true;
+
+} // end ComputeLInverse()
+
+
+/**
+ * ******************* ComputeKernelFactorization *******************
+ *
+ * The kernel matrix is symmetric positive definite. Its rows are first
+ * reordered by the reverse Cuthill-McKee algorithm, to make its envelope
+ * small. Since the Cholesky factor has no fill-in outside the envelope,
+ * it is computed in envelope storage, row by row.
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::ComputeKernelFactorization( void )
+{
+  this->m_KernelFactorizationComputed = false;
+  this->m_FactorPermutation.clear();
+  this->m_FactorFirstColumn.clear();
+  this->m_FactorRowStart.clear();
+  this->m_FactorValues.clear();
+
+  const unsigned long n = static_cast< unsigned long >( this->m_KernelDiagonal.size() );
+  if( n == 0 )
+  {
+    return;
+  }
+
+  const IndexListType & kernelRowStart = this->m_KernelRowStart;
+  const IndexListType & kernelColumns  = this->m_KernelColumns;
+  const auto lessDegree = [ &kernelRowStart ]( const unsigned long a, const unsigned long b )
+  {
+    return kernelRowStart[ a + 1 ] - kernelRowStart[ a ] < kernelRowStart[ b + 1 ] - kernelRowStart[ b ];
+  };
+
+  /** Cuthill-McKee ordering: a breadth first search through the graph of
+   * the kernel matrix, which starts each connected component at a node of
+   * minimum degree, and visits the neighbours in order of increasing degree.
+   */
+  IndexListType nodes( n );
+  for( unsigned long i = 0; i < n; ++i )
+  {
+    nodes[ i ] = i;
+  }
+  std::stable_sort( nodes.begin(), nodes.end(), lessDegree );
+
+  std::vector< bool > visited( n, false );
+  IndexListType       order;
+  IndexListType       neighbours;
+  order.reserve( n );
+  for( unsigned long s = 0; s < n; ++s )
+  {
+    if( visited[ nodes[ s ] ] )
+    {
+      continue;
+    }
+    visited[ nodes[ s ] ] = true;
+    order.push_back( nodes[ s ] );
+
+    for( std::size_t head = order.size() - 1; head < order.size(); ++head )
+    {
+      const unsigned long node = order[ head ];
+      neighbours.clear();
+      for( unsigned long k = kernelRowStart[ node ]; k < kernelRowStart[ node + 1 ]; ++k )
+      {
+        if( !visited[ kernelColumns[ k ] ] )
+        {
+          visited[ kernelColumns[ k ] ] = true;
+          neighbours.push_back( kernelColumns[ k ] );
+        }
+      }
+      std::stable_sort( neighbours.begin(), neighbours.end(), lessDegree );
+      order.insert( order.end(), neighbours.begin(), neighbours.end() );
+    }
+  }
+
+  /** Reverse the ordering. */
+  IndexListType permutation( order.rbegin(), order.rend() );
+  IndexListType inversePermutation( n );
+  for( unsigned long i = 0; i < n; ++i )
+  {
+    inversePermutation[ permutation[ i ] ] = i;
+  }
+
+  /** Determine the envelope of the reordered matrix. */
+  IndexListType firstColumn( n );
+  IndexListType rowStart( n + 1, 0 );
+  for( unsigned long i = 0; i < n; ++i )
+  {
+    const unsigned long row   = permutation[ i ];
+    unsigned long       first = i;
+    for( unsigned long k = kernelRowStart[ row ]; k < kernelRowStart[ row + 1 ]; ++k )
+    {
+      first = std::min( first, inversePermutation[ kernelColumns[ k ] ] );
+    }
+    firstColumn[ i ]  = first;
+    rowStart[ i + 1 ] = rowStart[ i ] + ( i - first + 1 );
+    if( rowStart[ i + 1 ] > this->m_MaximumNumberOfFactorElements )
+    {
+      itkDebugMacro( << "The envelope of the kernel matrix is too large; "
+                     << "the kernel system is solved iteratively." );
+      return;
+    }
+  }
+
+  /** Compute the Cholesky factor, row by row. */
+  ValueListType values( rowStart[ n ], 0.0 );
+  for( unsigned long i = 0; i < n; ++i )
+  {
+    const unsigned long fi  = firstColumn[ i ];
+    TScalarType *       Li  = &values[ rowStart[ i ] ];
+    const unsigned long row = permutation[ i ];
+    for( unsigned long k = kernelRowStart[ row ]; k < kernelRowStart[ row + 1 ]; ++k )
+    {
+      const unsigned long j = inversePermutation[ kernelColumns[ k ] ];
+      if( j <= i )
+      {
+        Li[ j - fi ] = this->m_KernelValues[ k ];
+      }
+    }
+
+    for( unsigned long j = fi; j < i; ++j )
+    {
+      const unsigned long fj    = firstColumn[ j ];
+      const TScalarType * Lj    = &values[ rowStart[ j ] ];
+      const unsigned long first = std::max( fi, fj );
+      TScalarType         sum   = Li[ j - fi ];
+      for( unsigned long k = first; k < j; ++k )
+      {
+        sum -= Li[ k - fi ] * Lj[ k - fj ];
+      }
+      Li[ j - fi ] = sum / Lj[ j - fj ];
+    }
+
+    TScalarType diagonal = Li[ i - fi ];
+    for( unsigned long k = fi; k < i; ++k )
+    {
+      diagonal -= Li[ k - fi ] * Li[ k - fi ];
+    }
+    if( !( diagonal > 0.0 ) )
+    {
+      itkWarningMacro( << "The Cholesky factorization of the kernel matrix failed; "
+                       << "the kernel system is solved iteratively." );
+      return;
+    }
+    Li[ i - fi ] = std::sqrt( diagonal );
+  }
+
+  this->m_FactorPermutation.swap( permutation );
+  this->m_FactorFirstColumn.swap( firstColumn );
+  this->m_FactorRowStart.swap( rowStart );
+  this->m_FactorValues.swap( values );
+  this->m_KernelFactorizationComputed = true;
+
+} // end ComputeKernelFactorization()
+
+
+/**
+ * ******************* SolveKernelSystem *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+unsigned long
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::SolveKernelSystem( const std::vector< TScalarType > & b,
+  std::vector< TScalarType > & x ) const
+{
+  const unsigned long n = static_cast< unsigned long >( b.size() );
+  x.assign( n, 0.0 );
+
+  /** Solve L L^T y = b, in the reordered numbering, by forward and
+   * backward substitution.
+   */
+  if( this->m_KernelFactorizationComputed )
+  {
+    std::vector< TScalarType > y( n );
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      y[ i ] = b[ this->m_FactorPermutation[ i ] ];
+    }
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      const unsigned long fi  = this->m_FactorFirstColumn[ i ];
+      const TScalarType * Li  = &this->m_FactorValues[ this->m_FactorRowStart[ i ] ];
+      TScalarType         sum = y[ i ];
+      for( unsigned long k = fi; k < i; ++k )
+      {
+        sum -= Li[ k - fi ] * y[ k ];
+      }
+      y[ i ] = sum / Li[ i - fi ];
+    }
+    for( unsigned long i = n; i-- > 0; )
+    {
+      const unsigned long fi = this->m_FactorFirstColumn[ i ];
+      const TScalarType * Li = &this->m_FactorValues[ this->m_FactorRowStart[ i ] ];
+      y[ i ] /= Li[ i - fi ];
+      const TScalarType yi = y[ i ];
+      for( unsigned long k = fi; k < i; ++k )
+      {
+        y[ k ] -= Li[ k - fi ] * yi;
+      }
+    }
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      x[ this->m_FactorPermutation[ i ] ] = y[ i ];
+    }
+    return 0;
+  }
+
+  std::vector< TScalarType > r( b );
+  std::vector< TScalarType > z( n );
+  std::vector< TScalarType > p( n );
+  std::vector< TScalarType > q( n );
+
+  double bNorm = 0.0;
+  double rz    = 0.0;
+  for( unsigned long i = 0; i < n; ++i )
+  {
+    bNorm += b[ i ] * b[ i ];
+    z[ i ] = r[ i ] / this->m_KernelDiagonal[ i ];
+    p[ i ] = z[ i ];
+    rz    += r[ i ] * z[ i ];
+  }
+  bNorm = std::sqrt( bNorm );
+  if( bNorm == 0.0 )
+  {
+    return 0;
+  }
+
+  const double  tolerance = this->m_SolverTolerance * bNorm;
+  unsigned long iteration = 0;
+  for( ; iteration < this->m_MaximumNumberOfSolverIterations; ++iteration )
+  {
+    /** q = A p */
+    double pq = 0.0;
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      TScalarType sum = 0.0;
+      for( unsigned long k = this->m_KernelRowStart[ i ]; k < this->m_KernelRowStart[ i + 1 ]; ++k )
+      {
+        sum += this->m_KernelValues[ k ] * p[ this->m_KernelColumns[ k ] ];
+      }
+      q[ i ] = sum;
+      pq    += p[ i ] * sum;
+    }
+
+    const double alpha = rz / pq;
+    double       rNorm = 0.0;
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      x[ i ] += alpha * p[ i ];
+      r[ i ] -= alpha * q[ i ];
+      rNorm  += r[ i ] * r[ i ];
+    }
+    if( std::sqrt( rNorm ) <= tolerance )
+    {
+      return iteration + 1;
+    }
+
+    double rzNew = 0.0;
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      z[ i ] = r[ i ] / this->m_KernelDiagonal[ i ];
+      rzNew += r[ i ] * z[ i ];
+    }
+    const double beta = rzNew / rz;
+    rz = rzNew;
+    for( unsigned long i = 0; i < n; ++i )
+    {
+      p[ i ] = z[ i ] + beta * p[ i ];
+    }
+  }
+
+  itkWarningMacro( << "The conjugate gradient solver did not converge within "
+                   << this->m_MaximumNumberOfSolverIterations << " iterations." );
+  return iteration;
+
+} // end SolveKernelSystem()
+
+
+/**
+ * ******************* ComputeWMatrix *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::ComputeWMatrix( void )
+{
+  if( !this->m_LMatrixComputed )
+  {
+    this->ComputeLInverse();
+  }
+
+  /** In ComputeD() the displacements are computed. */
+  this->ComputeD();
+
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+  this->m_DMatrix.set_size( NDimensions, numberOfLandmarks );
+  this->m_AMatrix.fill( 0.0 );
+  this->m_BVector.fill( 0.0 );
+
+  std::vector< TScalarType > residual( numberOfLandmarks );
+  std::vector< TScalarType > weights( numberOfLandmarks );
+  for( unsigned int dim = 0; dim < NDimensions; ++dim )
+  {
+    /** Step 1: least squares fit of the affine part. */
+    vnl_vector< TScalarType > affine( NDimensions + 1, 0.0 );
+    for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+    {
+      const TScalarType displacement = this->m_Displacements->ElementAt( lnd )[ dim ];
+      for( unsigned int i = 0; i <= NDimensions; ++i )
+      {
+        affine[ i ] += this->m_AffineProjection( i, lnd ) * displacement;
+      }
+    }
+    for( unsigned int i = 0; i < NDimensions; ++i )
+    {
+      this->m_AMatrix( dim, i ) = affine[ i ];
+    }
+    this->m_BVector[ dim ] = affine[ NDimensions ];
+
+    /** Step 2: interpolate the residual displacements with the kernel. */
+    for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+    {
+      const TScalarType * p = &this->m_LandmarkCoordinates[ lnd * NDimensions ];
+      TScalarType         r = this->m_Displacements->ElementAt( lnd )[ dim ] - affine[ NDimensions ];
+      for( unsigned int i = 0; i < NDimensions; ++i )
+      {
+        r -= affine[ i ] * p[ i ];
+      }
+      residual[ lnd ] = r;
+    }
+    this->SolveKernelSystem( residual, weights );
+    for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+    {
+      this->m_DMatrix( dim, lnd ) = weights[ lnd ];
+    }
+  }
+
+  this->m_WMatrixComputed = true;
+
+} // end ComputeWMatrix()
+
+
+/**
+ * ******************* ComputeDeformationContribution *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::ComputeDeformationContribution(
+  const InputPointType & thisPoint, OutputPointType & opp ) const
+{
+  std::vector< unsigned long > indices;
+  std::vector< TScalarType >   values;
+  this->GetLandmarksInSupport( thisPoint, indices, values );
+
+  for( std::size_t k = 0; k < indices.size(); ++k )
+  {
+    for( unsigned int odim = 0; odim < NDimensions; ++odim )
+    {
+      opp[ odim ] += values[ k ] * this->m_DMatrix( odim, indices[ k ] );
+    }
+  }
+
+} // end ComputeDeformationContribution()
+
+
+/**
+ * ********************* GetJacobian ****************************
+ *
+ * The transform is T_k(x) = x_k + [x^T 1] H d_k + g(x)^T K^{-1} ( I - P H ) d_k,
+ * with d_k the k-th component of the landmark displacements. The derivative
+ * to the target landmarks is therefore the same for each component:
+ * ( [x^T 1] - z^T P ) H + z^T, with z = K^{-1} g(x).
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::GetJacobian( const InputPointType & p, JacobianType & jac,
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const
+{
+  const unsigned long numberOfLandmarks = this->m_SourceLandmarks->GetNumberOfPoints();
+  jac.SetSize( NDimensions, numberOfLandmarks * NDimensions );
+  jac.Fill( 0.0 );
+
+  /** Solve K z = g(x). */
+  std::vector< unsigned long > indices;
+  std::vector< TScalarType >   values;
+  this->GetLandmarksInSupport( p, indices, values );
+  std::vector< TScalarType > g( numberOfLandmarks, 0.0 );
+  for( std::size_t k = 0; k < indices.size(); ++k )
+  {
+    g[ indices[ k ] ] = values[ k ];
+  }
+  std::vector< TScalarType > z;
+  this->SolveKernelSystem( g, z );
+
+  /** Compute [x^T 1] - z^T P. */
+  vnl_vector< TScalarType > c( NDimensions + 1 );
+  for( unsigned int i = 0; i < NDimensions; ++i )
+  {
+    c[ i ] = p[ i ];
+  }
+  c[ NDimensions ] = 1.0;
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    const TScalarType * pl = &this->m_LandmarkCoordinates[ lnd * NDimensions ];
+    for( unsigned int i = 0; i < NDimensions; ++i )
+    {
+      c[ i ] -= z[ lnd ] * pl[ i ];
+    }
+    c[ NDimensions ] -= z[ lnd ];
+  }
+
+  /** Fill the Jacobian. */
+  for( unsigned long lnd = 0; lnd < numberOfLandmarks; ++lnd )
+  {
+    TScalarType value = z[ lnd ];
+    for( unsigned int i = 0; i <= NDimensions; ++i )
+    {
+      value += c[ i ] * this->m_AffineProjection( i, lnd );
+    }
+    for( unsigned int dim = 0; dim < NDimensions; ++dim )
+    {
+      jac[ dim ][ lnd * NDimensions + dim ] = value;
+    }
+  }
+
+  nonZeroJacobianIndices = this->m_NonZeroJacobianIndices;
+
+} // end GetJacobian()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TScalarType, unsigned int NDimensions >
+void
+WendlandSplineKernelTransform2< TScalarType, NDimensions >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "SupportRadius: " << this->m_SupportRadius << std::endl;
+  os << indent << "UsedSupportRadius: " << this->m_UsedSupportRadius << std::endl;
+  os << indent << "SolverTolerance: " << this->m_SolverTolerance << std::endl;
+  os << indent << "MaximumNumberOfSolverIterations: "
+     << this->m_MaximumNumberOfSolverIterations << std::endl;
+  os << indent << "CellSize: " << this->m_CellSize << std::endl;
+  os << indent << "GridSize: " << this->m_GridSize << std::endl;
+  os << indent << "NumberOfNonZeroKernelElements: "
+     << this->m_KernelValues.size() << std::endl;
+  os << indent << "MaximumNumberOfFactorElements: "
+     << this->m_MaximumNumberOfFactorElements << std::endl;
+  os << indent << "KernelFactorizationComputed: "
+     << this->m_KernelFactorizationComputed << std::endl;
+  os << indent << "NumberOfFactorElements: "
+     << this->m_FactorValues.size() << std::endl;
+
+} // end PrintSelf()
+
+
+} // namespace itk
+
+#endif // end #ifndef _itkWendlandSplineKernelTransform2_hxx
@@ -24,6 +24,7 @@
 #include "elxBaseComponentSE.h"
 #include "itkObject.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
+#include "itkCachedMultiResolutionPyramidImageFilter.h"
 
 namespace elastix
 {
@@ -50,6 +51,14 @@ namespace elastix
  *    example: <tt>(WritePyramidImagesAfterEachResolution "true")</tt>\n
  *    default "false".
  *
+ * When the elastix object has an image pyramid cache, as in a batch of
+ * registrations to the same fixed image (see ElastixBatchFilter), the pyramid
+ * images are shared with the other registrations that use the cache: the
+ * registration that needs them first computes them with this pyramid, and the
+ * others use its images. This is not done when the images are computed per
+ * resolution (ComputePyramidImagesPerResolution), which only saves memory if
+ * the levels are not kept.
+ *
  * \ingroup ImagePyramids
  * \ingroup ComponentBaseClasses
  */
@@ -85,6 +94,10 @@ public:
   /** Typedef's from ITKBaseType. */
   typedef typename ITKBaseType::ScheduleType ScheduleType;
 
+  /** Typedef for the pyramid that gets its images from the image pyramid cache. */
+  typedef itk::CachedMultiResolutionPyramidImageFilter<
+    InputImageType, OutputImageType >                 CachedPyramidType;
+
   /** Cast to ITKBaseType. */
   virtual ITKBaseType * GetAsITKBaseType( void )
   {
@@ -99,8 +112,15 @@ public:
   }
 
 
+  /** Get the pyramid that the registration should use: a pyramid that
+   * provides the shared images from the image pyramid cache, if set,
+   * or else this pyramid itself.
+   */
+  virtual ITKBaseType * GetRegistrationPyramid( void );
+
   /** Execute stuff before the actual registration:
    * \li Set the schedule of the fixed image pyramid.
+   * \li Set up the pyramid that gets its images from the image pyramid cache.
    */
   void BeforeRegistrationBase( void ) override;
 
@@ -123,6 +143,14 @@ protected:
   /** The destructor. */
   ~FixedImagePyramidBase() override {}
 
+  /** Create the pyramid that gets its images from the image pyramid cache,
+   * if the elastix object has a cache and the pyramid can be shared.
+   */
+  virtual void InitializeCachedPyramid( void );
+
+  /** The pyramid that gets its images from the image pyramid cache. */
+  typename CachedPyramidType::Pointer m_CachedPyramid;
+
 private:
 
   /** The private constructor. */
@@ -36,9 +36,77 @@ FixedImagePyramidBase< TElastix >
   /** Call SetFixedSchedule.*/
   this->SetFixedSchedule();
 
+  /** Share the pyramid images with other registrations, if possible. */
+  this->InitializeCachedPyramid();
+
 } // end BeforeRegistrationBase()
 
 
+/**
+ * ******************* GetRegistrationPyramid *******************
+ */
+
+template< class TElastix >
+typename FixedImagePyramidBase< TElastix >::ITKBaseType *
+FixedImagePyramidBase< TElastix >
+::GetRegistrationPyramid( void )
+{
+  if( this->m_CachedPyramid.IsNotNull() )
+  {
+    return this->m_CachedPyramid.GetPointer();
+  }
+  return this->GetAsITKBaseType();
+
+} // end GetRegistrationPyramid()
+
+
+/**
+ * ******************* InitializeCachedPyramid *******************
+ */
+
+template< class TElastix >
+void
+FixedImagePyramidBase< TElastix >
+::InitializeCachedPyramid( void )
+{
+  this->m_CachedPyramid = nullptr;
+
+  /** Check if the pyramid images are shared. */
+  itk::ImagePyramidCache * cache = this->GetElastix()->GetImagePyramidCache();
+  if( cache == nullptr )
+  {
+    return;
+  }
+
+  bool computePerResolution = false;
+  this->m_Configuration->ReadParameter( computePerResolution,
+    "ComputePyramidImagesPerResolution", 0, false );
+  if( computePerResolution )
+  {
+    return;
+  }
+
+  /** The registrations that share the cache use the same parameter maps,
+   * so the elastix level and the component label identify the pyramid.
+   */
+  std::ostringstream key;
+  key << "ElastixLevel:" << this->m_Configuration->GetElastixLevel()
+      << ",Component:" << this->GetComponentLabel();
+
+  /** Set up the cached pyramid like this pyramid, which computes the images
+   * if this registration is the first to need them.
+   */
+  ITKBaseType * pyramid = this->GetAsITKBaseType();
+  this->m_CachedPyramid = CachedPyramidType::New();
+  this->m_CachedPyramid->SetSourcePyramid( pyramid );
+  this->m_CachedPyramid->SetImagePyramidCache( cache );
+  this->m_CachedPyramid->SetCacheKey( key.str() );
+  this->m_CachedPyramid->SetNumberOfLevels( pyramid->GetNumberOfLevels() );
+  this->m_CachedPyramid->SetSchedule( pyramid->GetSchedule() );
+
+} // end InitializeCachedPyramid()
+
+
 /**
  * ******************* BeforeEachResolutionBase *******************
  */
@@ -181,7 +249,7 @@ FixedImagePyramidBase< TElastix >
   typename WriterType::Pointer writer = WriterType::New();
 
   /** Setup the pipeline. */
-  writer->SetInput( this->GetAsITKBaseType()->GetOutput( level ) );
+  writer->SetInput( this->GetRegistrationPyramid()->GetOutput( level ) );
   writer->SetFileName( filename.c_str() );
   writer->SetOutputComponentType( resultImagePixelType.c_str() );
   writer->SetUseCompression( doCompression );
@@ -25,6 +25,7 @@
 #include "elxBaseComponentSE.h"
 
 #include "itkImageSamplerBase.h"
+#include "itkImageRandomSamplerBase.h"
 
 namespace elastix
 {
@@ -83,6 +84,7 @@ public:
   /** Execute stuff before each resolution:
    * \li Give a warning when NewSamplesEveryIteration is specified,
    * but the sampler is ignoring it.
+   * \li Let random samplers use the random generator of the registration.
    */
   void BeforeEachResolutionBase( void ) override;
 
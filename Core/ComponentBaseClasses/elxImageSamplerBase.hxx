@@ -64,6 +64,17 @@ ImageSamplerBase< TElastix >
   }
   else { this->GetAsITKBaseType()->SetUseMultiThread( false ); }
 
+  /** Random samplers draw from the random generator of this registration,
+   * so that concurrent registrations do not share a generator.
+   */
+  typedef itk::ImageRandomSamplerBase< InputImageType > RandomSamplerType;
+  RandomSamplerType * randomSampler
+    = dynamic_cast< RandomSamplerType * >( this->GetAsITKBaseType() );
+  if( randomSampler != 0 )
+  {
+    randomSampler->SetRandomGenerator( this->GetElastix()->GetRandomGenerator() );
+  }
+
 } // end BeforeEachResolutionBase()
 
 
@@ -23,9 +23,17 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkAdvancedImageToImageMetric.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkAdvancedMatrixOffsetTransformBase.h"
+#include "itkAdvancedTranslationTransform.h"
+#include "itkImageCopySampler.h"
 #include "itkImageGridSampler.h"
 #include "itkPointSet.h"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
 namespace elastix
 {
 
@@ -177,6 +185,25 @@ public:
    */
   virtual ImageSamplerBaseType * GetAdvancedMetricImageSampler( void ) const;
 
+  /** Create a copy of this metric that can be evaluated concurrently with
+   * other copies, for example to evaluate several candidate parameter
+   * vectors at the same time. Each copy is a new instance of the same
+   * component, configured from the parameter file like this metric, and
+   * initialized on the same images, masks and interpolator. It owns a copy
+   * of the transform and an itk::ImageCopySampler of the image sampler, so
+   * that it always uses the same samples as this metric. The number of
+   * threads of this metric is divided over the numberOfConcurrentEvaluations
+   * copies.
+   *
+   * Copies are only supported for metrics of AdvancedMetricType with a
+   * combination transform whose current transform is a matrix-offset,
+   * translation or B-spline transform. In other cases 0 is returned.
+   * This metric should be initialized before calling this function, and
+   * it should not be evaluated while the copies are.
+   */
+  virtual typename ITKBaseType::Pointer CreateConcurrentClone(
+    unsigned int numberOfConcurrentEvaluations );
+
   /** Get if the exact metric value is computed */
   virtual bool GetShowExactMetricValue( void ) const
   { return this->m_ShowExactMetricValue; }
@@ -213,11 +240,24 @@ protected:
 
   /** \todo the method GetExactDerivative could as well be added here. */
 
+  /** Typedefs for the copies made by CreateConcurrentClone(). */
+  typedef typename AdvancedMetricType::AdvancedTransformType    AdvancedTransformType;
+  typedef typename AdvancedMetricType::CombinationTransformType CombinationTransformType;
+  typedef itk::ImageCopySampler< FixedImageType >               ImageCopySamplerType;
+  typedef typename ImageCopySamplerType::SourceMutexPointer     ImageCopySamplerMutexPointer;
+
+  /** Copy the current transform of a combination transform, or return 0
+   * if the transform does not support it.
+   */
+  virtual typename AdvancedTransformType::Pointer CloneCurrentTransform(
+    const AdvancedTransformType * transform ) const;
+
   bool                             m_ShowExactMetricValue;
   ExactMetricImageSamplerPointer   m_ExactMetricSampler;
   MeasureType                      m_CurrentExactMetricValue;
   ExactMetricSampleGridSpacingType m_ExactMetricSampleGridSpacing;
   unsigned int                     m_ExactMetricEachXNumberOfIterations;
+  ImageCopySamplerMutexPointer     m_ConcurrentCloneSamplerMutex;
 
 private:
 
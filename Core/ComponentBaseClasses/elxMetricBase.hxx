@@ -169,6 +169,9 @@ MetricBase< TElastix >
     this->GetConfiguration()->ReadParameter( useMultiThreading,
       "UseMultiThreadingForMetrics", this->GetComponentLabel(), level, 0 );
 
+    /** Random sampling within the metric uses the random generator of the registration. */
+    thisAsAdvanced->SetRandomGenerator( this->GetElastix()->GetRandomGenerator() );
+
     thisAsAdvanced->SetUseMultiThread( useMultiThreading );
     if( useMultiThreading )
     {
@@ -391,6 +394,155 @@ typename MetricBase< TElastix >::ImageSamplerBaseType
 
 } // end GetAdvancedMetricImageSampler()
 
+
+/**
+ * ******************* CreateConcurrentClone ********************
+ */
+
+template< class TElastix >
+typename MetricBase< TElastix >::ITKBaseType::Pointer
+MetricBase< TElastix >
+::CreateConcurrentClone( unsigned int numberOfConcurrentEvaluations )
+{
+  /** Only advanced metrics with a supported transform can be copied. */
+  AdvancedMetricType * thisAsAdvanced
+    = dynamic_cast< AdvancedMetricType * >( this );
+  if( thisAsAdvanced == 0 )
+  {
+    return nullptr;
+  }
+  const CombinationTransformType * transform
+    = dynamic_cast< const CombinationTransformType * >( thisAsAdvanced->GetTransform() );
+  if( transform == 0 )
+  {
+    return nullptr;
+  }
+  typename AdvancedTransformType::Pointer currentTransform
+    = this->CloneCurrentTransform( transform->GetCurrentTransform() );
+  if( currentTransform.IsNull() )
+  {
+    return nullptr;
+  }
+
+  /** Create a new instance of the same component. */
+  itk::LightObject::Pointer anotherObject = this->GetAsITKBaseType()->CreateAnother();
+  Self *                    anotherBase   = dynamic_cast< Self * >( anotherObject.GetPointer() );
+  AdvancedMetricType *      another       = dynamic_cast< AdvancedMetricType * >( anotherObject.GetPointer() );
+  if( anotherBase == 0 || another == 0 )
+  {
+    return nullptr;
+  }
+
+  /** Configure it from the parameter file, under the label of this metric. */
+  anotherBase->SetElastix( this->GetElastix() );
+  for( unsigned int i = 0; i < this->GetElastix()->GetNumberOfMetrics(); ++i )
+  {
+    if( this->GetElastix()->GetElxMetricBase( i ) == this )
+    {
+      anotherBase->SetComponentLabel( "Metric", i );
+    }
+  }
+  anotherBase->BeforeRegistration();
+  anotherBase->BeforeEachResolution();
+
+  /** Copy the settings that BeforeEachResolutionBase() made to this metric. */
+  another->SetRequiredRatioOfValidSamples( thisAsAdvanced->GetRequiredRatioOfValidSamples() );
+  another->SetUseMovingImageDerivativeScales( thisAsAdvanced->GetUseMovingImageDerivativeScales() );
+  another->SetMovingImageDerivativeScales( thisAsAdvanced->GetMovingImageDerivativeScales() );
+  another->SetScaleGradientWithRespectToMovingImageOrientation(
+    thisAsAdvanced->GetScaleGradientWithRespectToMovingImageOrientation() );
+  another->SetRandomGenerator( AdvancedMetricType::RandomGeneratorType::New() );
+  another->SetUseMultiThread( thisAsAdvanced->GetUseMultiThread() );
+  const itk::ThreadIdType numberOfWorkUnits = thisAsAdvanced->GetNumberOfWorkUnits()
+    / std::max( numberOfConcurrentEvaluations, 1u );
+  another->SetNumberOfWorkUnits( std::max( numberOfWorkUnits, itk::ThreadIdType( 1 ) ) );
+
+  /** Share the images, masks and interpolator; copy the transform. */
+  typename CombinationTransformType::Pointer anotherTransform = CombinationTransformType::New();
+  anotherTransform->SetUseComposition( transform->GetUseComposition() );
+  anotherTransform->SetUseAddition( transform->GetUseAddition() );
+  anotherTransform->SetInitialTransform(
+    const_cast< CombinationTransformType * >( transform )->GetModifiableInitialTransform() );
+  anotherTransform->SetCurrentTransform( currentTransform );
+
+  another->SetFixedImage( thisAsAdvanced->GetFixedImage() );
+  another->SetMovingImage( thisAsAdvanced->GetMovingImage() );
+  another->SetFixedImageRegion( thisAsAdvanced->GetFixedImageRegion() );
+  another->SetFixedImageMask( thisAsAdvanced->GetFixedImageMask() );
+  another->SetMovingImageMask( thisAsAdvanced->GetMovingImageMask() );
+  another->SetInterpolator( thisAsAdvanced->GetModifiableInterpolator() );
+  another->SetTransform( anotherTransform );
+
+  /** Updating a sampler is not thread-safe, so the copies share the samples
+   * of the sampler of this metric through an ImageCopySampler.
+   */
+  if( thisAsAdvanced->GetUseImageSampler() )
+  {
+    if( !this->m_ConcurrentCloneSamplerMutex )
+    {
+      this->m_ConcurrentCloneSamplerMutex = std::make_shared< std::mutex >();
+    }
+    typename ImageCopySamplerType::Pointer sampler = ImageCopySamplerType::New();
+    sampler->SetSourceSampler( thisAsAdvanced->GetImageSampler() );
+    sampler->SetSourceMutex( this->m_ConcurrentCloneSamplerMutex );
+    another->SetImageSampler( sampler );
+  }
+
+  another->Initialize();
+
+  return another;
+
+} // end CreateConcurrentClone()
+
+
+/**
+ * ******************* CloneCurrentTransform ********************
+ */
+
+template< class TElastix >
+typename MetricBase< TElastix >::AdvancedTransformType::Pointer
+MetricBase< TElastix >
+::CloneCurrentTransform( const AdvancedTransformType * transform ) const
+{
+  typedef typename AdvancedTransformType::ScalarType ScalarType;
+  typedef itk::AdvancedMatrixOffsetTransformBase<
+    ScalarType, FixedImageDimension, MovingImageDimension >     MatrixOffsetTransformType;
+  typedef itk::AdvancedTranslationTransform<
+    ScalarType, FixedImageDimension >                           TranslationTransformType;
+  typedef itk::AdvancedBSplineDeformableTransformBase<
+    ScalarType, FixedImageDimension >                           BSplineTransformType;
+  typedef itk::AdvancedEuler3DTransform< ScalarType >           Euler3DTransformType;
+
+  /** The state of these transforms is fully described by their fixed
+   * and variable parameters, which is what Clone() copies.
+   */
+  if( dynamic_cast< const MatrixOffsetTransformType * >( transform ) == 0
+    && dynamic_cast< const TranslationTransformType * >( transform ) == 0
+    && dynamic_cast< const BSplineTransformType * >( transform ) == 0 )
+  {
+    return nullptr;
+  }
+
+  typename AdvancedTransformType::Pointer copy
+    = dynamic_cast< AdvancedTransformType * >( transform->Clone().GetPointer() );
+  if( copy.IsNull() )
+  {
+    return nullptr;
+  }
+
+  /** Except for the Euler angle convention. */
+  const Euler3DTransformType * euler = dynamic_cast< const Euler3DTransformType * >( transform );
+  Euler3DTransformType *       eulerCopy = dynamic_cast< Euler3DTransformType * >( copy.GetPointer() );
+  if( euler != 0 && eulerCopy != 0 )
+  {
+    eulerCopy->SetComputeZYX( euler->GetComputeZYX() );
+    eulerCopy->SetParameters( euler->GetParameters() );
+  }
+
+  return copy;
+
+} // end CloneCurrentTransform()
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxMetricBase_hxx
@@ -24,6 +24,11 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkOptimizer.h"
+#include "itkSingleValuedCostFunction.h"
+#include "itkStochasticConvergenceMonitor.h"
+
+#include <string>
+#include <vector>
 
 namespace elastix
 {
@@ -45,6 +50,24 @@ namespace elastix
  *    example: <tt>(NewSamplesEveryIteration "true" "true" "true")</tt> \n
  *    Default is "false" for every resolution.\n
  *
+ * Optimizers with an itk::StochasticConvergenceMonitor read the following
+ * parameters with ReadConvergenceMonitorParameters():
+ * \parameter ConvergenceWindowSize: Ends a resolution before MaximumNumberOfIterations when the
+ *   metric value stopped decreasing. A straight line is fitted through the metric values of the
+ *   last ConvergenceWindowSize iterations; the resolution ends when the decrease over the window
+ *   is not significantly larger than ConvergenceRelativeTolerance times the mean metric value.
+ *   A value of 0 disables this check. Can be specified for each resolution.\n
+ *     example: <tt>(ConvergenceWindowSize 100)</tt> \n
+ *     Default value: 0.
+ * \parameter ConvergenceRelativeTolerance: See ConvergenceWindowSize. Can be specified for each resolution.\n
+ *     example: <tt>(ConvergenceRelativeTolerance 0.001)</tt> \n
+ *     Default value: 1e-3.
+ * \parameter ConvergenceConfidenceFactor: The number of standard errors by which the decrease
+ *   should exceed the tolerance to count as progress; larger values end resolutions earlier.
+ *   Can be specified for each resolution.\n
+ *     example: <tt>(ConvergenceConfidenceFactor 2.0)</tt> \n
+ *     Default value: 2.0.
+ *
  * \ingroup Optimizers
  * \ingroup ComponentBaseClasses
  */
@@ -75,6 +98,10 @@ public:
   /** Typedef needed for the SetCurrentPositionPublic function. */
   typedef typename ITKBaseType::ParametersType ParametersType;
 
+  /** Typedefs for the copies of the metric of concurrent evaluations. */
+  typedef itk::SingleValuedCostFunction               CostFunctionType;
+  typedef std::vector< CostFunctionType::Pointer >    CostFunctionContainerType;
+
   /** Cast to ITKBaseType. */
   virtual ITKBaseType * GetAsITKBaseType( void )
   {
@@ -89,9 +116,27 @@ public:
   }
 
 
-  /** Add empty SetCurrentPositionPublic, so this function is known in every inherited class. */
+  /** Set the current position of the optimizer. It is used by the
+   * BSplineTransformWithDiffusion, and to resume a registration of which
+   * all resolutions were completed.
+   */
   virtual void SetCurrentPositionPublic( const ParametersType & param );
 
+  /** Get/Set the maximum number of iterations of the current resolution. They
+   * are used by the time budget of the kernel, to stop a resolution early.
+   * Optimizers that do not support this return 0, and ignore the new value.
+   * Optimizers override them with elxMaximumNumberOfIterationsPublicMacro.
+   */
+  virtual unsigned long GetMaximumNumberOfIterationsPublic( void ) const
+  {
+    return 0;
+  }
+
+
+  virtual void SetMaximumNumberOfIterationsPublic( const unsigned long )
+  {}
+
+
   /** Execute stuff before each new pyramid resolution:
    * \li Find out if new samples are used every new iteration in this resolution.
    */
@@ -123,6 +168,26 @@ protected:
   /** Check whether the user asked to select new samples every iteration. */
   virtual bool GetNewSamplesEveryIteration( void ) const;
 
+  /** Read the ConvergenceWindowSize, ConvergenceRelativeTolerance and
+   * ConvergenceConfidenceFactor of the current resolution into the monitor.
+   */
+  virtual void ReadConvergenceMonitorParameters(
+    itk::StochasticConvergenceMonitor * monitor ) const;
+
+  /** The stop condition description when the monitor ended the resolution. */
+  static std::string GetConvergenceMonitorStopCondition(
+    const itk::StochasticConvergenceMonitor * monitor );
+
+  /** Create numberOfClones copies of the metric, for optimizers that
+   * evaluate several parameter vectors concurrently, see
+   * MetricBase::CreateConcurrentClone(). This is only possible when the
+   * costFunction of the optimizer is the single metric of the registration.
+   * Otherwise a warning is printed, the clones are cleared and false is
+   * returned; the optimizer should then evaluate serially.
+   */
+  virtual bool CreateCostFunctionClones( const CostFunctionType * costFunction,
+    unsigned int numberOfClones, CostFunctionContainerType & clones );
+
 private:
 
   /** The private constructor. */
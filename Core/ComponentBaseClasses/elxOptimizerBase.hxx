@@ -23,6 +23,8 @@
 #include "itkSingleValuedNonLinearOptimizer.h"
 #include "itk_zlib.h"
 
+#include <sstream>
+
 namespace elastix
 {
 
@@ -46,17 +48,26 @@ OptimizerBase< TElastix >
 template< class TElastix >
 void
 OptimizerBase< TElastix >
-::SetCurrentPositionPublic( const ParametersType & /** param */ )
+::SetCurrentPositionPublic( const ParametersType & param )
 {
-  xl::xout[ "error" ] << "ERROR: This function should be overridden or just "
-                      << "not used.\n";
-  xl::xout[ "error" ] << "  Are you using BSplineTransformWithDiffusion in "
-                      << "combination with another optimizer than the "
-                      << "StandardGradientDescentOptimizer? Don't!" << std::endl;
-
-  /** Throw an exception if this function is not overridden. */
-  itkExceptionMacro( << "ERROR: The SetCurrentPositionPublic method is not "
-                     << "implemented in your optimizer" );
+  /** SetCurrentPosition() is protected in itk::Optimizer. It is reached
+   * through a member pointer, taken in a class that derives from it. The
+   * call is virtual, so the optimizer's own override is used.
+   */
+  struct CurrentPositionSetter : public ITKBaseType
+  {
+    static void Set( ITKBaseType & optimizer, const ParametersType & position )
+    {
+      ( optimizer.*&CurrentPositionSetter::SetCurrentPosition )( position );
+    }
+  };
+
+  ITKBaseType * optimizer = this->GetAsITKBaseType();
+  if( optimizer == nullptr )
+  {
+    itkExceptionMacro( << "ERROR: The optimizer is not an itk::Optimizer." );
+  }
+  CurrentPositionSetter::Set( *optimizer, param );
 
 } // end SetCurrentPositionPublic()
 
@@ -151,6 +162,99 @@ OptimizerBase< TElastix >
 } // end GetNewSamplesEveryIteration()
 
 
+/**
+ * ************** ReadConvergenceMonitorParameters ******************
+ */
+
+template< class TElastix >
+void
+OptimizerBase< TElastix >
+::ReadConvergenceMonitorParameters( itk::StochasticConvergenceMonitor * monitor ) const
+{
+  /** Get the current resolution level. */
+  const unsigned int level
+    = this->GetRegistration()->GetAsITKBaseType()->GetCurrentLevel();
+
+  /** The monitor ends the resolution when the metric value stopped
+   * decreasing. Disabled by default.
+   */
+  unsigned int convergenceWindowSize = 0;
+  this->GetConfiguration()->ReadParameter( convergenceWindowSize,
+    "ConvergenceWindowSize", this->GetComponentLabel(), level, 0 );
+  monitor->SetWindowSize( convergenceWindowSize );
+
+  double convergenceRelativeTolerance = 1e-3;
+  this->GetConfiguration()->ReadParameter( convergenceRelativeTolerance,
+    "ConvergenceRelativeTolerance", this->GetComponentLabel(), level, 0 );
+  monitor->SetRelativeTolerance( convergenceRelativeTolerance );
+
+  double convergenceConfidenceFactor = 2.0;
+  this->GetConfiguration()->ReadParameter( convergenceConfidenceFactor,
+    "ConvergenceConfidenceFactor", this->GetComponentLabel(), level, 0 );
+  monitor->SetConfidenceFactor( convergenceConfidenceFactor );
+
+} // end ReadConvergenceMonitorParameters()
+
+
+/**
+ * ************** GetConvergenceMonitorStopCondition ******************
+ */
+
+template< class TElastix >
+std::string
+OptimizerBase< TElastix >
+::GetConvergenceMonitorStopCondition( const itk::StochasticConvergenceMonitor * monitor )
+{
+  std::ostringstream reason;
+  reason << "The metric value stopped decreasing: relative decrease of "
+         << monitor->GetRelativeDecrease() << " +/- "
+         << monitor->GetRelativeDecreaseStandardError()
+         << " over the last " << monitor->GetWindowSize()
+         << " iterations";
+  return reason.str();
+
+} // end GetConvergenceMonitorStopCondition()
+
+
+/**
+ * ****************** CreateCostFunctionClones ********************
+ */
+
+template< class TElastix >
+bool
+OptimizerBase< TElastix >
+::CreateCostFunctionClones( const CostFunctionType * costFunction,
+  unsigned int numberOfClones, CostFunctionContainerType & clones )
+{
+  clones.clear();
+
+  /** The optimizer must optimize the metric itself. */
+  bool supported = this->GetElastix()->GetNumberOfMetrics() == 1
+    && costFunction != 0
+    && costFunction == this->GetElastix()->GetElxMetricBase()->GetAsITKBaseType();
+  for( unsigned int i = 0; supported && i < numberOfClones; ++i )
+  {
+    CostFunctionType::Pointer clone
+      = this->GetElastix()->GetElxMetricBase()->CreateConcurrentClone( numberOfClones );
+    supported = clone.IsNotNull();
+    clones.push_back( clone );
+  }
+
+  if( !supported )
+  {
+    clones.clear();
+    xl::xout[ "warning" ]
+      << "WARNING: " << this->GetComponentLabel()
+      << " cannot evaluate the metric concurrently with this registration,\n"
+      << "  metric and transform. The evaluations are done one at a time."
+      << std::endl;
+  }
+
+  return supported;
+
+} // end CreateCostFunctionClones()
+
+
 /**
  * ****************** SetSinusScales ********************
  */
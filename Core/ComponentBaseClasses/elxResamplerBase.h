@@ -59,11 +59,26 @@ namespace elastix
  *    or from float to char).\n
  *    Choose from (unsigned) char, (unsigned) short, float, double, etc.\n
  *    example: <tt>(ResultImagePixelType "unsigned short")</tt> \n
- *    The default is "short".
+ *    The default is "short". When transformix resamples several input
+ *    images, entry i is the pixel type of result image i, and
+ *    entry 0 is used for the input images without an entry.\n
+ *    example: <tt>(ResultImagePixelType "float" "unsigned char")</tt> \n
  * \parameter CompressResultImage: parameter to set if (lossless) compression
  *    of the written image is desired.\n
  *    example: <tt>(CompressResultImage "true")</tt> \n
  *    The default is "false".
+ * \parameter NumberOfStreamDivisions: the number of pieces in which the result
+ *    image is resampled, cast and written to disk. Streaming keeps the memory
+ *    use bounded for very large images, if the image file format supports it
+ *    (e.g. mhd, mha and nrrd without compression).\n
+ *    example: <tt>(NumberOfStreamDivisions 16)</tt> \n
+ *    The default is such that each piece takes about 256 MB at most.
+ *
+ * Transformix can resample several input images (<tt>-in0 -in1 ...</tt>)
+ * with the same transform in a single pass: the transform is evaluated
+ * once for each output voxel, and all input images are interpolated at
+ * the mapped point. Input image i is interpolated by ResampleInterpolator
+ * i, see ElastixTemplate::ApplyTransform().
  *
  * \ingroup Resamplers
  * \ingroup ComponentBaseClasses
@@ -109,6 +124,7 @@ public:
   typedef typename ITKBaseType::DirectionType    DirectionType;
   typedef typename ITKBaseType::OriginPointType  OriginPointType;
   typedef typename ITKBaseType::PixelType        OutputPixelType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
 
   /** Typedef that is used in the elastix dll version. */
   typedef typename ElastixType::ParameterMapType ParameterMapType;
@@ -174,13 +190,33 @@ public:
   /** Function to perform resample and write the result output image to a file. */
   virtual void ResampleAndWriteResultImage( const char * filename, const bool & showProgress = true );
 
-  /** Function to write the result output image to a file. */
+  /** Function to write the result output image to a file. The pixel type
+   * is read from entry resultImageIndex of ResultImagePixelType.
+   */
   virtual void WriteResultImage( OutputImageType * imageimage,
-    const char * filename, const bool & showProgress = true );
+    const char * filename, const bool & showProgress = true,
+    const unsigned int resultImageIndex = 0 );
 
   /** Function to create the result image in the format of an itk::Image. */
   virtual void CreateItkResultImage( void );
 
+  /** Determine the number of pieces in which an image on the output grid
+   * is streamed to disk, such that each piece takes about 256 MB at most.
+   * The user can overrule this with the parameter NumberOfStreamDivisions.
+   */
+  unsigned int GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const;
+
+  /** Function to resample all input images in a single pass, and to
+   * write result image i to filenames[ i ].
+   */
+  virtual void ResampleAndWriteResultImages(
+    const std::vector< std::string > & filenames, const bool & showProgress = true );
+
+  /** Function to resample all input images in a single pass, and to
+   * create the result images in the format of an itk::Image.
+   */
+  virtual void CreateItkResultImages( void );
+
 protected:
 
   /** The constructor. */
@@ -191,6 +227,14 @@ protected:
   /** Method that sets the transform, the interpolator and the inputImage. */
   virtual void SetComponents( void );
 
+  /** Resample all input images with the same transform, in a single pass. */
+  virtual void ResampleInputImages(
+    std::vector< OutputImagePointer > & resultImages, const bool & showProgress );
+
+  /** Cast a result image to entry resultImageIndex of ResultImagePixelType. */
+  virtual itk::DataObject::Pointer CastResultImage(
+    OutputImageType * image, const unsigned int resultImageIndex ) const;
+
   /** Variable that defines to print the progress or not. */
   bool m_ShowProgress;
 
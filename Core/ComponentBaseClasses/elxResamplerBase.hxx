@@ -23,6 +23,7 @@
 #include "itkImageFileCastWriter.h"
 #include "itkChangeInformationImageFilter.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkMultiInputResampleImageFilter.h"
 #include "itkTimeProbe.h"
 
 namespace elastix
@@ -337,24 +338,9 @@ ResamplerBase< TElastix >
   }
 #endif
 
-  /** Do the resampling. */
-  try
-  {
-    this->GetAsITKBaseType()->Update();
-  }
-  catch( itk::ExceptionObject & excp )
-  {
-    /** Add information to the exception. */
-    excp.SetLocation( "ResamplerBase - WriteResultImage()" );
-    std::string err_str = excp.GetDescription();
-    err_str += "\nError occurred while resampling the image.\n";
-    excp.SetDescription( err_str );
-
-    /** Pass the exception to an higher level. */
-    throw excp;
-  }
-
-  /** Perform the writing. */
+  /** Perform the resampling and the writing. The writer streams the
+   * resampler, so that only a piece of the result image is in memory.
+   */
   this->WriteResultImage( this->GetAsITKBaseType()->GetOutput(), filename, showProgress );
 
   /** Disconnect from the resampler. */
@@ -376,7 +362,8 @@ template< class TElastix >
 void
 ResamplerBase< TElastix >
 ::WriteResultImage( OutputImageType * image,
-  const char * filename, const bool & showProgress )
+  const char * filename, const bool & showProgress,
+  const unsigned int resultImageIndex )
 {
   /** Check if ResampleInterpolator is the RayCastResampleInterpolator  */
   typedef itk::AdvancedRayCastInterpolateImageFunction<  InputImageType,
@@ -397,7 +384,7 @@ ResamplerBase< TElastix >
   /** Read output pixeltype from parameter the file. Replace possible " " with "_". */
   std::string resultImagePixelType = "short";
   this->m_Configuration->ReadParameter( resultImagePixelType,
-    "ResultImagePixelType", 0, false );
+    "ResultImagePixelType", "", resultImageIndex, 0, false );
   std::basic_string< char >::size_type       pos  = resultImagePixelType.find( " " );
   const std::basic_string< char >::size_type npos = std::basic_string< char >::npos;
   if( pos != npos ) { resultImagePixelType.replace( pos, 1, "_" ); }
@@ -427,11 +414,15 @@ ResamplerBase< TElastix >
   /** Create writer. */
   WriterPointer writer = WriterType::New();
 
-  /** Setup the pipeline. */
+  /** Setup the pipeline. The image is written in pieces, each of which is
+   * cast separately, if the file format supports streaming.
+   */
   writer->SetInput( infoChanger->GetOutput() );
   writer->SetFileName( filename );
   writer->SetOutputComponentType( resultImagePixelType.c_str() );
   writer->SetUseCompression( doCompression );
+  writer->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( OutputPixelType ) + sizeof( double ) ) );
 
   /** Do the writing. */
   if( showProgress )
@@ -467,8 +458,6 @@ void
 ResamplerBase< TElastix >
 ::CreateItkResultImage( void )
 {
-  itk::DataObject::Pointer resultImage;
-
   /** Make sure the resampler is updated. */
   this->GetAsITKBaseType()->Modified();
 
@@ -513,10 +502,32 @@ ResamplerBase< TElastix >
       ( const_cast< RayCastInterpolatorType * >( testptr ) )->GetTransform() );
   }
 
-  /** Read output pixeltype from parameter the file. Replace possible " " with "_". */
+  /** Cast the image to the result pixel type and put it in the container. */
+  this->m_Elastix->SetResultImage(
+    this->CastResultImage( this->GetAsITKBaseType()->GetOutput(), 0 ) );
+
+#ifndef _ELASTIX_BUILD_LIBRARY
+  /** Disconnect from the resampler. */
+  progressObserver->DisconnectObserver( this->GetAsITKBaseType() );
+#endif
+} // end CreateItkResultImage()
+
+
+/*
+ * ******************* CastResultImage ********************
+ */
+
+template< class TElastix >
+itk::DataObject::Pointer
+ResamplerBase< TElastix >
+::CastResultImage( OutputImageType * image, const unsigned int resultImageIndex ) const
+{
+  itk::DataObject::Pointer resultImage;
+
+  /** Read output pixeltype from parameter the file. */
   std::string resultImagePixelType = "short";
   this->m_Configuration->ReadParameter( resultImagePixelType,
-    "ResultImagePixelType", 0, false );
+    "ResultImagePixelType", "", resultImageIndex, 0, false );
 
   /** Typedef's for writing the output image. */
   typedef itk::ChangeInformationImageFilter<
@@ -531,7 +542,7 @@ ResamplerBase< TElastix >
   bool          retdc = this->GetElastix()->GetOriginalFixedImageDirection( originalDirection );
   infoChanger->SetOutputDirection( originalDirection );
   infoChanger->SetChangeDirection( retdc & !this->GetElastix()->GetUseDirectionCosines() );
-  infoChanger->SetInput( this->GetAsITKBaseType()->GetOutput() );
+  infoChanger->SetInput( image );
 
   typedef itk::CastImageFilter< InputImageType,
     itk::Image< char, InputImageType::ImageDimension > >            CastFilterChar;
@@ -634,14 +645,162 @@ ResamplerBase< TElastix >
       << "\"." );
   }
 
-  //put image in container
-  this->m_Elastix->SetResultImage( resultImage );
+  return resultImage;
+
+} // end CastResultImage()
+
+
+/**
+ * ******************* ResampleInputImages ********************
+ */
+
+template< class TElastix >
+void
+ResamplerBase< TElastix >
+::ResampleInputImages( std::vector< OutputImagePointer > & resultImages, const bool & showProgress )
+{
+  typedef itk::MultiInputResampleImageFilter<
+    InputImageType, OutputImageType, CoordRepType >       MultiInputResamplerType;
+  typedef itk::AdvancedRayCastInterpolateImageFunction<
+    InputImageType, CoordRepType >                        RayCastInterpolatorType;
+
+  /** The multi-input resampler uses the transform and the output grid of this resampler. */
+  const ITKBaseType * resampler = this->GetAsITKBaseType();
+  typename MultiInputResamplerType::Pointer multiInputResampler = MultiInputResamplerType::New();
+  multiInputResampler->SetTransform( resampler->GetTransform() );
+  multiInputResampler->SetSize( resampler->GetSize() );
+  multiInputResampler->SetOutputStartIndex( resampler->GetOutputStartIndex() );
+  multiInputResampler->SetOutputOrigin( resampler->GetOutputOrigin() );
+  multiInputResampler->SetOutputSpacing( resampler->GetOutputSpacing() );
+  multiInputResampler->SetOutputDirection( resampler->GetOutputDirection() );
+  multiInputResampler->SetDefaultPixelValue( resampler->GetDefaultPixelValue() );
+
+  /** Input image i is interpolated by resample interpolator i. */
+  const unsigned int numberOfInputs = this->m_Elastix->GetNumberOfMovingImages();
+  for( unsigned int i = 0; i < numberOfInputs; ++i )
+  {
+    if( this->m_Elastix->GetElxResampleInterpolatorBase( i ) == 0 )
+    {
+      itkExceptionMacro( << "No ResampleInterpolator for input image " << i << "." );
+    }
+    InterpolatorType * interpolator
+      = this->m_Elastix->GetElxResampleInterpolatorBase( i )->GetAsITKBaseType();
+
+    /** The RayCastResampleInterpolator replaces the transform of the resampler. */
+    if( dynamic_cast< RayCastInterpolatorType * >( interpolator ) )
+    {
+      itkExceptionMacro( << "The RayCastResampleInterpolator supports a single input image only." );
+    }
 
+    multiInputResampler->SetInput( i, dynamic_cast< InputImageType * >(
+        this->m_Elastix->GetMovingImage( i ) ) );
+    multiInputResampler->SetInterpolator( i, interpolator );
+  }
+
+  /** Add a progress observer to the resampler. */
 #ifndef _ELASTIX_BUILD_LIBRARY
-  /** Disconnect from the resampler. */
-  progressObserver->DisconnectObserver( this->GetAsITKBaseType() );
+  typename ProgressCommandType::Pointer progressObserver = ProgressCommandType::New();
+  if( showProgress )
+  {
+    progressObserver->ConnectObserver( multiInputResampler );
+    progressObserver->SetStartString( "  Progress: " );
+    progressObserver->SetEndString( "%" );
+  }
 #endif
-} // end CreateItkResultImage()
+
+  /** Do the resampling. */
+  try
+  {
+    multiInputResampler->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    /** Add information to the exception. */
+    excp.SetLocation( "ResamplerBase - ResampleInputImages()" );
+    std::string err_str = excp.GetDescription();
+    err_str += "\nError occurred while resampling the images.\n";
+    excp.SetDescription( err_str );
+
+    /** Pass the exception to an higher level. */
+    throw excp;
+  }
+
+#ifndef _ELASTIX_BUILD_LIBRARY
+  if( showProgress )
+  {
+    progressObserver->DisconnectObserver( multiInputResampler );
+  }
+#endif
+
+  /** Take the result images out of the pipeline. */
+  resultImages.resize( numberOfInputs );
+  for( unsigned int i = 0; i < numberOfInputs; ++i )
+  {
+    resultImages[ i ] = multiInputResampler->GetOutput( i );
+    resultImages[ i ]->DisconnectPipeline();
+  }
+
+} // end ResampleInputImages()
+
+
+/**
+ * ******************* ResampleAndWriteResultImages ********************
+ */
+
+template< class TElastix >
+void
+ResamplerBase< TElastix >
+::ResampleAndWriteResultImages( const std::vector< std::string > & filenames, const bool & showProgress )
+{
+  /** A single input image is resampled as usual. */
+  if( this->m_Elastix->GetNumberOfMovingImages() < 2 )
+  {
+    this->ResampleAndWriteResultImage( filenames[ 0 ].c_str(), showProgress );
+    return;
+  }
+
+  /** Resample all input images at once, and write them one by one. */
+  std::vector< OutputImagePointer > resultImages;
+  this->ResampleInputImages( resultImages, showProgress );
+  for( unsigned int i = 0; i < resultImages.size(); ++i )
+  {
+    this->WriteResultImage( resultImages[ i ], filenames[ i ].c_str(), showProgress, i );
+    resultImages[ i ] = nullptr;
+  }
+
+} // end ResampleAndWriteResultImages()
+
+
+/**
+ * ******************* CreateItkResultImages ********************
+ */
+
+template< class TElastix >
+void
+ResamplerBase< TElastix >
+::CreateItkResultImages( void )
+{
+  /** A single input image is resampled as usual. */
+  if( this->m_Elastix->GetNumberOfMovingImages() < 2 )
+  {
+    this->CreateItkResultImage();
+    return;
+  }
+
+  /** Resample all input images at once, and put the results in the container. */
+  std::vector< OutputImagePointer > resultImages;
+  this->ResampleInputImages( resultImages, true );
+
+  typename ElastixType::DataObjectContainerPointer resultImageContainer
+    = ElastixType::DataObjectContainerType::New();
+  for( unsigned int i = 0; i < resultImages.size(); ++i )
+  {
+    resultImageContainer->CreateElementAt( i ) = this->CastResultImage( resultImages[ i ], i );
+    resultImages[ i ] = nullptr;
+  }
+  this->m_Elastix->SetResultImageContainer( resultImageContainer );
+
+} // end CreateItkResultImages()
 
 
 /*
@@ -833,6 +992,34 @@ ResamplerBase< TElastix >
 } // end CreateTransformParametersMap()
 
 
+/**
+ * ******************* GetNumberOfStreamDivisions ********************
+ */
+
+template< class TElastix >
+unsigned int
+ResamplerBase< TElastix >
+::GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const
+{
+  /** The user may specify the number of stream divisions. */
+  unsigned int numberOfStreamDivisions = 0;
+  this->m_Configuration->ReadParameter( numberOfStreamDivisions,
+    "NumberOfStreamDivisions", 0, false );
+  if( numberOfStreamDivisions > 0 )
+  {
+    return numberOfStreamDivisions;
+  }
+
+  /** Otherwise limit the size of each piece to about 256 MB. */
+  const std::size_t maximumBytesPerPiece = 256 * 1024 * 1024;
+  const std::size_t numberOfBytes        = bytesPerPixel * static_cast< std::size_t >(
+    this->GetAsITKBaseType()->GetSize().CalculateProductOfElements() );
+
+  return static_cast< unsigned int >( 1 + numberOfBytes / maximumBytesPerPiece );
+
+} // end GetNumberOfStreamDivisions()
+
+
 /**
  * ******************* ReleaseMemory ********************
  */
@@ -24,6 +24,8 @@
 #include "elxBaseComponentSE.h"
 #include "itkAdvancedTransform.h"
 #include "itkAdvancedCombinationTransform.h"
+#include "itkDefaultStaticMeshTraits.h"
+#include "itkPointSet.h"
 #include "elxComponentDatabase.h"
 #include "elxProgressCommand.h"
 
@@ -105,6 +107,20 @@ namespace elastix
  * The location is relative to the path from where elastix/transformix is started!\n
  * Default: "NoInitialTransform", which (obviously) means that there is no initial transform
  * to be loaded.
+ * \transformparameter NumberOfStreamDivisions: the number of pieces in which the
+ * spatial Jacobian images ("-jac all" and "-jacmat all") are computed and written to
+ * disk. Streaming keeps the memory use bounded for very large images, if the image
+ * file format supports it (e.g. mhd and nii).\n
+ * example <tt>(NumberOfStreamDivisions 16)</tt>\n
+ * Default: such that each piece takes about 256 MB at most.
+ * \transformparameter InverseMaximumNumberOfIterations: the maximum number of Newton
+ * iterations per voxel when computing the inverse deformation field with "-inv all".\n
+ * example <tt>(InverseMaximumNumberOfIterations 20)</tt>\n
+ * Default: 20.
+ * \transformparameter InverseTolerance: the tolerance (in physical units) on the residual
+ * ||T(x) - y|| when computing the inverse deformation field with "-inv all".\n
+ * example <tt>(InverseTolerance 0.001)</tt>\n
+ * Default: 0.001.
  *
  * The command line arguments used by this class are:
  * \commandlinearg -t0: optional argument for elastix for specifying an initial transform
@@ -117,9 +133,16 @@ namespace elastix
  *    "point", depending if the user supplies voxel indices or real world coordinates.
  *    The second line should be the number of points that should be transformed. The
  *    third and following lines give the indices or points.\n
+ *    For very large point sets, a binary file with the extension ".bin" can be given
+ *    instead. It contains only the world coordinates, as consecutive doubles. The
+ *    transformed points are then written in the same format to outputpoints.bin.\n
+ *    example: <tt>-def inputPoints.bin</tt> \n
  *    It is also possible to deform all points, thereby generating a deformation field
  *    image. This is done by:\n
  *    example: <tt>-def all</tt> \n
+ * \commandlinearg -inv: optional argument for transformix for computing the deformation
+ *    field of the inverse transform, on the grid of the input image if given.\n
+ *    example: <tt>-inv all</tt> \n
  *
  * \ingroup Transforms
  * \ingroup ComponentBaseClasses
@@ -190,6 +213,13 @@ public:
   typedef typename ITKBaseType::InputPointType  InputPointType;
   typedef typename ITKBaseType::OutputPointType OutputPointType;
 
+  /** Typedef's for the point sets that are transformed by TransformPoints. */
+  typedef itk::DefaultStaticMeshTraits<
+    unsigned char, FixedImageDimension,
+    FixedImageDimension, CoordRepType >               PointSetMeshTraitsType;
+  typedef itk::PointSet< unsigned char,
+    FixedImageDimension, PointSetMeshTraitsType >     PointSetType;
+
   /** Typedef's for TransformPointsAllPoints. */
   typedef itk::Vector<
     float, FixedImageDimension >                      VectorPixelType;
@@ -296,6 +326,11 @@ public:
   /** Function to transform coordinates from fixed to moving image, given as VTK file. */
   virtual void TransformPointsSomePointsVTK( const std::string filename ) const;
 
+  /** Function to transform a set of points, in world coordinates, from fixed to
+   * moving image. The points are transformed in parallel.
+   */
+  typename PointSetType::Pointer GenerateTransformedPointSet( const PointSetType * inputPointSet ) const;
+
   /** Deprecation note: The plan is to split all Compute* and TransformPoints* functions
    *  into Generate* and Write* functions, since that would facilitate a proper library
    *  interface. To keep everything functional during the transition period we need to
@@ -317,6 +352,9 @@ public:
   /** Function to compute the determinant of the spatial Jacobian. */
   virtual void ComputeSpatialJacobian( void ) const;
 
+  /** Function to compute the deformation field of the inverse transform. */
+  virtual void ComputeInverseDeformationField( void ) const;
+
   /** Makes sure that the final parameters from the registration components
    * are copied, set, and stored.
    */
@@ -347,6 +385,13 @@ protected:
   void AutomaticScalesEstimationStackTransform(
     const unsigned int & numSubTransforms, ScalesType & scales ) const;
 
+  /** Determine the number of pieces in which an image on the output grid of
+   * the resampler is streamed to disk, such that each piece takes about
+   * 256 MB at most. The user can overrule this with the parameter
+   * NumberOfStreamDivisions.
+   */
+  unsigned int GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const;
+
   /** Member variables. */
   ParametersType * m_TransformParametersPointer;
   std::string      m_TransformParametersFileName;
@@ -23,12 +23,14 @@
 #include "itkPointSet.h"
 #include "itkDefaultStaticMeshTraits.h"
 #include "itkTransformixInputPointFileReader.h"
+#include "itkMultiThreaderBase.h"
 #include "vnl/vnl_math.h"
 #include <itksys/SystemTools.hxx>
 #include "itkVector.h"
 #include "itkTransformToDisplacementFieldFilter.h"
 #include "itkTransformToDeterminantOfSpatialJacobianSource.h"
 #include "itkTransformToSpatialJacobianSource.h"
+#include "itkTransformToInverseDisplacementFieldSource.h"
 #include "itkImageFileWriter.h"
 #include "itkImageGridSampler.h"
 #include "itkContinuousIndex.h"
@@ -38,6 +40,8 @@
 #include "itkMeshFileWriter.h"
 #include "itkTransformMeshFilter.h"
 
+#include <cstdio>
+
 namespace itk
 {
 
@@ -229,6 +233,17 @@ TransformBase< TElastix >
     elxout << "-jacmat   " << check << std::endl;
   }
 
+  /** Check for appearance of "-inv". */
+  check = this->m_Configuration->GetCommandLineArgument( "-inv" );
+  if( check == "" )
+  {
+    elxout << "-inv      unspecified, so no inverse deformation field computed" << std::endl;
+  }
+  else
+  {
+    elxout << "-inv      " << check << std::endl;
+  }
+
   /** Return a value. */
   return returndummy;
 
@@ -1072,6 +1087,26 @@ void
 TransformBase< TElastix >
 ::TransformPoints( void ) const
 {
+  /** Points that are given in memory, by the TransformixFilter, are
+   * transformed without reading or writing a point file.
+   */
+  if( this->m_Elastix->GetInputPointSet() != nullptr )
+  {
+    const PointSetType * inputPointSet
+      = dynamic_cast< const PointSetType * >( this->m_Elastix->GetInputPointSet() );
+    if( inputPointSet == nullptr )
+    {
+      itkExceptionMacro( << "ERROR: The input point set does not have the "
+                         << "dimension and coordinate type of the transform." );
+    }
+    elxout << "  The transform is evaluated on "
+           << inputPointSet->GetNumberOfPoints()
+           << " points, specified in memory." << std::endl;
+    this->m_Elastix->SetResultPointSet(
+      this->GenerateTransformedPointSet( inputPointSet ).GetPointer() );
+    return;
+  }
+
   /** If the optional command "-def" is given in the command
    * line arguments, then and only then we continue.
    */
@@ -1133,6 +1168,9 @@ TransformBase< TElastix >
  * Computes the transformed points, converts them back to an index and compute
  * the deformation vector as the difference between the outputpoint and
  * the input point. Save the results.
+ *
+ * A binary input point file only contains world coordinates; then
+ * only the transformed points are saved, in the same binary format.
  */
 
 template< class TElastix >
@@ -1154,12 +1192,6 @@ TransformBase< TElastix >
     itk::ContinuousIndex< double, MovingImageDimension >  MovingImageContinuousIndexType;
   typedef typename FixedImageType::DirectionType FixedImageDirectionType;
 
-  typedef unsigned char DummyIPPPixelType;
-  typedef itk::DefaultStaticMeshTraits<
-    DummyIPPPixelType, FixedImageDimension,
-    FixedImageDimension, CoordRepType >                  MeshTraitsType;
-  typedef itk::PointSet< DummyIPPPixelType,
-    FixedImageDimension, MeshTraitsType >                PointSetType;
   typedef itk::TransformixInputPointFileReader<
     PointSetType >                                      IPPReaderType;
   typedef itk::Vector< float, FixedImageDimension > DeformationVectorType;
@@ -1178,6 +1210,7 @@ TransformBase< TElastix >
   {
     xl::xout[ "error" ] << "  Error while opening input point file." << std::endl;
     xl::xout[ "error" ] << err << std::endl;
+    return;
   }
 
   /** Some user-feedback. */
@@ -1189,12 +1222,51 @@ TransformBase< TElastix >
   {
     elxout << "  Input points are specified in world coordinates." << std::endl;
   }
-  unsigned int nrofpoints = ippReader->GetNumberOfPoints();
+  const std::size_t nrofpoints = ippReader->GetNumberOfPoints();
   elxout << "  Number of specified input points: " << nrofpoints << std::endl;
 
   /** Get the set of input points. */
   typename PointSetType::Pointer inputPointSet = ippReader->GetOutput();
 
+  /** For a binary point file, only the points are transformed; no indices are computed. */
+  if( ippReader->GetFileIsBinary() )
+  {
+    elxout << "  The input points are transformed." << std::endl;
+    typename PointSetType::Pointer outputPointSet
+      = this->GenerateTransformedPointSet( inputPointSet );
+
+    std::string outputPointsFileName = this->m_Configuration
+      ->GetCommandLineArgument( "-out" );
+    outputPointsFileName += "outputpoints.bin";
+    elxout << "  The transformed points are saved in: "
+           <<  outputPointsFileName << std::endl;
+
+    /** Write the points in blocks, to limit the size of the buffer. */
+    std::ofstream         outputPointsFile( outputPointsFileName.c_str(), std::ios::out | std::ios::binary );
+    const std::size_t     pointsPerBlock = 65536;
+    std::vector< double > buffer;
+    buffer.reserve( pointsPerBlock * FixedImageDimension );
+    for( std::size_t j = 0; j < nrofpoints; j++ )
+    {
+      const typename PointSetType::PointType & point = outputPointSet->GetPoints()->ElementAt( j );
+      for( unsigned int i = 0; i < FixedImageDimension; i++ )
+      {
+        buffer.push_back( static_cast< double >( point[ i ] ) );
+      }
+      if( buffer.size() >= pointsPerBlock * FixedImageDimension || j + 1 == nrofpoints )
+      {
+        outputPointsFile.write( reinterpret_cast< const char * >( buffer.data() ),
+          buffer.size() * sizeof( double ) );
+        buffer.clear();
+      }
+    }
+    if( !outputPointsFile )
+    {
+      itkExceptionMacro( << "ERROR: Could not write " << outputPointsFileName );
+    }
+    return;
+  }
+
   /** Create the storage classes. */
   std::vector< FixedImageIndexType >   inputindexvec(  nrofpoints );
   std::vector< InputPointType >        inputpointvec(  nrofpoints );
@@ -1225,10 +1297,6 @@ TransformBase< TElastix >
   dummyImage->SetSpacing( spacing );
   dummyImage->SetDirection( direction );
 
-  /** Temp vars */
-  FixedImageContinuousIndexType  fixedcindex;
-  MovingImageContinuousIndexType movingcindex;
-
   /** Also output moving image indices if a moving image was supplied. */
   bool alsoMovingIndices = false;
   typename MovingImageType::Pointer movingImage = this->GetElastix()->GetMovingImage();
@@ -1237,14 +1305,22 @@ TransformBase< TElastix >
     alsoMovingIndices = true;
   }
 
-  /** Read the input points, as index or as point. */
-  if( !( ippReader->GetPointsAreIndices() ) )
+  /** Read the input points, as index or as point, and apply the transform.
+   * TransformPoint and the index conversions are const, so the points are
+   * processed in parallel.
+   */
+  elxout << "  The input points are transformed." << std::endl;
+  const bool          pointsAreIndices = ippReader->GetPointsAreIndices();
+  const ITKBaseType * transform        = this->GetAsITKBaseType();
+  const auto          transformPoint   = [ & ]( const itk::SizeValueType j )
   {
-    for( unsigned int j = 0; j < nrofpoints; j++ )
+    FixedImageContinuousIndexType  fixedcindex;
+    MovingImageContinuousIndexType movingcindex;
+
+    const InputPointType & point = inputPointSet->GetPoints()->ElementAt( j );
+    if( !pointsAreIndices )
     {
       /** Compute index of nearest voxel in fixed image. */
-      InputPointType point; point.Fill( 0.0f );
-      inputPointSet->GetPoint( j, &point );
       inputpointvec[ j ] = point;
       dummyImage->TransformPhysicalPointToContinuousIndex(
         point, fixedcindex );
@@ -1254,16 +1330,11 @@ TransformBase< TElastix >
           itk::Math::Round< double >( fixedcindex[ i ] ) );
       }
     }
-  }
-  else //so: inputasindex
-  {
-    for( unsigned int j = 0; j < nrofpoints; j++ )
+    else //so: inputasindex
     {
       /** The read point from the inutPointSet is actually an index
        * Cast to the proper type.
        */
-      InputPointType point; point.Fill( 0.0f );
-      inputPointSet->GetPoint( j, &point );
       for( unsigned int i = 0; i < FixedImageDimension; i++ )
       {
         inputindexvec[ j ][ i ] = static_cast< FixedImageIndexValueType >(
@@ -1273,14 +1344,9 @@ TransformBase< TElastix >
       dummyImage->TransformIndexToPhysicalPoint(
         inputindexvec[ j ], inputpointvec[ j ] );
     }
-  }
 
-  /** Apply the transform. */
-  elxout << "  The input points are transformed." << std::endl;
-  for( unsigned int j = 0; j < nrofpoints; j++ )
-  {
     /** Call TransformPoint. */
-    outputpointvec[ j ] = this->GetAsITKBaseType()->TransformPoint( inputpointvec[ j ] );
+    outputpointvec[ j ] = transform->TransformPoint( inputpointvec[ j ] );
 
     /** Transform back to index in fixed image domain. */
     dummyImage->TransformPhysicalPointToContinuousIndex(
@@ -1305,66 +1371,89 @@ TransformBase< TElastix >
 
     /** Compute displacement. */
     deformationvec[ j ].CastFrom( outputpointvec[ j ] - inputpointvec[ j ] );
-  }
+  };
+  itk::MultiThreaderBase::New()->ParallelizeArray( 0, nrofpoints, transformPoint, nullptr );
 
   /** Create filename and file stream. */
   std::string outputPointsFileName = this->m_Configuration
     ->GetCommandLineArgument( "-out" );
   outputPointsFileName += "outputpoints.txt";
   std::ofstream outputPointsFile( outputPointsFileName.c_str() );
-  outputPointsFile << std::showpoint << std::fixed;
   elxout << "  The transformed points are saved in: "
          <<  outputPointsFileName << std::endl;
 
-  /** Print the results. */
-  for( unsigned int j = 0; j < nrofpoints; j++ )
+  /** Print the results. The numbers are formatted with snprintf, like
+   * an ostream with std::showpoint and std::fixed would do, but much faster,
+   * and the text is written to the file in large blocks.
+   */
+  std::string buffer;
+  char        number[ 64 ];
+  const auto  appendInteger = [ &buffer, &number ]( const long long value )
+  {
+    buffer.append( number, std::snprintf( number, sizeof( number ), "%lld ", value ) );
+  };
+  const auto appendReal = [ &buffer, &number ]( const double value )
+  {
+    buffer.append( number, std::snprintf( number, sizeof( number ), "%f ", value ) );
+  };
+
+  for( std::size_t j = 0; j < nrofpoints; j++ )
   {
     /** The input index. */
-    outputPointsFile << "Point\t" << j << "\t; InputIndex = [ ";
+    buffer.append( "Point\t" );
+    buffer.append( std::to_string( j ) );
+    buffer.append( "\t; InputIndex = [ " );
     for( unsigned int i = 0; i < FixedImageDimension; i++ )
     {
-      outputPointsFile << inputindexvec[ j ][ i ] << " ";
+      appendInteger( inputindexvec[ j ][ i ] );
     }
 
     /** The input point. */
-    outputPointsFile << "]\t; InputPoint = [ ";
+    buffer.append( "]\t; InputPoint = [ " );
     for( unsigned int i = 0; i < FixedImageDimension; i++ )
     {
-      outputPointsFile << inputpointvec[ j ][ i ] << " ";
+      appendReal( inputpointvec[ j ][ i ] );
     }
 
     /** The output index in fixed image. */
-    outputPointsFile << "]\t; OutputIndexFixed = [ ";
+    buffer.append( "]\t; OutputIndexFixed = [ " );
     for( unsigned int i = 0; i < FixedImageDimension; i++ )
     {
-      outputPointsFile << outputindexfixedvec[ j ][ i ] << " ";
+      appendInteger( outputindexfixedvec[ j ][ i ] );
     }
 
     /** The output point. */
-    outputPointsFile << "]\t; OutputPoint = [ ";
+    buffer.append( "]\t; OutputPoint = [ " );
     for( unsigned int i = 0; i < FixedImageDimension; i++ )
     {
-      outputPointsFile << outputpointvec[ j ][ i ] << " ";
+      appendReal( outputpointvec[ j ][ i ] );
     }
 
     /** The output point minus the input point. */
-    outputPointsFile << "]\t; Deformation = [ ";
+    buffer.append( "]\t; Deformation = [ " );
     for( unsigned int i = 0; i < MovingImageDimension; i++ )
     {
-      outputPointsFile << deformationvec[ j ][ i ] << " ";
+      appendReal( deformationvec[ j ][ i ] );
     }
 
     if( alsoMovingIndices )
     {
       /** The output index in moving image. */
-      outputPointsFile << "]\t; OutputIndexMoving = [ ";
+      buffer.append( "]\t; OutputIndexMoving = [ " );
       for( unsigned int i = 0; i < MovingImageDimension; i++ )
       {
-        outputPointsFile << outputindexmovingvec[ j ][ i ] << " ";
+        appendInteger( outputindexmovingvec[ j ][ i ] );
       }
     }
 
-    outputPointsFile << "]" << std::endl;
+    buffer.append( "]\n" );
+
+    /** Write the text in blocks of about a megabyte. */
+    if( buffer.size() > ( 1 << 20 ) || j + 1 == nrofpoints )
+    {
+      outputPointsFile.write( buffer.data(), buffer.size() );
+      buffer.clear();
+    }
   } // end for nrofpoints
 
 } // end TransformPointsSomePoints()
@@ -1456,6 +1545,44 @@ TransformBase< TElastix >
 } // end TransformPointsSomePointsVTK()
 
 
+/**
+ * ************** GenerateTransformedPointSet *********************
+ *
+ * Transforms the points of a point set, in world coordinates, from
+ * the fixed to the moving image domain. TransformPoint is const, so
+ * the points are transformed in parallel, by the ITK default threader.
+ */
+
+template< class TElastix >
+typename TransformBase< TElastix >::PointSetType::Pointer
+TransformBase< TElastix >
+::GenerateTransformedPointSet( const PointSetType * inputPointSet ) const
+{
+  typedef typename PointSetType::PointsContainer PointsContainerType;
+
+  typename PointSetType::Pointer outputPointSet = PointSetType::New();
+  typename PointsContainerType::Pointer outputPoints = PointsContainerType::New();
+  outputPointSet->SetPoints( outputPoints );
+
+  const PointsContainerType * inputPoints = inputPointSet->GetPoints();
+  if( inputPoints == nullptr || inputPoints->Size() == 0 )
+  {
+    return outputPointSet;
+  }
+  outputPoints->Reserve( inputPoints->Size() );
+
+  const ITKBaseType * transform = this->GetAsITKBaseType();
+  itk::MultiThreaderBase::New()->ParallelizeArray( 0, inputPoints->Size(),
+    [ & ]( const itk::SizeValueType j )
+    {
+      outputPoints->ElementAt( j ) = transform->TransformPoint( inputPoints->ElementAt( j ) );
+    }, nullptr );
+
+  return outputPointSet;
+
+} // end GenerateTransformedPointSet()
+
+
 /**
  * ************** TransformPointsAllPoints **********************
  *
@@ -1680,6 +1807,8 @@ TransformBase< TElastix >
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  jacWriter->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( typename JacobianImageType::PixelType ) ) );
 
   /** Do the writing. */
   elxout << "  Computing and writing the spatial Jacobian determinant..." << std::endl;
@@ -1783,6 +1912,8 @@ TransformBase< TElastix >
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  jacWriter->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( typename JacobianImageType::PixelType ) ) );
   /** Hack to change the pixel type to vector. Not necessary for mhd. */
   typename PixelTypeChangeCommandType::Pointer jacStartWriteCommand
     = PixelTypeChangeCommandType::New();
@@ -1812,6 +1943,148 @@ TransformBase< TElastix >
 } // end ComputeSpatialJacobian()
 
 
+/**
+ * ************** GetNumberOfStreamDivisions **********************
+ */
+
+template< class TElastix >
+unsigned int
+TransformBase< TElastix >
+::GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const
+{
+  /** The resampler defines the output grid. */
+  return this->m_Elastix->GetElxResamplerBase()->GetNumberOfStreamDivisions( bytesPerPixel );
+
+} // end GetNumberOfStreamDivisions()
+
+
+/**
+ * ************** ComputeInverseDeformationField **********************
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::ComputeInverseDeformationField( void ) const
+{
+  /** If the optional command "-inv" is given in the command line arguments,
+   * then and only then we continue.
+   */
+  std::string inv = this->GetConfiguration()->GetCommandLineArgument( "-inv" );
+  if( inv == "" )
+  {
+    elxout << "  The command-line option \"-inv\" is not used, "
+           << "so no inverse deformation field computed." << std::endl;
+    return;
+  }
+  else if( inv != "all" )
+  {
+    elxout << "  WARNING: The command-line option \"-inv\" should be used as \"-inv all\",\n"
+           << "    but is specified as \"-inv " << inv << "\"\n"
+           << "    Therefore the inverse deformation field is not computed." << std::endl;
+    return;
+  }
+
+  /** Typedef's. */
+  typedef itk::TransformToInverseDisplacementFieldSource<
+    DeformationFieldImageType, CoordRepType >         InverseGeneratorType;
+  typedef typename InverseGeneratorType::ResidualImageType ResidualImageType;
+  typedef itk::ImageFileWriter< DeformationFieldImageType > DeformationFieldWriterType;
+  typedef itk::ImageFileWriter< ResidualImageType >         ResidualWriterType;
+
+  /** Read the settings of the inversion. */
+  unsigned int maximumNumberOfIterations = 20;
+  this->m_Configuration->ReadParameter( maximumNumberOfIterations,
+    "InverseMaximumNumberOfIterations", 0, false );
+  double tolerance = 1e-3;
+  this->m_Configuration->ReadParameter( tolerance, "InverseTolerance", 0, false );
+
+  /** Create an setup the inverse generator. */
+  typename InverseGeneratorType::Pointer invGenerator = InverseGeneratorType::New();
+  invGenerator->SetTransform( const_cast< const ITKBaseType * >(
+      this->GetAsITKBaseType() ) );
+  invGenerator->SetMaximumNumberOfIterations( maximumNumberOfIterations );
+  invGenerator->SetTolerance( tolerance );
+
+  /** The inverse transform maps the moving image domain to the fixed image
+   * domain. So, the moving image grid is used when it is given. Otherwise
+   * the output grid of the resampler is used.
+   */
+  const MovingImageType * movingImage = this->GetElastix()->GetMovingImage();
+  if( movingImage != 0 )
+  {
+    invGenerator->SetOutputParametersFromImage( movingImage );
+  }
+  else
+  {
+    typename InverseGeneratorType::RegionType region;
+    region.SetSize(
+      this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize() );
+    region.SetIndex(
+      this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputStartIndex() );
+    invGenerator->SetOutputRegion( region );
+    invGenerator->SetOutputSpacing(
+      this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputSpacing() );
+    invGenerator->SetOutputOrigin(
+      this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputOrigin() );
+    invGenerator->SetOutputDirection(
+      this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputDirection() );
+  }
+
+#ifndef _ELASTIX_BUILD_LIBRARY
+  /** Track the progress of the generation of the inverse deformation field. */
+  typename ProgressCommandType::Pointer progressObserver = ProgressCommandType::New();
+  progressObserver->ConnectObserver( invGenerator );
+  progressObserver->SetStartString( "  Progress: " );
+  progressObserver->SetEndString( "%" );
+#endif
+
+  /** Create names for the output files. */
+  std::string resultImageFormat = "mhd";
+  this->m_Configuration->ReadParameter( resultImageFormat, "ResultImageFormat", 0, false );
+  std::ostringstream makeFileName( "" );
+  makeFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
+               << "inverseDeformationField." << resultImageFormat;
+  std::ostringstream makeResidualFileName( "" );
+  makeResidualFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
+                       << "inverseDeformationFieldResidual." << resultImageFormat;
+
+  /** Compute the inverse, and write both outputs to disk. */
+  typename DeformationFieldWriterType::Pointer defWriter = DeformationFieldWriterType::New();
+  defWriter->SetInput( invGenerator->GetOutput() );
+  defWriter->SetFileName( makeFileName.str().c_str() );
+  typename ResidualWriterType::Pointer resWriter = ResidualWriterType::New();
+  resWriter->SetInput( invGenerator->GetResidualOutput() );
+  resWriter->SetFileName( makeResidualFileName.str().c_str() );
+
+  elxout << "  Computing and writing the inverse deformation field ..." << std::endl;
+  try
+  {
+    invGenerator->Update();
+    defWriter->Update();
+    resWriter->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    /** Add information to the exception. */
+    excp.SetLocation( "TransformBase - ComputeInverseDeformationField()" );
+    std::string err_str = excp.GetDescription();
+    err_str += "\nError occurred while writing inverse deformation field image.\n";
+    excp.SetDescription( err_str );
+
+    /** Pass the exception to an higher level. */
+    throw excp;
+  }
+
+  /** Report on the accuracy of the inversion. */
+  elxout << "  Maximum residual ||T(x) - y||: " << invGenerator->GetMaximumResidual() << "\n"
+         << "  Mean residual ||T(x) - y||: " << invGenerator->GetMeanResidual() << "\n"
+         << "  Number of voxels with residual > " << tolerance << ": "
+         << invGenerator->GetNumberOfNonConvergedPixels() << std::endl;
+
+} // end ComputeInverseDeformationField()
+
+
 /**
  * ************** SetTransformParametersFileName ****************
  */
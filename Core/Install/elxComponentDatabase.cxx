@@ -26,6 +26,7 @@
 
 #include "elxComponentDatabase.h"
 #include "xoutmain.h"
+#include "itkTimeProbe.h"
 
 namespace elastix
 {
@@ -127,6 +128,42 @@ ComponentDatabase::SetIndex(
 } // end SetIndex
 
 
+/**
+ * *********************** SetInstaller *************************
+ */
+
+void
+ComponentDatabase::SetInstaller( PtrToInstaller installer )
+{
+  std::lock_guard< std::mutex > lock( this->m_Mutex );
+  this->m_Installer = installer;
+
+} // end SetInstaller
+
+
+/**
+ * ******************** InstallComponents ***********************
+ */
+
+void
+ComponentDatabase::InstallComponents( IndexType i )
+{
+  itk::TimeProbe timer;
+  timer.Start();
+
+  const int installReturnCode = this->m_Installer( this, i );
+
+  timer.Stop();
+  if( installReturnCode != 0 )
+  {
+    xout[ "error" ] << "ERROR: Installing of at least one of components failed." << std::endl;
+  }
+  xout[ "standard" ] << "Installing the components for image type " << i << " took "
+                     << static_cast< unsigned long >( timer.GetMean() * 1000 ) << " ms." << std::endl;
+
+} // end InstallComponents
+
+
 /**
  * *********************** GetCreator ***************************
  */
@@ -136,25 +173,29 @@ ComponentDatabase::GetCreator(
   const ComponentDescriptionType & name,
   IndexType i )
 {
-  /** Get the map */
-  CreatorMapType map = GetCreatorMap();
+  std::lock_guard< std::mutex > lock( this->m_Mutex );
 
-  /** Make a key with the input arguments */
-  CreatorMapKeyType key( name, i );
+  /** Install the components of this image type, the first time that any
+   * of them is asked for.
+   */
+  if( this->m_Installer != nullptr && this->m_InstalledIndices.count( i ) == 0 )
+  {
+    this->m_InstalledIndices.insert( i );
+    this->InstallComponents( i );
+  }
 
   /** Check if this key has been defined. If yes, return the 'creator'
    * that is linked to it.
    */
-  if( map.count( key ) == 0 )    // of gewoon !map.count( key ) als boven??
+  const CreatorMapType::const_iterator found = this->CreatorMap.find( CreatorMapKeyType( name, i ) );
+  if( found == this->CreatorMap.end() )
   {
     xout[ "error" ] << "Error: " << std::endl;
     xout[ "error" ] << name << "(index " << i << ") - This component is not installed!" << std::endl;
     return 0;
   }
-  else
-  {
-    return map[ key ];
-  }
+
+  return found->second;
 
 } // end GetCreator
 
@@ -170,9 +211,6 @@ ComponentDatabase::GetIndex(
   const PixelTypeDescriptionType & movingPixelType,
   ImageDimensionType movingDimension )
 {
-  /** Get the map */
-  IndexMapType map = GetIndexMap();
-
   /** Make a key with the input arguments */
   ImageTypeDescriptionType fixedImage( fixedPixelType, fixedDimension );
   ImageTypeDescriptionType movingImage( movingPixelType, movingDimension );
@@ -181,7 +219,8 @@ ComponentDatabase::GetIndex(
   /** Check if this key has been defined. If yes, return the 'index'
    * that is linked to it.
    */
-  if( map.count( key ) == 0 )
+  const IndexMapType::const_iterator found = this->IndexMap.find( key );
+  if( found == this->IndexMap.end() )
   {
     xout[ "error" ] << "ERROR:\n"
                     << "  FixedImageType:  " << fixedDimension << "D " << fixedPixelType << std::endl
@@ -194,10 +233,8 @@ ComponentDatabase::GetIndex(
                     << "in the elastix parameter file.\n" << std::endl;
     return 0;
   }
-  else
-  {
-    return map[ key ];
-  }
+
+  return found->second;
 
 } // end GetIndex
 
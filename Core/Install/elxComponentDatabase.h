@@ -25,6 +25,8 @@
 #include <string>
 #include <utility>
 #include <map>
+#include <mutex>
+#include <set>
 
 namespace elastix
 {
@@ -107,12 +109,20 @@ public:
     IndexMapValueType >                IndexMapType;
   typedef IndexMapType::value_type IndexMapEntryType;
 
+  /** PtrToInstaller is a pointer to a function which installs the
+   * creators of all components for one image type, with the specified
+   * index. It returns 0 if everything went ok.
+   */
+  typedef int (* PtrToInstaller)( ComponentDatabase *, IndexType );
+
   /** Functions to get the CreatorMap and the IndexMap.*/
   CreatorMapType & GetCreatorMap( void );
 
   IndexMapType & GetIndexMap( void );
 
-  /** Functions to set an entry in a map.*/
+  /** Functions to set an entry in a map. SetCreator() is not thread-safe;
+   * it is only called by the installer, and while loading the database.
+   */
   int SetCreator(
     const ComponentDescriptionType & name,
     IndexType i,
@@ -125,7 +135,16 @@ public:
     ImageDimensionType movingDimension,
     IndexType i );
 
-  /** Functions to get an entry in a map */
+  /** Set the function that installs the components. The components of an
+   * image type are then installed lazily, by the first GetCreator() for
+   * that image type, instead of all components for all image types at
+   * startup.
+   */
+  void SetInstaller( PtrToInstaller installer );
+
+  /** Functions to get an entry in a map. GetCreator() may be called by
+   * several threads at the same time.
+   */
   PtrToCreator GetCreator(
     const ComponentDescriptionType & name,
     IndexType i );
@@ -138,7 +157,7 @@ public:
 
 protected:
 
-  ComponentDatabase(){}
+  ComponentDatabase() : m_Installer( nullptr ) {}
   ~ComponentDatabase() override{}
 
   CreatorMapType CreatorMap;
@@ -149,6 +168,13 @@ private:
   ComponentDatabase( const Self & ); // purposely not implemented
   void operator=( const Self & );    // purposely not implemented
 
+  /** Installs the components of image type i, with the installer. */
+  void InstallComponents( IndexType i );
+
+  PtrToInstaller        m_Installer;
+  std::set< IndexType > m_InstalledIndices;
+  std::mutex            m_Mutex;
+
 };
 
 } // end namespace elastix
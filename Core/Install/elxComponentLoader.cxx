@@ -154,19 +154,11 @@ ComponentLoader::LoadComponents( const char * /** argv0 */ )
     }
   }   //end if !ImageTypeSupportInstalled
 
-  elxout << "Installing all components." << std::endl;
-
-  /** Fill the component database */
-  installReturnCode = InstallAllComponents( this->m_ComponentDatabase );
-
-  if( installReturnCode )
-  {
-    xout[ "error" ]
-      << "ERROR: Installing of at least one of components failed." << std::endl;
-    return installReturnCode;
-  }
-
-  elxout << "InstallingComponents was successful.\n" << std::endl;
+  /** The component database installs the components of an image type
+   * when they are needed for the first time. Installing them all here, for
+   * all supported image types, would only slow down the startup.
+   */
+  this->m_ComponentDatabase->SetInstaller( InstallAllComponents );
 
   return 0;
 
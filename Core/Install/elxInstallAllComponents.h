@@ -28,8 +28,12 @@
  * the InstallComponent functions implemented by the components. */
 #include "elxInstallComponentFunctionDeclarations.h"
 
+/** Installs all components for the image type with index _index.
+ * The ComponentDatabase calls this function when the components of an
+ * image type are needed for the first time, see ComponentLoader.
+ */
 int
-InstallAllComponents( elx::ComponentDatabase * _cdb )
+InstallAllComponents( elx::ComponentDatabase * _cdb, elx::ComponentDatabase::IndexType _index )
 {
   int ret = 0;
 
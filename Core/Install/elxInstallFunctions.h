@@ -35,8 +35,9 @@ namespace elastix
  * stores for each instance and each pixeltype/dimension a pointers to a function
  * that creates a component of the specific type. The InstallFunctions
  * class provides functions that aid in filling the elx::ComponentDatabase.
- * The functions are called when elastix is started. Do not do this
- * directly. Use the elxInstallMacro instead (see elxMacro.h).
+ * The functions are called when the components of an image type are
+ * needed for the first time. Do not do this directly. Use the
+ * elxInstallMacro instead (see elxMacro.h).
  *
  * \sa ComponentDatabase
  * \ingroup Install
@@ -17,7 +17,6 @@
  *=========================================================================*/
 #include "elxElastixBase.h"
 #include <sstream>
-#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace elastix
 {
@@ -32,6 +31,7 @@ ElastixBase::ElastixBase()
   this->m_Configuration     = 0;
   this->m_ComponentDatabase = 0;
   this->m_DBIndex           = 0;
+  this->m_RandomGenerator   = RandomGeneratorType::New();
 
   /** The default output precision of elxout is set to 6. */
   this->m_DefaultOutputPrecision = 6;
@@ -221,6 +221,13 @@ ElastixBase::BeforeAllBase( void )
     elxout << "-threads  " << check << std::endl;
   }
 
+  /** Check for appearance of -resume, which specifies the directory with the checkpoints. */
+  check = this->GetConfiguration()->GetCommandLineArgument( "-resume" );
+  if( check != "" )
+  {
+    elxout << "-resume   " << check << std::endl;
+  }
+
   /** Check the very important UseDirectionCosines parameter. */
   bool retudc = this->GetConfiguration()->ReadParameter( this->m_UseDirectionCosines,
     "UseDirectionCosines", 0 );
@@ -237,12 +244,10 @@ ElastixBase::BeforeAllBase( void )
    * the default in the MersenneTwister code.
    * Use silent parameter file readout, to avoid annoying warning when
    * starting elastix */
-  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
-  typedef RandomGeneratorType::IntegerType                       SeedType;
+  typedef RandomGeneratorType::IntegerType SeedType;
   unsigned int randomSeed = 121212;
   this->GetConfiguration()->ReadParameter( randomSeed, "RandomSeed", 0, false );
-  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
-  randomGenerator->SetSeed( static_cast< SeedType >( randomSeed ) );
+  this->m_RandomGenerator->SetSeed( static_cast< SeedType >( randomSeed ) );
 
   /** Return a value. */
   return returndummy;
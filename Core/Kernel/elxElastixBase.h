@@ -38,6 +38,8 @@
 #include "itkVectorContainer.h"
 #include "itkImageFileReader.h"
 #include "itkChangeInformationImageFilter.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkImagePyramidCache.h"
 
 #include <fstream>
 #include <iomanip>
@@ -90,7 +92,7 @@ namespace elastix
  * of the images to be registered, is defined in this class.
  *
  * The parameters used by this class are:
- * \parameter RandomSeed: Sets a global seed for the random generator.\n
+ * \parameter RandomSeed: Sets the seed for the random generator of the registration.\n
  *   example: <tt>(RandomSeed 121212)</tt>\n
  *   It must be a positive integer number. Default: 121212.
  * \parameter DefaultOutputPrecision: Set the default precision of floating values in the output.
@@ -133,6 +135,20 @@ namespace elastix
  * \commandlinearg -threads: optional argument for both elastix and transformix to
  *    specify the maximum number of threads used by this process. Default: no maximum. \n
  *    example: <tt>-threads 2</tt> \n
+ * \commandlinearg -resume: optional argument for elastix with the directory that
+ *    contains the checkpoints of an interrupted registration, usually its output
+ *    directory. The resolutions that it has completed are skipped. See the
+ *    parameter WriteCheckpoints. \n
+ *    example: <tt>-resume outDir</tt> \n
+ * \commandlinearg -batch: optional argument for elastix, instead of -m, with a text
+ *    file that contains a moving image file name per line. Each moving image is
+ *    registered to the fixed image, which is read only once, and whose pyramids
+ *    are computed only once. The registration of
+ *    moving image i writes its output to the subdirectory "i" of the output directory. \n
+ *    example: <tt>-batch atlases.txt</tt> \n
+ * \commandlinearg -concurrent: optional argument for elastix with the maximum number of
+ *    registrations of a -batch that run at the same time. Default: the number of cores. \n
+ *    example: <tt>-concurrent 4</tt> \n
  * \commandlinearg -in: optional argument for transformix with the file name of an input image. \n
  *    example: <tt>-in inputImage.mhd</tt> \n
  *    If this option is skipped, a deformation field of the transform will be generated.
@@ -171,6 +187,13 @@ public:
   typedef ComponentDatabaseType::IndexType DBIndexType;
   typedef std::vector< double >            FlatDirectionCosinesType;
 
+  /** Typedef for the random number generator. */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  typedef RandomGeneratorType::Pointer                           RandomGeneratorPointer;
+
+  /** Typedef for the cache of fixed image pyramids that are shared between registrations. */
+  typedef itk::ImagePyramidCache ImagePyramidCacheType;
+
   /** Typedef that is used in the elastix dll version. */
   typedef itk::ParameterMapInterface::ParameterMapType ParameterMapType;
 
@@ -206,6 +229,14 @@ public:
   elxGetObjectMacro( ComponentDatabase, ComponentDatabaseType );
   elxSetObjectMacro( ComponentDatabase, ComponentDatabaseType );
 
+  /** Get the random number generator of this registration. It is seeded
+   * with the RandomSeed parameter in BeforeAllBase(). The components use
+   * it instead of the global instance of the MersenneTwisterRandomVariateGenerator,
+   * so that registrations that run concurrently in one process do not
+   * share their random number streams.
+   */
+  elxGetObjectMacro( RandomGenerator, RandomGeneratorType );
+
   /** Get the component containers.
    * The component containers store components, such as
    * the metric, in the form of an itk::Object::Pointer.
@@ -256,6 +287,23 @@ public:
   elxGetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
   elxSetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
 
+  /** Set/Get the points that transformix transforms, given in memory instead
+   * of by "-def", and the transformed points. Both are an itk::PointSet of
+   * TransformBase::PointSetType.
+   */
+  elxGetObjectMacro( InputPointSet, DataObjectType );
+  elxSetObjectMacro( InputPointSet, DataObjectType );
+  elxGetObjectMacro( ResultPointSet, DataObjectType );
+  elxSetObjectMacro( ResultPointSet, DataObjectType );
+
+  /** Set/Get the cache of the fixed image pyramids. When set, the fixed
+   * image pyramids are shared with the other registrations that use the same
+   * cache, which should all register to the same fixed image(s), with the
+   * same parameter maps (see ElastixBatchFilter). Null by default.
+   */
+  elxGetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+  elxSetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+
   /** Set/Get The Image FileName containers.
    * Normally, these are filled in the BeforeAllBase function.
    */
@@ -316,6 +364,12 @@ public:
   /** Empty ApplyTransform()-function to be overridden. */
   virtual int ApplyTransform( void ) = 0;
 
+  /** Reads only the fixed images and masks, given by the command line
+   * arguments -f and -fMask, without running a registration. The batch
+   * mode uses this to read them once, for all its registrations.
+   */
+  virtual int ReadFixedImages( void ) = 0;
+
   /** Function that is called at the very beginning of ElastixTemplate::Run().
    * It checks the command line input arguments.
    */
@@ -372,6 +426,7 @@ protected:
   ConfigurationPointer     m_Configuration;
   DBIndexType              m_DBIndex;
   ComponentDatabasePointer m_ComponentDatabase;
+  RandomGeneratorPointer   m_RandomGenerator;
 
   FlatDirectionCosinesType m_OriginalFixedImageDirection;
 
@@ -533,6 +588,13 @@ private:
   /** The result deformation field container. These are stored as pointers to itk::DataObject. */
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
 
+  /** The input and result point sets of transformix, if given in memory. */
+  DataObjectPointer m_InputPointSet;
+  DataObjectPointer m_ResultPointSet;
+
+  /** The cache of the fixed image pyramids, if shared with other registrations. */
+  ImagePyramidCacheType::Pointer m_ImagePyramidCache;
+
   /** The image and mask FileNameContainers. */
   FileNameContainerPointer m_FixedImageFileNameContainer;
   FileNameContainerPointer m_MovingImageFileNameContainer;
@@ -28,6 +28,10 @@
 
 #include "elxMacro.h"
 #include "itkPlatformMultiThreader.h"
+#include "itkTimeProbe.h"
+
+#include <memory>
+#include <mutex>
 
 #ifdef ELASTIX_USE_OPENCL
 #include "itkOpenCLSetup.h"
@@ -56,73 +60,192 @@ xoutsimple_type g_CoutOnlyXout;
 xoutsimple_type g_LogOnlyXout;
 std::ofstream   g_LogFileStream;
 
+/** Writes to g_LogFileStream in a background thread. Defined after
+ * g_LogFileStream, so that it is destructed, and flushed, before it.
+ */
+static std::unique_ptr< asyncostream > g_AsyncLogFileStream;
+
+/** Protects the configuration of the global xout by xoutManager. */
+static std::mutex s_GlobalXoutMutex;
+
 /**
- * ********************* xoutSetup ******************************
+ * ********************* GetAsyncCout ***************************
  *
- * NB: this function is a global function, not part of the ElastixMain
- * class!!
+ * Returns a stream that writes to std::cout in a background thread. It is
+ * shared by all xouts, so that there is only one such thread.
  */
 
-int
-xoutSetup( const char * logfilename, bool setupLogging, bool setupCout )
+static std::ostream &
+GetAsyncCout( void )
 {
-  /** The namespace of xout. */
-  using namespace xl;
+  static asyncostream asyncCout( std::cout );
+  return asyncCout;
 
+} // end GetAsyncCout()
+
+
+/**
+ * ********************* xoutSetupFields ************************
+ *
+ * Connects the fields "warning", "error", "standard", "logonly" and
+ * "coutonly" to baseXout, and sets the outputs of baseXout to std::cout
+ * and/or the logfile. Used by xoutSetup and xoutManager.
+ */
+
+static int
+xoutSetupFields( const char * logfilename, bool setupLogging, bool setupCout,
+  xoutbase_type & baseXout, xoutsimple_type & warningXout,
+  xoutsimple_type & errorXout, xoutsimple_type & standardXout,
+  xoutsimple_type & logOnlyXout, xoutsimple_type & coutOnlyXout,
+  std::ofstream & logFileStream,
+  std::unique_ptr< asyncostream > & asyncLogFileStream )
+{
   int returndummy = 0;
-  set_xout( &g_xout );
 
   if( setupLogging )
   {
     /** Open the logfile for writing. */
-    g_LogFileStream.open( logfilename );
-    if( !g_LogFileStream.is_open() )
+    logFileStream.open( logfilename );
+    if( !logFileStream.is_open() )
     {
       std::cerr << "ERROR: LogFile cannot be opened!" << std::endl;
       return 1;
     }
+
+    /** The logfile is written by a background thread, so that logging
+     * (and flushing it by std::endl) does not block the registration.
+     */
+    asyncLogFileStream.reset( new asyncostream( logFileStream ) );
   }
 
+  std::ostream * logStream  = asyncLogFileStream ? asyncLogFileStream.get() : &logFileStream;
+  std::ostream * coutStream = &GetAsyncCout();
+
   /** Set std::cout and the logfile as outputs of xout. */
   if( setupLogging )
   {
-    returndummy |= xout.AddOutput( "log", &g_LogFileStream );
+    returndummy |= baseXout.AddOutput( "log", logStream );
   }
   if( setupCout )
   {
-    returndummy |= xout.AddOutput( "cout", &std::cout );
+    returndummy |= baseXout.AddOutput( "cout", coutStream );
   }
 
   /** Set outputs of LogOnly and CoutOnly. */
-  returndummy |= g_LogOnlyXout.AddOutput( "log", &g_LogFileStream );
-  returndummy |= g_CoutOnlyXout.AddOutput( "cout", &std::cout );
+  returndummy |= logOnlyXout.AddOutput( "log", logStream );
+  returndummy |= coutOnlyXout.AddOutput( "cout", coutStream );
 
   /** Copy the outputs to the warning-, error- and standard-xouts. */
-  g_WarningXout.SetOutputs( xout.GetCOutputs() );
-  g_ErrorXout.SetOutputs( xout.GetCOutputs() );
-  g_StandardXout.SetOutputs( xout.GetCOutputs() );
+  warningXout.SetOutputs( baseXout.GetCOutputs() );
+  errorXout.SetOutputs( baseXout.GetCOutputs() );
+  standardXout.SetOutputs( baseXout.GetCOutputs() );
 
-  g_WarningXout.SetOutputs( xout.GetXOutputs() );
-  g_ErrorXout.SetOutputs( xout.GetXOutputs() );
-  g_StandardXout.SetOutputs( xout.GetXOutputs() );
+  warningXout.SetOutputs( baseXout.GetXOutputs() );
+  errorXout.SetOutputs( baseXout.GetXOutputs() );
+  standardXout.SetOutputs( baseXout.GetXOutputs() );
 
   /** Link the warning-, error- and standard-xouts to xout. */
-  returndummy |= xout.AddTargetCell( "warning", &g_WarningXout );
-  returndummy |= xout.AddTargetCell( "error", &g_ErrorXout );
-  returndummy |= xout.AddTargetCell( "standard", &g_StandardXout );
-  returndummy |= xout.AddTargetCell( "logonly", &g_LogOnlyXout );
-  returndummy |= xout.AddTargetCell( "coutonly", &g_CoutOnlyXout );
+  returndummy |= baseXout.AddTargetCell( "warning", &warningXout );
+  returndummy |= baseXout.AddTargetCell( "error", &errorXout );
+  returndummy |= baseXout.AddTargetCell( "standard", &standardXout );
+  returndummy |= baseXout.AddTargetCell( "logonly", &logOnlyXout );
+  returndummy |= baseXout.AddTargetCell( "coutonly", &coutOnlyXout );
 
   /** Format the output. */
-  xout[ "standard" ] << std::fixed;
-  xout[ "standard" ] << std::showpoint;
+  baseXout[ "standard" ] << std::fixed;
+  baseXout[ "standard" ] << std::showpoint;
 
   /** Return a value. */
   return returndummy;
 
+} // end xoutSetupFields()
+
+
+/**
+ * ********************* xoutSetup ******************************
+ *
+ * NB: this function is a global function, not part of the ElastixMain
+ * class!!
+ */
+
+int
+xoutSetup( const char * logfilename, bool setupLogging, bool setupCout )
+{
+  /** The namespace of xout. */
+  using namespace xl;
+
+  set_xout( &g_xout );
+
+  return xoutSetupFields( logfilename, setupLogging, setupCout,
+    g_xout, g_WarningXout, g_ErrorXout, g_StandardXout,
+    g_LogOnlyXout, g_CoutOnlyXout, g_LogFileStream, g_AsyncLogFileStream );
+
 } // end xoutSetup()
 
 
+/**
+ * ********************* xoutManager ****************************
+ */
+
+xoutManager::xoutManager()
+{
+  this->m_PreviousXout = xl::get_thread_xout();
+  this->m_Installed    = false;
+
+} // end Constructor
+
+
+/**
+ * ********************* ~xoutManager ***************************
+ */
+
+xoutManager::~xoutManager()
+{
+  /** Restore the xout that the thread used before. */
+  if( this->m_Installed )
+  {
+    xl::set_thread_xout( this->m_PreviousXout );
+  }
+
+} // end Destructor
+
+
+/**
+ * ********************* xoutManager::Setup *********************
+ */
+
+int
+xoutManager::Setup( const std::string & logFileName,
+  bool setupLogging, bool setupCout )
+{
+  const int returnCode = xoutSetupFields( logFileName.c_str(),
+    setupLogging, setupCout,
+    this->m_Xout, this->m_WarningXout, this->m_ErrorXout, this->m_StandardXout,
+    this->m_LogOnlyXout, this->m_CoutOnlyXout, this->m_LogFileStream,
+    this->m_AsyncLogFileStream );
+
+  /** Make sure that threads without an xout of their own can log as well.
+   * The xout of the calling thread is uninstalled temporarily to check
+   * whether the global xout has been configured.
+   */
+  {
+    std::lock_guard< std::mutex > lock( s_GlobalXoutMutex );
+    xl::set_thread_xout( 0 );
+    if( !xl::xout_valid() )
+    {
+      xoutSetup( "", false, false );
+    }
+  }
+
+  /** Install this xout for the calling thread. */
+  xl::set_thread_xout( &this->m_Xout );
+  this->m_Installed = true;
+
+  return returnCode;
+
+} // end Setup()
+
+
 /**
  * ********************* Constructor ****************************
  */
@@ -140,7 +263,8 @@ ElastixMain::ElastixMain()
   this->m_MovingImagePixelType = "";
   this->m_MovingImageDimension = 0;
 
-  this->m_DBIndex = 0;
+  this->m_DBIndex           = 0;
+  this->m_ComponentDatabase = 0;
 
   this->m_FixedImageContainer  = 0;
   this->m_MovingImageContainer = 0;
@@ -150,6 +274,8 @@ ElastixMain::ElastixMain()
 
   this->m_ResultImageContainer = 0;
 
+  this->m_ImagePyramidCache = 0;
+
   this->m_FinalTransform   = 0;
   this->m_InitialTransform = 0;
   this->m_TransformParametersMap.clear();
@@ -165,6 +291,9 @@ ElastixMain::ElastixMain()
 ElastixMain::ComponentDatabasePointer ElastixMain::s_CDB;
 ElastixMain::ComponentLoaderPointer   ElastixMain::s_ComponentLoader;
 
+/** Protects the shared component database and component loader. */
+static std::mutex s_ComponentDatabaseMutex;
+
 /**
  * ********************** Destructor ****************************
  */
@@ -264,6 +393,11 @@ ElastixMain
 int
 ElastixMain::Run( void )
 {
+  /** Measure the startup time: reading the image information, loading the
+   * component database and creating the components.
+   */
+  itk::TimeProbe startupTimer;
+  startupTimer.Start();
 
   /** Set process properties. */
   this->SetProcessPriority();
@@ -320,7 +454,7 @@ ElastixMain::Run( void )
 
   /** Set some information in the ElastixBase. */
   this->GetElastixBase()->SetConfiguration( this->m_Configuration );
-  this->GetElastixBase()->SetComponentDatabase( this->s_CDB );
+  this->GetElastixBase()->SetComponentDatabase( this->m_ComponentDatabase );
   this->GetElastixBase()->SetDBIndex( this->m_DBIndex );
 
   /** Populate the component containers. ImageSampler is not mandatory.
@@ -380,6 +514,9 @@ ElastixMain::Run( void )
   this->GetElastixBase()->SetMovingMaskContainer( this->GetModifiableMovingMaskContainer() );
   this->GetElastixBase()->SetResultImageContainer( this->GetModifiableResultImageContainer() );
 
+  /** Set the cache of the fixed image pyramids, if the pyramids are shared. */
+  this->GetElastixBase()->SetImagePyramidCache( this->GetModifiableImagePyramidCache() );
+
   /** Set the initial transform, if it happens to be there. */
   this->GetElastixBase()->SetInitialTransform( this->GetModifiableInitialTransform() );
 
@@ -389,6 +526,10 @@ ElastixMain::Run( void )
   this->GetElastixBase()->SetOriginalFixedImageDirectionFlat(
     this->GetOriginalFixedImageDirectionFlat() );
 
+  startupTimer.Stop();
+  elxout << "Starting elastix took " << static_cast< unsigned long >(
+    startupTimer.GetMean() * 1000 ) << " ms." << std::endl;
+
   /** Run elastix! */
   try
   {
@@ -464,6 +605,60 @@ ElastixMain
 } // end Run()
 
 
+/**
+ * ************************ ReadFixedImages *********************
+ */
+
+int
+ElastixMain::ReadFixedImages( const ArgumentMapType & argmap )
+{
+  this->EnterCommandLineArguments( argmap );
+
+  /** Initialize database. */
+  int errorCode = this->InitDBIndex();
+  if( errorCode != 0 )
+  {
+    return errorCode;
+  }
+
+  /** Create the elastix component, which knows the image types. */
+  try
+  {
+    this->m_Elastix = this->CreateComponent( "Elastix" );
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    xl::xout[ "error" ] << excp << std::endl;
+    return 1;
+  }
+  this->GetElastixBase()->SetConfiguration( this->m_Configuration );
+
+  /** Read the fixed images and masks. */
+  try
+  {
+    errorCode = this->GetElastixBase()->ReadFixedImages();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    xl::xout[ "error" ] << excp << std::endl;
+    errorCode = 1;
+  }
+  if( errorCode != 0 )
+  {
+    return errorCode;
+  }
+
+  /** Store the images in ElastixMain. */
+  this->SetFixedImageContainer( this->GetElastixBase()->GetFixedImageContainer() );
+  this->SetFixedMaskContainer( this->GetElastixBase()->GetFixedMaskContainer() );
+  this->SetOriginalFixedImageDirectionFlat(
+    this->GetElastixBase()->GetOriginalFixedImageDirectionFlat() );
+
+  return 0;
+
+} // end ReadFixedImages()
+
+
 /**
  * ************************** InitDBIndex ***********************
  *
@@ -636,7 +831,7 @@ ElastixMain::InitDBIndex( void )
     }
 
     /** Load the components. */
-    if( this->s_CDB.IsNull() )
+    if( this->m_ComponentDatabase.IsNull() )
     {
       int loadReturnCode = this->LoadComponents();
       if( loadReturnCode != 0 )
@@ -646,10 +841,10 @@ ElastixMain::InitDBIndex( void )
       }
     }
 
-    if( this->s_CDB.IsNotNull() )
+    if( this->m_ComponentDatabase.IsNotNull() )
     {
       /** Get the DBIndex from the ComponentDatabase. */
-      this->m_DBIndex = this->s_CDB->GetIndex(
+      this->m_DBIndex = this->m_ComponentDatabase->GetIndex(
         this->m_FixedImagePixelType,
         this->m_FixedImageDimension,
         this->m_MovingImagePixelType,
@@ -660,7 +855,7 @@ ElastixMain::InitDBIndex( void )
         xout[ "error" ] << "Something went wrong in the ComponentDatabase" << std::endl;
         return 1;
       }
-    } // end if s_CDB!=0
+    } // end if m_ComponentDatabase!=0
 
   } // end if m_Configuration->Initialized();
   else
@@ -738,25 +933,37 @@ ElastixMain::GetTotalNumberOfElastixLevels( void )
 int
 ElastixMain::LoadComponents( void )
 {
-  /** Create a ComponentDatabase. */
-  if( this->s_CDB.IsNull() )
-  {
-    this->s_CDB = ComponentDatabaseType::New();
-  }
+  std::lock_guard< std::mutex > lock( s_ComponentDatabaseMutex );
 
-  /** Create a ComponentLoader and set the database. */
-  if( this->s_ComponentLoader.IsNull() )
+  /** The components are loaded only once, by the first instance. */
+  if( s_CDB.IsNotNull() )
   {
-    this->s_ComponentLoader = ComponentLoaderType::New();
-    this->s_ComponentLoader->SetComponentDatabase( s_CDB );
+    this->m_ComponentDatabase = s_CDB;
+    return 0;
   }
 
+  /** Create a ComponentDatabase and a ComponentLoader. The database is
+   * only shared after the supported image types have been installed
+   * successfully. The components themselves are installed lazily, by the
+   * database, when an image type is used for the first time.
+   */
+  ComponentDatabasePointer componentDatabase = ComponentDatabaseType::New();
+  s_ComponentLoader = ComponentLoaderType::New();
+  s_ComponentLoader->SetComponentDatabase( componentDatabase );
+
   /** Get the current program. */
   const char * argv0
     = this->m_Configuration->GetCommandLineArgument( "-argv0" ).c_str();
 
   /** Load the components. */
-  return this->s_ComponentLoader->LoadComponents( argv0 );
+  const int loadReturnCode = s_ComponentLoader->LoadComponents( argv0 );
+  if( loadReturnCode == 0 )
+  {
+    s_CDB                     = componentDatabase;
+    this->m_ComponentDatabase = componentDatabase;
+  }
+
+  return loadReturnCode;
 
 } // end LoadComponents()
 
@@ -768,11 +975,13 @@ ElastixMain::LoadComponents( void )
 void
 ElastixMain::UnloadComponents( void )
 {
+  std::lock_guard< std::mutex > lock( s_ComponentDatabaseMutex );
+
   s_CDB = 0;
-  s_ComponentLoader->SetComponentDatabase( 0 );
 
   if( s_ComponentLoader )
   {
+    s_ComponentLoader->SetComponentDatabase( 0 );
     s_ComponentLoader->UnloadComponents();
   }
 
@@ -781,6 +990,58 @@ ElastixMain::UnloadComponents( void )
 } // end UnloadComponents()
 
 
+/**
+ * ********************* CreateShallowCopy **************************
+ */
+
+ElastixMain::DataObjectContainerPointer
+ElastixMain::CreateShallowCopy( DataObjectContainerType * container )
+{
+  DataObjectContainerPointer copy = DataObjectContainerType::New();
+  for( unsigned int i = 0; i < container->Size(); ++i )
+  {
+    itk::DataObject *         image   = container->ElementAt( i ).GetPointer();
+    itk::LightObject::Pointer another = image->CreateAnother();
+    itk::DataObject::Pointer  imageCopy
+      = dynamic_cast< itk::DataObject * >( another.GetPointer() );
+    imageCopy->Graft( image );
+    copy->CreateElementAt( i ) = imageCopy;
+  }
+
+  return copy;
+
+} // end CreateShallowCopy()
+
+
+/**
+ * ********************* GetComponentDatabase **************************
+ */
+
+ComponentDatabase *
+ElastixMain::GetComponentDatabase( void )
+{
+  std::lock_guard< std::mutex > lock( s_ComponentDatabaseMutex );
+  return s_CDB.GetPointer();
+
+} // end GetComponentDatabase()
+
+
+/**
+ * ********************* SetComponentDatabase **************************
+ */
+
+void
+ElastixMain::SetComponentDatabase( ComponentDatabase * arg )
+{
+  std::lock_guard< std::mutex > lock( s_ComponentDatabaseMutex );
+  if( s_CDB != arg )
+  {
+    s_CDB = arg;
+  }
+
+} // end SetComponentDatabase()
+
+
 /**
  * ************************* GetElastixBase ***************************
  */
@@ -812,7 +1073,7 @@ ElastixMain::CreateComponent(
 {
   /** A pointer to the New() function. */
   PtrToCreator  testcreator = 0;
-  testcreator = this->s_CDB->GetCreator( name,  this->m_DBIndex );
+  testcreator = this->m_ComponentDatabase->GetCreator( name, this->m_DBIndex );
 
   // Note that ObjectPointer() yields a default-constructed SmartPointer (null).
   ObjectPointer testpointer = testcreator ? testcreator() : ObjectPointer();
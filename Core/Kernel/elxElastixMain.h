@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 
 #include "itkParameterMapInterface.h"
 
@@ -49,11 +50,62 @@ namespace elastix
  * such as "warning", "error", "standard", "logonly" and "coutonly",
  * and it sets the outputs to std::cout and/or a logfile.
  *
+ * The logfile and std::cout are written by a background thread (see
+ * xl::asyncostream), so that writing messages does not wait for I/O.
+ *
  * The method takes a logfile name as its input argument.
  * It returns 0 if everything went ok. 1 otherwise.
  */
 extern int xoutSetup( const char * logfilename, bool setupLogging, bool setupCout );
 
+/**
+ * \class xoutManager
+ * \brief Configures an xout that is only used by the calling thread.
+ *
+ * xoutSetup() configures the global xout, which is shared by all threads.
+ * An xoutManager owns its own xout with the same fields, and installs it as
+ * the xout of the calling thread (see xl::set_thread_xout). This allows
+ * the ElastixFilter and TransformixFilter to run concurrently in different
+ * threads of one process, each writing to its own log file. The previous
+ * xout of the thread is restored when the xoutManager is destructed.
+ *
+ * Note that worker threads started by ITK do not see the xout of the
+ * thread that started them, and use the global xout instead. If the global
+ * xout has not been configured by xoutSetup(), Setup() configures it
+ * without any outputs.
+ */
+class xoutManager
+{
+public:
+
+  xoutManager();
+  ~xoutManager();
+
+  /** Configure the xout and install it for the calling thread.
+   * Returns 0 if everything went ok, 1 otherwise.
+   */
+  int Setup( const std::string & logFileName, bool setupLogging, bool setupCout );
+
+private:
+
+  xoutManager( const xoutManager & );     // purposely not implemented
+  void operator=( const xoutManager & );  // purposely not implemented
+
+  xl::xoutbase_type * m_PreviousXout;
+  bool                m_Installed;
+
+  std::ofstream                       m_LogFileStream;
+  std::unique_ptr< xl::asyncostream > m_AsyncLogFileStream;
+
+  xl::xoutbase_type   m_Xout;
+  xl::xoutsimple_type m_WarningXout;
+  xl::xoutsimple_type m_ErrorXout;
+  xl::xoutsimple_type m_StandardXout;
+  xl::xoutsimple_type m_CoutOnlyXout;
+  xl::xoutsimple_type m_LogOnlyXout;
+
+};
+
 /**
  * \class ElastixMain
  * \brief A class with all functionality to configure elastix.
@@ -129,6 +181,7 @@ public:
   typedef ElastixBase::ObjectContainerPointer           ObjectContainerPointer;
   typedef ElastixBase::DataObjectContainerPointer       DataObjectContainerPointer;
   typedef ElastixBase::FlatDirectionCosinesType         FlatDirectionCosinesType;
+  typedef ElastixBase::ImagePyramidCacheType            ImagePyramidCacheType;
 
   /** Typedefs for the database that holds pointers to New() functions.
    * Those functions are used to instantiate components, such as the metric etc.
@@ -186,6 +239,12 @@ public:
   itkSetObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
   itkGetModifiableObjectMacro( ResultDeformationFieldContainer, DataObjectContainerType );
 
+  /** Set/Get the cache of the fixed image pyramids, which is passed to the
+   * elastix object (see ElastixBase::SetImagePyramidCache()).
+   */
+  itkSetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+  itkGetModifiableObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+
   /** Set/Get the configuration object. */
   itkSetObjectMacro( Configuration, ConfigurationType );
   itkGetModifiableObjectMacro( Configuration, ConfigurationType );
@@ -263,6 +322,13 @@ public:
 
   virtual int Run( const ArgumentMapType & argmap, const ParameterMapType & inputMap );
 
+  /** Only read the fixed images and masks, as specified by the command line
+   * arguments and the parameter file, without running a registration. They
+   * are stored in the fixed image and mask containers, so that they can be
+   * passed on to other registrations.
+   */
+  virtual int ReadFixedImages( const ArgumentMapType & argmap );
+
   /** Set process priority, which is read from the command line arguments.
    * Syntax:
    * -priority \<high, belownormal\>
@@ -275,20 +341,15 @@ public:
    */
   virtual void SetMaximumNumberOfThreads( void ) const;
 
-  /** Functions to get/set the ComponentDatabase. */
-  static ComponentDatabase * GetComponentDatabase( void )
-  {
-    return s_CDB.GetPointer();
-  }
-
+  /** Functions to get/set the ComponentDatabase. The database is shared by
+   * all instances, and it is loaded only once, by the first instance that
+   * needs it. The components of an image type are installed by the first
+   * lookup for that image type; the database serializes its lookups, so
+   * that several instances may run concurrently in one process.
+   */
+  static ComponentDatabase * GetComponentDatabase( void );
 
-  static void SetComponentDatabase( ComponentDatabase * arg )
-  {
-    if( s_CDB != arg )
-    {
-      s_CDB = arg;
-    }
-  }
+  static void SetComponentDatabase( ComponentDatabase * arg );
 
 
   /** GetTransformParametersMap */
@@ -296,6 +357,14 @@ public:
 
   static void UnloadComponents( void );
 
+  /** Creates new image objects that share the pixel buffers of the images
+   * in the container. The copies have no source, so that registrations that
+   * run concurrently may share the pixel data of images that have been read
+   * only once, without touching each others image meta data (for example
+   * the requested region) or the pipeline of the original images.
+   */
+  static DataObjectContainerPointer CreateShallowCopy( DataObjectContainerType * container );
+
 protected:
 
   ElastixMain();
@@ -328,6 +397,9 @@ protected:
   DataObjectContainerPointer m_ResultImageContainer;
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
 
+  /** The cache of the fixed image pyramids. */
+  ImagePyramidCacheType::Pointer m_ImagePyramidCache;
+
   /** A transform that is the result of registration. */
   ObjectPointer m_FinalTransform;
 
@@ -342,6 +414,15 @@ protected:
 
   static ComponentDatabasePointer s_CDB;
   static ComponentLoaderPointer   s_ComponentLoader;
+
+  /** The component database that is used by this instance. It refers to
+   * the shared database, which is obtained once by LoadComponents().
+   */
+  ComponentDatabasePointer m_ComponentDatabase;
+
+  /** Load the components into the shared component database, if that has not
+   * been done yet, and let m_ComponentDatabase refer to it.
+   */
   virtual int LoadComponents( void );
 
   /** InitDBIndex sets m_DBIndex by asking the ImageTypes
@@ -42,6 +42,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <memory>
 
 /**
  * Macro that defines to functions. In the case of
@@ -106,6 +107,34 @@ namespace elastix
  *  image, which relates voxel coordinates to world coordinates. Ignoring it
  *  may easily lead to left/right swaps for example, which could skrew up a
  *  (medical) analysis.
+ * \parameter TimeBudget: The wall-clock time in seconds that is available for the
+ *    registration, from the start of the registration until the end of the last
+ *    resolution. The remaining time is divided equally over the remaining resolutions.
+ *    During each resolution the maximum number of iterations is lowered when the
+ *    measured time per iteration shows that it does not fit in the time of the
+ *    resolution, so that the registration ends in time with a valid transform.
+ *    When much fewer iterations fit than requested, the number of samples of the
+ *    metrics is lowered once as well, if new samples are selected every iteration.
+ *    Only optimizers that support changing the maximum number of iterations are
+ *    stopped early; for other optimizers the time spent is only reported.\n
+ *    example: <tt>(TimeBudget 60.0)</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: 0, which means no time budget.
+ * \parameter TimeBudgetMinimumSampleFraction: The fraction of the number of
+ *    samples below which the time budget does not lower the number of samples.
+ *    Set it to 1 to never change the number of samples.\n
+ *    example: <tt>(TimeBudgetMinimumSampleFraction 0.5)</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: 0.25.
+ * \parameter WriteCheckpoints: Controls whether to save a checkpoint after
+ *    each resolution, to the file Checkpoint.<ElastixLevel>.txt in the output
+ *    directory. An interrupted registration can be resumed from it with the
+ *    command line argument "-resume". The random generator is then reseeded at
+ *    the start of each resolution, so that a resumed registration gives the same
+ *    result as an uninterrupted one.\n
+ *    example: <tt>(WriteCheckpoints "true")</tt>\n
+ *    This parameter can not be specified for each resolution separately.
+ *    Default value: "false".
  *
  * \ingroup Kernel
  */
@@ -296,6 +325,9 @@ public:
 
   int ApplyTransform( void ) override;
 
+  /** Reads only the fixed images and masks. */
+  int ReadFixedImages( void ) override;
+
   /** The Callback functions. */
   int BeforeAll( void ) override;
 
@@ -365,6 +397,52 @@ protected:
   /** Count the number of iterations. */
   unsigned int m_IterationCounter;
 
+  /** Variables of the time budget, see UpdateTimeBudget(). All times are in
+   * seconds since the start of the registration.
+   */
+  double        m_TimeBudget;
+  double        m_TimeBudgetMinimumSampleFraction;
+  TimerType     m_TimeBudgetTimer;
+  double        m_TimeBudgetResolutionStart;
+  double        m_TimeBudgetResolutionTime;
+  double        m_TimeBudgetIterationStart;
+  unsigned long m_TimeBudgetIterationStartCount;
+  unsigned long m_TimeBudgetMaximumNumberOfIterations;
+  bool          m_TimeBudgetSamplesAdapted;
+  bool          m_TimeBudgetExhausted;
+
+  /** Get the time elapsed since the start of the registration. */
+  virtual double GetTimeBudgetElapsedTime( void );
+
+  /** Adapt the maximum number of iterations, and possibly the number of
+   * samples, of the current resolution to the remaining time. Called after
+   * each iteration when a TimeBudget is set.
+   */
+  virtual void UpdateTimeBudget( void );
+
+  /** Variables of the checkpoints, see WriteCheckpoint() and ReadCheckpoint().
+   * The random seed is needed to reseed the random generator at the start
+   * of each resolution, so that a resumed registration draws the same
+   * random numbers as an uninterrupted one.
+   */
+  bool         m_WriteCheckpoints;
+  std::string  m_ResumeDirectory;
+  unsigned int m_RandomSeed;
+
+  /** Get the name of the checkpoint file of this elastix level in a directory. */
+  virtual std::string GetCheckpointFileName( const std::string & directory ) const;
+
+  /** Write the transform parameters at the end of the current resolution
+   * to the checkpoint file in the output directory. Called after each
+   * resolution when WriteCheckpoints is true.
+   */
+  virtual void WriteCheckpoint( void );
+
+  /** Read the checkpoint file in the "-resume" directory, and let the
+   * registration skip the resolutions that it has completed.
+   */
+  virtual void ReadCheckpoint( void );
+
   /** CreateTransformParameterFile. */
   virtual void CreateTransformParameterFile( const std::string FileName,
     const bool ToLog );
@@ -383,6 +461,12 @@ protected:
 
   std::ofstream m_IterationInfoFile;
 
+  /** Writes to m_IterationInfoFile in a background thread, so that the
+   * iteration info does not slow down the optimization. Declared after
+   * m_IterationInfoFile, so that it is destructed, and flushed, before it.
+   */
+  std::unique_ptr< xl::asyncostream > m_AsyncIterationInfoFile;
+
   /** Used by the callback functions, BeforeEachResolution() etc.).
    * This method calls a function in each component, in the following order:
    * \li Registration
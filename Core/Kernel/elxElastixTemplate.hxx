@@ -20,6 +20,12 @@
 
 #include "elxElastixTemplate.h"
 
+#include <itksys/SystemTools.hxx>
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
 #define elxCheckAndSetComponentMacro( _name ) \
   _name##BaseType * base = this->GetElx##_name##Base( i ); \
   if( base != 0 ) \
@@ -60,6 +66,22 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Initialize the this->m_IterationCounter. */
   this->m_IterationCounter = 0;
 
+  /** Initialize the time budget. */
+  this->m_TimeBudget                          = 0.0;
+  this->m_TimeBudgetMinimumSampleFraction     = 0.25;
+  this->m_TimeBudgetResolutionStart           = 0.0;
+  this->m_TimeBudgetResolutionTime            = 0.0;
+  this->m_TimeBudgetIterationStart            = 0.0;
+  this->m_TimeBudgetIterationStartCount       = 0;
+  this->m_TimeBudgetMaximumNumberOfIterations = 0;
+  this->m_TimeBudgetSamplesAdapted            = false;
+  this->m_TimeBudgetExhausted                 = false;
+
+  /** Initialize the checkpoint variables. */
+  this->m_WriteCheckpoints = false;
+  this->m_ResumeDirectory  = "";
+  this->m_RandomSeed       = 121212;
+
   /** Initialize CurrentTransformParameterFileName. */
   this->m_CurrentTransformParameterFileName = "";
   this->m_TransformParametersMap.clear();
@@ -361,6 +383,50 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end Run()
 
 
+/**
+ * ************************ ReadFixedImages *********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+int
+ElastixTemplate< TFixedImage, TMovingImage >
+::ReadFixedImages( void )
+{
+  /** Get the file names. The fixed image is obliged, the mask is not. */
+  int errorCode     = 0;
+  int maskErrorCode = 0;
+  this->SetFixedImageFileNameContainer(
+    this->GenerateFileNameContainer( "-f", errorCode, true, false ) );
+  this->SetFixedMaskFileNameContainer(
+    this->GenerateFileNameContainer( "-fMask", maskErrorCode, false, false ) );
+  if( errorCode != 0 )
+  {
+    return errorCode;
+  }
+
+  /** Read the UseDirectionCosines parameter silently; BeforeAllBase()
+   * warns about it when the registrations run.
+   */
+  this->GetConfiguration()->ReadParameter( this->m_UseDirectionCosines,
+    "UseDirectionCosines", 0, false );
+
+  /** Read the fixed images and masks. */
+  FixedImageDirectionType fixDirCos;
+  this->SetFixedImageContainer(
+    FixedImageLoaderType::GenerateImageContainer(
+    this->GetFixedImageFileNameContainer(), "Fixed Image",
+    this->GetUseDirectionCosines(), &fixDirCos ) );
+  this->SetOriginalFixedImageDirection( fixDirCos );
+  this->SetFixedMaskContainer(
+    FixedMaskLoaderType::GenerateImageContainer(
+    this->GetFixedMaskFileNameContainer(), "Fixed Mask",
+    this->GetUseDirectionCosines() ) );
+
+  return 0;
+
+} // end ReadFixedImages()
+
+
 /**
  * ************************ ApplyTransform **********************
  */
@@ -410,11 +476,38 @@ ElastixTemplate< TFixedImage, TMovingImage >
 
   } // end if inputImageFileName
 
+  /** Each input image is interpolated by its own resample interpolator:
+   * input image i by entry i of ResampleInterpolator. The input images
+   * without an entry get an interpolator of the same type as the last entry.
+   */
+  const unsigned int numberOfResampleInterpolators = this->GetNumberOfResampleInterpolators();
+  if( this->GetNumberOfMovingImages() > numberOfResampleInterpolators )
+  {
+    std::string resampleInterpolatorName = "FinalBSplineInterpolator";
+    this->GetConfiguration()->ReadParameter( resampleInterpolatorName,
+      "ResampleInterpolator", numberOfResampleInterpolators - 1, false );
+    const ComponentDatabase::PtrToCreator creator = this->GetComponentDatabase()
+      ->GetCreator( resampleInterpolatorName, this->GetDBIndex() );
+    if( creator == 0 )
+    {
+      itkExceptionMacro( << "ERROR: cannot create ResampleInterpolator \""
+                         << resampleInterpolatorName << "\"." );
+    }
+    for( unsigned int i = numberOfResampleInterpolators; i < this->GetNumberOfMovingImages(); ++i )
+    {
+      this->GetResampleInterpolatorContainer()->CreateElementAt( i ) = creator();
+    }
+    this->ConfigureComponents( this );
+  }
+
   /** Call all the ReadFromFile() functions. */
   timer.Reset();
   timer.Start();
   elxout << "Calling all ReadFromFile()'s ..." << std::endl;
-  this->GetElxResampleInterpolatorBase()->ReadFromFile();
+  for( unsigned int i = 0; i < this->GetNumberOfResampleInterpolators(); ++i )
+  {
+    this->GetElxResampleInterpolatorBase( i )->ReadFromFile();
+  }
   this->GetElxResamplerBase()->ReadFromFile();
   this->GetElxTransformBase()->ReadFromFile();
 
@@ -484,29 +577,64 @@ ElastixTemplate< TFixedImage, TMovingImage >
   elxout << "  Computing spatial Jacobian done, it took "
          << this->ConvertSecondsToDHMS( timer.GetMean(), 2 ) << std::endl;
 
+  /** Call ComputeInverseDeformationField. */
+  timer.Reset();
+  timer.Start();
+  elxout << "Compute inverse deformation field ..." << std::endl;
+  try
+  {
+    this->GetElxTransformBase()->ComputeInverseDeformationField();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    xout[ "error" ] << excp << std::endl;
+    xout[ "error" ] << "However, transformix continues anyway." << std::endl;
+  }
+  timer.Stop();
+  elxout << "  Computing inverse deformation field done, it took "
+         << this->ConvertSecondsToDHMS( timer.GetMean(), 2 ) << std::endl;
+
   /** Resample the image. */
   if( this->GetMovingImage() != 0 )
   {
     timer.Reset();
     timer.Start();
-    elxout << "Resampling image and writing to disk ..." << std::endl;
+    const unsigned int numberOfInputImages = this->GetNumberOfMovingImages();
+    if( numberOfInputImages > 1 )
+    {
+      elxout << "Resampling " << numberOfInputImages
+             << " images and writing to disk ..." << std::endl;
+    }
+    else
+    {
+      elxout << "Resampling image and writing to disk ..." << std::endl;
+    }
 
-    /** Create a name for the final result. */
+    /** Create a name for the final result. With more than one input
+     * image, result image i is called result.i.<format>.
+     */
     std::string resultImageFormat = "mhd";
     this->GetConfiguration()->ReadParameter( resultImageFormat,
       "ResultImageFormat", 0, false );
-    std::ostringstream makeFileName( "" );
-    makeFileName << this->GetConfiguration()->GetCommandLineArgument( "-out" )
-                 << "result." << resultImageFormat;
+    std::vector< std::string > resultImageFileNames;
+    for( unsigned int i = 0; i < numberOfInputImages; ++i )
+    {
+      std::ostringstream makeFileName( "" );
+      makeFileName << this->GetConfiguration()->GetCommandLineArgument( "-out" )
+                   << "result.";
+      if( numberOfInputImages > 1 ) { makeFileName << i << "."; }
+      makeFileName << resultImageFormat;
+      resultImageFileNames.push_back( makeFileName.str() );
+    }
 
-    /** Write the resampled image to disk.
+    /** Resample all input images in a single pass, and write them to disk.
      * Actually we could loop over all resamplers.
      * But for now, there seems to be no use yet for that.
      */
 #ifndef _ELASTIX_BUILD_LIBRARY
-    this->GetElxResamplerBase()->ResampleAndWriteResultImage( makeFileName.str().c_str() );
+    this->GetElxResamplerBase()->ResampleAndWriteResultImages( resultImageFileNames );
 #else
-    this->GetElxResamplerBase()->CreateItkResultImage();
+    this->GetElxResamplerBase()->CreateItkResultImages();
 #endif
 
     /** Print the elapsed time for the resampling. */
@@ -597,11 +725,40 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_Timer0.Reset();
   this->m_Timer0.Start();
 
+  /** Start the clock of the time budget. */
+  this->m_TimeBudget = 0.0;
+  this->GetConfiguration()->ReadParameter( this->m_TimeBudget,
+    "TimeBudget", 0, false );
+  this->m_TimeBudgetMinimumSampleFraction = 0.25;
+  this->GetConfiguration()->ReadParameter( this->m_TimeBudgetMinimumSampleFraction,
+    "TimeBudgetMinimumSampleFraction", 0, false );
+  this->m_TimeBudgetTimer.Reset();
+  this->m_TimeBudgetTimer.Start();
+  if( this->m_TimeBudget > 0.0 )
+  {
+    elxout << "Time budget for the registration: "
+           << this->m_TimeBudget << " s.\n";
+  }
+
   /** Call all the BeforeRegistration() functions. */
   this->BeforeRegistrationBase();
   CallInEachComponent( &BaseComponentType::BeforeRegistrationBase );
   CallInEachComponent( &BaseComponentType::BeforeRegistration );
 
+  /** Read the checkpoint settings, and resume from a checkpoint if "-resume" was given. */
+  this->m_WriteCheckpoints = false;
+  this->GetConfiguration()->ReadParameter( this->m_WriteCheckpoints,
+    "WriteCheckpoints", 0, false );
+  this->m_RandomSeed = 121212;
+  this->GetConfiguration()->ReadParameter( this->m_RandomSeed,
+    "RandomSeed", 0, false );
+  this->m_ResumeDirectory = this->GetConfiguration()->GetCommandLineArgument( "-resume" );
+  this->GetElxRegistrationBase()->GetAsITKBaseType()->SetResumeLevel( 0 );
+  if( !this->m_ResumeDirectory.empty() )
+  {
+    this->ReadCheckpoint();
+  }
+
   /** Add a column to iteration with the iteration number. */
   xout[ "iteration" ].AddTargetCell( "1:ItNr" );
 
@@ -653,11 +810,42 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Print the current resolution. */
   elxout << "\nResolution: " << level << std::endl;
 
+  /** Check whether this resolution was completed before, when resuming. */
+  const unsigned long numberOfLevels
+    = this->GetElxRegistrationBase()->GetAsITKBaseType()->GetNumberOfLevels();
+  const bool skipResolution
+    = level < this->GetElxRegistrationBase()->GetAsITKBaseType()->GetResumeLevel();
+  if( skipResolution )
+  {
+    elxout << "This resolution was completed before, so it is skipped." << std::endl;
+  }
+
+  /** Reseed the random generator, so that the random numbers of a
+   * resolution do not depend on whether the previous ones were skipped.
+   */
+  if( this->m_WriteCheckpoints || !this->m_ResumeDirectory.empty() )
+  {
+    typedef RandomGeneratorType::IntegerType SeedType;
+    this->GetRandomGenerator()->SetSeed( static_cast< SeedType >( this->m_RandomSeed + level ) );
+  }
+
+  /** Divide the remaining time equally over the remaining resolutions. */
+  if( this->m_TimeBudget > 0.0 )
+  {
+    this->m_TimeBudgetResolutionStart = this->GetTimeBudgetElapsedTime();
+    this->m_TimeBudgetResolutionTime  = std::max( 0.0,
+      this->m_TimeBudget - this->m_TimeBudgetResolutionStart )
+      / static_cast< double >( std::max( numberOfLevels - level, 1ul ) );
+    elxout << "Time budget for this resolution: " << std::setprecision( 3 )
+           << this->m_TimeBudgetResolutionTime << " s.\n"
+           << std::setprecision( this->GetDefaultOutputPrecision() );
+  }
+
   /** Create a TransformParameter-file for the current resolution. */
   bool writeIterationInfo = true;
   this->GetConfiguration()->ReadParameter( writeIterationInfo,
     "WriteIterationInfo", 0, false );
-  if( writeIterationInfo )
+  if( writeIterationInfo && !skipResolution )
   {
     this->OpenIterationInfoFile();
   }
@@ -667,6 +855,41 @@ ElastixTemplate< TFixedImage, TMovingImage >
   CallInEachComponent( &BaseComponentType::BeforeEachResolutionBase );
   CallInEachComponent( &BaseComponentType::BeforeEachResolution );
 
+  /** If all resolutions are skipped, the optimizer is never started, while
+   * the final results are taken from its current position.
+   */
+  if( skipResolution && level + 1 == numberOfLevels )
+  {
+    try
+    {
+      this->GetElxOptimizerBase()->SetCurrentPositionPublic(
+        this->GetElxRegistrationBase()->GetAsITKBaseType()->GetResumeTransformParameters() );
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::string err_str = excp.GetDescription();
+      err_str += "\nAll resolutions were completed before, but the optimizer "
+        "cannot be set to their final parameters.";
+      excp.SetDescription( err_str );
+      throw excp;
+    }
+  }
+
+  /** Get the maximum number of iterations, to be lowered by the time budget. */
+  if( this->m_TimeBudget > 0.0 )
+  {
+    this->m_TimeBudgetMaximumNumberOfIterations
+      = this->GetElxOptimizerBase()->GetMaximumNumberOfIterationsPublic();
+    this->m_TimeBudgetIterationStartCount = 0;
+    this->m_TimeBudgetSamplesAdapted      = false;
+    this->m_TimeBudgetExhausted           = false;
+    if( this->m_TimeBudgetMaximumNumberOfIterations == 0 )
+    {
+      xl::xout[ "warning" ] << "WARNING: The optimizer does not support the TimeBudget. "
+                            << "The time spent is only reported." << std::endl;
+    }
+  }
+
   /** Print the extra preparation time needed for this resolution. */
   this->m_Timer0.Stop();
   elxout << "Elastix initialization of all components (for this resolution) took: "
@@ -707,6 +930,15 @@ ElastixTemplate< TFixedImage, TMovingImage >
     << " (ITK initialization and iterating): "
     << this->m_ResolutionTimer.GetMean()
     << " s.\n";
+  if( this->m_TimeBudget > 0.0 )
+  {
+    const double elapsed = this->GetTimeBudgetElapsedTime();
+    elxout
+      << "Time budget of resolution " << level << ": spent "
+      << elapsed - this->m_TimeBudgetResolutionStart << " s of "
+      << this->m_TimeBudgetResolutionTime << " s; spent "
+      << elapsed << " s of " << this->m_TimeBudget << " s in total.\n";
+  }
   elxout << std::setprecision( this->GetDefaultOutputPrecision() );
 
   /** Call all the AfterEachResolution() functions. */
@@ -714,6 +946,12 @@ ElastixTemplate< TFixedImage, TMovingImage >
   CallInEachComponent( &BaseComponentType::AfterEachResolutionBase );
   CallInEachComponent( &BaseComponentType::AfterEachResolution );
 
+  /** Save the state of the registration, to be able to resume from here. */
+  if( this->m_WriteCheckpoints )
+  {
+    this->WriteCheckpoint();
+  }
+
   /** Create a TransformParameter-file for the current resolution. */
   bool writeTransformParameterEachResolution = false;
   this->GetConfiguration()->ReadParameter( writeTransformParameterEachResolution,
@@ -773,6 +1011,12 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Write the iteration info of this iteration. */
   xout[ "iteration" ].WriteBufferedData();
 
+  /** Stop the resolution in time. */
+  if( this->m_TimeBudget > 0.0 && this->m_TimeBudgetMaximumNumberOfIterations > 0 )
+  {
+    this->UpdateTimeBudget();
+  }
+
   /** Create a TransformParameter-file for the current iteration. */
   bool writeTansformParametersThisIteration = false;
   this->GetConfiguration()->ReadParameter( writeTansformParametersThisIteration,
@@ -825,6 +1069,126 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end AfterEachIteration()
 
 
+/**
+ * ************** GetTimeBudgetElapsedTime *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+double
+ElastixTemplate< TFixedImage, TMovingImage >
+::GetTimeBudgetElapsedTime( void )
+{
+  /** The timer only accumulates when it is stopped. */
+  this->m_TimeBudgetTimer.Stop();
+  const double elapsed = this->m_TimeBudgetTimer.GetTotal();
+  this->m_TimeBudgetTimer.Start();
+  return elapsed;
+
+} // end GetTimeBudgetElapsedTime()
+
+
+/**
+ * ************** UpdateTimeBudget *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::UpdateTimeBudget( void )
+{
+  if( this->m_TimeBudgetExhausted )
+  {
+    return;
+  }
+
+  const unsigned long numberOfIterations = this->m_IterationCounter + 1;
+  const double        now                = this->GetTimeBudgetElapsedTime();
+  const double        remainingTime      = this->m_TimeBudgetResolutionStart
+    + this->m_TimeBudgetResolutionTime - now;
+
+  /** Stop after this iteration when the time of this resolution is up. */
+  if( remainingTime <= 0.0 )
+  {
+    this->GetElxOptimizerBase()->SetMaximumNumberOfIterationsPublic( numberOfIterations );
+    this->m_TimeBudgetExhausted = true;
+    elxout << "The time budget of this resolution is exhausted after "
+           << numberOfIterations << " iterations." << std::endl;
+    return;
+  }
+
+  /** The first iteration often includes extra work, such as the automatic
+   * parameter estimation, so the time per iteration is measured after it.
+   */
+  if( this->m_TimeBudgetIterationStartCount == 0 )
+  {
+    this->m_TimeBudgetIterationStart      = now;
+    this->m_TimeBudgetIterationStartCount = numberOfIterations;
+    return;
+  }
+  const unsigned long measuredIterations
+    = numberOfIterations - this->m_TimeBudgetIterationStartCount;
+  if( measuredIterations == 0 )
+  {
+    return;
+  }
+  const double timePerIteration
+    = ( now - this->m_TimeBudgetIterationStart ) / static_cast< double >( measuredIterations );
+  const unsigned long affordableIterations = numberOfIterations + static_cast< unsigned long >(
+    remainingTime / std::max( timePerIteration, 1e-9 ) );
+  const unsigned long maximumNumberOfIterations = this->m_TimeBudgetMaximumNumberOfIterations;
+
+  /** When far fewer iterations fit than requested, lower the number of samples
+   * once, after 10 measured iterations. The iteration time is roughly
+   * proportional to the number of samples, but only when new samples are
+   * selected every iteration.
+   */
+  if( !this->m_TimeBudgetSamplesAdapted && measuredIterations >= 10
+    && affordableIterations < maximumNumberOfIterations
+    && numberOfIterations < maximumNumberOfIterations )
+  {
+    this->m_TimeBudgetSamplesAdapted = true;
+
+    const unsigned int level = static_cast< unsigned int >(
+      this->GetElxRegistrationBase()->GetAsITKBaseType()->GetCurrentLevel() );
+    bool newSamplesEveryIteration = false;
+    this->GetConfiguration()->ReadParameter( newSamplesEveryIteration,
+      "NewSamplesEveryIteration", this->GetElxOptimizerBase()->GetComponentLabel(),
+      level, 0, false );
+    const double fraction = std::max( this->m_TimeBudgetMinimumSampleFraction,
+      static_cast< double >( affordableIterations - numberOfIterations )
+      / static_cast< double >( maximumNumberOfIterations - numberOfIterations ) );
+    if( newSamplesEveryIteration && fraction < 1.0 )
+    {
+      for( unsigned int i = 0; i < this->GetNumberOfMetrics(); ++i )
+      {
+        typename MetricBaseType::ImageSamplerBaseType * sampler
+          = this->GetElxMetricBase( i )->GetAdvancedMetricImageSampler();
+        if( sampler == 0 )
+        {
+          continue;
+        }
+        const unsigned long numberOfSamples = sampler->GetNumberOfSamples();
+        sampler->SetNumberOfSamples( std::max( 1ul, static_cast< unsigned long >(
+          fraction * static_cast< double >( numberOfSamples ) ) ) );
+        elxout << "The time budget lowered the number of samples of metric " << i
+               << " from " << numberOfSamples << " to "
+               << sampler->GetNumberOfSamples() << "." << std::endl;
+      }
+
+      /** Measure the time per iteration again. */
+      this->m_TimeBudgetIterationStart      = now;
+      this->m_TimeBudgetIterationStartCount = numberOfIterations;
+      return;
+    }
+  }
+
+  /** Lower the maximum number of iterations to the number that fits. */
+  this->GetElxOptimizerBase()->SetMaximumNumberOfIterationsPublic(
+    std::max( numberOfIterations, std::min( maximumNumberOfIterations, affordableIterations ) ) );
+
+} // end UpdateTimeBudget()
+
+
 /**
  * ************** AfterRegistration *******************
  */
@@ -1174,6 +1538,169 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end ConfigureComponents()
 
 
+/**
+ * ************** GetCheckpointFileName *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+std::string
+ElastixTemplate< TFixedImage, TMovingImage >
+::GetCheckpointFileName( const std::string & directory ) const
+{
+  std::ostringstream makeFileName( "" );
+  makeFileName << directory;
+  if( !directory.empty()
+    && directory[ directory.size() - 1 ] != '/' && directory[ directory.size() - 1 ] != '\\' )
+  {
+    makeFileName << '/';
+  }
+  makeFileName << "Checkpoint." << this->m_Configuration->GetElastixLevel() << ".txt";
+  return makeFileName.str();
+
+} // end GetCheckpointFileName()
+
+
+/**
+ * ************** WriteCheckpoint *******************************
+ *
+ * Writes the transform parameters at the end of the current resolution,
+ * in the syntax of a parameter file. The parameters are written with
+ * full precision, so that a resumed registration continues exactly
+ * where the interrupted one stopped. The optimizers start each resolution
+ * anew, e.g. their step sizes, LBFGS memory and preconditioners, so at
+ * this point the transform parameters are all there is to save. The file
+ * is first written under a temporary name, so that an interruption while
+ * writing leaves the previous checkpoint intact.
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::WriteCheckpoint( void )
+{
+  const std::string fileName
+    = this->GetCheckpointFileName( this->m_Configuration->GetCommandLineArgument( "-out" ) );
+  const std::string temporaryFileName = fileName + ".tmp";
+
+  typedef typename RegistrationBaseType::ITKBaseType::ParametersType ParametersType;
+  const ParametersType & parameters
+    = this->GetElxOptimizerBase()->GetAsITKBaseType()->GetCurrentPosition();
+
+  std::ofstream checkpointFile( temporaryFileName.c_str() );
+  if( !checkpointFile.is_open() )
+  {
+    xout[ "error" ] << "ERROR: File \"" << temporaryFileName << "\" could not be opened!" << std::endl;
+    return;
+  }
+
+  checkpointFile << "// elastix checkpoint, to be used with -resume.\n"
+                 << "(CheckpointResolution "
+                 << this->GetElxRegistrationBase()->GetAsITKBaseType()->GetCurrentLevel() << ")\n"
+                 << "(NumberOfResolutions "
+                 << this->GetElxRegistrationBase()->GetAsITKBaseType()->GetNumberOfLevels() << ")\n"
+                 << "(Transform \"" << this->GetElxTransformBase()->elxGetClassName() << "\")\n"
+                 << "(NumberOfParameters " << parameters.GetSize() << ")\n"
+                 << "(TransformParameters";
+  checkpointFile << std::setprecision( std::numeric_limits< double >::max_digits10 );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    checkpointFile << ' ' << parameters[ i ];
+  }
+  checkpointFile << ")" << std::endl;
+  checkpointFile.close();
+
+  if( checkpointFile.fail() )
+  {
+    xout[ "error" ] << "ERROR: File \"" << temporaryFileName << "\" could not be written!" << std::endl;
+    return;
+  }
+
+  /** std::rename does not replace an existing file on all platforms. */
+  if( std::rename( temporaryFileName.c_str(), fileName.c_str() ) != 0 )
+  {
+    std::remove( fileName.c_str() );
+    if( std::rename( temporaryFileName.c_str(), fileName.c_str() ) != 0 )
+    {
+      xout[ "error" ] << "ERROR: File \"" << fileName << "\" could not be written!" << std::endl;
+    }
+  }
+
+} // end WriteCheckpoint()
+
+
+/**
+ * ************** ReadCheckpoint ********************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::ReadCheckpoint( void )
+{
+  typedef typename RegistrationBaseType::ITKBaseType::ParametersType ParametersType;
+
+  const std::string fileName = this->GetCheckpointFileName( this->m_ResumeDirectory );
+  if( !itksys::SystemTools::FileExists( fileName.c_str(), true ) )
+  {
+    elxout << "No checkpoint \"" << fileName
+           << "\" found, so the registration starts at the first resolution." << std::endl;
+    return;
+  }
+
+  itk::ParameterFileParser::Pointer parser = itk::ParameterFileParser::New();
+  parser->SetParameterFileName( fileName );
+  parser->ReadParameterFile();
+  const itk::ParameterFileParser::ParameterMapType & checkpoint = parser->GetParameterMap();
+
+  /** Returns the values of a parameter, or throws if it is missing. */
+  const auto getValues = [ &checkpoint, &fileName, this ]( const std::string & name )
+    -> const std::vector< std::string > &
+    {
+      const auto found = checkpoint.find( name );
+      if( found == checkpoint.end() || found->second.empty() )
+      {
+        itkExceptionMacro( << "ERROR: the checkpoint \"" << fileName << "\" has no " << name << "." );
+      }
+      return found->second;
+    };
+
+  const unsigned long checkpointResolution
+    = std::strtoul( getValues( "CheckpointResolution" )[ 0 ].c_str(), nullptr, 10 );
+  const unsigned long numberOfResolutions
+    = std::strtoul( getValues( "NumberOfResolutions" )[ 0 ].c_str(), nullptr, 10 );
+  const std::string & transformName = getValues( "Transform" )[ 0 ];
+  const std::vector< std::string > & parameterValues = getValues( "TransformParameters" );
+
+  /** Check that the checkpoint belongs to this registration. */
+  RegistrationBaseType * registration = this->GetElxRegistrationBase();
+  if( numberOfResolutions != registration->GetAsITKBaseType()->GetNumberOfLevels()
+    || checkpointResolution >= numberOfResolutions )
+  {
+    itkExceptionMacro( << "ERROR: the checkpoint \"" << fileName << "\" was written by a registration with "
+                       << numberOfResolutions << " resolutions, instead of "
+                       << registration->GetAsITKBaseType()->GetNumberOfLevels() << "." );
+  }
+  if( transformName != this->GetElxTransformBase()->elxGetClassName() )
+  {
+    itkExceptionMacro( << "ERROR: the checkpoint \"" << fileName << "\" was written by a registration with the "
+                       << transformName << ", instead of the " << this->GetElxTransformBase()->elxGetClassName() << "." );
+  }
+
+  ParametersType parameters( static_cast< unsigned int >( parameterValues.size() ) );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = std::strtod( parameterValues[ i ].c_str(), nullptr );
+  }
+
+  registration->GetAsITKBaseType()->SetResumeTransformParameters( parameters );
+  registration->GetAsITKBaseType()->SetResumeLevel( checkpointResolution + 1 );
+
+  elxout << "Resuming from checkpoint \"" << fileName << "\": resolution "
+         << checkpointResolution << " and before were completed." << std::endl;
+
+} // end ReadCheckpoint()
+
+
 /**
  * ************** OpenIterationInfoFile *************************
  *
@@ -1191,6 +1718,8 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Remove the current iteration info output file, if any. */
   xout[ "iteration" ].RemoveOutput( "IterationInfoFile" );
 
+  /** Write the remaining iteration info, before closing the file. */
+  this->m_AsyncIterationInfoFile.reset();
   if( this->m_IterationInfoFile.is_open() )
   {
     this->m_IterationInfoFile.close();
@@ -1214,7 +1743,8 @@ ElastixTemplate< TFixedImage, TMovingImage >
   else
   {
     /** Add this file to the list of outputs of xout["iteration"]. */
-    xout[ "iteration" ].AddOutput( "IterationInfoFile", &( this->m_IterationInfoFile ) );
+    this->m_AsyncIterationInfoFile.reset( new asyncostream( this->m_IterationInfoFile ) );
+    xout[ "iteration" ].AddOutput( "IterationInfoFile", this->m_AsyncIterationInfoFile.get() );
   }
 
 } // end OpenIterationInfoFile()
@@ -27,6 +27,7 @@
 #include "elxTransformixMain.h"
 
 #include "elxMacro.h"
+#include "itkTimeProbe.h"
 
 #ifdef ELASTIX_USE_OPENCL
 #include "itkOpenCLSetup.h"
@@ -45,6 +46,12 @@ namespace elastix
 int
 TransformixMain::Run( void )
 {
+  /** Measure the startup time: reading the image information, loading the
+   * component database and creating the components.
+   */
+  itk::TimeProbe startupTimer;
+  startupTimer.Start();
+
   /** Set process properties. */
   this->SetProcessPriority();
   this->SetMaximumNumberOfThreads();
@@ -104,7 +111,7 @@ TransformixMain::Run( void )
 
   /** Set some information in the ElastixBase. */
   this->GetElastixBase()->SetConfiguration( this->m_Configuration );
-  this->GetElastixBase()->SetComponentDatabase( this->s_CDB );
+  this->GetElastixBase()->SetComponentDatabase( this->m_ComponentDatabase );
   this->GetElastixBase()->SetDBIndex( this->m_DBIndex );
 
   /** Populate the component containers. No default is specified for the Transform. */
@@ -137,6 +144,13 @@ TransformixMain::Run( void )
   */
   this->GetElastixBase()->SetInitialTransform( this->GetModifiableInitialTransform() );
 
+  /** Set the points to transform, if given in memory. */
+  this->GetElastixBase()->SetInputPointSet( this->m_InputPointSet );
+
+  startupTimer.Stop();
+  elxout << "Starting transformix took " << static_cast< unsigned long >(
+    startupTimer.GetMean() * 1000 ) << " ms." << std::endl;
+
   /** ApplyTransform! */
   try
   {
@@ -159,6 +173,7 @@ TransformixMain::Run( void )
     this->GetElastixBase()->GetResultImageContainer() );
   this->SetResultDeformationFieldContainer(
     this->GetElastixBase()->GetResultDeformationFieldContainer() );
+  this->m_ResultPointSet = this->GetElastixBase()->GetResultPointSet();
 
   return errorCode;
 
@@ -286,7 +301,7 @@ TransformixMain::InitDBIndex( void )
     }
 
     /** Load the components. */
-    if( this->s_CDB.IsNull() )
+    if( this->m_ComponentDatabase.IsNull() )
     {
       int loadReturnCode = this->LoadComponents();
       if( loadReturnCode != 0 )
@@ -296,10 +311,10 @@ TransformixMain::InitDBIndex( void )
       }
     }
 
-    if( this->s_CDB.IsNotNull() )
+    if( this->m_ComponentDatabase.IsNotNull() )
     {
       /** Get the DBIndex from the ComponentDatabase. */
-      this->m_DBIndex = this->s_CDB->GetIndex(
+      this->m_DBIndex = this->m_ComponentDatabase->GetIndex(
         this->m_FixedImagePixelType,
         this->m_FixedImageDimension,
         this->m_MovingImagePixelType,
@@ -310,7 +325,7 @@ TransformixMain::InitDBIndex( void )
         xl::xout[ "error" ] << "Something went wrong in the ComponentDatabase." << std::endl;
         return 1;
       }
-    } //end if s_CDB!=0
+    } //end if m_ComponentDatabase!=0
 
   } // end if m_Configuration->Initialized();
   else
@@ -102,6 +102,14 @@ public:
   virtual void SetInputImageContainer(
     DataObjectContainerType * inputImageContainer );
 
+  /** Set the points to transform, as an alternative to "-def <file>",
+   * and get the transformed points after Run(). The points are an
+   * itk::PointSet in world coordinates, of type TransformBase::PointSetType.
+   */
+  itkSetObjectMacro( InputPointSet, DataObjectType );
+  itkGetModifiableObjectMacro( InputPointSet, DataObjectType );
+  itkGetModifiableObjectMacro( ResultPointSet, DataObjectType );
+
 protected:
 
   TransformixMain(){}
@@ -117,6 +125,9 @@ private:
   TransformixMain( const Self & ); // purposely not implemented
   void operator=( const Self & );  // purposely not implemented
 
+  DataObjectPointer m_InputPointSet;
+  DataObjectPointer m_ResultPointSet;
+
 };
 
 } // end namespace elastix
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header files to be tested:
+#include "elxElastixFilter.h"
+#include "elxElastixBatchFilter.h"
+#include "itkImagePyramidCache.h"
+
+#include "elxGTestUtilities.h"
+
+// ITK header files:
+#include <itkImage.h>
+
+// GoogleTest header file:
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+using namespace elastix::GTestUtilities;
+using ImageType = itk::Image<float, 2>;
+using ElastixFilterType = elastix::ElastixFilter<ImageType, ImageType>;
+using ElastixBatchFilterType = elastix::ElastixBatchFilter<ImageType, ImageType>;
+using ParameterObjectType = elastix::ParameterObject;
+
+// Creates the parameter object of a translation registration with a random sampler.
+ParameterObjectType::Pointer CreateParameterObject()
+{
+  ParameterObjectType::ParameterMapType parameterMap = CreateTranslationParameterMap();
+  parameterMap["ImageSampler"] = { "RandomCoordinate" };
+  parameterMap["NumberOfSpatialSamples"] = { "512" };
+  parameterMap["RandomSeed"] = { "121212" };
+  parameterMap["UseMultiThreadingForMetrics"] = { "false" };
+
+  const auto parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap(parameterMap);
+  return parameterObject;
+}
+
+
+// Registers the moving image to the fixed image, and returns the transform parameters.
+std::vector<std::string> Register(ImageType * fixedImage, ImageType * movingImage)
+{
+  const auto filter = ElastixFilterType::New();
+  filter->SetFixedImage(fixedImage);
+  filter->SetMovingImage(movingImage);
+  filter->SetParameterObject(CreateParameterObject());
+  filter->SetNumberOfThreads(1);
+  filter->LogToConsoleOff();
+  filter->Update();
+
+  return filter->GetTransformParameterObject()->GetParameterMap(0).at("TransformParameters");
+}
+
+} // namespace
+
+
+// Tests that registrations running concurrently in one process give the same
+// result as a registration that runs on its own. Each registration has its
+// own random generator, seeded by RandomSeed, so the results are identical.
+GTEST_TEST(ElastixFilter, ConcurrentRegistrationsGiveSameResult)
+{
+  const auto fixedImage = CreateBlobImage<float>(FixedBlobCenterX, FixedBlobCenterY);
+  const auto movingImage = CreateBlobImage<float>(MovingBlobCenterX, MovingBlobCenterY);
+
+  // The reference result, of a registration that runs on its own.
+  const std::vector<std::string> expectedParameters = Register(fixedImage, movingImage);
+  ExpectBlobTranslation(expectedParameters);
+
+  // Run a number of registrations concurrently, repeatedly.
+  constexpr unsigned int numberOfThreads = 4;
+  constexpr unsigned int numberOfRepetitions = 3;
+
+  for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+  {
+    std::vector<std::vector<std::string>> actualParameters(numberOfThreads);
+    std::vector<std::string> errors(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i] {
+        try
+        {
+          actualParameters[i] = Register(fixedImage, movingImage);
+        }
+        catch (const itk::ExceptionObject & excp)
+        {
+          errors[i] = excp.what();
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+      EXPECT_EQ(errors[i], "");
+      EXPECT_EQ(actualParameters[i], expectedParameters);
+    }
+  }
+}
+
+
+// Tests that a batch of registrations to one fixed image gives the same
+// results as registering each moving image on its own.
+GTEST_TEST(ElastixBatchFilter, BatchGivesSameResultsAsSeparateRegistrations)
+{
+  const auto fixedImage = CreateBlobImage<float>(FixedBlobCenterX, FixedBlobCenterY);
+  const std::vector<ImageType::Pointer> movingImages = {
+    CreateBlobImage<float>(MovingBlobCenterX, MovingBlobCenterY), CreateBlobImage<float>(13.0, 16.0),
+    CreateBlobImage<float>(16.0, 17.0), CreateBlobImage<float>(14.0, 13.0), CreateBlobImage<float>(15.0, 12.0)
+  };
+
+  const auto filter = ElastixBatchFilterType::New();
+  filter->SetFixedImage(fixedImage);
+  for (const auto & movingImage : movingImages)
+  {
+    filter->AddMovingImage(movingImage);
+  }
+  filter->SetParameterObject(CreateParameterObject());
+  filter->SetNumberOfThreads(1);
+  filter->SetNumberOfConcurrentRegistrations(3);
+  filter->LogToConsoleOff();
+  filter->Update();
+
+  for (unsigned int i = 0; i < movingImages.size(); ++i)
+  {
+    EXPECT_NE(filter->GetResultImage(i), nullptr);
+    EXPECT_EQ(filter->GetTransformParameterObject(i)->GetParameterMap(0).at("TransformParameters"),
+              Register(fixedImage, movingImages[i]));
+  }
+  EXPECT_EQ(filter->GetOutput()->GetBufferPointer(), filter->GetResultImage(0)->GetBufferPointer());
+}
+
+
+// Tests that registrations that share an image pyramid cache compute the
+// fixed image pyramid only once, and give the same results as without it.
+GTEST_TEST(ElastixFilter, SharedImagePyramidCacheHoldsOneFixedPyramid)
+{
+  const auto fixedImage = CreateBlobImage<float>(FixedBlobCenterX, FixedBlobCenterY);
+  const std::vector<ImageType::Pointer> movingImages = {
+    CreateBlobImage<float>(MovingBlobCenterX, MovingBlobCenterY), CreateBlobImage<float>(13.0, 16.0)
+  };
+  const auto pyramidCache = itk::ImagePyramidCache::New();
+
+  for (const auto & movingImage : movingImages)
+  {
+    const auto filter = ElastixFilterType::New();
+    filter->SetFixedImage(fixedImage);
+    filter->SetMovingImage(movingImage);
+    filter->SetParameterObject(CreateParameterObject());
+    filter->SetNumberOfThreads(1);
+    filter->SetImagePyramidCache(pyramidCache);
+    filter->LogToConsoleOff();
+    filter->Update();
+
+    EXPECT_EQ(pyramidCache->GetNumberOfEntries(), 1u);
+    EXPECT_EQ(filter->GetTransformParameterObject()->GetParameterMap(0).at("TransformParameters"),
+              Register(fixedImage, movingImage));
+  }
+}
@@ -0,0 +1,99 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "elxElastixFilter.h"
+
+#include "elxGTestUtilities.h"
+
+// ITK header files:
+#include <itkImage.h>
+
+// GoogleTest header file:
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+
+namespace
+{
+using namespace elastix::GTestUtilities;
+using ParameterObjectType = elastix::ParameterObject;
+
+// Registers the moving buffer to the fixed buffer, which are both wrapped
+// without copying, and returns the transform parameters.
+template <typename TPixel>
+std::vector<std::string> RegisterBuffers(const std::vector<TPixel> & fixedBuffer,
+                                         const std::vector<TPixel> & movingBuffer)
+{
+  using ImageType = itk::Image<TPixel, 2>;
+  using ElastixFilterType = elastix::ElastixFilter<ImageType, ImageType>;
+
+  const auto parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap(CreateTranslationParameterMap());
+
+  typename ImageType::DirectionType direction;
+  direction.SetIdentity();
+  const typename ImageType::SizeType size = { { BlobImageSize, BlobImageSize } };
+  const typename ImageType::SpacingType spacing(1.0);
+  const typename ImageType::PointType origin(0.0);
+
+  const auto filter = ElastixFilterType::New();
+  filter->SetFixedImageBuffer(fixedBuffer.data(), size, spacing, origin, direction);
+  filter->SetMovingImageBuffer(movingBuffer.data(), size, spacing, origin, direction);
+  filter->SetParameterObject(parameterObject);
+  filter->LogToConsoleOff();
+
+  // The images refer to the buffers of the caller.
+  EXPECT_EQ(filter->GetFixedImage()->GetBufferPointer(), fixedBuffer.data());
+  EXPECT_EQ(filter->GetMovingImage()->GetBufferPointer(), movingBuffer.data());
+
+  filter->Update();
+
+  return filter->GetTransformParameterObject()->GetParameterMap(0).at("TransformParameters");
+}
+
+} // namespace
+
+
+// Tests registering images from pixel buffers of the caller, of the internal
+// pixel type (float), so that elastix uses them without any copy.
+GTEST_TEST(ElastixFilter, RegisterFloatImageBuffers)
+{
+  const std::vector<float> fixedBuffer = CreateBlobBuffer<float>(FixedBlobCenterX, FixedBlobCenterY);
+  const std::vector<float> movingBuffer = CreateBlobBuffer<float>(MovingBlobCenterX, MovingBlobCenterY);
+
+  ExpectBlobTranslation(RegisterBuffers(fixedBuffer, movingBuffer));
+
+  // elastix does not write to the buffers.
+  EXPECT_EQ(fixedBuffer, CreateBlobBuffer<float>(FixedBlobCenterX, FixedBlobCenterY));
+  EXPECT_EQ(movingBuffer, CreateBlobBuffer<float>(MovingBlobCenterX, MovingBlobCenterY));
+}
+
+
+// Tests registering images of another pixel type than the internal pixel
+// type (float), which are cast to the internal pixel type.
+GTEST_TEST(ElastixFilter, RegisterShortImageBuffers)
+{
+  const std::vector<short> fixedBuffer = CreateBlobBuffer<short>(FixedBlobCenterX, FixedBlobCenterY);
+  const std::vector<short> movingBuffer = CreateBlobBuffer<short>(MovingBlobCenterX, MovingBlobCenterY);
+
+  ExpectBlobTranslation(RegisterBuffers(fixedBuffer, movingBuffer));
+}
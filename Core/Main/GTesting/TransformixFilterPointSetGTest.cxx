@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+ // First include the header file to be tested:
+#include "elxTransformixFilter.h"
+
+// ITK header files:
+#include <itkImage.h>
+
+// GoogleTest header file:
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+namespace
+{
+using ImageType = itk::Image<float, 2>;
+using TransformixFilterType = elastix::TransformixFilter<ImageType>;
+using ParameterObjectType = elastix::ParameterObject;
+using PointSetType = TransformixFilterType::PointSetType;
+
+// Creates the transform parameter map of a translation by (2, -1).
+ParameterObjectType::Pointer CreateTranslationParameterObject()
+{
+  const ParameterObjectType::ParameterMapType parameterMap = {
+    { "Direction", { "1", "0", "0", "1" } },
+    { "FixedImageDimension", { "2" } },
+    { "FixedInternalImagePixelType", { "float" } },
+    { "HowToCombineTransforms", { "Compose" } },
+    { "Index", { "0", "0" } },
+    { "InitialTransformParametersFileName", { "NoInitialTransform" } },
+    { "MovingImageDimension", { "2" } },
+    { "MovingInternalImagePixelType", { "float" } },
+    { "NumberOfParameters", { "2" } },
+    { "Origin", { "0", "0" } },
+    { "ResampleInterpolator", { "FinalLinearInterpolator" } },
+    { "Resampler", { "DefaultResampler" } },
+    { "Size", { "32", "32" } },
+    { "Spacing", { "1", "1" } },
+    { "Transform", { "TranslationTransform" } },
+    { "TransformParameters", { "2", "-1" } },
+    { "UseDirectionCosines", { "true" } },
+  };
+
+  const auto parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap(parameterMap);
+  return parameterObject;
+}
+
+} // namespace
+
+
+// Tests transforming a point set in memory. There are enough points to have
+// them transformed by several threads.
+GTEST_TEST(TransformixFilter, TransformFixedPointSetInMemory)
+{
+  constexpr unsigned int numberOfPoints = 10000;
+
+  const auto fixedPointSet = PointSetType::New();
+  for (unsigned int i = 0; i < numberOfPoints; ++i)
+  {
+    PointSetType::PointType point;
+    point[0] = 0.5 * i;
+    point[1] = 30.0 - 0.25 * i;
+    fixedPointSet->SetPoint(i, point);
+  }
+
+  const auto filter = TransformixFilterType::New();
+  filter->SetTransformParameterObject(CreateTranslationParameterObject());
+  filter->SetFixedPointSet(fixedPointSet);
+  filter->LogToConsoleOff();
+  filter->Update();
+
+  const PointSetType * resultPointSet = filter->GetResultPointSet();
+  ASSERT_NE(resultPointSet, nullptr);
+  ASSERT_EQ(resultPointSet->GetNumberOfPoints(), numberOfPoints);
+
+  for (unsigned int i = 0; i < numberOfPoints; ++i)
+  {
+    const PointSetType::PointType & fixedPoint = fixedPointSet->GetPoints()->ElementAt(i);
+    const PointSetType::PointType & resultPoint = resultPointSet->GetPoints()->ElementAt(i);
+    EXPECT_DOUBLE_EQ(resultPoint[0], fixedPoint[0] + 2.0);
+    EXPECT_DOUBLE_EQ(resultPoint[1], fixedPoint[1] - 1.0);
+  }
+}
+
+
+// Tests that a point set and a point set file cannot be combined.
+GTEST_TEST(TransformixFilter, FixedPointSetAndFileNameAreExclusive)
+{
+  const auto filter = TransformixFilterType::New();
+  filter->SetTransformParameterObject(CreateTranslationParameterObject());
+  filter->SetFixedPointSet(PointSetType::New());
+  filter->SetFixedPointSetFileName("inputPoints.txt");
+  filter->LogToConsoleOff();
+  EXPECT_THROW(filter->Update(), itk::ExceptionObject);
+}
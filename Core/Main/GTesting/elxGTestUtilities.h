@@ -0,0 +1,113 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __elxGTestUtilities_h
+#define __elxGTestUtilities_h
+
+// The registrations of the GoogleTest tests of the elastix library share
+// their test images and parameter maps: a fixed and a moving image, each
+// with a Gaussian blob, which a translation registers to each other.
+
+#include "elxParameterObject.h"
+
+// ITK header files:
+#include <itkImage.h>
+
+// GoogleTest header file:
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace elastix
+{
+namespace GTestUtilities
+{
+
+// The size of the blob images, in both dimensions.
+constexpr unsigned int BlobImageSize = 32;
+
+// The centres of the blobs of the fixed and the moving image, in pixels.
+constexpr double FixedBlobCenterX = 15.0;
+constexpr double FixedBlobCenterY = 15.0;
+constexpr double MovingBlobCenterX = 17.0;
+constexpr double MovingBlobCenterY = 14.0;
+
+
+// Creates the pixel buffer of a blob image, with a Gaussian blob centred at
+// the specified index.
+template <typename TPixel>
+std::vector<TPixel>
+CreateBlobBuffer(const double centerX, const double centerY)
+{
+  std::vector<TPixel> buffer(BlobImageSize * BlobImageSize);
+  for (unsigned int y = 0; y < BlobImageSize; ++y)
+  {
+    for (unsigned int x = 0; x < BlobImageSize; ++x)
+    {
+      const double dx = x - centerX;
+      const double dy = y - centerY;
+      buffer[y * BlobImageSize + x] = static_cast<TPixel>(100.0 * std::exp(-(dx * dx + dy * dy) / 50.0));
+    }
+  }
+  return buffer;
+}
+
+
+// Creates a 2D blob image, with a Gaussian blob centred at the specified index.
+template <typename TPixel>
+typename itk::Image<TPixel, 2>::Pointer
+CreateBlobImage(const double centerX, const double centerY)
+{
+  using ImageType = itk::Image<TPixel, 2>;
+
+  const auto image = ImageType::New();
+  image->SetRegions(typename ImageType::SizeType{ { BlobImageSize, BlobImageSize } });
+  image->Allocate();
+
+  const std::vector<TPixel> buffer = CreateBlobBuffer<TPixel>(centerX, centerY);
+  std::copy(buffer.begin(), buffer.end(), image->GetBufferPointer());
+  return image;
+}
+
+
+// Creates the parameter map of a translation registration of blob images.
+inline ParameterObject::ParameterMapType
+CreateTranslationParameterMap()
+{
+  ParameterObject::ParameterMapType parameterMap = ParameterObject::GetDefaultParameterMap("translation", 2);
+  parameterMap["MaximumNumberOfIterations"] = { "100" };
+  return parameterMap;
+}
+
+
+// Expects that the transform parameters of a registration of the moving blob
+// image to the fixed blob image are the translation between the blobs.
+inline void
+ExpectBlobTranslation(const std::vector<std::string> & transformParameters)
+{
+  ASSERT_EQ(transformParameters.size(), 2u);
+  EXPECT_NEAR(std::stod(transformParameters[0]), MovingBlobCenterX - FixedBlobCenterX, 0.5);
+  EXPECT_NEAR(std::stod(transformParameters[1]), MovingBlobCenterY - FixedBlobCenterY, 0.5);
+}
+
+} // namespace GTestUtilities
+} // namespace elastix
+
+#endif // __elxGTestUtilities_h
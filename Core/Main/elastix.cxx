@@ -19,8 +19,296 @@
 #include "elastix.h"
 #include "elxElastixMain.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef> // For size_t.
+#include <cstdlib>
+#include <fstream>
 #include <limits>
+#include <thread>
+
+namespace
+{
+
+/** Some typedef's. */
+typedef elx::ElastixMain                            ElastixMainType;
+typedef ElastixMainType::Pointer                    ElastixMainPointer;
+typedef ElastixMainType::ObjectPointer              ObjectPointer;
+typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
+typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
+typedef ElastixMainType::ImagePyramidCacheType      ImagePyramidCacheType;
+typedef ElastixMainType::ArgumentMapType            ArgumentMapType;
+typedef ArgumentMapType::value_type                 ArgumentMapEntryType;
+
+/** The fixed image and mask of a batch, which are read once, before the
+ * registrations start, and then shared by all registrations.
+ */
+struct BatchFixedImagesType
+{
+  DataObjectContainerPointer fixedImageContainer;
+  DataObjectContainerPointer fixedMaskContainer;
+  FlatDirectionCosinesType   fixedImageOriginalDirection;
+};
+
+/**
+ * ********************* ReadBatchFileNames *********************
+ *
+ * Reads the moving image file names of a batch: one file name per line.
+ * Empty lines and lines that start with '#' are skipped.
+ */
+
+bool
+ReadBatchFileNames( const std::string & batchFileName, std::vector< std::string > & fileNames )
+{
+  std::ifstream batchFile( batchFileName.c_str() );
+  if( !batchFile.is_open() )
+  {
+    return false;
+  }
+
+  std::string line;
+  while( std::getline( batchFile, line ) )
+  {
+    line = itksys::SystemTools::TrimWhitespace( line );
+    if( !line.empty() && line[ 0 ] != '#' )
+    {
+      fileNames.push_back( line );
+    }
+  }
+
+  return true;
+
+} // end ReadBatchFileNames()
+
+
+/**
+ * ********************* RunBatchRegistration *******************
+ *
+ * Registers one moving image of a batch, with all parameter files. The
+ * registration uses shallow copies of the fixed image and mask of the
+ * batch, and shares the fixed image pyramids through pyramidCache.
+ */
+
+int
+RunBatchRegistration( ArgumentMapType argMap,
+  const std::vector< std::string > & parameterFiles,
+  const BatchFixedImagesType & fixedImages,
+  ImagePyramidCacheType * pyramidCache )
+{
+  /** Log to the output directory of this registration only. */
+  elx::xoutManager threadXout;
+  if( threadXout.Setup( argMap[ "-out" ] + "elastix.log", true, false ) )
+  {
+    return -2;
+  }
+
+  // Note that the following pointers are "smart", so they are defaulted-constructed to null.
+  ObjectPointer              transform;
+  DataObjectContainerPointer fixedImageContainer;
+  DataObjectContainerPointer movingImageContainer;
+  DataObjectContainerPointer fixedMaskContainer;
+  DataObjectContainerPointer movingMaskContainer;
+  FlatDirectionCosinesType   fixedImageOriginalDirection;
+
+  /** Use the fixed image and mask of the batch. Shallow copies are used,
+   * because each registration changes the meta data of its own images.
+   */
+  fixedImageContainer         = ElastixMainType::CreateShallowCopy( fixedImages.fixedImageContainer );
+  fixedImageOriginalDirection = fixedImages.fixedImageOriginalDirection;
+  if( fixedImages.fixedMaskContainer )
+  {
+    fixedMaskContainer = ElastixMainType::CreateShallowCopy( fixedImages.fixedMaskContainer );
+  }
+
+  int returndummy = 0;
+  for( unsigned int i = 0; i < parameterFiles.size(); ++i )
+  {
+    ElastixMainPointer elastix = ElastixMainType::New();
+
+    /** Set stuff we get from a former registration, or from the batch. */
+    elastix->SetInitialTransform( transform );
+    elastix->SetFixedImageContainer( fixedImageContainer );
+    elastix->SetMovingImageContainer( movingImageContainer );
+    elastix->SetFixedMaskContainer( fixedMaskContainer );
+    elastix->SetMovingMaskContainer( movingMaskContainer );
+    elastix->SetOriginalFixedImageDirectionFlat( fixedImageOriginalDirection );
+    elastix->SetImagePyramidCache( pyramidCache );
+
+    /** Set the current elastix-level. */
+    elastix->SetElastixLevel( i );
+    elastix->SetTotalNumberOfElastixLevels( parameterFiles.size() );
+
+    argMap.erase( "-p" );
+    argMap.insert( ArgumentMapEntryType( "-p", parameterFiles[ i ] ) );
+
+    elxout << "-------------------------------------------------------------------------" << "\n" << std::endl;
+    elxout << "Running elastix with parameter file " << i
+           << ": \"" << parameterFiles[ i ] << "\".\n" << std::endl;
+
+    itk::TimeProbe timer;
+    timer.Start();
+    returndummy = elastix->Run( argMap );
+    timer.Stop();
+
+    if( returndummy != 0 )
+    {
+      xl::xout[ "error" ] << "Errors occurred!" << std::endl;
+      return returndummy;
+    }
+
+    /** Get the transform, the fixedImage and the movingImage
+     * in order to put it in the (possibly) next registration.
+     */
+    transform                   = elastix->GetModifiableFinalTransform();
+    fixedImageContainer         = elastix->GetModifiableFixedImageContainer();
+    movingImageContainer        = elastix->GetModifiableMovingImageContainer();
+    fixedMaskContainer          = elastix->GetModifiableFixedMaskContainer();
+    movingMaskContainer         = elastix->GetModifiableMovingMaskContainer();
+    fixedImageOriginalDirection = elastix->GetOriginalFixedImageDirectionFlat();
+
+    elxout << "Time used for running elastix with this parameter file:\n  "
+           << ConvertSecondsToDHMS( timer.GetMean(), 1 ) << ".\n" << std::endl;
+  }
+
+  return returndummy;
+
+} // end RunBatchRegistration()
+
+
+/**
+ * ********************* RunBatch *******************************
+ *
+ * Registers each of the moving images to the fixed image. The registrations
+ * run concurrently, in at most "-concurrent" threads. Registration i writes
+ * its output to the subdirectory "i" of the output directory.
+ */
+
+int
+RunBatch( const ArgumentMapType & argMap,
+  const std::vector< std::string > & parameterFiles,
+  const std::vector< std::string > & movingImageFiles )
+{
+  const unsigned int numberOfRegistrations = movingImageFiles.size();
+  const unsigned int numberOfCores         = std::max( std::thread::hardware_concurrency(), 1u );
+
+  /** The number of concurrent registrations, and their number of threads. */
+  unsigned int numberOfWorkers = numberOfCores;
+  if( argMap.count( "-concurrent" ) )
+  {
+    numberOfWorkers = std::max( atoi( argMap.find( "-concurrent" )->second.c_str() ), 1 );
+  }
+  numberOfWorkers = std::min( numberOfWorkers, numberOfRegistrations );
+
+  ArgumentMapType batchArgMap = argMap;
+  if( batchArgMap.count( "-threads" ) == 0 )
+  {
+    batchArgMap.insert( ArgumentMapEntryType( "-threads",
+      std::to_string( std::max( numberOfCores / numberOfWorkers, 1u ) ) ) );
+  }
+
+  elxout << "Running a batch of " << numberOfRegistrations << " registrations, "
+         << numberOfWorkers << " at a time, with " << batchArgMap[ "-threads" ]
+         << " threads each.\n" << std::endl;
+
+  /** Create the output directories. */
+  const std::string          outFolder = argMap.find( "-out" )->second;
+  std::vector< std::string > outFolders( numberOfRegistrations );
+  for( unsigned int i = 0; i < numberOfRegistrations; ++i )
+  {
+    outFolders[ i ] = outFolder + std::to_string( i ) + "/";
+    if( !itksys::SystemTools::MakeDirectory( outFolders[ i ] ) )
+    {
+      xl::xout[ "error" ] << "ERROR: could not create the output directory \""
+                          << outFolders[ i ] << "\"." << std::endl;
+      return -2;
+    }
+  }
+
+  /** Read the fixed image and mask once, before the registrations start,
+   * with the image types of the first parameter file.
+   */
+  BatchFixedImagesType fixedImages;
+  {
+    ArgumentMapType readArgMap = batchArgMap;
+    readArgMap.erase( "-p" );
+    readArgMap.insert( ArgumentMapEntryType( "-p", parameterFiles[ 0 ] ) );
+
+    ElastixMainPointer elastix   = ElastixMainType::New();
+    const int          errorCode = elastix->ReadFixedImages( readArgMap );
+    if( errorCode != 0 )
+    {
+      xl::xout[ "error" ] << "ERROR: could not read the fixed image of the batch." << std::endl;
+      return errorCode;
+    }
+    fixedImages.fixedImageContainer         = elastix->GetModifiableFixedImageContainer();
+    fixedImages.fixedMaskContainer          = elastix->GetModifiableFixedMaskContainer();
+    fixedImages.fixedImageOriginalDirection = elastix->GetOriginalFixedImageDirectionFlat();
+  }
+
+  /** The fixed image pyramids, which are computed only once. */
+  ImagePyramidCacheType::Pointer pyramidCache = ImagePyramidCacheType::New();
+
+  std::vector< int >          errorCodes( numberOfRegistrations, 0 );
+  std::vector< double >       times( numberOfRegistrations, 0.0 );
+  std::atomic< unsigned int > nextIndex( 0 );
+
+  auto worker = [ & ]()
+  {
+    for( unsigned int index = nextIndex++; index < numberOfRegistrations; index = nextIndex++ )
+    {
+      ArgumentMapType registrationArgMap = batchArgMap;
+      registrationArgMap[ "-m" ]   = movingImageFiles[ index ];
+      registrationArgMap[ "-out" ] = outFolders[ index ];
+
+      itk::TimeProbe timer;
+      timer.Start();
+      try
+      {
+        errorCodes[ index ] = RunBatchRegistration( registrationArgMap, parameterFiles,
+          fixedImages, pyramidCache );
+      }
+      catch( std::exception & )
+      {
+        errorCodes[ index ] = 1;
+      }
+      timer.Stop();
+      times[ index ] = timer.GetMean();
+    }
+  };
+
+  std::vector< std::thread > workers;
+  for( unsigned int i = 1; i < numberOfWorkers; ++i )
+  {
+    workers.push_back( std::thread( worker ) );
+  }
+  worker();
+  for( unsigned int i = 0; i < workers.size(); ++i )
+  {
+    workers[ i ].join();
+  }
+
+  /** Report the results. */
+  int returndummy = 0;
+  for( unsigned int i = 0; i < numberOfRegistrations; ++i )
+  {
+    elxout << "Registration " << i << " of \"" << movingImageFiles[ i ] << "\" ";
+    if( errorCodes[ i ] == 0 )
+    {
+      elxout << "finished in " << ConvertSecondsToDHMS( times[ i ], 1 ) << "." << std::endl;
+    }
+    else
+    {
+      elxout << "FAILED, see \"" << outFolders[ i ] << "elastix.log\"." << std::endl;
+      returndummy = errorCodes[ i ];
+    }
+  }
+  elxout << std::endl;
+
+  return returndummy;
+
+} // end RunBatch()
+
+} // end namespace
 
 int
 main( int argc, char ** argv )
@@ -99,15 +387,7 @@ main( int argc, char ** argv )
   }
 
   /** Some typedef's. */
-  typedef elx::ElastixMain                            ElastixMainType;
-  typedef ElastixMainType::Pointer                    ElastixMainPointer;
-  typedef std::vector< ElastixMainPointer >           ElastixMainVectorType;
-  typedef ElastixMainType::ObjectPointer              ObjectPointer;
-  typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
-  typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
-
-  typedef ElastixMainType::ArgumentMapType ArgumentMapType;
-  typedef ArgumentMapType::value_type      ArgumentMapEntryType;
+  typedef std::vector< ElastixMainPointer > ElastixMainVectorType;
 
   typedef std::pair< std::string, std::string > ArgPairType;
   typedef std::queue< ArgPairType >             ParameterFileListType;
@@ -131,6 +411,8 @@ main( int argc, char ** argv )
   unsigned long              nrOfParameterFiles = 0;
   ArgumentMapType            argMap;
   ParameterFileListType      parameterFileList;
+  std::vector< std::string > parameterFiles;
+  std::vector< std::string > batchMovingImageFiles;
   bool                       outFolderPresent = false;
   std::string                outFolder        = "";
   std::string                logFileName      = "";
@@ -147,6 +429,7 @@ main( int argc, char ** argv )
       nrOfParameterFiles++;
       parameterFileList.push(
         ParameterFileListEntryType( key.c_str(), value.c_str() ) );
+      parameterFiles.push_back( value );
       /** The different '-p' are stored in the argMap, with
        * keys p(1), p(2), etc. */
       std::ostringstream tempPname( "" );
@@ -206,6 +489,26 @@ main( int argc, char ** argv )
     returndummy |= -1;
   }
 
+  /** Check the -batch option, which replaces the "-m" option. */
+  if( argMap.count( "-batch" ) )
+  {
+    if( argMap.count( "-m" ) )
+    {
+      std::cerr << "ERROR: The CommandLine options \"-m\" and \"-batch\" cannot be combined!" << std::endl;
+      returndummy |= -1;
+    }
+    else if( !ReadBatchFileNames( argMap[ "-batch" ], batchMovingImageFiles ) )
+    {
+      std::cerr << "ERROR: could not read the batch file \"" << argMap[ "-batch" ] << "\"." << std::endl;
+      returndummy |= -1;
+    }
+    else if( batchMovingImageFiles.empty() )
+    {
+      std::cerr << "ERROR: the batch file \"" << argMap[ "-batch" ] << "\" contains no moving images." << std::endl;
+      returndummy |= -1;
+    }
+  }
+
   /** Check if the -out option is given. */
   if( outFolderPresent )
   {
@@ -263,6 +566,13 @@ main( int argc, char ** argv )
          << static_cast< unsigned int >( info.GetProcessorClockFrequency() )
          << " MHz." << std::endl;
 
+  /** Register a batch of moving images to the fixed image. */
+  if( !batchMovingImageFiles.empty() )
+  {
+    returndummy = RunBatch( argMap, parameterFiles, batchMovingImageFiles );
+    nrOfParameterFiles = 0;
+  }
+
   /**
    * ********************* START REGISTRATION *********************
    *
@@ -411,7 +721,15 @@ PrintHelp( void )
   std::cout << "  -t0       parameter file for initial transform\n";
   std::cout << "  -priority set the process priority to high, abovenormal, normal (default),\n"
             << "            belownormal, or idle (Windows only option)\n";
-  std::cout << "  -threads  set the maximum number of threads of elastix\n"
+  std::cout << "  -threads  set the maximum number of threads of elastix\n";
+  std::cout << "  -resume   directory with the checkpoints of an interrupted registration,\n"
+            << "            of which the completed resolutions are skipped\n";
+  std::cout << "  -batch    text file with a moving image per line, instead of \"-m\". Each\n"
+            << "            moving image is registered to the fixed image, which is read\n"
+            << "            only once. The output of moving image i is written to the\n"
+            << "            subdirectory \"i\" of the output directory\n";
+  std::cout << "  -concurrent  the maximum number of registrations of a \"-batch\" that\n"
+            << "            run at the same time (default: the number of cores)\n"
             << std::endl;
 
   /** The parameter file.*/
@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+/** elastixclient submits a job to elastixserver, waits until it has
+ * finished, and returns the return code of the job. Example:
+ *
+ *   elastixclient -s /tmp/elastix.socket elastix -f fixed.mha -m moving.mha -p par.txt -out out
+ *   elastixclient -s /tmp/elastix.socket transformix -tp out/TransformParameters.0.txt -in moving.mha -out out
+ *   elastixclient -s /tmp/elastix.socket status
+ *   elastixclient -s /tmp/elastix.socket shutdown
+ */
+
+#include "elxServerProtocol.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+int
+main( int argc, char ** argv )
+{
+  if( argc < 4 || std::string( argv[ 1 ] ) != "-s" )
+  {
+    std::cout << "Usage: elastixclient -s <socket> <command> [arguments]\n"
+              << "  command: elastix, transformix, status or shutdown\n"
+              << "  arguments: the command line arguments of elastix or transformix\n"
+              << "The return code is the return code of the job." << std::endl;
+    return argc == 1 ? 0 : 1;
+  }
+
+  /** Compose the request. Paths are made absolute, because the
+   * server runs in another working directory.
+   */
+  std::vector< std::string > request;
+  request.push_back( argv[ 3 ] );
+  for( int i = 4; i < argc; ++i )
+  {
+    std::string argument( argv[ i ] );
+    if( argument.find( '\n' ) != std::string::npos )
+    {
+      std::cerr << "ERROR: arguments cannot contain a newline." << std::endl;
+      return 1;
+    }
+
+    const bool isValue = ( i - 4 ) % 2 == 1;
+    if( isValue )
+    {
+      const std::string key( argv[ i - 1 ] );
+      if( key != "-threads" && key != "-priority" && argument != "all" )
+      {
+        argument = itksys::SystemTools::CollapseFullPath( argument );
+      }
+    }
+    request.push_back( argument );
+  }
+
+  /** Connect to the server. */
+  sockaddr_un address;
+  if( !elastix::ServerSocketAddress( argv[ 2 ], address ) )
+  {
+    std::cerr << "ERROR: invalid socket file name \"" << argv[ 2 ] << "\"." << std::endl;
+    return 1;
+  }
+  std::signal( SIGPIPE, SIG_IGN );
+  const int clientSocket = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+  if( clientSocket < 0
+    || ::connect( clientSocket, reinterpret_cast< sockaddr * >( &address ), sizeof( address ) ) != 0 )
+  {
+    std::cerr << "ERROR: cannot connect to elastixserver at \"" << argv[ 2 ] << "\": "
+              << std::strerror( errno ) << std::endl;
+    return 1;
+  }
+
+  /** Send the request and wait for the reply. */
+  std::string reply;
+  if( !elastix::ServerSendRequest( clientSocket, request )
+    || !elastix::ServerReadLine( clientSocket, reply ) )
+  {
+    std::cerr << "ERROR: the connection to elastixserver was lost." << std::endl;
+    ::close( clientSocket );
+    return 1;
+  }
+  ::close( clientSocket );
+
+  if( request[ 0 ] == "status" )
+  {
+    std::cout << reply << std::endl;
+    return 0;
+  }
+  if( request[ 0 ] != "elastix" && request[ 0 ] != "transformix" && request[ 0 ] != "shutdown" )
+  {
+    std::cerr << "ERROR: " << reply << std::endl;
+    return 1;
+  }
+
+  const int returnCode = atoi( reply.c_str() );
+  if( returnCode != 0 )
+  {
+    std::cerr << request[ 0 ] << " returned " << returnCode
+              << ", see the log file in the output directory." << std::endl;
+  }
+  return returnCode;
+
+} // end main
@@ -0,0 +1,936 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+/** elastixserver is a long-running process that runs elastix and transformix
+ * jobs, which it receives over a Unix domain socket, see elxServerProtocol.h.
+ * Compared to starting elastix for every registration, the components are
+ * installed only once, decoded images and fixed image pyramids are kept in a
+ * cache, and several jobs run concurrently, each with a part of the cores.
+ */
+
+#include "elastix.h"
+#include "elxElastixMain.h"
+#include "elxTransformixMain.h"
+#include "elxServerProtocol.h"
+
+#include "itkMultiThreaderBase.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <sys/time.h>
+
+namespace
+{
+
+/** Some typedef's. */
+typedef elx::ElastixMain                            ElastixMainType;
+typedef ElastixMainType::Pointer                    ElastixMainPointer;
+typedef elx::TransformixMain                        TransformixMainType;
+typedef TransformixMainType::Pointer                TransformixMainPointer;
+typedef ElastixMainType::ObjectPointer              ObjectPointer;
+typedef ElastixMainType::DataObjectContainerType    DataObjectContainerType;
+typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
+typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
+typedef ElastixMainType::ImagePyramidCacheType      ImagePyramidCacheType;
+typedef ElastixMainType::ConfigurationType          ConfigurationType;
+typedef ElastixMainType::ArgumentMapType            ArgumentMapType;
+typedef ArgumentMapType::value_type                 ArgumentMapEntryType;
+typedef std::vector< std::string >                  RequestType;
+
+/**
+ * ********************* AddFileToStamp *************************
+ *
+ * Adds the canonical path, the modification time and the size of a file to
+ * the stamp of an image. Returns false if the file does not exist.
+ */
+
+bool
+AddFileToStamp( const std::string & fileName, std::ostringstream & stamp )
+{
+  if( !itksys::SystemTools::FileExists( fileName, true ) )
+  {
+    return false;
+  }
+
+  stamp << itksys::SystemTools::GetRealPath( fileName ) << "|"
+        << itksys::SystemTools::ModifiedTime( fileName ) << "|"
+        << itksys::SystemTools::FileLength( fileName ) << "|";
+  return true;
+
+} // end AddFileToStamp()
+
+
+/**
+ * ************************* Trim *******************************
+ */
+
+std::string
+Trim( const std::string & text )
+{
+  const std::string::size_type begin = text.find_first_not_of( " \t\r" );
+  if( begin == std::string::npos )
+  {
+    return "";
+  }
+  const std::string::size_type end = text.find_last_not_of( " \t\r" );
+  return text.substr( begin, end - begin + 1 );
+
+} // end Trim()
+
+
+/**
+ * ********************* GetImageFileStamp **********************
+ *
+ * Identifies the current version of an image file, by the canonical path,
+ * the modification time and the size of the file, without reading it. For
+ * MetaImage headers (.mhd) and Analyze/NIfTI headers (.hdr) the data file is
+ * included. Returns an empty string if the image should not be cached.
+ */
+
+std::string
+GetImageFileStamp( const std::string & fileName )
+{
+  std::ostringstream stamp;
+  if( !AddFileToStamp( fileName, stamp ) )
+  {
+    return "";
+  }
+
+  const std::string extension
+    = itksys::SystemTools::LowerCase( itksys::SystemTools::GetFilenameLastExtension( fileName ) );
+  const std::string path = itksys::SystemTools::GetFilenamePath( fileName );
+  if( extension == ".mhd" )
+  {
+    /** Find the data file in the header. */
+    std::ifstream header( fileName.c_str() );
+    std::string   line;
+    while( itksys::SystemTools::GetLineFromStream( header, line ) )
+    {
+      const std::string::size_type equals = line.find( '=' );
+      if( equals == std::string::npos
+        || Trim( line.substr( 0, equals ) ) != "ElementDataFile" )
+      {
+        continue;
+      }
+      const std::string dataFile
+        = Trim( line.substr( equals + 1 ) );
+      if( dataFile == "LOCAL" || dataFile == "LIST" || dataFile.find( '%' ) != std::string::npos )
+      {
+        return "";  // not supported, do not cache
+      }
+      const std::string dataFileName = itksys::SystemTools::FileIsFullPath( dataFile )
+        ? dataFile : path + "/" + dataFile;
+      if( !AddFileToStamp( dataFileName, stamp ) )
+      {
+        return "";
+      }
+    }
+  }
+  else if( extension == ".hdr" )
+  {
+    const std::string dataFileName
+      = itksys::SystemTools::GetFilenameWithoutLastExtension( fileName ) + ".img";
+    AddFileToStamp( path.empty() ? dataFileName : path + "/" + dataFileName, stamp );
+  }
+
+  return stamp.str();
+
+} // end GetImageFileStamp()
+
+
+/**
+ * ************************ ImageCache **************************
+ *
+ * Keeps the most recently used decoded images, by the stamp of the image
+ * file and the internal pixel type. Also keeps the most recently used fixed
+ * image pyramid caches, by the fixed image and the parameter files of the
+ * job. Can be used by several threads.
+ */
+
+class ImageCache
+{
+public:
+
+  ImageCache( const std::size_t maximumNumberOfEntries ) :
+    m_MaximumNumberOfEntries( maximumNumberOfEntries )
+  {}
+
+  /** Returns a shallow copy of the cached images, or null. */
+  DataObjectContainerPointer Get( const std::string & key )
+  {
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    for( EntryListType::iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+      if( it->first == key )
+      {
+        /** Move the entry to the front. */
+        this->m_Entries.splice( this->m_Entries.begin(), this->m_Entries, it );
+        return ElastixMainType::CreateShallowCopy( it->second );
+      }
+    }
+    return DataObjectContainerPointer();
+  }
+
+
+  /** Stores a shallow copy of the images. */
+  void Add( const std::string & key, DataObjectContainerType * container )
+  {
+    if( this->m_MaximumNumberOfEntries == 0 )
+    {
+      return;
+    }
+    DataObjectContainerPointer copy = ElastixMainType::CreateShallowCopy( container );
+
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    for( EntryListType::iterator it = this->m_Entries.begin(); it != this->m_Entries.end(); ++it )
+    {
+      if( it->first == key )
+      {
+        this->m_Entries.erase( it );
+        break;
+      }
+    }
+    this->m_Entries.push_front( EntryType( key, copy ) );
+    while( this->m_Entries.size() > this->m_MaximumNumberOfEntries )
+    {
+      this->m_Entries.pop_back();
+    }
+  }
+
+
+  /** Returns the fixed image pyramid cache of key, which is created if
+   * needed, or null if nothing is cached.
+   */
+  ImagePyramidCacheType::Pointer GetPyramidCache( const std::string & key )
+  {
+    if( this->m_MaximumNumberOfEntries == 0 )
+    {
+      return ImagePyramidCacheType::Pointer();
+    }
+
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    for( PyramidEntryListType::iterator it = this->m_PyramidEntries.begin();
+      it != this->m_PyramidEntries.end(); ++it )
+    {
+      if( it->first == key )
+      {
+        /** Move the entry to the front. */
+        this->m_PyramidEntries.splice( this->m_PyramidEntries.begin(), this->m_PyramidEntries, it );
+        return it->second;
+      }
+    }
+    ImagePyramidCacheType::Pointer pyramidCache = ImagePyramidCacheType::New();
+    this->m_PyramidEntries.push_front( PyramidEntryType( key, pyramidCache ) );
+    while( this->m_PyramidEntries.size() > this->m_MaximumNumberOfEntries )
+    {
+      this->m_PyramidEntries.pop_back();
+    }
+    return pyramidCache;
+  }
+
+
+  std::size_t GetNumberOfEntries( void )
+  {
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    return this->m_Entries.size();
+  }
+
+
+  std::size_t GetNumberOfPyramidEntries( void )
+  {
+    std::lock_guard< std::mutex > lock( this->m_Mutex );
+    return this->m_PyramidEntries.size();
+  }
+
+
+private:
+
+  typedef std::pair< std::string, DataObjectContainerPointer >     EntryType;
+  typedef std::list< EntryType >                                   EntryListType;
+  typedef std::pair< std::string, ImagePyramidCacheType::Pointer > PyramidEntryType;
+  typedef std::list< PyramidEntryType >                            PyramidEntryListType;
+
+  std::mutex           m_Mutex;
+  std::size_t          m_MaximumNumberOfEntries;
+  EntryListType        m_Entries;
+  PyramidEntryListType m_PyramidEntries;
+
+};
+
+/**
+ * ************************* Server *****************************
+ */
+
+struct JobType
+{
+  int         m_Socket;
+  RequestType m_Request;
+};
+
+struct ServerState
+{
+  std::mutex              m_Mutex;
+  std::condition_variable m_JobAvailable;
+  std::condition_variable m_ClientFinished;
+  std::deque< JobType >   m_Queue;
+  unsigned int            m_NumberOfRunningJobs = 0;
+  unsigned int            m_NumberOfClients = 0;
+  int                     m_ShutdownSocket = -1;
+  bool                    m_Stop = false;
+  std::string             m_Argv0;
+  std::string             m_SocketFileName;
+};
+
+/** The time that a client may take to send its request, in seconds. */
+const int ClientRequestTimeout = 10;
+
+/**
+ * ********************* ParseArguments *************************
+ *
+ * Puts the arguments of a job in an argument map, in the same way as the
+ * elastix and transformix executables do. The parameter files of elastix
+ * are returned separately. Returns an error message, or an empty string.
+ */
+
+std::string
+ParseArguments( const RequestType & request, const ServerState & state,
+  ArgumentMapType & argMap, std::vector< std::string > & parameterFiles )
+{
+  if( request.size() % 2 != 1 )
+  {
+    return "the arguments should be pairs of a key and a value";
+  }
+
+  for( std::size_t i = 1; i + 1 < request.size(); i += 2 )
+  {
+    const std::string & key   = request[ i ];
+    std::string         value = request[ i + 1 ];
+
+    if( key == "-p" )
+    {
+      parameterFiles.push_back( value );
+      std::ostringstream tempPname( "" );
+      tempPname << "-p(" << parameterFiles.size() << ")";
+      argMap.insert( ArgumentMapEntryType( tempPname.str(), value ) );
+      continue;
+    }
+
+    /** These arguments affect the whole process; the server decides. */
+    if( key == "-threads" || key == "-priority" )
+    {
+      continue;
+    }
+
+    if( key == "-out" )
+    {
+      const char last = value.empty() ? '/' : value[ value.size() - 1 ];
+      if( last != '/' && last != '\\' ) { value.append( "/" ); }
+      if( !itksys::SystemTools::FileIsDirectory( value.c_str() ) )
+      {
+        return "the output directory \"" + value + "\" does not exist";
+      }
+    }
+    argMap.insert( ArgumentMapEntryType( key, value ) );
+  }
+
+  if( argMap.count( "-out" ) == 0 )
+  {
+    return "no \"-out\" given";
+  }
+
+  argMap.insert( ArgumentMapEntryType( "-argv0", state.m_Argv0 ) );
+  return "";
+
+} // end ParseArguments()
+
+
+/**
+ * ********************* GetImageCacheKey ***********************
+ *
+ * The cache key of the image given by the argument key ("-f" or "-m"),
+ * or an empty string if it should not be cached.
+ */
+
+std::string
+GetImageCacheKey( const ArgumentMapType & argMap,
+  const std::string & argumentKey, const std::string & pixelTypeKey,
+  ConfigurationType * configuration )
+{
+  ArgumentMapType::const_iterator it = argMap.find( argumentKey );
+  if( it == argMap.end() )
+  {
+    return "";
+  }
+
+  /** With UseDirectionCosines false, the images are changed while reading,
+   * and the original direction is only known to the first registration.
+   */
+  bool useDirectionCosines = true;
+  configuration->ReadParameter( useDirectionCosines, "UseDirectionCosines", 0, false );
+  if( !useDirectionCosines )
+  {
+    return "";
+  }
+
+  const std::string stamp = GetImageFileStamp( it->second );
+  if( stamp.empty() )
+  {
+    return "";
+  }
+
+  std::string pixelType = "float";
+  configuration->ReadParameter( pixelType, pixelTypeKey, 0, false );
+  return stamp + pixelType;
+
+} // end GetImageCacheKey()
+
+
+/**
+ * ********************* RunElastixJob **************************
+ */
+
+int
+RunElastixJob( const RequestType & request, ServerState & state, ImageCache & cache )
+{
+  ArgumentMapType            argMap;
+  std::vector< std::string > parameterFiles;
+  const std::string          error = ParseArguments( request, state, argMap, parameterFiles );
+  if( !error.empty() || parameterFiles.empty() )
+  {
+    elxout << "ERROR: elastix job rejected: "
+           << ( error.empty() ? "no \"-p\" given" : error ) << "." << std::endl;
+    return -1;
+  }
+
+  /** Log to the output directory of this job. */
+  elx::xoutManager threadXout;
+  if( threadXout.Setup( argMap[ "-out" ] + "elastix.log", true, false ) )
+  {
+    return -2;
+  }
+
+  // Note that the following pointers are "smart", so they are defaulted-constructed to null.
+  ObjectPointer              transform;
+  DataObjectContainerPointer fixedImageContainer;
+  DataObjectContainerPointer movingImageContainer;
+  DataObjectContainerPointer fixedMaskContainer;
+  DataObjectContainerPointer movingMaskContainer;
+  FlatDirectionCosinesType   fixedImageOriginalDirection;
+
+  /** Look up the images in the cache, using the first parameter file. */
+  std::string fixedImageKey, movingImageKey;
+  {
+    ArgumentMapType firstArgMap = argMap;
+    firstArgMap.insert( ArgumentMapEntryType( "-p", parameterFiles[ 0 ] ) );
+    ConfigurationType::Pointer configuration = ConfigurationType::New();
+    if( configuration->Initialize( firstArgMap ) == 0 )
+    {
+      fixedImageKey  = GetImageCacheKey( argMap, "-f", "FixedInternalImagePixelType", configuration );
+      movingImageKey = GetImageCacheKey( argMap, "-m", "MovingInternalImagePixelType", configuration );
+    }
+  }
+  if( !fixedImageKey.empty() )
+  {
+    fixedImageContainer = cache.Get( fixedImageKey );
+  }
+  if( !movingImageKey.empty() )
+  {
+    movingImageContainer = cache.Get( movingImageKey );
+  }
+
+  /** The fixed image pyramids depend on the fixed image and the parameter
+   * files, so jobs that have both in common share them.
+   */
+  ImagePyramidCacheType::Pointer pyramidCache;
+  if( !fixedImageKey.empty() )
+  {
+    std::ostringstream pyramidKey;
+    pyramidKey << fixedImageKey << "|";
+    bool stamped = true;
+    for( unsigned int i = 0; stamped && i < parameterFiles.size(); ++i )
+    {
+      stamped = AddFileToStamp( parameterFiles[ i ], pyramidKey );
+    }
+    if( stamped )
+    {
+      pyramidCache = cache.GetPyramidCache( pyramidKey.str() );
+    }
+  }
+
+  elxout << "Images from the cache of elastixserver:"
+         << "\n  fixed image:    " << ( fixedImageContainer ? "yes" : "no" )
+         << "\n  moving image:   " << ( movingImageContainer ? "yes" : "no" )
+         << "\n  fixed pyramids: " << ( pyramidCache ? "shared" : "no" )
+         << "\n" << std::endl;
+
+  /** Do the (possibly multiple) registration(s). */
+  int returndummy = 0;
+  for( unsigned int i = 0; i < parameterFiles.size(); ++i )
+  {
+    ElastixMainPointer elastix = ElastixMainType::New();
+
+    /** Set stuff we get from a former registration, or from the cache. */
+    elastix->SetInitialTransform( transform );
+    elastix->SetFixedImageContainer( fixedImageContainer );
+    elastix->SetMovingImageContainer( movingImageContainer );
+    elastix->SetFixedMaskContainer( fixedMaskContainer );
+    elastix->SetMovingMaskContainer( movingMaskContainer );
+    elastix->SetOriginalFixedImageDirectionFlat( fixedImageOriginalDirection );
+    elastix->SetImagePyramidCache( pyramidCache );
+
+    /** Set the current elastix-level. */
+    elastix->SetElastixLevel( i );
+    elastix->SetTotalNumberOfElastixLevels( parameterFiles.size() );
+
+    argMap.erase( "-p" );
+    argMap.insert( ArgumentMapEntryType( "-p", parameterFiles[ i ] ) );
+
+    elxout << "-------------------------------------------------------------------------" << "\n" << std::endl;
+    elxout << "Running elastix with parameter file " << i
+           << ": \"" << parameterFiles[ i ] << "\".\n" << std::endl;
+
+    itk::TimeProbe timer;
+    timer.Start();
+    returndummy = elastix->Run( argMap );
+    timer.Stop();
+    if( returndummy != 0 )
+    {
+      xl::xout[ "error" ] << "Errors occurred!" << std::endl;
+      return returndummy;
+    }
+
+    /** Store the images that were read in the cache. */
+    if( i == 0 )
+    {
+      if( !fixedImageKey.empty() && !fixedImageContainer )
+      {
+        cache.Add( fixedImageKey, elastix->GetModifiableFixedImageContainer() );
+      }
+      if( !movingImageKey.empty() && !movingImageContainer )
+      {
+        cache.Add( movingImageKey, elastix->GetModifiableMovingImageContainer() );
+      }
+    }
+
+    /** Get the transform, the fixedImage and the movingImage
+     * in order to put it in the (possibly) next registration.
+     */
+    transform                   = elastix->GetModifiableFinalTransform();
+    fixedImageContainer         = elastix->GetModifiableFixedImageContainer();
+    movingImageContainer        = elastix->GetModifiableMovingImageContainer();
+    fixedMaskContainer          = elastix->GetModifiableFixedMaskContainer();
+    movingMaskContainer         = elastix->GetModifiableMovingMaskContainer();
+    fixedImageOriginalDirection = elastix->GetOriginalFixedImageDirectionFlat();
+
+    elxout << "Time used for running elastix with this parameter file:\n  "
+           << ConvertSecondsToDHMS( timer.GetMean(), 1 ) << ".\n" << std::endl;
+  }
+
+  return returndummy;
+
+} // end RunElastixJob()
+
+
+/**
+ * ********************* RunTransformixJob **********************
+ */
+
+int
+RunTransformixJob( const RequestType & request, ServerState & state )
+{
+  ArgumentMapType            argMap;
+  std::vector< std::string > parameterFiles;
+  const std::string          error = ParseArguments( request, state, argMap, parameterFiles );
+  if( !error.empty() || argMap.count( "-tp" ) == 0 )
+  {
+    elxout << "ERROR: transformix job rejected: "
+           << ( error.empty() ? "no \"-tp\" given" : error ) << "." << std::endl;
+    return -1;
+  }
+
+  /** Log to the output directory of this job. */
+  elx::xoutManager threadXout;
+  if( threadXout.Setup( argMap[ "-out" ] + "transformix.log", true, false ) )
+  {
+    return -2;
+  }
+
+  elxout << "Running transformix with parameter file \""
+         << argMap[ "-tp" ] << "\".\n" << std::endl;
+
+  TransformixMainPointer transformix = TransformixMainType::New();
+  const int              returndummy = transformix->Run( argMap );
+  if( returndummy != 0 )
+  {
+    xl::xout[ "error" ] << "Errors occurred" << std::endl;
+  }
+
+  return returndummy;
+
+} // end RunTransformixJob()
+
+
+/**
+ * ************************* Worker *****************************
+ *
+ * Takes jobs from the queue, until the server stops.
+ */
+
+void
+Worker( ServerState & state, ImageCache & cache )
+{
+  while( true )
+  {
+    JobType job;
+    {
+      std::unique_lock< std::mutex > lock( state.m_Mutex );
+      state.m_JobAvailable.wait( lock, [ &state ] {
+        return state.m_Stop || !state.m_Queue.empty();
+      } );
+      if( state.m_Queue.empty() )
+      {
+        return;
+      }
+      job = state.m_Queue.front();
+      state.m_Queue.pop_front();
+      ++state.m_NumberOfRunningJobs;
+    }
+
+    itk::TimeProbe timer;
+    timer.Start();
+    int returnCode = 0;
+    try
+    {
+      returnCode = job.m_Request[ 0 ] == "elastix"
+        ? RunElastixJob( job.m_Request, state, cache )
+        : RunTransformixJob( job.m_Request, state );
+    }
+    catch( std::exception & excp )
+    {
+      elxout << "ERROR: " << excp.what() << std::endl;
+      returnCode = 1;
+    }
+    timer.Stop();
+
+    elxout << GetCurrentDateAndTime() << ": " << job.m_Request[ 0 ]
+           << " job finished with return code " << returnCode << " in "
+           << ConvertSecondsToDHMS( timer.GetMean(), 1 ) << "." << std::endl;
+
+    std::ostringstream reply;
+    reply << returnCode << "\n";
+    elx::ServerWrite( job.m_Socket, reply.str() );
+    ::close( job.m_Socket );
+
+    std::lock_guard< std::mutex > lock( state.m_Mutex );
+    --state.m_NumberOfRunningJobs;
+  }
+
+} // end Worker()
+
+
+/**
+ * ********************** HandleClient **************************
+ *
+ * Receives the request of a client, and queues it or answers it. Runs in
+ * its own thread, so that a slow client does not block the other clients.
+ * A client that does not send its request in time is dropped.
+ */
+
+void
+HandleClient( const int clientSocket, ServerState & state, ImageCache & cache )
+{
+  timeval timeout;
+  timeout.tv_sec  = ClientRequestTimeout;
+  timeout.tv_usec = 0;
+  ::setsockopt( clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) );
+
+  RequestType request;
+  if( !elx::ServerReceiveRequest( clientSocket, request ) )
+  {
+    ::close( clientSocket );
+  }
+  else if( request[ 0 ] == "elastix" || request[ 0 ] == "transformix" )
+  {
+    JobType job;
+    job.m_Socket  = clientSocket;
+    job.m_Request = request;
+    std::lock_guard< std::mutex > lock( state.m_Mutex );
+    state.m_Queue.push_back( job );
+    state.m_JobAvailable.notify_one();
+  }
+  else if( request[ 0 ] == "status" )
+  {
+    std::ostringstream reply;
+    {
+      std::lock_guard< std::mutex > lock( state.m_Mutex );
+      reply << "queued jobs: " << state.m_Queue.size()
+            << ", running jobs: " << state.m_NumberOfRunningJobs;
+    }
+    reply << ", cached images: " << cache.GetNumberOfEntries()
+          << ", cached pyramids: " << cache.GetNumberOfPyramidEntries() << "\n";
+    elx::ServerWrite( clientSocket, reply.str() );
+    ::close( clientSocket );
+  }
+  else if( request[ 0 ] == "shutdown" )
+  {
+    bool first = false;
+    {
+      std::lock_guard< std::mutex > lock( state.m_Mutex );
+      first = state.m_ShutdownSocket < 0;
+      if( first )
+      {
+        state.m_ShutdownSocket = clientSocket;
+      }
+    }
+    if( first )
+    {
+      /** Wake up the accept loop, by connecting to the server. */
+      sockaddr_un address;
+      elx::ServerSocketAddress( state.m_SocketFileName, address );
+      const int wakeSocket = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+      if( wakeSocket >= 0 )
+      {
+        ::connect( wakeSocket, reinterpret_cast< sockaddr * >( &address ), sizeof( address ) );
+        ::close( wakeSocket );
+      }
+    }
+    else
+    {
+      elx::ServerWrite( clientSocket, "0\n" );
+      ::close( clientSocket );
+    }
+  }
+  else
+  {
+    elx::ServerWrite( clientSocket, "unknown command\n" );
+    ::close( clientSocket );
+  }
+
+  std::lock_guard< std::mutex > lock( state.m_Mutex );
+  --state.m_NumberOfClients;
+  state.m_ClientFinished.notify_all();
+
+} // end HandleClient()
+
+
+} // end namespace
+
+/**
+ * **************************** main ****************************
+ */
+
+int
+main( int argc, char ** argv )
+{
+  /** Check if "--help" was asked for. */
+  if( argc == 2 )
+  {
+    std::string argument( argv[ 1 ] );
+    if( argument == "-help" || argument == "--help" || argument == "-h" )
+    {
+      PrintHelp();
+      return 0;
+    }
+  }
+
+  /** Read the arguments. */
+  const unsigned int numberOfCores = std::max( 1u, std::thread::hardware_concurrency() );
+  std::string        socketFileName;
+  unsigned int       numberOfJobs    = std::max( 1u, numberOfCores / 4 );
+  unsigned int       numberOfThreads = 0;
+  std::size_t        cacheSize       = 16;
+  for( int i = 1; i + 1 < argc; i += 2 )
+  {
+    const std::string key( argv[ i ] );
+    const std::string value( argv[ i + 1 ] );
+    if( key == "-s" )            { socketFileName = value; }
+    else if( key == "-jobs" )    { numberOfJobs = std::max( 1, atoi( value.c_str() ) ); }
+    else if( key == "-threads" ) { numberOfThreads = std::max( 1, atoi( value.c_str() ) ); }
+    else if( key == "-cache" )   { cacheSize = std::max( 0, atoi( value.c_str() ) ); }
+    else
+    {
+      std::cerr << "ERROR: unknown argument \"" << key << "\"." << std::endl;
+      return 1;
+    }
+  }
+  if( socketFileName.empty() || argc % 2 != 1 )
+  {
+    std::cerr << "Use \"elastixserver --help\" for information about elastixserver-usage." << std::endl;
+    return 1;
+  }
+  if( numberOfThreads == 0 )
+  {
+    numberOfThreads = std::max( 1u, numberOfCores / numberOfJobs );
+  }
+
+  /** The jobs share the cores. The number of threads is global in ITK,
+   * so the jobs cannot choose their own.
+   */
+  itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+
+  /** Messages of the server itself go to the console. */
+  if( elx::xoutSetup( "", false, true ) )
+  {
+    std::cerr << "ERROR while setting up xout." << std::endl;
+    return 1;
+  }
+
+  /** Support Mevis Dicom Tiff (if selected in cmake) */
+  RegisterMevisDicomTiff();
+
+  /** A client that disconnects should not stop the server. */
+  std::signal( SIGPIPE, SIG_IGN );
+
+  /** Create the socket. */
+  sockaddr_un address;
+  if( !elx::ServerSocketAddress( socketFileName, address ) )
+  {
+    std::cerr << "ERROR: invalid socket file name \"" << socketFileName << "\"." << std::endl;
+    return 1;
+  }
+  const int serverSocket = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+  ::unlink( socketFileName.c_str() );
+  if( serverSocket < 0
+    || ::bind( serverSocket, reinterpret_cast< sockaddr * >( &address ), sizeof( address ) ) != 0
+    || ::listen( serverSocket, 64 ) != 0 )
+  {
+    std::cerr << "ERROR: cannot listen on \"" << socketFileName << "\": "
+              << std::strerror( errno ) << std::endl;
+    return 1;
+  }
+
+  elxout << "elastixserver is started at " << GetCurrentDateAndTime() << ".\n"
+         << "  socket:          " << socketFileName << "\n"
+         << "  concurrent jobs: " << numberOfJobs << "\n"
+         << "  threads per job: " << numberOfThreads << "\n"
+         << "  cached images:   " << cacheSize << "\n" << std::endl;
+
+  /** Start the workers. */
+  ServerState state;
+  state.m_Argv0          = argv[ 0 ];
+  state.m_SocketFileName = socketFileName;
+  ImageCache                 cache( cacheSize );
+  std::vector< std::thread > workers;
+  for( unsigned int i = 0; i < numberOfJobs; ++i )
+  {
+    workers.emplace_back( Worker, std::ref( state ), std::ref( cache ) );
+  }
+
+  /** Accept clients, until a shutdown is requested. Each client is
+   * handled in its own thread.
+   */
+  bool acceptFailed = false;
+  while( true )
+  {
+    const int clientSocket = ::accept( serverSocket, 0, 0 );
+    if( clientSocket < 0 )
+    {
+      if( errno == EINTR ) { continue; }
+      std::cerr << "ERROR: accept failed: " << std::strerror( errno ) << std::endl;
+      acceptFailed = true;
+      break;
+    }
+
+    std::lock_guard< std::mutex > lock( state.m_Mutex );
+    if( state.m_ShutdownSocket >= 0 )
+    {
+      ::close( clientSocket );
+      break;
+    }
+    ++state.m_NumberOfClients;
+    std::thread( HandleClient, clientSocket, std::ref( state ), std::ref( cache ) ).detach();
+  }
+
+  /** Wait for the clients that are still sending their request, then
+   * finish the queued jobs, and stop.
+   */
+  ::close( serverSocket );
+  ::unlink( socketFileName.c_str() );
+  {
+    std::unique_lock< std::mutex > lock( state.m_Mutex );
+    state.m_ClientFinished.wait( lock, [ &state ] {
+      return state.m_NumberOfClients == 0;
+    } );
+    state.m_Stop = true;
+    state.m_JobAvailable.notify_all();
+  }
+  for( std::size_t i = 0; i < workers.size(); ++i )
+  {
+    workers[ i ].join();
+  }
+
+  elxout << "elastixserver has stopped at " << GetCurrentDateAndTime() << "." << std::endl;
+  if( state.m_ShutdownSocket >= 0 )
+  {
+    elx::ServerWrite( state.m_ShutdownSocket, "0\n" );
+    ::close( state.m_ShutdownSocket );
+  }
+
+  /** Close the modules. */
+  ElastixMainType::UnloadComponents();
+
+  return acceptFailed ? 1 : 0;
+
+} // end main
+
+
+/**
+ * *********************** PrintHelp ****************************
+ */
+
+void
+PrintHelp( void )
+{
+  /** Print the version. */
+  std::cout << std::fixed;
+  std::cout << std::showpoint;
+  std::cout << std::setprecision( 3 );
+  std::cout << "elastix version: " << __ELASTIX_VERSION << "\n" << std::endl;
+
+  /** What is elastixserver? */
+  std::cout << "elastixserver runs elastix and transformix jobs, which it receives\n"
+            << "over a Unix domain socket. Use elastixclient to submit jobs.\n"
+            << "The components are installed once, and decoded images are cached.\n"
+            << "  --help, -h displays this message and exit\n" << std::endl;
+
+  /** Mandatory arguments.*/
+  std::cout << "Call elastixserver from the command line with mandatory argument:\n";
+  std::cout << "  -s        the socket file to listen on\n" << std::endl;
+
+  /** Optional arguments.*/
+  std::cout << "Optional extra commands:\n";
+  std::cout << "  -jobs     the number of jobs that run concurrently,\n"
+            << "            default: the number of cores divided by 4\n";
+  std::cout << "  -threads  the number of threads of each job,\n"
+            << "            default: the number of cores divided by the number of jobs\n";
+  std::cout << "  -cache    the number of decoded images, and of fixed image pyramids,\n"
+            << "            to keep, default: 16\n" << std::endl;
+
+  std::cout << "The \"-threads\" and \"-priority\" arguments of jobs are ignored.\n"
+            << "Each job writes its log file to its own output directory." << std::endl;
+
+} // end PrintHelp()
@@ -0,0 +1,197 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef elxElastixBatchFilter_h
+#define elxElastixBatchFilter_h
+
+#include "itkImageSource.h"
+
+#include "elxElastixFilter.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * \class ElastixBatchFilter
+ * \brief Registers many moving images to one fixed image.
+ *
+ * Each moving image is registered to the fixed image by its own
+ * ElastixFilter, with the same parameter object. The registrations run
+ * concurrently, at most NumberOfConcurrentRegistrations at a time.
+ *
+ * The fixed image and the fixed mask are brought up to date once, before
+ * the registrations start. All registrations then share their pixel data,
+ * read-only: each registration gets its own image object, without a
+ * pipeline, that refers to the same pixel buffer. The images of the
+ * registrations are thus never copied, and the registrations do not
+ * update the pipeline of the inputs concurrently.
+ *
+ * The fixed image pyramids are computed only once as well: the registrations
+ * share an itk::ImagePyramidCache. The first registration that needs a fixed
+ * image pyramid computes it, and the others use its images. The pyramids are
+ * kept in memory until all registrations have finished.
+ *
+ * Result image i and transform parameter object i belong to moving image i.
+ * When an output directory is set, registration i writes its output to
+ * the subdirectory "i" of the output directory, which is created if
+ * needed. Note that the registrations write to the console at the same
+ * time, when LogToConsole is on.
+ *
+ * NumberOfThreads is the number of threads of each registration. By default
+ * the cores are divided over the registrations that run at the same time,
+ * like the -batch option of the elastix executable does.
+ */
+
+namespace elastix
+{
+
+template< typename TFixedImage, typename TMovingImage >
+class ELASTIXLIB_API ElastixBatchFilter : public itk::ImageSource< TFixedImage >
+{
+public:
+
+  /** Standard ITK typedefs. */
+  typedef ElastixBatchFilter              Self;
+  typedef itk::ImageSource< TFixedImage > Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( Self, itk::ImageSource );
+
+  /** Typedefs. */
+  typedef ElastixFilter< TFixedImage, TMovingImage > ElastixFilterType;
+  typedef typename ElastixFilterType::Pointer        ElastixFilterPointer;
+
+  typedef typename ElastixFilterType::ParameterObjectType     ParameterObjectType;
+  typedef typename ElastixFilterType::ParameterObjectPointer  ParameterObjectPointer;
+  typedef typename ElastixFilterType::FixedImagePointer       FixedImagePointer;
+  typedef typename ElastixFilterType::FixedImageConstPointer  FixedImageConstPointer;
+  typedef typename ElastixFilterType::MovingImagePointer      MovingImagePointer;
+  typedef typename ElastixFilterType::MovingImageConstPointer MovingImageConstPointer;
+  typedef typename ElastixFilterType::FixedMaskType           FixedMaskType;
+  typedef typename ElastixFilterType::FixedMaskPointer        FixedMaskPointer;
+  typedef typename ElastixFilterType::ImagePyramidCacheType   ImagePyramidCacheType;
+
+  /** Set/Get the fixed image, which is shared by all registrations. */
+  virtual void SetFixedImage( TFixedImage * fixedImage );
+  FixedImageConstPointer GetFixedImage( void ) const;
+
+  /** Set/Get/Remove the fixed mask, which is shared by all registrations. */
+  virtual void SetFixedMask( FixedMaskType * fixedMask );
+  const FixedMaskType * GetFixedMask( void ) const;
+  virtual void RemoveFixedMask( void );
+
+  /** Add/Get/NumberOf moving images. Each moving image is registered
+   * to the fixed image separately.
+   */
+  virtual void AddMovingImage( TMovingImage * movingImage );
+  MovingImageConstPointer GetMovingImage( const unsigned int index ) const;
+  unsigned int GetNumberOfMovingImages( void ) const;
+  virtual void RemoveMovingImages( void );
+
+  /** Set/Get parameter object, which is used by all registrations. */
+  virtual void SetParameterObject( ParameterObjectType * parameterObject );
+  ParameterObjectType * GetParameterObject( void );
+
+  /** Get the result image of moving image index. */
+  TFixedImage * GetResultImage( const unsigned int index );
+
+  /** Get the transform parameter object of moving image index. */
+  ParameterObjectType * GetTransformParameterObject( const unsigned int index );
+
+  /** Set/Get/Remove initial transform parameter filename. */
+  itkSetMacro( InitialTransformParameterFileName, std::string );
+  itkGetMacro( InitialTransformParameterFileName, std::string );
+  virtual void RemoveInitialTransformParameterFileName( void ) { this->SetInitialTransformParameterFileName( "" ); }
+
+  /** Set/Get/Remove output directory. */
+  itkSetMacro( OutputDirectory, std::string );
+  itkGetMacro( OutputDirectory, std::string );
+  void RemoveOutputDirectory() { this->SetOutputDirectory( "" ); }
+
+  /** Log to std::cout on/off. */
+  itkSetMacro( LogToConsole, bool );
+  itkGetConstReferenceMacro( LogToConsole, bool );
+  itkBooleanMacro( LogToConsole );
+
+  /** Log to file on/off. Each registration writes elastix.log to its
+   * own subdirectory of the output directory.
+   */
+  itkSetMacro( LogToFile, bool );
+  itkGetConstReferenceMacro( LogToFile, bool );
+  itkBooleanMacro( LogToFile );
+
+  /** Set/Get the number of threads of each registration. The default, 0,
+   * means the number of cores divided by the number of concurrent
+   * registrations.
+   */
+  itkSetMacro( NumberOfThreads, int );
+  itkGetMacro( NumberOfThreads, int );
+
+  /** Set/Get the maximum number of registrations that run at the same
+   * time. The default, 0, means the number of cores.
+   */
+  itkSetMacro( NumberOfConcurrentRegistrations, unsigned int );
+  itkGetConstMacro( NumberOfConcurrentRegistrations, unsigned int );
+
+protected:
+
+  ElastixBatchFilter( void );
+
+  virtual void GenerateData( void ) override;
+
+private:
+
+  ElastixBatchFilter( const Self & );  // purposely not implemented
+  void operator=( const Self & );      // purposely not implemented
+
+  /** Registers moving image index with numberOfThreads threads, and stores
+   * its results. The fixed image pyramids are shared through pyramidCache.
+   */
+  void RunRegistration( const unsigned int index, const int numberOfThreads,
+    ImagePyramidCacheType * pyramidCache );
+
+  /** The name of the input of moving image index. */
+  static std::string GetMovingImageInputName( const unsigned int index );
+
+  std::string m_InitialTransformParameterFileName;
+  std::string m_OutputDirectory;
+
+  bool m_LogToConsole;
+  bool m_LogToFile;
+
+  int          m_NumberOfThreads;
+  unsigned int m_NumberOfConcurrentRegistrations;
+  unsigned int m_NumberOfMovingImages;
+
+  /** The results, by moving image. */
+  std::vector< FixedImagePointer >      m_ResultImages;
+  std::vector< ParameterObjectPointer > m_TransformParameterObjects;
+
+};
+
+} // namespace elx
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "elxElastixBatchFilter.hxx"
+#endif
+
+#endif // elxElastixBatchFilter_h
@@ -0,0 +1,449 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef elxElastixBatchFilter_hxx
+#define elxElastixBatchFilter_hxx
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+namespace elastix
+{
+
+/**
+ * ********************* Constructor *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::ElastixBatchFilter( void )
+{
+  this->SetPrimaryInputName( "FixedImage" );
+  this->SetPrimaryOutputName( "ResultImage" );
+
+  this->AddRequiredInputName( "FixedImage" );
+  this->AddRequiredInputName( "ParameterObject" );
+
+  this->m_InitialTransformParameterFileName = "";
+  this->m_OutputDirectory                   = "";
+
+  this->m_LogToConsole = false;
+  this->m_LogToFile    = false;
+
+  this->m_NumberOfThreads                 = 0;
+  this->m_NumberOfConcurrentRegistrations = 0;
+  this->m_NumberOfMovingImages            = 0;
+
+  ParameterObjectPointer defaultParameterObject = ParameterObjectType::New();
+  defaultParameterObject->AddParameterMap( ParameterObjectType::GetDefaultParameterMap( "translation" ) );
+  defaultParameterObject->AddParameterMap( ParameterObjectType::GetDefaultParameterMap( "affine" ) );
+  defaultParameterObject->AddParameterMap( ParameterObjectType::GetDefaultParameterMap( "bspline" ) );
+  this->SetParameterObject( defaultParameterObject );
+
+} // end Constructor
+
+
+/**
+ * ********************* GenerateData *********************
+ *
+ * At this point the pipeline has brought all inputs up to date, so the
+ * fixed image and mask are read only once. The registrations share a cache
+ * of the fixed image pyramids, so these are computed only once too. The
+ * registrations are distributed over a number of worker threads, which each
+ * take the next moving image until all moving images are registered.
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GenerateData( void )
+{
+  const unsigned int numberOfRegistrations = this->m_NumberOfMovingImages;
+  if( numberOfRegistrations == 0 )
+  {
+    itkExceptionMacro( "No moving images have been added." );
+  }
+
+  if( this->m_LogToFile && this->m_OutputDirectory.empty() )
+  {
+    itkExceptionMacro( "LogToFileOn() requires an output directory to be specified." );
+  }
+
+  if( !this->m_OutputDirectory.empty() && !itksys::SystemTools::FileIsDirectory( this->m_OutputDirectory ) )
+  {
+    itkExceptionMacro( "Output directory \"" << this->m_OutputDirectory << "\" does not exist." );
+  }
+
+  /** Determine the number of worker threads, and divide the cores over
+   * them, unless the number of threads of each registration is set.
+   */
+  const unsigned int numberOfCores   = std::max( std::thread::hardware_concurrency(), 1u );
+  unsigned int       numberOfWorkers = this->m_NumberOfConcurrentRegistrations;
+  if( numberOfWorkers == 0 )
+  {
+    numberOfWorkers = numberOfCores;
+  }
+  numberOfWorkers = std::min( numberOfWorkers, numberOfRegistrations );
+
+  int numberOfThreads = this->m_NumberOfThreads;
+  if( numberOfThreads <= 0 )
+  {
+    numberOfThreads = static_cast< int >( std::max( numberOfCores / numberOfWorkers, 1u ) );
+  }
+
+  this->m_ResultImages.assign( numberOfRegistrations, nullptr );
+  this->m_TransformParameterObjects.assign( numberOfRegistrations, nullptr );
+
+  /** The fixed image pyramids, shared by all registrations. */
+  typename ImagePyramidCacheType::Pointer pyramidCache = ImagePyramidCacheType::New();
+
+  /** Run the registrations. An error in one registration does not stop
+   * the others; all errors are reported afterwards.
+   */
+  std::vector< std::string > errors( numberOfRegistrations );
+  std::atomic< unsigned int > nextIndex( 0 );
+
+  auto worker = [ this, &errors, &nextIndex, &pyramidCache, numberOfRegistrations, numberOfThreads ]()
+  {
+    for( unsigned int index = nextIndex++; index < numberOfRegistrations; index = nextIndex++ )
+    {
+      try
+      {
+        this->RunRegistration( index, numberOfThreads, pyramidCache );
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        errors[ index ] = excp.GetDescription();
+      }
+      catch( std::exception & excp )
+      {
+        errors[ index ] = excp.what();
+      }
+    }
+  };
+
+  std::vector< std::thread > workers;
+  for( unsigned int i = 1; i < numberOfWorkers; ++i )
+  {
+    workers.push_back( std::thread( worker ) );
+  }
+  worker();
+  for( unsigned int i = 0; i < workers.size(); ++i )
+  {
+    workers[ i ].join();
+  }
+
+  std::ostringstream errorMessage;
+  for( unsigned int i = 0; i < numberOfRegistrations; ++i )
+  {
+    if( !errors[ i ].empty() )
+    {
+      errorMessage << "\nRegistration of moving image " << i << " failed: " << errors[ i ];
+    }
+  }
+  if( !errorMessage.str().empty() )
+  {
+    itkExceptionMacro( << "Errors occurred during batch registration:" << errorMessage.str() );
+  }
+
+  /** The primary output is the result image of the first moving image. */
+  this->GraftOutput( this->m_ResultImages[ 0 ] );
+
+} // end GenerateData()
+
+
+/**
+ * ********************* RunRegistration *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::RunRegistration( const unsigned int index, const int numberOfThreads,
+  ImagePyramidCacheType * pyramidCache )
+{
+  /** Give the registration its own fixed image and mask objects, that share
+   * the pixel buffers of the inputs. Grafting only reads the inputs, and the
+   * new objects have no source, so the registrations never touch the input
+   * pipeline or each others image meta data.
+   */
+  FixedImagePointer fixedImage = TFixedImage::New();
+  fixedImage->Graft( this->GetFixedImage() );
+
+  MovingImagePointer movingImage = TMovingImage::New();
+  movingImage->Graft( this->GetMovingImage( index ) );
+
+  /** The parameter object is copied, because the ElastixFilter is a
+   * consumer of it in its own pipeline.
+   */
+  ParameterObjectPointer parameterObject = ParameterObjectType::New();
+  parameterObject->SetParameterMap( this->GetParameterObject()->GetParameterMap() );
+
+  ElastixFilterPointer filter = ElastixFilterType::New();
+  filter->SetFixedImage( fixedImage );
+  filter->SetMovingImage( movingImage );
+  filter->SetParameterObject( parameterObject );
+
+  if( this->GetFixedMask() != nullptr )
+  {
+    FixedMaskPointer fixedMask = FixedMaskType::New();
+    fixedMask->Graft( this->GetFixedMask() );
+    filter->SetFixedMask( fixedMask );
+  }
+
+  filter->SetInitialTransformParameterFileName( this->m_InitialTransformParameterFileName );
+  filter->SetNumberOfThreads( numberOfThreads );
+  filter->SetImagePyramidCache( pyramidCache );
+  filter->SetLogToConsole( this->m_LogToConsole );
+  filter->SetLogToFile( this->m_LogToFile );
+
+  /** Each registration writes to its own subdirectory. */
+  if( !this->m_OutputDirectory.empty() )
+  {
+    std::string outputDirectory = this->m_OutputDirectory;
+    if( outputDirectory[ outputDirectory.size() - 1 ] != '/'
+      && outputDirectory[ outputDirectory.size() - 1 ] != '\\' )
+    {
+      outputDirectory += "/";
+    }
+    outputDirectory += std::to_string( index ) + "/";
+    if( !itksys::SystemTools::MakeDirectory( outputDirectory ) )
+    {
+      itkExceptionMacro( "Could not create output directory \"" << outputDirectory << "\"." );
+    }
+    filter->SetOutputDirectory( outputDirectory );
+  }
+
+  filter->Update();
+
+  this->m_ResultImages[ index ]              = filter->GetOutput();
+  this->m_TransformParameterObjects[ index ] = filter->GetTransformParameterObject();
+
+} // end RunRegistration()
+
+
+/**
+ * ********************* SetFixedImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::SetFixedImage( TFixedImage * fixedImage )
+{
+  this->SetInput( "FixedImage", fixedImage );
+} // end SetFixedImage()
+
+
+/**
+ * ********************* GetFixedImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixBatchFilter< TFixedImage, TMovingImage >::FixedImageConstPointer
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetFixedImage( void ) const
+{
+  return itkDynamicCastInDebugMode< const TFixedImage * >( this->GetInput( "FixedImage" ) );
+} // end GetFixedImage()
+
+
+/**
+ * ********************* SetFixedMask *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::SetFixedMask( FixedMaskType * fixedMask )
+{
+  this->SetInput( "FixedMask", fixedMask );
+} // end SetFixedMask()
+
+
+/**
+ * ********************* GetFixedMask *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+const typename ElastixBatchFilter< TFixedImage, TMovingImage >::FixedMaskType *
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetFixedMask( void ) const
+{
+  return itkDynamicCastInDebugMode< const FixedMaskType * >( this->GetInput( "FixedMask" ) );
+} // end GetFixedMask()
+
+
+/**
+ * ********************* RemoveFixedMask *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::RemoveFixedMask( void )
+{
+  this->RemoveInput( "FixedMask" );
+} // end RemoveFixedMask()
+
+
+/**
+ * ********************* AddMovingImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::AddMovingImage( TMovingImage * movingImage )
+{
+  this->SetInput( GetMovingImageInputName( this->m_NumberOfMovingImages ), movingImage );
+  this->m_NumberOfMovingImages++;
+} // end AddMovingImage()
+
+
+/**
+ * ********************* GetMovingImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixBatchFilter< TFixedImage, TMovingImage >::MovingImageConstPointer
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetMovingImage( const unsigned int index ) const
+{
+  if( index >= this->m_NumberOfMovingImages )
+  {
+    itkExceptionMacro( << "Index exceeds the number of moving images (index: "
+                       << index << ", "
+                       << "number of moving images: " << this->m_NumberOfMovingImages << ")" );
+  }
+
+  return itkDynamicCastInDebugMode< const TMovingImage * >( this->GetInput( GetMovingImageInputName( index ) ) );
+} // end GetMovingImage()
+
+
+/**
+ * ********************* GetNumberOfMovingImages *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+unsigned int
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetNumberOfMovingImages( void ) const
+{
+  return this->m_NumberOfMovingImages;
+} // end GetNumberOfMovingImages()
+
+
+/**
+ * ********************* RemoveMovingImages *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::RemoveMovingImages( void )
+{
+  for( unsigned int i = 0; i < this->m_NumberOfMovingImages; ++i )
+  {
+    this->RemoveInput( GetMovingImageInputName( i ) );
+  }
+  this->m_NumberOfMovingImages = 0;
+} // end RemoveMovingImages()
+
+
+/**
+ * ********************* SetParameterObject *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::SetParameterObject( ParameterObjectType * parameterObject )
+{
+  this->SetInput( "ParameterObject", parameterObject );
+} // end SetParameterObject()
+
+
+/**
+ * ********************* GetParameterObject *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixBatchFilter< TFixedImage, TMovingImage >::ParameterObjectType *
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetParameterObject( void )
+{
+  return itkDynamicCastInDebugMode< ParameterObjectType * >( itk::ProcessObject::GetInput( "ParameterObject" ) );
+} // end GetParameterObject()
+
+
+/**
+ * ********************* GetResultImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+TFixedImage *
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetResultImage( const unsigned int index )
+{
+  if( index >= this->m_ResultImages.size() )
+  {
+    itkExceptionMacro( "Result image " << index << " has not been generated. "
+      "Update() ElastixBatchFilter before requesting this output." );
+  }
+
+  return this->m_ResultImages[ index ];
+} // end GetResultImage()
+
+
+/**
+ * ********************* GetTransformParameterObject *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+typename ElastixBatchFilter< TFixedImage, TMovingImage >::ParameterObjectType *
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetTransformParameterObject( const unsigned int index )
+{
+  if( index >= this->m_TransformParameterObjects.size() )
+  {
+    itkExceptionMacro( "TransformParameterObject " << index << " has not been generated. "
+      "Update() ElastixBatchFilter before requesting this output." );
+  }
+
+  return this->m_TransformParameterObjects[ index ];
+} // end GetTransformParameterObject()
+
+
+/**
+ * ********************* GetMovingImageInputName *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+std::string
+ElastixBatchFilter< TFixedImage, TMovingImage >
+::GetMovingImageInputName( const unsigned int index )
+{
+  return "MovingImage" + std::to_string( index );
+} // end GetMovingImageInputName()
+
+
+} // namespace elx
+
+#endif // elxElastixBatchFilter_hxx
@@ -19,6 +19,7 @@
 #define elxElastixFilter_h
 
 #include "itkImageSource.h"
+#include "itkImportImageContainer.h"
 
 #include "elxElastixMain.h"
 #include "elxParameterObject.h"
@@ -57,6 +58,7 @@ public:
   typedef ElastixMainType::ArgumentMapType          ArgumentMapType;
   typedef ArgumentMapType::value_type               ArgumentMapEntryType;
   typedef ElastixMainType::FlatDirectionCosinesType FlatDirectionCosinesType;
+  typedef ElastixMainType::ImagePyramidCacheType    ImagePyramidCacheType;
 
   typedef ElastixMainType::DataObjectContainerType           DataObjectContainerType;
   typedef ElastixMainType::DataObjectContainerPointer        DataObjectContainerPointer;
@@ -77,6 +79,17 @@ public:
   typedef typename TMovingImage::Pointer      MovingImagePointer;
   typedef typename TMovingImage::ConstPointer MovingImageConstPointer;
 
+  typedef typename TFixedImage::PixelType      FixedImagePixelType;
+  typedef typename TFixedImage::SizeType       FixedImageSizeType;
+  typedef typename TFixedImage::SpacingType    FixedImageSpacingType;
+  typedef typename TFixedImage::PointType      FixedImagePointType;
+  typedef typename TFixedImage::DirectionType  FixedImageDirectionType;
+  typedef typename TMovingImage::PixelType     MovingImagePixelType;
+  typedef typename TMovingImage::SizeType      MovingImageSizeType;
+  typedef typename TMovingImage::SpacingType   MovingImageSpacingType;
+  typedef typename TMovingImage::PointType     MovingImagePointType;
+  typedef typename TMovingImage::DirectionType MovingImageDirectionType;
+
   itkStaticConstMacro( FixedImageDimension, unsigned int, TFixedImage::ImageDimension );
   itkStaticConstMacro( MovingImageDimension, unsigned int, TMovingImage::ImageDimension );
 
@@ -94,6 +107,23 @@ public:
   FixedImageConstPointer GetFixedImage( const unsigned int index ) const;
   unsigned int GetNumberOfFixedImages( void ) const;
 
+  /** Set/Add a fixed image from a pixel buffer of the caller, without
+   * copying it. The buffer holds the pixels in ITK order (x fastest), and
+   * is wrapped by an image with the specified geometry. elastix only reads
+   * the pixels.
+   *
+   * The caller keeps owning the buffer: it is never freed by elastix. The
+   * buffer must stay valid, and must not be modified, as long as the image
+   * is an input of this filter, so until it is replaced or removed, or the
+   * filter is destroyed. The outputs of the filter do not refer to it.
+   */
+  virtual void SetFixedImageBuffer( const FixedImagePixelType * buffer,
+    const FixedImageSizeType & size, const FixedImageSpacingType & spacing,
+    const FixedImagePointType & origin, const FixedImageDirectionType & direction );
+  virtual void AddFixedImageBuffer( const FixedImagePixelType * buffer,
+    const FixedImageSizeType & size, const FixedImageSpacingType & spacing,
+    const FixedImagePointType & origin, const FixedImageDirectionType & direction );
+
   /** Set/Add/Get/NumberOf moving images. */
   virtual void SetMovingImage( TMovingImage * movingImages );
   virtual void AddMovingImage( TMovingImage * movingImage );
@@ -101,6 +131,16 @@ public:
   MovingImageConstPointer GetMovingImage( const unsigned int index ) const;
   unsigned int GetNumberOfMovingImages( void ) const;
 
+  /** Set/Add a moving image from a pixel buffer of the caller, without
+   * copying it. The same rules apply as for SetFixedImageBuffer().
+   */
+  virtual void SetMovingImageBuffer( const MovingImagePixelType * buffer,
+    const MovingImageSizeType & size, const MovingImageSpacingType & spacing,
+    const MovingImagePointType & origin, const MovingImageDirectionType & direction );
+  virtual void AddMovingImageBuffer( const MovingImagePixelType * buffer,
+    const MovingImageSizeType & size, const MovingImageSpacingType & spacing,
+    const MovingImagePointType & origin, const MovingImageDirectionType & direction );
+
   /** Set/Add/Get/Remove/NumberOf fixed masks. */
   virtual void AddFixedMask( FixedMaskType * fixedMask );
   virtual void SetFixedMask( FixedMaskType * fixedMask );
@@ -165,6 +205,13 @@ public:
   itkSetMacro( NumberOfThreads, int );
   itkGetMacro( NumberOfThreads, int );
 
+  /** Set/Get the cache of the fixed image pyramids. Registrations of the same
+   * fixed image(s) with the same parameter object may share a cache, so that
+   * they compute the fixed image pyramids only once. Null by default.
+   */
+  itkSetObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+  itkGetModifiableObjectMacro( ImagePyramidCache, ImagePyramidCacheType );
+
 protected:
 
   ElastixFilter( void );
@@ -176,6 +223,21 @@ private:
   ElastixFilter( const Self & );  // purposely not implemented
   void operator=( const Self & ); // purposely not implemented
 
+  /** Wraps a pixel buffer of the caller in an image, without copying it. */
+  template< typename TImage >
+  static typename TImage::Pointer WrapImageBuffer( const typename TImage::PixelType * buffer,
+    const typename TImage::SizeType & size, const typename TImage::SpacingType & spacing,
+    const typename TImage::PointType & origin, const typename TImage::DirectionType & direction );
+
+  /** Returns the image as an image of the internal pixel type of elastix.
+   * The image itself is returned if its pixel type is the internal pixel
+   * type already, so then nothing is copied. Otherwise, if the internal
+   * pixel type is float, a copy that is cast to float is returned.
+   */
+  template< typename TImage >
+  static itk::DataObject::Pointer ConvertToInternalImage( itk::DataObject * image,
+    const std::string & internalPixelType );
+
   /** MakeUniqueName. */
   std::string MakeUniqueName( const DataObjectIdentifierType & key );
 
@@ -200,6 +262,8 @@ private:
 
   int m_NumberOfThreads;
 
+  ImagePyramidCacheType::Pointer m_ImagePyramidCache;
+
   unsigned int m_InputUID;
 
 };
@@ -18,6 +18,8 @@
 #ifndef elxElastixFilter_hxx
 #define elxElastixFilter_hxx
 
+#include "itkCastImageFilter.h"
+
 namespace elastix
 {
 
@@ -74,6 +76,29 @@ ElastixFilter< TFixedImage, TMovingImage >
   const unsigned int fixedImageDimension = FixedImageDimension;
   const unsigned int movingImageDimension = MovingImageDimension;
 
+  // Get the parameter maps
+  ParameterObjectPointer parameterObject    = itkDynamicCastInDebugMode< ParameterObject * >( this->GetInput( "ParameterObject" ) );
+  ParameterMapVectorType parameterMapVector = parameterObject->GetParameterMap();
+
+  if( parameterMapVector.size() == 0 )
+  {
+    itkExceptionMacro( "Empty parameter map in parameter object." );
+  }
+
+  // The internal pixel types of elastix, to which the input images are converted
+  std::string fixedInternalPixelType  = "float";
+  std::string movingInternalPixelType = "float";
+  if( parameterMapVector[ 0 ].count( "FixedInternalImagePixelType" )
+    && !parameterMapVector[ 0 ][ "FixedInternalImagePixelType" ].empty() )
+  {
+    fixedInternalPixelType = parameterMapVector[ 0 ][ "FixedInternalImagePixelType" ][ 0 ];
+  }
+  if( parameterMapVector[ 0 ].count( "MovingInternalImagePixelType" )
+    && !parameterMapVector[ 0 ][ "MovingInternalImagePixelType" ].empty() )
+  {
+    movingInternalPixelType = parameterMapVector[ 0 ][ "MovingInternalImagePixelType" ][ 0 ];
+  }
+
   DataObjectContainerPointer fixedImageContainer  = DataObjectContainerType::New();
   DataObjectContainerPointer movingImageContainer = DataObjectContainerType::New();
   DataObjectContainerPointer fixedMaskContainer   = nullptr;
@@ -89,13 +114,15 @@ ElastixFilter< TFixedImage, TMovingImage >
   {
     if( this->IsInputOfType( "FixedImage", inputNames[ i ] ) )
     {
-      fixedImageContainer->push_back( this->GetInput( inputNames[ i ] ) );
+      fixedImageContainer->push_back( ConvertToInternalImage< TFixedImage >(
+        this->GetInput( inputNames[ i ] ), fixedInternalPixelType ) );
       continue;
     }
 
     if( this->IsInputOfType( "MovingImage", inputNames[ i ] ) )
     {
-      movingImageContainer->push_back( this->GetInput( inputNames[ i ] ) );
+      movingImageContainer->push_back( ConvertToInternalImage< TMovingImage >(
+        this->GetInput( inputNames[ i ] ), movingInternalPixelType ) );
       continue;
     }
 
@@ -121,15 +148,6 @@ ElastixFilter< TFixedImage, TMovingImage >
     }
   }
 
-  // Set ParameterMap
-  ParameterObjectPointer parameterObject    = itkDynamicCastInDebugMode< ParameterObject * >( this->GetInput( "ParameterObject" ) );
-  ParameterMapVectorType parameterMapVector = parameterObject->GetParameterMap();
-
-  if( parameterMapVector.size() == 0 )
-  {
-    itkExceptionMacro( "Empty parameter map in parameter object." );
-  }
-
   // Elastix must always write result image to guarantee that the ITK pipeline is in a consistent state
   parameterMapVector[ parameterMapVector.size() - 1 ][ "WriteResultImage" ] = ParameterValueVectorType( 1, "true" );
 
@@ -198,8 +216,9 @@ ElastixFilter< TFixedImage, TMovingImage >
     argumentMap.insert( ArgumentMapEntryType( "-threads", std::to_string( this->m_NumberOfThreads ) ) );
   }
 
-  // Setup xout
-  if( elx::xoutSetup( logFileName.c_str(), this->GetLogToFile(), this->GetLogToConsole() ) )
+  // Setup an xout for this thread only, so that filters can run concurrently
+  elx::xoutManager threadXout;
+  if( threadXout.Setup( logFileName, this->GetLogToFile(), this->GetLogToConsole() ) )
   {
     itkExceptionMacro( "Error while setting up xout" );
   }
@@ -237,6 +256,9 @@ ElastixFilter< TFixedImage, TMovingImage >
     elastix->SetResultImageContainer( resultImageContainer );
     elastix->SetOriginalFixedImageDirectionFlat( fixedImageOriginalDirection );
 
+    // Share the fixed image pyramids, if a cache is set
+    elastix->SetImagePyramidCache( this->m_ImagePyramidCache );
+
     // Start registration
     unsigned int isError = 0;
     try
@@ -396,6 +418,38 @@ ElastixFilter< TFixedImage, TMovingImage >
 } // end AddFixedImage()
 
 
+/**
+ * ********************* SetFixedImageBuffer *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::SetFixedImageBuffer( const FixedImagePixelType * buffer,
+  const FixedImageSizeType & size, const FixedImageSpacingType & spacing,
+  const FixedImagePointType & origin, const FixedImageDirectionType & direction )
+{
+  FixedImagePointer fixedImage = WrapImageBuffer< TFixedImage >( buffer, size, spacing, origin, direction );
+  this->SetFixedImage( fixedImage );
+} // end SetFixedImageBuffer()
+
+
+/**
+ * ********************* AddFixedImageBuffer *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::AddFixedImageBuffer( const FixedImagePixelType * buffer,
+  const FixedImageSizeType & size, const FixedImageSpacingType & spacing,
+  const FixedImagePointType & origin, const FixedImageDirectionType & direction )
+{
+  FixedImagePointer fixedImage = WrapImageBuffer< TFixedImage >( buffer, size, spacing, origin, direction );
+  this->AddFixedImage( fixedImage );
+} // end AddFixedImageBuffer()
+
+
 /**
  * ********************* GetFixedImage *********************
  */
@@ -491,6 +545,38 @@ ElastixFilter< TFixedImage, TMovingImage >
 } // end AddMovingImage()
 
 
+/**
+ * ********************* SetMovingImageBuffer *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::SetMovingImageBuffer( const MovingImagePixelType * buffer,
+  const MovingImageSizeType & size, const MovingImageSpacingType & spacing,
+  const MovingImagePointType & origin, const MovingImageDirectionType & direction )
+{
+  MovingImagePointer movingImage = WrapImageBuffer< TMovingImage >( buffer, size, spacing, origin, direction );
+  this->SetMovingImage( movingImage );
+} // end SetMovingImageBuffer()
+
+
+/**
+ * ********************* AddMovingImageBuffer *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+void
+ElastixFilter< TFixedImage, TMovingImage >
+::AddMovingImageBuffer( const MovingImagePixelType * buffer,
+  const MovingImageSizeType & size, const MovingImageSpacingType & spacing,
+  const MovingImagePointType & origin, const MovingImageDirectionType & direction )
+{
+  MovingImagePointer movingImage = WrapImageBuffer< TMovingImage >( buffer, size, spacing, origin, direction );
+  this->AddMovingImage( movingImage );
+} // end AddMovingImageBuffer()
+
+
 /**
  * ********************* GetMovingImage *********************
  */
@@ -773,6 +859,70 @@ ElastixFilter< TFixedImage, TMovingImage >
 } // end RemoveLogFileName()
 
 
+/**
+ * ********************* WrapImageBuffer *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+template< typename TImage >
+typename TImage::Pointer
+ElastixFilter< TFixedImage, TMovingImage >
+::WrapImageBuffer( const typename TImage::PixelType * buffer,
+  const typename TImage::SizeType & size, const typename TImage::SpacingType & spacing,
+  const typename TImage::PointType & origin, const typename TImage::DirectionType & direction )
+{
+  if( buffer == nullptr )
+  {
+    itkGenericExceptionMacro( "The image buffer is null." );
+  }
+
+  typename TImage::Pointer image = TImage::New();
+  image->SetRegions( size );
+  image->SetSpacing( spacing );
+  image->SetOrigin( origin );
+  image->SetDirection( direction );
+
+  /** The container does not manage the memory, so it never frees the
+   * buffer of the caller. The const_cast is safe, because elastix does not
+   * write to its input images.
+   */
+  typename TImage::PixelContainerPointer pixelContainer = TImage::PixelContainer::New();
+  pixelContainer->SetImportPointer( const_cast< typename TImage::PixelType * >( buffer ),
+    image->GetLargestPossibleRegion().GetNumberOfPixels(), false );
+  image->SetPixelContainer( pixelContainer );
+
+  return image;
+} // end WrapImageBuffer()
+
+
+/**
+ * ********************* ConvertToInternalImage *********************
+ */
+
+template< typename TFixedImage, typename TMovingImage >
+template< typename TImage >
+itk::DataObject::Pointer
+ElastixFilter< TFixedImage, TMovingImage >
+::ConvertToInternalImage( itk::DataObject * image, const std::string & internalPixelType )
+{
+  if( internalPixelType != "float"
+    || internalPixelType == PixelType< typename TImage::PixelType >::ToString() )
+  {
+    return image;
+  }
+
+  typedef itk::Image< float, TImage::ImageDimension >      InternalImageType;
+  typedef itk::CastImageFilter< TImage, InternalImageType > CastFilterType;
+  typename CastFilterType::Pointer castFilter = CastFilterType::New();
+  castFilter->SetInput( itkDynamicCastInDebugMode< TImage * >( image ) );
+  castFilter->Update();
+
+  typename InternalImageType::Pointer internalImage = castFilter->GetOutput();
+  internalImage->DisconnectPipeline();
+  return internalImage.GetPointer();
+} // end ConvertToInternalImage()
+
+
 /**
  * ********************* MakeUniqueName *********************
  */
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __elxServerProtocol_h
+#define __elxServerProtocol_h
+
+/**
+ * The protocol between elastixserver and elastixclient.
+ *
+ * The client connects to the Unix domain socket of the server, and sends a
+ * request: one line with the command ("elastix", "transformix", "status" or
+ * "shutdown"), followed by the command line arguments of the job, one per
+ * line, and terminated by an empty line. The server answers with a single
+ * line, and closes the connection. For "elastix" and "transformix" the
+ * answer is the return code of the job, which is sent when the job has
+ * finished. For "status" it is a description of the state of the server.
+ */
+
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace elastix
+{
+
+/** Fill a socket address for the socket file. Returns false if the
+ * file name is too long.
+ */
+inline bool
+ServerSocketAddress( const std::string & socketFileName, sockaddr_un & address )
+{
+  std::memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+  if( socketFileName.empty() || socketFileName.size() >= sizeof( address.sun_path ) )
+  {
+    return false;
+  }
+  std::strncpy( address.sun_path, socketFileName.c_str(), sizeof( address.sun_path ) - 1 );
+  return true;
+}
+
+
+/** Write a string to the socket. Returns false on failure. */
+inline bool
+ServerWrite( const int socket, const std::string & message )
+{
+  std::size_t written = 0;
+  while( written < message.size() )
+  {
+    const ssize_t n = ::write( socket, message.c_str() + written, message.size() - written );
+    if( n < 0 && errno == EINTR )
+    {
+      continue;
+    }
+    if( n <= 0 )
+    {
+      return false;
+    }
+    written += static_cast< std::size_t >( n );
+  }
+  return true;
+}
+
+
+/** Read one line from the socket, without the newline.
+ * Returns false on failure, or if the connection was closed.
+ */
+inline bool
+ServerReadLine( const int socket, std::string & line )
+{
+  line.clear();
+  char c = 0;
+  while( true )
+  {
+    const ssize_t n = ::read( socket, &c, 1 );
+    if( n < 0 && errno == EINTR )
+    {
+      continue;
+    }
+    if( n <= 0 )
+    {
+      return false;
+    }
+    if( c == '\n' )
+    {
+      return true;
+    }
+    line += c;
+  }
+}
+
+
+/** Send a request: the command, followed by its arguments. */
+inline bool
+ServerSendRequest( const int socket, const std::vector< std::string > & request )
+{
+  std::string message;
+  for( std::size_t i = 0; i < request.size(); ++i )
+  {
+    message += request[ i ] + "\n";
+  }
+  message += "\n";
+  return ServerWrite( socket, message );
+}
+
+
+/** Receive a request: the command, followed by its arguments. */
+inline bool
+ServerReceiveRequest( const int socket, std::vector< std::string > & request )
+{
+  request.clear();
+  std::string line;
+  while( ServerReadLine( socket, line ) )
+  {
+    if( line.empty() )
+    {
+      return !request.empty();
+    }
+    request.push_back( line );
+  }
+  return false;
+}
+
+
+} // end namespace elastix
+
+#endif // end #ifndef __elxServerProtocol_h
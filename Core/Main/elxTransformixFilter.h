@@ -19,6 +19,8 @@
 #define elxTransformixFilter_h
 
 #include "itkImageSource.h"
+#include "itkDefaultStaticMeshTraits.h"
+#include "itkPointSet.h"
 
 #include "elxTransformixMain.h"
 #include "elxParameterObject.h"
@@ -76,16 +78,45 @@ public:
 
   itkStaticConstMacro( MovingImageDimension, unsigned int, TMovingImage::ImageDimension );
 
+  /** The type of the point sets that are transformed in memory. It equals
+   * the PointSetType of the elastix TransformBase.
+   */
+  typedef itk::DefaultStaticMeshTraits< unsigned char,
+    TMovingImage::ImageDimension, TMovingImage::ImageDimension, double > PointSetMeshTraitsType;
+  typedef itk::PointSet< unsigned char,
+    TMovingImage::ImageDimension, PointSetMeshTraitsType >              PointSetType;
+
   /** Set/Get/Add moving image. */
   virtual void SetMovingImage( TMovingImage * inputImage );
   InputImageConstPointer GetMovingImage( void );
   virtual void RemoveMovingImage( void );
 
+  /** Add/Get moving images. All moving images are resampled with the same
+   * transform, in a single pass. Result image i is GetResultImage( i ),
+   * which is GetOutput() for i = 0. The ResultImagePixelType is that of
+   * TMovingImage, and entry i of ResampleInterpolator is used for moving
+   * image i, if present.
+   */
+  virtual void AddMovingImage( TMovingImage * inputImage );
+  InputImageConstPointer GetMovingImage( const unsigned int index );
+  unsigned int GetNumberOfMovingImages( void ) const;
+  OutputImageType * GetResultImage( const unsigned int index );
+
   /** Set/Get/Remove moving point set filename. */
   itkSetMacro( FixedPointSetFileName, std::string );
   itkGetMacro( FixedPointSetFileName, std::string );
   virtual void RemoveFixedPointSetFileName() { this->SetFixedPointSetFileName( "" ); }
 
+  /** Set/Get/Remove the fixed point set, as an alternative to SetFixedPointSetFileName().
+   * The points are given in world coordinates, and transformed in parallel,
+   * without reading or writing a point file. After Update(), the transformed
+   * points are returned by GetResultPointSet().
+   */
+  itkSetConstObjectMacro( FixedPointSet, PointSetType );
+  itkGetConstObjectMacro( FixedPointSet, PointSetType );
+  virtual void RemoveFixedPointSet() { this->SetFixedPointSet( nullptr ); }
+  itkGetConstObjectMacro( ResultPointSet, PointSetType );
+
   /** Compute spatial Jacobian On/Off. */
   itkSetMacro( ComputeSpatialJacobian, bool );
   itkGetConstMacro( ComputeSpatialJacobian, bool );
@@ -101,6 +132,11 @@ public:
   itkGetConstMacro( ComputeDeformationField, bool );
   itkBooleanMacro( ComputeDeformationField );
 
+  /** Compute the deformation field of the inverse transform On/Off. */
+  itkSetMacro( ComputeInverseDeformationField, bool );
+  itkGetConstMacro( ComputeInverseDeformationField, bool );
+  itkBooleanMacro( ComputeInverseDeformationField );
+
   /** Get/Set transform parameter object. */
   virtual void SetTransformParameterObject( ParameterObjectPointer transformParameterObject );
 
@@ -155,6 +191,9 @@ private:
   /** IsEmpty. */
   static bool IsEmpty( const InputImagePointer inputImage );
 
+  /** The name of input or output i of a type: e.g. "InputImage", "InputImage1", ... */
+  static DataObjectIdentifierType MakeIndexedName( const DataObjectIdentifierType & name, const unsigned int index );
+
   /** Tell the compiler we want all definitions of Get/Set/Remove
    *  from ProcessObject and TransformixFilter.
    */
@@ -163,9 +202,14 @@ private:
   using itk::ProcessObject::RemoveInput;
 
   std::string m_FixedPointSetFileName;
+
+  typename PointSetType::ConstPointer m_FixedPointSet;
+  typename PointSetType::Pointer      m_ResultPointSet;
+
   bool        m_ComputeSpatialJacobian;
   bool        m_ComputeDeterminantOfSpatialJacobian;
   bool        m_ComputeDeformationField;
+  bool        m_ComputeInverseDeformationField;
 
   std::string m_OutputDirectory;
   std::string m_LogFileName;
@@ -37,6 +37,7 @@ TransformixFilter< TMovingImage >
   this->m_ComputeSpatialJacobian              = false;
   this->m_ComputeDeterminantOfSpatialJacobian = false;
   this->m_ComputeDeformationField             = false;
+  this->m_ComputeInverseDeformationField      = false;
 
   this->m_OutputDirectory = "";
   this->m_LogFileName     = "";
@@ -64,15 +65,19 @@ TransformixFilter< TMovingImage >
 
   if( this->IsEmpty( itkDynamicCastInDebugMode< TMovingImage* >( this->GetInput( "InputImage" ) ) ) &&
       this->GetFixedPointSetFileName().empty() &&
+      this->m_FixedPointSet.IsNull() &&
       !this->GetComputeSpatialJacobian() &&
       !this->GetComputeDeterminantOfSpatialJacobian() &&
-      !this->GetComputeDeformationField() )
+      !this->GetComputeDeformationField() &&
+      !this->GetComputeInverseDeformationField() )
   {
     itkExceptionMacro( "Expected at least one of SeTMovingImage(), "
-                    << "SetFixedPointSetFileName() "
+                    << "SetFixedPointSetFileName(), "
+                    << "SetFixedPointSet(), "
                     << "ComputeSpatialJacobianOn(), "
-                    << "ComputeDeterminantOfSpatialJacobianOn() or "
-                    << "ComputeDeformationFieldOn(), "
+                    << "ComputeDeterminantOfSpatialJacobianOn(), "
+                    << "ComputeDeformationFieldOn() or "
+                    << "ComputeInverseDeformationFieldOn(), "
                     << "to be active.\"" );
   }
 
@@ -84,6 +89,13 @@ TransformixFilter< TMovingImage >
                        << "or SetFixedPointSetFileName() can be active at any one time." )
   }
 
+  if( this->m_FixedPointSet.IsNotNull() && !this->GetFixedPointSetFileName().empty() )
+  {
+    itkExceptionMacro( << "Only one of SetFixedPointSet() or SetFixedPointSetFileName() "
+                       << "can be active at any one time." )
+  }
+  this->m_ResultPointSet = nullptr;
+
   // Setup argument map which transformix uses internally ito figure out what needs to be done
   ArgumentMapType argumentMap;
 
@@ -102,6 +114,11 @@ TransformixFilter< TMovingImage >
     argumentMap.insert( ArgumentMapEntryType( "-def", "all" ) );
   }
 
+  if( this->GetComputeInverseDeformationField() )
+  {
+    argumentMap.insert( ArgumentMapEntryType( "-inv", "all" ) );
+  }
+
   if( !this->GetFixedPointSetFileName().empty() )
   {
     argumentMap.insert( ArgumentMapEntryType( "-def", this->GetFixedPointSetFileName() ) );
@@ -112,6 +129,7 @@ TransformixFilter< TMovingImage >
   if( ( this->GetComputeSpatialJacobian()
     || this->GetComputeDeterminantOfSpatialJacobian()
     || this->GetComputeDeformationField()
+    || this->GetComputeInverseDeformationField()
     || !this->GetFixedPointSetFileName().empty()
     || this->GetLogToFile() )
     && this->GetOutputDirectory().empty() )
@@ -154,8 +172,9 @@ TransformixFilter< TMovingImage >
     }
   }
 
-  // Setup xout
-  if( elx::xoutSetup( logFileName.c_str(), this->GetLogToFile(), this->GetLogToConsole() ) )
+  // Setup an xout for this thread only, so that filters can run concurrently
+  elx::xoutManager threadXout;
+  if( threadXout.Setup( logFileName, this->GetLogToFile(), this->GetLogToConsole() ) )
   {
     itkExceptionMacro( "Error while setting up xout" );
   }
@@ -163,14 +182,24 @@ TransformixFilter< TMovingImage >
   // Instantiate transformix
   TransformixMainPointer transformix = TransformixMainType::New();
 
-  // Setup transformix for warping input image if given
+  // Setup transformix for warping input images if given, all in a single pass
   DataObjectContainerPointer inputImageContainer = nullptr;
+  const unsigned int numberOfMovingImages = this->GetNumberOfMovingImages();
   if( !this->IsEmpty( itkDynamicCastInDebugMode< TMovingImage* >( this->GetInput( "InputImage" ) ) ) ) {
     inputImageContainer = DataObjectContainerType::New();
-    inputImageContainer->CreateElementAt( 0 ) = this->GetInput( "InputImage" );
+    for( unsigned int i = 0; i < numberOfMovingImages; ++i )
+    {
+      inputImageContainer->CreateElementAt( i ) = this->GetInput( this->MakeIndexedName( "InputImage", i ) );
+    }
     transformix->SetInputImageContainer( inputImageContainer );
   }
 
+  // Setup transformix for transforming the fixed point set in memory, if given
+  if( this->m_FixedPointSet.IsNotNull() )
+  {
+    transformix->SetInputPointSet( const_cast< PointSetType * >( this->m_FixedPointSet.GetPointer() ) );
+  }
+
   // Get ParameterMap
   ParameterObjectPointer transformParameterObject = itkDynamicCastInDebugMode< ParameterObject * >( this->GetInput( "TransformParameterObject" ) );
   ParameterMapVectorType transformParameterMapVector = transformParameterObject->GetParameterMap();
@@ -214,12 +243,30 @@ TransformixFilter< TMovingImage >
     itkExceptionMacro( "Internal transformix error: See transformix log (use LogToConsoleOn() or LogToFileOn())" );
   }
 
-  // Save result image
+  // Save result images
   DataObjectContainerPointer resultImageContainer = transformix->GetResultImageContainer();
-  if( resultImageContainer.IsNotNull() && resultImageContainer->Size() > 0 && resultImageContainer->ElementAt( 0 ).IsNotNull()  )
+  if( resultImageContainer.IsNotNull() )
+  {
+    for( unsigned int i = 0; i < resultImageContainer->Size() && i < numberOfMovingImages; ++i )
+    {
+      if( resultImageContainer->ElementAt( i ).IsNotNull() )
+      {
+        this->GraftOutput( this->MakeIndexedName( "ResultImage", i ), resultImageContainer->ElementAt( i ) );
+      }
+    }
+  }
+  // Save the transformed points. Transformix only logs errors while transforming
+  // points, so check here whether it succeeded.
+  if( this->m_FixedPointSet.IsNotNull() )
   {
-    this->GraftOutput( "ResultImage", resultImageContainer->ElementAt( 0 ) );
+    this->m_ResultPointSet = dynamic_cast< PointSetType * >( transformix->GetModifiableResultPointSet() );
+    if( this->m_ResultPointSet.IsNull() )
+    {
+      itkExceptionMacro( "Error while transforming the fixed point set: See transformix log "
+                      << "(use LogToConsoleOn() or LogToFileOn())" );
+    }
   }
+
   // Optionally, save result deformation field
   DataObjectContainerPointer resultDeformationFieldContainer = transformix->GetResultDeformationFieldContainer();
   if ( resultDeformationFieldContainer.IsNotNull() && resultDeformationFieldContainer->Size() > 0 && resultDeformationFieldContainer->ElementAt( 0 ).IsNotNull()  )
@@ -353,6 +400,12 @@ TransformixFilter< TMovingImage >
 
   outputPtr->SetNumberOfComponentsPerPixel( 1 );
   outputOutputDeformationFieldPtr->SetNumberOfComponentsPerPixel( TMovingImage::ImageDimension );
+
+  // The result images of the other moving images are on the same grid
+  for( unsigned int i = 1; i < this->GetNumberOfMovingImages(); ++i )
+  {
+    this->GetResultImage( i )->CopyInformation( outputPtr );
+  }
 } // end GenerateOutputInformation()
 
 
@@ -365,6 +418,7 @@ void
 TransformixFilter< TMovingImage >
 ::SetMovingImage( TMovingImage * inputImage )
 {
+  this->RemoveMovingImage();
   this->SetInput( "InputImage", inputImage );
 } // end SetMovingImage()
 
@@ -391,10 +445,98 @@ void
 TransformixFilter< TMovingImage >
 ::RemoveMovingImage( void )
 {
+  for( unsigned int i = this->GetNumberOfMovingImages(); i > 1; --i )
+  {
+    this->RemoveInput( this->MakeIndexedName( "InputImage", i - 1 ) );
+    this->RemoveOutput( this->MakeIndexedName( "ResultImage", i - 1 ) );
+  }
   this->RemoveInput( "InputImage" );
 } // end RemoveMovingImage
 
 
+/**
+ * ********************* AddMovingImage *********************
+ */
+
+template< typename TMovingImage >
+void
+TransformixFilter< TMovingImage >
+::AddMovingImage( TMovingImage * inputImage )
+{
+  const unsigned int index = this->GetNumberOfMovingImages();
+  if( index == 0 )
+  {
+    this->SetMovingImage( inputImage );
+  }
+  else
+  {
+    this->SetInput( this->MakeIndexedName( "InputImage", index ), inputImage );
+    this->SetOutput( this->MakeIndexedName( "ResultImage", index ),
+      this->MakeOutput( this->MakeIndexedName( "ResultImage", index ) ) );
+  }
+} // end AddMovingImage()
+
+
+/**
+ * ********************* GetMovingImage *********************
+ */
+
+template< typename TMovingImage >
+typename TransformixFilter< TMovingImage >::InputImageConstPointer
+TransformixFilter< TMovingImage >
+::GetMovingImage( const unsigned int index )
+{
+  if( index >= this->GetNumberOfMovingImages() )
+  {
+    itkExceptionMacro( << "Index exceeds the number of moving images (index: "
+                       << index << ", "
+                       << "number of moving images: " << this->GetNumberOfMovingImages() << ")" );
+  }
+
+  return itkDynamicCastInDebugMode< TMovingImage * >(
+    this->GetInput( this->MakeIndexedName( "InputImage", index ) ) );
+} // end GetMovingImage()
+
+
+/**
+ * ********************* GetNumberOfMovingImages *********************
+ */
+
+template< typename TMovingImage >
+unsigned int
+TransformixFilter< TMovingImage >
+::GetNumberOfMovingImages( void ) const
+{
+  unsigned int n = 0;
+  while( this->GetInput( this->MakeIndexedName( "InputImage", n ) ) != ITK_NULLPTR )
+  {
+    ++n;
+  }
+  return n;
+} // end GetNumberOfMovingImages()
+
+
+/**
+ * ********************* GetResultImage *********************
+ */
+
+template< typename TMovingImage >
+typename TransformixFilter< TMovingImage >::OutputImageType *
+TransformixFilter< TMovingImage >
+::GetResultImage( const unsigned int index )
+{
+  if( index > 0 && index >= this->GetNumberOfMovingImages() )
+  {
+    itkExceptionMacro( << "Index exceeds the number of result images (index: "
+                       << index << ", "
+                       << "number of moving images: " << this->GetNumberOfMovingImages() << ")" );
+  }
+
+  return itkDynamicCastInDebugMode< OutputImageType * >(
+    this->itk::ProcessObject::GetOutput( this->MakeIndexedName( "ResultImage", index ) ) );
+} // end GetResultImage()
+
+
 /**
  * ********************* SetTransformParameterObject *********************
  */
@@ -479,6 +621,19 @@ TransformixFilter< TMovingImage >
 } // end IsEmpty()
 
 
+/**
+* ********************* MakeIndexedName ****************************
+*/
+
+template< typename TMovingImage >
+typename TransformixFilter< TMovingImage >::DataObjectIdentifierType
+TransformixFilter< TMovingImage >
+::MakeIndexedName( const DataObjectIdentifierType & name, const unsigned int index )
+{
+  return index == 0 ? name : name + std::to_string( index );
+} // end MakeIndexedName()
+
+
 /**
  * ********************* SetLogFileName ****************************
  */
@@ -17,6 +17,9 @@
  *=========================================================================*/
 #include "itkSmartPointer.h"
 #include "itkArray.h"
+#include "itkParameterUpdateKernels.h"
+#include <cmath>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <iomanip>
@@ -243,6 +246,12 @@ public:
 // end class Optimizer
 
 //-------------------------------------------------------------------------------------
+// This benchmark compares the different implementations of the gradient descent
+// update mu_{k+1} = mu_k - a_k * g_k: a plain loop, ITK threads, OpenMP, Eigen,
+// and the ParameterUpdateKernels that are used by the elastix optimizers. It also
+// compares the fused AdaGrad kernel with the separate passes over the parameters.
+// The results of the kernels are checked against the plain loop.
+// Run with the argument "-full" for the full number of repetitions.
 
 int
 main( int argc, char * argv[] )
@@ -253,11 +262,16 @@ main( int argc, char * argv[] )
             << "\n\n" << std::endl;
 
   /** Typedefs. */
-  typedef OptimizerTEMP                  OptimizerClass;
-  typedef OptimizerClass::ParametersType ParametersType;
+  typedef OptimizerTEMP                         OptimizerClass;
+  typedef OptimizerClass::ParametersType        ParametersType;
+  typedef itk::ParameterUpdateKernels           KernelsType;
+  typedef KernelsType::ArrayType                ArrayType;
 
   OptimizerClass::Pointer optimizer = OptimizerClass::New();
 
+  /** Check for full testing. */
+  const bool fullTesting = argc > 1 && std::string( argv[ 1 ] ) == "-full";
+
   // test parameters
   std::vector< unsigned int > arraySizes;
   arraySizes.push_back( 1e2 ); arraySizes.push_back( 1e3 ); arraySizes.push_back( 1e4 );
@@ -273,7 +287,7 @@ main( int argc, char * argv[] )
 
     /** Setup. */
     itk::TimeProbesCollectorBase timeCollector;
-    repetitions[ s ] = 1; // outcomment this line for full testing
+    if( !fullTesting ) { repetitions[ s ] = 1; }
 
     ParametersType newPos( arraySizes[ s ] );
     ParametersType curPos( arraySizes[ s ] );
@@ -344,10 +358,107 @@ main( int argc, char * argv[] )
     }
 #endif
 
+    /** Setup the arrays for the kernels. */
+    const double learningRate = 3.67;
+    ArrayType    kernelPos( arraySizes[ s ] );
+    ArrayType    kernelGradient( arraySizes[ s ] );
+    ArrayType    squaredGradientSum( arraySizes[ s ] );
+    ArrayType    searchDirection( arraySizes[ s ] );
+    ArrayType    referencePos( arraySizes[ s ] );
+    ArrayType    resultPos( arraySizes[ s ] );
+    for( unsigned int i = 0; i < arraySizes[ s ]; ++i )
+    {
+      kernelPos[ i ]      = 2.1 + 1e-3 * ( i % 97 );
+      kernelGradient[ i ] = 2.1 - 1e-3 * ( i % 89 );
+    }
+    squaredGradientSum.Fill( 0.0 );
+
+    /** Time the kernel, single-threaded and with the default number of threads. */
+    for( unsigned int i = 0; i < repetitions[ s ]; ++i )
+    {
+      timeCollector.Start( "Kernel (st)" );
+      KernelsType::GradientStep( resultPos, kernelPos, kernelGradient, learningRate, 1 );
+      timeCollector.Stop( "Kernel (st)" );
+    }
+    for( unsigned int i = 0; i < repetitions[ s ]; ++i )
+    {
+      timeCollector.Start( "Kernel (mt)" );
+      KernelsType::GradientStep( resultPos, kernelPos, kernelGradient, learningRate );
+      timeCollector.Stop( "Kernel (mt)" );
+    }
+
+    /** Time the AdaGrad update, with separate passes and fused. */
+    for( unsigned int i = 0; i < repetitions[ s ]; ++i )
+    {
+      timeCollector.Start( "AdaGrad (3 passes)" );
+      for( unsigned int j = 0; j < arraySizes[ s ]; ++j )
+      {
+        squaredGradientSum[ j ] += kernelGradient[ j ] * kernelGradient[ j ];
+      }
+      for( unsigned int j = 0; j < arraySizes[ s ]; ++j )
+      {
+        searchDirection[ j ] = kernelGradient[ j ] / std::sqrt( squaredGradientSum[ j ] + 1e-14 );
+      }
+      for( unsigned int j = 0; j < arraySizes[ s ]; ++j )
+      {
+        resultPos[ j ] = kernelPos[ j ] - learningRate * searchDirection[ j ];
+      }
+      timeCollector.Stop( "AdaGrad (3 passes)" );
+    }
+    for( unsigned int i = 0; i < repetitions[ s ]; ++i )
+    {
+      timeCollector.Start( "AdaGrad (fused)" );
+      KernelsType::AdaGradStep( resultPos, kernelPos, squaredGradientSum,
+        kernelGradient, searchDirection, learningRate, 1e-14 );
+      timeCollector.Stop( "AdaGrad (fused)" );
+    }
+
     // Report timings for this array size
     timeCollector.Report( std::cout, false, true );
     std::cout << std::endl;
 
+    /** Check the kernels against the plain loops. */
+    for( unsigned int j = 0; j < arraySizes[ s ]; ++j )
+    {
+      referencePos[ j ] = kernelPos[ j ] - learningRate * kernelGradient[ j ];
+    }
+    KernelsType::GradientStep( resultPos, kernelPos, kernelGradient, learningRate );
+    if( ( resultPos - referencePos ).inf_norm() > 1e-12 )
+    {
+      std::cerr << "ERROR: GradientStep() differs from the plain loop." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    /** The in-place update, as done by the optimizers. */
+    resultPos = kernelPos;
+    KernelsType::GradientStep( resultPos, resultPos, kernelGradient, learningRate );
+    if( ( resultPos - referencePos ).inf_norm() > 1e-12 )
+    {
+      std::cerr << "ERROR: the in-place GradientStep() differs from the plain loop." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    /** The preconditioned step and the fused inner product. */
+    ArrayType precondition( arraySizes[ s ] );
+    precondition.Fill( 0.5 );
+    KernelsType::PreconditionedGradientStep( resultPos, kernelPos, precondition,
+      kernelGradient, searchDirection, 2.0 * learningRate );
+    if( ( resultPos - referencePos ).inf_norm() > 1e-12 )
+    {
+      std::cerr << "ERROR: PreconditionedGradientStep() differs from the plain loop." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    ArrayType    previous = kernelPos;
+    const double referenceInnerProduct = inner_product( kernelPos, kernelGradient );
+    const double innerProduct = KernelsType::InnerProductAndCopy( previous, kernelGradient );
+    if( std::abs( innerProduct - referenceInnerProduct ) > 1e-10 * std::abs( referenceInnerProduct )
+      || previous != kernelGradient )
+    {
+      std::cerr << "ERROR: InnerProductAndCopy() differs from the plain loop." << std::endl;
+      return EXIT_FAILURE;
+    }
+
   } // end loop over array sizes
 
   return EXIT_SUCCESS;
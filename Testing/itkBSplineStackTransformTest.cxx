@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBSplineStackTransform.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test compares the batched TransformPoints() and GetJacobians() of the
+// BSplineStackTransform, which share the B-spline weights over the stack,
+// with the point-wise TransformPoint() and GetJacobian().
+
+int
+main( void )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double ScalarType;   // ScalarType double used in elastix
+
+  typedef itk::BSplineStackTransform<
+    ScalarType, Dimension, SplineOrder >                    StackTransformType;
+  typedef StackTransformType::BSplineSubTransformType    SubTransformType;
+  typedef StackTransformType::ParametersType             ParametersType;
+  typedef StackTransformType::InputPointType             InputPointType;
+  typedef StackTransformType::OutputPointType            OutputPointType;
+  typedef StackTransformType::JacobianType               JacobianType;
+  typedef StackTransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+  typedef SubTransformType::RegionType                   RegionType;
+  typedef SubTransformType::SizeType                     SizeType;
+  typedef SubTransformType::SpacingType                  SpacingType;
+  typedef SubTransformType::OriginType                   OriginType;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator MersenneTwisterType;
+
+  /** Settings. */
+  const unsigned int numberOfSubTransforms = 40;
+  const unsigned int numberOfLocations     = 5000;
+  const double       tolerance             = 1e-10;
+
+  /** Create the sub transform, with a grid of 12 x 12 control points
+   * covering the domain [0,100] x [0,100].
+   */
+  SubTransformType::Pointer subTransform = SubTransformType::New();
+  SizeType                  gridSize;
+  gridSize.Fill( 12 );
+  RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  SpacingType gridSpacing;
+  gridSpacing.Fill( 100.0 / 8.0 );
+  OriginType gridOrigin;
+  gridOrigin.Fill( -1.5 * gridSpacing[ 0 ] );
+  subTransform->SetGridRegion( gridRegion );
+  subTransform->SetGridSpacing( gridSpacing );
+  subTransform->SetGridOrigin( gridOrigin );
+
+  /** Create the stack transform. */
+  StackTransformType::Pointer stackTransform = StackTransformType::New();
+  stackTransform->SetNumberOfSubTransforms( numberOfSubTransforms );
+  stackTransform->SetStackOrigin( 0.0 );
+  stackTransform->SetStackSpacing( 1.0 );
+  stackTransform->SetAllSubTransforms( subTransform );
+
+  /** Set random parameters. */
+  MersenneTwisterType::Pointer randomNum = MersenneTwisterType::GetInstance();
+  randomNum->SetSeed( 1234 );
+  ParametersType parameters( stackTransform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = randomNum->GetUniformVariate( -5.0, 5.0 );
+  }
+  stackTransform->SetParameters( parameters );
+
+  if( !stackTransform->GetSubTransformsShareGrid() )
+  {
+    std::cerr << "ERROR: the sub transforms should share their grid." << std::endl;
+    return 1;
+  }
+
+  /** Create random locations, each evaluated at all time points. */
+  std::vector< std::vector< InputPointType > > locations( numberOfLocations );
+  for( unsigned int i = 0; i < numberOfLocations; ++i )
+  {
+    InputPointType point;
+    point[ 0 ] = randomNum->GetUniformVariate( -10.0, 110.0 );
+    point[ 1 ] = randomNum->GetUniformVariate( -10.0, 110.0 );
+    for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+    {
+      point[ Dimension - 1 ] = t;
+      locations[ i ].push_back( point );
+    }
+  }
+
+  /** Time and compare TransformPoint() and TransformPoints(). */
+  itk::TimeProbe                 timer1, timer2;
+  std::vector< OutputPointType > opps( numberOfSubTransforms );
+  std::vector< OutputPointType > oppsBatched;
+  double                         maxPointDifference = 0.0;
+  for( unsigned int i = 0; i < numberOfLocations; ++i )
+  {
+    timer1.Start();
+    for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+    {
+      opps[ t ] = stackTransform->TransformPoint( locations[ i ][ t ] );
+    }
+    timer1.Stop();
+
+    timer2.Start();
+    stackTransform->TransformPoints( locations[ i ], oppsBatched );
+    timer2.Stop();
+
+    for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+    {
+      maxPointDifference = std::max( maxPointDifference,
+        opps[ t ].EuclideanDistanceTo( oppsBatched[ t ] ) );
+    }
+  }
+
+  std::cerr << std::setprecision( 4 );
+  std::cerr << "TransformPoint()  computation time: " << timer1.GetMean() * numberOfLocations
+            << " s." << std::endl;
+  std::cerr << "TransformPoints() computation time: " << timer2.GetMean() * numberOfLocations
+            << " s." << std::endl;
+  std::cerr << "Maximum point difference: " << maxPointDifference << std::endl;
+
+  /** Time and compare GetJacobian() and GetJacobians(). */
+  itk::TimeProbe                            timer3, timer4;
+  std::vector< JacobianType >               jacs( numberOfSubTransforms );
+  std::vector< NonZeroJacobianIndicesType > nzjis( numberOfSubTransforms );
+  std::vector< JacobianType >               jacsBatched;
+  std::vector< NonZeroJacobianIndicesType > nzjisBatched;
+  double                                    maxJacobianDifference = 0.0;
+  bool                                      indicesEqual          = true;
+  for( unsigned int i = 0; i < numberOfLocations; ++i )
+  {
+    timer3.Start();
+    for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+    {
+      stackTransform->GetJacobian( locations[ i ][ t ], jacs[ t ], nzjis[ t ] );
+    }
+    timer3.Stop();
+
+    timer4.Start();
+    stackTransform->GetJacobians( locations[ i ], jacsBatched, nzjisBatched );
+    timer4.Stop();
+
+    for( unsigned int t = 0; t < numberOfSubTransforms; ++t )
+    {
+      indicesEqual &= ( nzjis[ t ] == nzjisBatched[ t ] );
+      maxJacobianDifference = std::max( maxJacobianDifference,
+        ( jacs[ t ] - jacsBatched[ t ] ).array_inf_norm() );
+    }
+  }
+
+  std::cerr << "GetJacobian()  computation time: " << timer3.GetMean() * numberOfLocations
+            << " s." << std::endl;
+  std::cerr << "GetJacobians() computation time: " << timer4.GetMean() * numberOfLocations
+            << " s." << std::endl;
+  std::cerr << "Maximum Jacobian difference: " << maxJacobianDifference << std::endl;
+
+  /** Check the results. */
+  if( maxPointDifference > tolerance )
+  {
+    std::cerr << "ERROR: TransformPoints() differs from TransformPoint()." << std::endl;
+    return 1;
+  }
+  if( maxJacobianDifference > tolerance || !indicesEqual )
+  {
+    std::cerr << "ERROR: GetJacobians() differs from GetJacobian()." << std::endl;
+    return 1;
+  }
+
+  /** Points that do not share their in-slice coordinates should take the generic path. */
+  std::vector< InputPointType > mixedPoints( 2, locations[ 0 ][ 0 ] );
+  mixedPoints[ 1 ] = locations[ 1 ][ 1 ];
+  stackTransform->TransformPoints( mixedPoints, oppsBatched );
+  for( unsigned int t = 0; t < mixedPoints.size(); ++t )
+  {
+    if( oppsBatched[ t ].EuclideanDistanceTo( stackTransform->TransformPoint( mixedPoints[ t ] ) ) > tolerance )
+    {
+      std::cerr << "ERROR: TransformPoints() fails for points at different locations." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,129 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkComputeJacobianTerms.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImage.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test checks that the multi-threaded computation of the Jacobian terms
+// for the automatic parameter estimation gives the same result for different
+// numbers of threads, and reports the timings.
+
+int
+main( void )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double ScalarType;   // ScalarType double used in elastix
+
+  typedef itk::Image< short, Dimension >          ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    ScalarType, Dimension, SplineOrder >          BSplineTransformType;
+  typedef itk::AdvancedTransform<
+    ScalarType, Dimension, Dimension >            TransformType;
+  typedef itk::ComputeJacobianTerms<
+    ImageType, TransformType >                    ComputeJacobianTermsType;
+
+  /** Create a fixed image of 64^3 voxels. */
+  ImageType::Pointer    image = ImageType::New();
+  ImageType::RegionType region;
+  ImageType::SizeType   imageSize;
+  imageSize.Fill( 64 );
+  region.SetSize( imageSize );
+  image->SetRegions( region );
+  image->Allocate();
+  image->FillBuffer( 0 );
+
+  /** Create a B-spline transform with a 12^3 grid covering the image. */
+  BSplineTransformType::Pointer transform = BSplineTransformType::New();
+  BSplineTransformType::SizeType gridSize;
+  gridSize.Fill( 12 );
+  BSplineTransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  BSplineTransformType::SpacingType gridSpacing;
+  gridSpacing.Fill( 63.0 / 9.0 );
+  BSplineTransformType::OriginType gridOrigin;
+  gridOrigin.Fill( -gridSpacing[ 0 ] );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+  BSplineTransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  transform->SetParameters( parameters );
+
+  /** Compute the terms with 1 and with 4 threads. */
+  const unsigned int numberOfThreads[ 2 ] = { 1, 4 };
+  double             TrC[ 2 ], TrCC[ 2 ], maxJJ[ 2 ], maxJCJ[ 2 ];
+  std::cerr << std::setprecision( 4 );
+  for( unsigned int i = 0; i < 2; ++i )
+  {
+    ComputeJacobianTermsType::Pointer computeJacobianTerms = ComputeJacobianTermsType::New();
+    computeJacobianTerms->SetFixedImage( image );
+    computeJacobianTerms->SetFixedImageRegion( region );
+    computeJacobianTerms->SetTransform( transform.GetPointer() );
+    computeJacobianTerms->SetMaxBandCovSize( 192 );
+    computeJacobianTerms->SetNumberOfBandStructureSamples( 10 );
+    computeJacobianTerms->SetNumberOfJacobianMeasurements( 100000 );
+    computeJacobianTerms->SetUseScales( false );
+    computeJacobianTerms->SetNumberOfWorkUnits( numberOfThreads[ i ] );
+
+    itk::TimeProbe timer;
+    timer.Start();
+    try
+    {
+      computeJacobianTerms->Compute( TrC[ i ], TrCC[ i ], maxJJ[ i ], maxJCJ[ i ] );
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      std::cerr << excp << std::endl;
+      return 1;
+    }
+    timer.Stop();
+
+    std::cerr << "Computation time using " << numberOfThreads[ i ] << " threads: "
+              << timer.GetMean() << " s." << std::endl;
+    std::cerr << "  TrC = " << TrC[ i ] << ", TrCC = " << TrCC[ i ]
+              << ", maxJJ = " << maxJJ[ i ] << ", maxJCJ = " << maxJCJ[ i ] << std::endl;
+  }
+
+  /** Check the results. Only the summation order differs between both. */
+  const double tolerance = 1e-10;
+  if( std::abs( TrC[ 0 ] - TrC[ 1 ] ) > tolerance * std::abs( TrC[ 0 ] )
+    || std::abs( TrCC[ 0 ] - TrCC[ 1 ] ) > tolerance * std::abs( TrCC[ 0 ] )
+    || std::abs( maxJJ[ 0 ] - maxJJ[ 1 ] ) > tolerance * std::abs( maxJJ[ 0 ] )
+    || std::abs( maxJCJ[ 0 ] - maxJCJ[ 1 ] ) > tolerance * std::abs( maxJCJ[ 0 ] ) )
+  {
+    std::cerr << "ERROR: the multi-threaded result differs from the single-threaded result." << std::endl;
+    return 1;
+  }
+  if( TrC[ 0 ] <= 0.0 || maxJJ[ 0 ] <= 0.0 )
+  {
+    std::cerr << "ERROR: the Jacobian terms are not positive." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
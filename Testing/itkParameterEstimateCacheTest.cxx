@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParameterEstimateCache.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iostream>
+
+//-------------------------------------------------------------------------------------
+// This test checks that the entries of the ParameterEstimateCache survive
+// a round trip through the cache file, exactly.
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify the cache file name." << std::endl;
+    return 1;
+  }
+  const std::string fileName = argv[ 1 ];
+  itksys::SystemTools::RemoveFile( fileName.c_str() );
+
+  typedef itk::ParameterEstimateCache CacheType;
+  typedef CacheType::ValuesType       ValuesType;
+
+  /** A cache file that does not exist is empty. */
+  CacheType::Pointer cache = CacheType::New();
+  cache->SetFileName( fileName );
+  if( cache->ReadFile() != 0 )
+  {
+    std::cerr << "ERROR: a non-existing cache file should be empty." << std::endl;
+    return 1;
+  }
+
+  /** Add some entries. The second entry of key1 replaces the first. */
+  ValuesType values1( 3 ), values2( 2 );
+  values1[ 0 ] = 1.0 / 3.0; values1[ 1 ] = -2.5e-12; values1[ 2 ] = 20.0;
+  values2[ 0 ] = 3.0e8;     values2[ 1 ] = 0.1;
+  const std::string key1 = "ParameterMap:" + CacheType::GetChecksum( "parameters" ) + ",Resolution:0";
+  const std::string key2 = "ParameterMap:" + CacheType::GetChecksum( "parameters" ) + ",Resolution:1";
+  cache->AddEntry( key1, values2, 1.0 );
+  cache->AddEntry( key1, values1, 12.5 );
+  cache->AddEntry( key2, values2, 3.25 );
+
+  /** Keys with white space are not allowed. */
+  bool exceptionThrown = false;
+  try
+  {
+    cache->AddEntry( "invalid key", values1, 1.0 );
+  }
+  catch( itk::ExceptionObject & )
+  {
+    exceptionThrown = true;
+  }
+  if( !exceptionThrown )
+  {
+    std::cerr << "ERROR: a key with white space should not be accepted." << std::endl;
+    return 1;
+  }
+
+  /** Append a line that cannot be parsed, which should be ignored. */
+  {
+    std::ofstream file( fileName.c_str(), std::ios::out | std::ios::app );
+    file << "key3 1.0 nonsense 2.0\n";
+  }
+
+  /** Read the cache in a new object and compare. */
+  CacheType::Pointer cache2 = CacheType::New();
+  cache2->SetFileName( fileName );
+  if( cache2->ReadFile() != 2 )
+  {
+    std::cerr << "ERROR: the cache file should contain two valid keys." << std::endl;
+    return 1;
+  }
+
+  ValuesType values;
+  double     estimationTime = 0.0;
+  if( !cache2->GetEntry( key1, values, estimationTime )
+    || values != values1 || estimationTime != 12.5 )
+  {
+    std::cerr << "ERROR: the entry of key1 was not read back exactly." << std::endl;
+    return 1;
+  }
+  if( !cache2->GetEntry( key2, values, estimationTime )
+    || values != values2 || estimationTime != 3.25 )
+  {
+    std::cerr << "ERROR: the entry of key2 was not read back exactly." << std::endl;
+    return 1;
+  }
+  if( cache2->GetEntry( "key3", values, estimationTime ) )
+  {
+    std::cerr << "ERROR: an invalid line should be ignored." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,96 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkStochasticConvergenceMonitor.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <cmath>
+#include <iostream>
+
+//-------------------------------------------------------------------------------------
+// This test checks that the StochasticConvergenceMonitor stops a noisy, decaying
+// sequence of metric values after it levels off, but not while it still decreases.
+
+int
+main( void )
+{
+  typedef itk::StochasticConvergenceMonitor                      MonitorType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+  randomGenerator->SetSeed( 12345 );
+
+  MonitorType::Pointer monitor = MonitorType::New();
+  monitor->SetWindowSize( 100 );
+  monitor->SetRelativeTolerance( 1e-3 );
+  monitor->SetConfidenceFactor( 2.0 );
+
+  /** A noisy exponential decay should converge after it has levelled off. */
+  monitor->Initialize();
+  unsigned int iteration = 0;
+  for( iteration = 0; iteration < 4000; ++iteration )
+  {
+    const double value = 1.0 + std::exp( -iteration / 200.0 )
+      + 0.005 * randomGenerator->GetNormalVariate();
+    if( monitor->AddValue( value ) )
+    {
+      break;
+    }
+  }
+  std::cerr << "The exponential decay converged after " << iteration << " iterations; "
+            << "relative decrease: " << monitor->GetRelativeDecrease() << " +/- "
+            << monitor->GetRelativeDecreaseStandardError() << std::endl;
+  if( iteration < 500 || iteration >= 2000 )
+  {
+    std::cerr << "ERROR: the exponential decay should converge between 500 and 2000 iterations." << std::endl;
+    return 1;
+  }
+  if( !monitor->GetConverged() )
+  {
+    std::cerr << "ERROR: GetConverged() should return true." << std::endl;
+    return 1;
+  }
+
+  /** A steady decrease should not converge. */
+  monitor->Initialize();
+  for( iteration = 0; iteration < 900; ++iteration )
+  {
+    const double value = 10.0 - 0.01 * iteration
+      + 0.005 * randomGenerator->GetNormalVariate();
+    if( monitor->AddValue( value ) )
+    {
+      std::cerr << "ERROR: a steady decrease should not converge." << std::endl;
+      return 1;
+    }
+  }
+
+  /** A window size of zero disables the monitor. */
+  monitor->SetWindowSize( 0 );
+  monitor->Initialize();
+  for( iteration = 0; iteration < 1000; ++iteration )
+  {
+    if( monitor->AddValue( 1.0 ) )
+    {
+      std::cerr << "ERROR: a disabled monitor should never converge." << std::endl;
+      return 1;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
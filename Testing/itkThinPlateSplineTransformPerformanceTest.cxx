@@ -16,12 +16,16 @@
  *
  *=========================================================================*/
 #include "SplineKernelTransform/itkThinPlateSplineKernelTransform2.h"
+#include "SplineKernelTransform/itkWendlandSplineKernelTransform2.h"
 #include "itkTransformixInputPointFileReader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 // Report timings
 #include "itkTimeProbe.h"
 #include "itkTimeProbesCollectorBase.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 
@@ -369,6 +373,168 @@ main( int argc, char * argv[] )
 
   } // end loop
 
+  //
+  // Test the scalable, compactly supported kernel transform
+
+  typedef itk::WendlandSplineKernelTransform2<
+    ScalarType, Dimension >                              WendlandTransformType;
+  typedef WendlandTransformType::ParametersType           ParametersType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator MersenneTwisterType;
+
+  MersenneTwisterType::Pointer randomGenerator = MersenneTwisterType::GetInstance();
+  randomGenerator->SetSeed( 1234 );
+
+  std::vector< unsigned long > wendlandNumberOfLandmarks;
+  wendlandNumberOfLandmarks.push_back( 500 );
+  wendlandNumberOfLandmarks.push_back( 5000 );
+#ifdef _ELASTIX_TEST_TIMING
+  wendlandNumberOfLandmarks.push_back( 50000 );
+#endif
+
+  for( std::size_t i = 0; i < wendlandNumberOfLandmarks.size(); i++ )
+  {
+    itk::TimeProbesCollectorBase timeCollector;
+
+    const unsigned long numberOfLandmarks = wendlandNumberOfLandmarks[ i ];
+    std::cerr << "----------------------------------------\n";
+    std::cerr << "Wendland spline, number of landmarks: "
+              << numberOfLandmarks << std::endl;
+
+    /** Random source landmarks in a 100 mm cube, and a smooth displacement. */
+    PointsContainerPointer sourcePoints = PointsContainerType::New();
+    PointSetType::Pointer  sourceSet    = PointSetType::New();
+    ParametersType         targetParameters( numberOfLandmarks * Dimension );
+    for( unsigned long j = 0; j < numberOfLandmarks; j++ )
+    {
+      PointType tmp;
+      for( unsigned int d = 0; d < Dimension; d++ )
+      {
+        tmp[ d ] = randomGenerator->GetUniformVariate( 0.0, 100.0 );
+      }
+      sourcePoints->push_back( tmp );
+      for( unsigned int d = 0; d < Dimension; d++ )
+      {
+        targetParameters[ j * Dimension + d ] = tmp[ d ]
+          + 2.0 * std::sin( tmp[ ( d + 1 ) % Dimension ] / 10.0 ) + 0.01 * tmp[ d ];
+      }
+    }
+    sourceSet->SetPoints( sourcePoints );
+
+    WendlandTransformType::Pointer wendlandTransform = WendlandTransformType::New();
+    wendlandTransform->SetStiffness( 0.0 ); // interpolating
+    wendlandTransform->SetSolverTolerance( 1e-10 );
+    wendlandTransform->SetMaximumNumberOfSolverIterations( 100000 );
+
+    timeCollector.Start( "WendlandSetSourceLandmarks" );
+    wendlandTransform->SetSourceLandmarks( sourceSet );
+    timeCollector.Stop( "WendlandSetSourceLandmarks" );
+
+    timeCollector.Start( "WendlandSetParameters" );
+    wendlandTransform->SetParameters( targetParameters );
+    timeCollector.Stop( "WendlandSetParameters" );
+
+    std::cerr << "Support radius: " << wendlandTransform->GetUsedSupportRadius()
+              << ", non-zero kernel elements: "
+              << wendlandTransform->GetNumberOfNonZeroKernelElements()
+              << ", kernel factorization: "
+              << wendlandTransform->GetKernelFactorizationComputed() << std::endl;
+
+    /** The interpolating spline should map the source to the target landmarks. */
+    double maxError = 0.0;
+    timeCollector.Start( "WendlandTransformPoint" );
+    for( unsigned long j = 0; j < numberOfLandmarks; j++ )
+    {
+      const PointType q = wendlandTransform->TransformPoint( sourcePoints->ElementAt( j ) );
+      for( unsigned int d = 0; d < Dimension; d++ )
+      {
+        maxError = std::max( maxError,
+          std::abs( q[ d ] - targetParameters[ j * Dimension + d ] ) );
+      }
+    }
+    timeCollector.Stop( "WendlandTransformPoint" );
+
+    std::cerr << "Maximum landmark error: " << maxError << std::endl;
+    if( maxError > 1e-6 )
+    {
+      std::cerr << "ERROR: Wendland spline does not interpolate the landmarks: "
+                << maxError << std::endl;
+      return 1;
+    }
+
+    /** Compare the Jacobian with finite differences, for the smallest set. */
+    if( i == 0 )
+    {
+      PointType p; p[ 0 ] = 40.0; p[ 1 ] = 53.0; p[ 2 ] = 61.0;
+      JacobianType               jac;
+      NonZeroJacobianIndicesType nzji;
+      timeCollector.Start( "WendlandGetJacobian" );
+      wendlandTransform->GetJacobian( p, jac, nzji );
+      timeCollector.Stop( "WendlandGetJacobian" );
+
+      const double delta = 1e-3;
+      for( unsigned long par = 0; par < targetParameters.GetSize(); par += 97 )
+      {
+        ParametersType parametersPlus  = targetParameters;
+        ParametersType parametersMinus = targetParameters;
+        parametersPlus[ par ]  += delta;
+        parametersMinus[ par ] -= delta;
+        wendlandTransform->SetParameters( parametersPlus );
+        const PointType qPlus = wendlandTransform->TransformPoint( p );
+        wendlandTransform->SetParameters( parametersMinus );
+        const PointType qMinus = wendlandTransform->TransformPoint( p );
+        for( unsigned int d = 0; d < Dimension; d++ )
+        {
+          const double fd = ( qPlus[ d ] - qMinus[ d ] ) / ( 2.0 * delta );
+          if( std::abs( fd - jac[ d ][ par ] ) > 1e-5 )
+          {
+            std::cerr << "ERROR: Wendland spline Jacobian differs from finite "
+                      << "difference at parameter " << par << ": "
+                      << jac[ d ][ par ] << " vs " << fd << std::endl;
+            return 1;
+          }
+        }
+      }
+      wendlandTransform->SetParameters( targetParameters );
+
+      /** The cached Cholesky factor and the iterative solver should agree. */
+      WendlandTransformType::Pointer iterativeTransform = WendlandTransformType::New();
+      iterativeTransform->SetStiffness( 0.0 );
+      iterativeTransform->SetSolverTolerance( 1e-12 );
+      iterativeTransform->SetMaximumNumberOfSolverIterations( 100000 );
+      iterativeTransform->SetMaximumNumberOfFactorElements( 0 );
+      iterativeTransform->SetSourceLandmarks( sourceSet );
+      iterativeTransform->SetParameters( targetParameters );
+      if( !wendlandTransform->GetKernelFactorizationComputed()
+        || iterativeTransform->GetKernelFactorizationComputed() )
+      {
+        std::cerr << "ERROR: unexpected Wendland spline kernel factorization state." << std::endl;
+        return 1;
+      }
+
+      JacobianType iterativeJac;
+      timeCollector.Start( "WendlandGetJacobianIterative" );
+      iterativeTransform->GetJacobian( p, iterativeJac, nzji );
+      timeCollector.Stop( "WendlandGetJacobianIterative" );
+      for( unsigned long par = 0; par < targetParameters.GetSize(); par++ )
+      {
+        for( unsigned int d = 0; d < Dimension; d++ )
+        {
+          if( std::abs( iterativeJac[ d ][ par ] - jac[ d ][ par ] ) > 1e-6 )
+          {
+            std::cerr << "ERROR: Wendland spline Jacobian differs between the "
+                      << "factorized and the iterative solver at parameter " << par
+                      << ": " << jac[ d ][ par ] << " vs " << iterativeJac[ d ][ par ] << std::endl;
+            return 1;
+          }
+        }
+      }
+    }
+
+    // Report timings
+    timeCollector.Report();
+    std::cout << std::endl;
+  }
+
   /** Return a value. */
   return 0;
 
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTransformToInverseDisplacementFieldSource.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test inverts a smooth, invertible B-spline transform, and checks that
+// T(y + u(y)) = y for the computed inverse displacement u.
+
+int
+main( void )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 2;
+  const unsigned int SplineOrder = 3;
+  typedef double ScalarType;   // ScalarType double used in elastix
+
+  typedef itk::AdvancedBSplineDeformableTransform<
+    ScalarType, Dimension, SplineOrder >                  TransformType;
+  typedef TransformType::ParametersType                   ParametersType;
+  typedef TransformType::InputPointType                   InputPointType;
+  typedef TransformType::OutputPointType                  OutputPointType;
+  typedef itk::Vector< float, Dimension >                 VectorPixelType;
+  typedef itk::Image< VectorPixelType, Dimension >        DeformationFieldImageType;
+  typedef itk::TransformToInverseDisplacementFieldSource<
+    DeformationFieldImageType, ScalarType >               InverseGeneratorType;
+  typedef itk::ImageRegionConstIteratorWithIndex<
+    DeformationFieldImageType >                           IteratorType;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator MersenneTwisterType;
+
+  /** Create the transform, with a grid of 10 x 10 control points
+   * covering the domain [0,100] x [0,100].
+   */
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::SizeType gridSize;
+  gridSize.Fill( 10 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  TransformType::SpacingType gridSpacing;
+  gridSpacing.Fill( 100.0 / 6.0 );
+  TransformType::OriginType gridOrigin;
+  gridOrigin.Fill( -1.5 * gridSpacing[ 0 ] );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  /** Set random coefficients that are small compared to the grid spacing,
+   * so that the transform is invertible.
+   */
+  MersenneTwisterType::Pointer randomNum = MersenneTwisterType::GetInstance();
+  randomNum->SetSeed( 1234 );
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = randomNum->GetUniformVariate( -3.0, 3.0 );
+  }
+  transform->SetParameters( parameters );
+
+  /** Compute the inverse on a 200 x 200 grid. */
+  const double tolerance = 1e-4;
+  DeformationFieldImageType::RegionType region;
+  DeformationFieldImageType::SizeType   size;
+  size.Fill( 200 );
+  region.SetSize( size );
+  DeformationFieldImageType::SpacingType spacing;
+  spacing.Fill( 0.5 );
+
+  InverseGeneratorType::Pointer invGenerator = InverseGeneratorType::New();
+  invGenerator->SetTransform( transform );
+  invGenerator->SetOutputRegion( region );
+  invGenerator->SetOutputSpacing( spacing );
+  invGenerator->SetTolerance( tolerance );
+
+  itk::TimeProbe timer;
+  timer.Start();
+  try
+  {
+    invGenerator->Update();
+  }
+  catch( itk::ExceptionObject & excp )
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+  timer.Stop();
+
+  std::cerr << std::setprecision( 4 );
+  std::cerr << "Inversion computation time: " << timer.GetMean() << " s." << std::endl;
+  std::cerr << "Maximum residual: " << invGenerator->GetMaximumResidual() << std::endl;
+  std::cerr << "Mean residual: " << invGenerator->GetMeanResidual() << std::endl;
+  std::cerr << "Non converged pixels: " << invGenerator->GetNumberOfNonConvergedPixels() << std::endl;
+
+  /** Check independently that T(y + u(y)) = y. The displacements are stored
+   * as floats, so the check is somewhat less strict than the tolerance.
+   */
+  DeformationFieldImageType::Pointer field = invGenerator->GetOutput();
+  double                             maxError = 0.0;
+  for( IteratorType it( field, field->GetLargestPossibleRegion() ); !it.IsAtEnd(); ++it )
+  {
+    DeformationFieldImageType::PointType y;
+    field->TransformIndexToPhysicalPoint( it.GetIndex(), y );
+    InputPointType x;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      x[ d ] = y[ d ] + it.Get()[ d ];
+    }
+    const OutputPointType Tx = transform->TransformPoint( x );
+    maxError = std::max( maxError, Tx.EuclideanDistanceTo( y ) );
+  }
+  std::cerr << "Maximum error of T(y + u(y)): " << maxError << std::endl;
+
+  /** Check the results. */
+  if( invGenerator->GetNumberOfNonConvergedPixels() != 0
+    || invGenerator->GetMaximumResidual() > tolerance )
+  {
+    std::cerr << "ERROR: the inversion did not converge everywhere." << std::endl;
+    return 1;
+  }
+  if( maxError > 1e-3 )
+  {
+    std::cerr << "ERROR: the inverse displacement field is not accurate." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
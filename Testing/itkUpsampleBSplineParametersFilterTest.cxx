@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkUpsampleBSplineParametersFilter.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test checks that the exact B-spline refinement of the
+// UpsampleBSplineParametersFilter reproduces the coarse transform on the
+// fine grid, and compares its timing with the general resampling approach.
+
+int
+main( void )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double ScalarType;   // ScalarType double used in elastix
+
+  typedef itk::AdvancedBSplineDeformableTransform<
+    ScalarType, Dimension, SplineOrder >                 TransformType;
+  typedef TransformType::ParametersType                  ParametersType;
+  typedef TransformType::ImageType                       ImageType;
+  typedef TransformType::InputPointType                  InputPointType;
+  typedef itk::UpsampleBSplineParametersFilter<
+    ParametersType, ImageType >                          UpsampleFilterType;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator MersenneTwisterType;
+
+  /** The coarse grid: 20^3 control points with spacing 10. */
+  const unsigned int         coarseSize    = 20;
+  const double               coarseSpacing = 10.0;
+  TransformType::RegionType  coarseRegion;
+  TransformType::SizeType    size;
+  TransformType::SpacingType spacing;
+  TransformType::OriginType  coarseOrigin;
+  TransformType::DirectionType direction;
+  size.Fill( coarseSize );
+  coarseRegion.SetSize( size );
+  spacing.Fill( coarseSpacing );
+  coarseOrigin.Fill( -1.5 * coarseSpacing );
+  direction.SetIdentity();
+
+  TransformType::Pointer coarseTransform = TransformType::New();
+  coarseTransform->SetGridRegion( coarseRegion );
+  coarseTransform->SetGridSpacing( spacing );
+  coarseTransform->SetGridOrigin( coarseOrigin );
+  coarseTransform->SetGridDirection( direction );
+
+  /** The fine grid, with half the spacing. The fine basis functions that
+   * refine the first coarse basis function start 2 fine grid points earlier.
+   */
+  TransformType::RegionType  fineRegion;
+  TransformType::SpacingType fineSpacing;
+  TransformType::OriginType  fineOrigin;
+  size.Fill( 2 * ( coarseSize - 1 ) + SplineOrder + 2 );
+  fineRegion.SetSize( size );
+  fineSpacing.Fill( coarseSpacing / 2.0 );
+  fineOrigin.Fill( coarseOrigin[ 0 ] - 0.5 * ( SplineOrder + 1 ) * fineSpacing[ 0 ] );
+
+  /** Set random coefficients. */
+  MersenneTwisterType::Pointer randomNum = MersenneTwisterType::GetInstance();
+  randomNum->SetSeed( 1234 );
+  ParametersType coarseParameters( coarseTransform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < coarseParameters.GetSize(); ++i )
+  {
+    coarseParameters[ i ] = randomNum->GetUniformVariate( -5.0, 5.0 );
+  }
+  coarseTransform->SetParameters( coarseParameters );
+
+  /** Setup the upsampler. */
+  UpsampleFilterType::Pointer upsampler = UpsampleFilterType::New();
+  upsampler->SetCurrentGridOrigin( coarseOrigin );
+  upsampler->SetCurrentGridSpacing( spacing );
+  upsampler->SetCurrentGridRegion( coarseRegion );
+  upsampler->SetCurrentGridDirection( direction );
+  upsampler->SetRequiredGridOrigin( fineOrigin );
+  upsampler->SetRequiredGridSpacing( fineSpacing );
+  upsampler->SetRequiredGridRegion( fineRegion );
+  upsampler->SetRequiredGridDirection( direction );
+  upsampler->SetBSplineOrder( SplineOrder );
+
+  /** Time the exact refinement and the general approach. */
+  ParametersType fineParameters, fineParametersGeneral;
+  itk::TimeProbe timer1, timer2;
+  timer1.Start();
+  upsampler->UseRefinementOn();
+  upsampler->UpsampleParameters( coarseParameters, fineParameters );
+  timer1.Stop();
+  timer2.Start();
+  upsampler->UseRefinementOff();
+  upsampler->UpsampleParameters( coarseParameters, fineParametersGeneral );
+  timer2.Stop();
+
+  std::cerr << std::setprecision( 4 );
+  std::cerr << "Exact refinement computation time: " << timer1.GetMean() << " s." << std::endl;
+  std::cerr << "General upsampling computation time: " << timer2.GetMean() << " s." << std::endl;
+
+  /** Create the fine transform. */
+  TransformType::Pointer fineTransform = TransformType::New();
+  fineTransform->SetGridRegion( fineRegion );
+  fineTransform->SetGridSpacing( fineSpacing );
+  fineTransform->SetGridOrigin( fineOrigin );
+  fineTransform->SetGridDirection( direction );
+  fineTransform->SetParameters( fineParameters );
+
+  /** Compare both transforms at random points inside the valid region of the coarse grid. */
+  const double lowerBound = coarseOrigin[ 0 ] + coarseSpacing;
+  const double upperBound = coarseOrigin[ 0 ] + ( coarseSize - 2 ) * coarseSpacing;
+  double       maxDifference = 0.0;
+  for( unsigned int i = 0; i < 10000; ++i )
+  {
+    InputPointType point;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      point[ d ] = randomNum->GetUniformVariate( lowerBound, upperBound );
+    }
+    maxDifference = std::max( maxDifference, coarseTransform->TransformPoint( point )
+      .EuclideanDistanceTo( fineTransform->TransformPoint( point ) ) );
+  }
+  std::cerr << "Maximum difference between coarse and refined transform: "
+            << maxDifference << std::endl;
+
+  /** Check the results. */
+  if( maxDifference > 1e-10 )
+  {
+    std::cerr << "ERROR: the refined transform differs from the coarse transform." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main